@@ -49,6 +49,7 @@ function __fish_fwupdmgr_subcommands --description 'Get fwupdmgr subcommands'
         modify-remote 'Modifies a given remote' \
         monitor 'Monitor the daemon for events' \
         clean-remote 'Clean a given remote' \
+        prefetch 'Downloads the latest firmware so that it can be installed later' \
         quit 'Asks the daemon to quit' \
         refresh 'Refresh metadata from remote server' \
         reinstall 'Reinstall current firmware on the device' \
@@ -77,6 +78,7 @@ complete -c fwupdmgr -s h -l help -d 'Show help options'
 complete -c fwupdmgr -s v -l verbose -d 'Show extra debugging information'
 complete -c fwupdmgr -l version -d 'Show client and daemon versions'
 complete -c fwupdmgr -l download-retries -x -d 'Set the download retries for transient errors'
+complete -c fwupdmgr -l download-cache -r -d 'Keep downloaded firmware in a directory, which may be shared by all users'
 complete -c fwupdmgr -l allow-reinstall -d 'Allow reinstalling existing firmware versions'
 complete -c fwupdmgr -l allow-older -d 'Allow downgrading firmware versions'
 complete -c fwupdmgr -l allow-branch-switch -d 'Allow switching firmware branch'
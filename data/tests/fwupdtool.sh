@@ -27,6 +27,21 @@ expect_rc() {
     [ "$expected" -eq "$rc" ] || error "$rc" "$expected"
 }
 
+expect_output() {
+    grep -q -- "$1" fwupdtool.txt && return
+    cat fwupdtool.txt
+    echo " ● output did not contain ${1}"
+    exit 1
+}
+
+expect_lines() {
+    count=$(grep -c -- "$1" fwupdtool.txt)
+    [ "$count" -eq "$2" ] && return
+    cat fwupdtool.txt
+    echo " ● output contained ${1} ${count} times and expected ${2}"
+    exit 1
+}
+
 run() {
     cmd="fwupdtool -v --plugins test $*"
     echo " ● cmd: $cmd" >fwupdtool.txt
@@ -224,6 +239,28 @@ echo " ● Firmware parse blob (auto)…"
 run firmware-parse ${TMPDIR}/blob.srec auto
 expect_rc 0
 
+# ---
+echo " ● Firmware batch parse directory…"
+mkdir -p ${TMPDIR}/batch/subdir
+cp ${TMPDIR}/blob.srec ${TMPDIR}/batch/
+cp ${TMPDIR}/blob.srec ${TMPDIR}/batch/subdir/
+mkfifo ${TMPDIR}/batch/fifo
+run firmware-batch-parse ${TMPDIR}/batch
+expect_rc 0
+expect_lines '^{"Filename": ' 2
+expect_lines '"FirmwareType": "srec", "Matches": \[' 2
+expect_lines '"Error": ' 0
+expect_output "\"Filename\": \"${TMPDIR}/batch/subdir/blob.srec\""
+expect_output '"DurationUs": '
+
+# ---
+echo " ● Firmware batch parse manifest…"
+echo "${TMPDIR}/blob.srec" >${TMPDIR}/batch.txt
+run firmware-batch-parse ${TMPDIR}/batch.txt srec
+expect_rc 0
+expect_lines '^{"Filename": ' 1
+expect_output '"FirmwareType": "srec", "Matches": \["srec"\]'
+
 # ---
 echo " ● Firmware extract…"
 run firmware-extract ${TMPDIR}/blob.srec srec
@@ -220,6 +220,34 @@ struct FwupdClientSyncImpl {
 
 const FwupdClientSyncImpl *
 fwupd_client_get_sync_impl(FwupdClient *self, gpointer *impl_userdata) G_GNUC_NON_NULL(1);
+void
+fwupd_client_download_release_async(FwupdClient *self,
+				    FwupdRelease *release,
+				    FwupdRemote *remote,
+				    FwupdClientDownloadFlags download_flags,
+				    GCancellable *cancellable,
+				    GAsyncReadyCallback callback,
+				    gpointer callback_data) G_GNUC_NON_NULL(1, 2);
+GBytes *
+fwupd_client_download_release_finish(FwupdClient *self,
+				     GAsyncResult *res,
+				     GError **error) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_NON_NULL(1, 2);
+void
+fwupd_client_download_metadata_async(FwupdClient *self,
+				     FwupdRemote *remote,
+				     FwupdClientDownloadFlags download_flags,
+				     GCancellable *cancellable,
+				     GAsyncReadyCallback callback,
+				     gpointer callback_data) G_GNUC_NON_NULL(1, 2);
+GBytes *
+fwupd_client_download_metadata_finish(FwupdClient *self,
+				      GAsyncResult *res,
+				      GError **error) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_NON_NULL(1, 2);
+GBytes *
+fwupd_client_metadata_delta_apply(GBytes *basis, GBytes *delta, GError **error)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
 
 #ifdef HAVE_GIO_UNIX
 void
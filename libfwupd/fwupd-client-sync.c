@@ -2196,6 +2196,59 @@ fwupd_client_install_release(FwupdClient *self,
 				     error);
 }
 
+static void
+fwupd_client_prefetch_releases_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientHelper *helper = (FwupdClientHelper *)user_data;
+	helper->ret =
+	    fwupd_client_prefetch_releases_finish(FWUPD_CLIENT(source), res, &helper->error);
+	g_main_loop_quit(helper->loop);
+}
+
+/**
+ * fwupd_client_prefetch_releases:
+ * @self: a #FwupdClient
+ * @releases: (element-type FwupdRelease): releases
+ * @download_flags: download flags, e.g. %FWUPD_CLIENT_DOWNLOAD_FLAG_NONE
+ * @cancellable: (nullable): optional #GCancellable
+ * @error: (nullable): optional return location for an error
+ *
+ * Downloads the firmware for all the releases at the same time into the download cache.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.2.1
+ **/
+gboolean
+fwupd_client_prefetch_releases(FwupdClient *self,
+			       GPtrArray *releases,
+			       FwupdClientDownloadFlags download_flags,
+			       GCancellable *cancellable,
+			       GError **error)
+{
+	g_autoptr(FwupdClientHelper) helper = NULL;
+
+	g_return_val_if_fail(FWUPD_IS_CLIENT(self), FALSE);
+	g_return_val_if_fail(releases != NULL, FALSE);
+	g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* call async version and run loop until complete */
+	helper = fwupd_client_helper_new(self);
+	fwupd_client_prefetch_releases_async(self,
+					     releases,
+					     download_flags,
+					     cancellable,
+					     fwupd_client_prefetch_releases_cb,
+					     helper);
+	g_main_loop_run(helper->loop);
+	if (!helper->ret) {
+		g_propagate_error(error, g_steal_pointer(&helper->error));
+		return FALSE;
+	}
+	return TRUE;
+}
+
 #ifdef HAVE_GIO_UNIX
 static void
 fwupd_client_update_metadata_cb(GObject *source, GAsyncResult *res, gpointer user_data)
@@ -163,6 +163,12 @@ fwupd_client_install_release(FwupdClient *self,
 			     GCancellable *cancellable,
 			     GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2, 3);
 gboolean
+fwupd_client_prefetch_releases(FwupdClient *self,
+			       GPtrArray *releases,
+			       FwupdClientDownloadFlags download_flags,
+			       GCancellable *cancellable,
+			       GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
+gboolean
 fwupd_client_update_metadata(FwupdClient *self,
 			     const gchar *remote_id,
 			     const gchar *metadata_fn,
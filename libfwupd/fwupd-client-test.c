@@ -6,9 +6,18 @@
 
 #include "config.h"
 
+#include <glib/gstdio.h>
+
 #include "fwupd-client-private.h"
+#include "fwupd-client-sync-private.h"
 #include "fwupd-client-sync.h"
+#include "fwupd-codec.h"
+#include "fwupd-common.h"
 #include "fwupd-error.h"
+#include "fwupd-jcat-blob.h"
+#include "fwupd-jcat-file.h"
+#include "fwupd-jcat-item.h"
+#include "fwupd-remote-private.h"
 #include "fwupd-test.h"
 
 static gboolean
@@ -153,6 +162,623 @@ fwupd_client_download_func(void)
 	g_assert_null(blob2);
 }
 
+/* a minimal HTTP server that supports If-None-Match, as the LVFS CDN does */
+typedef struct {
+	GSocketListener *listener;
+	GCancellable *cancellable;
+	GThread *thread;
+	GMutex mutex;	    /* for @files, @hits and @not_modified */
+	GHashTable *files;  /* path:GBytes */
+	GHashTable *hits;   /* path:count of 200 responses */
+	guint not_modified; /* count of 304 responses */
+	guint16 port;
+} FwupdClientTestServer;
+
+static void
+fwupd_client_test_server_handle(FwupdClientTestServer *server, GSocketConnection *connection)
+{
+	GBytes *blob = NULL;
+	GOutputStream *ostream = g_io_stream_get_output_stream(G_IO_STREAM(connection));
+	g_autofree gchar *etag = NULL;
+	g_autofree gchar *if_none_match = NULL;
+	g_autofree gchar *request = NULL;
+	g_autoptr(GDataInputStream) istream = NULL;
+	g_autoptr(GString) response = g_string_new(NULL);
+	g_auto(GStrv) split = NULL;
+
+	istream = g_data_input_stream_new(g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+	g_data_input_stream_set_newline_type(istream, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+	request = g_data_input_stream_read_line(istream, NULL, NULL, NULL);
+	if (request == NULL)
+		return;
+	while (TRUE) {
+		g_autofree gchar *line = g_data_input_stream_read_line(istream, NULL, NULL, NULL);
+		if (line == NULL || line[0] == '\0')
+			break;
+		if (g_ascii_strncasecmp(line, "If-None-Match: ", 15) == 0)
+			if_none_match = g_strdup(line + 15);
+	}
+	split = g_strsplit(request, " ", -1);
+
+	g_mutex_lock(&server->mutex);
+	if (g_strv_length(split) >= 2)
+		blob = g_hash_table_lookup(server->files, split[1]);
+	if (blob == NULL) {
+		g_string_append(response, "HTTP/1.1 404 Not Found\r\n");
+		g_string_append(response, "Content-Length: 0\r\nConnection: close\r\n\r\n");
+	} else {
+		g_autofree gchar *checksum = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob);
+		etag = g_strdup_printf("\"%s\"", checksum);
+		if (g_strcmp0(if_none_match, etag) == 0) {
+			server->not_modified++;
+			g_string_append(response, "HTTP/1.1 304 Not Modified\r\n");
+			g_string_append_printf(response, "ETag: %s\r\n", etag);
+			g_string_append(response, "Connection: close\r\n\r\n");
+		} else {
+			guint hits = GPOINTER_TO_UINT(g_hash_table_lookup(server->hits, split[1]));
+			g_hash_table_insert(server->hits,
+					    g_strdup(split[1]),
+					    GUINT_TO_POINTER(hits + 1));
+			g_string_append(response, "HTTP/1.1 200 OK\r\n");
+			g_string_append_printf(response, "ETag: %s\r\n", etag);
+			g_string_append_printf(response,
+					       "Content-Length: %u\r\n",
+					       (guint)g_bytes_get_size(blob));
+			g_string_append(response, "Connection: close\r\n\r\n");
+			g_string_append_len(response,
+					    g_bytes_get_data(blob, NULL),
+					    (gssize)g_bytes_get_size(blob));
+		}
+	}
+	g_mutex_unlock(&server->mutex);
+	(void)g_output_stream_write_all(ostream, response->str, response->len, NULL, NULL, NULL);
+	(void)g_io_stream_close(G_IO_STREAM(connection), NULL, NULL);
+}
+
+static gpointer
+fwupd_client_test_server_thread_cb(gpointer user_data)
+{
+	FwupdClientTestServer *server = (FwupdClientTestServer *)user_data;
+	while (TRUE) {
+		g_autoptr(GSocketConnection) connection = NULL;
+		connection =
+		    g_socket_listener_accept(server->listener, NULL, server->cancellable, NULL);
+		if (connection == NULL)
+			break;
+		fwupd_client_test_server_handle(server, connection);
+	}
+	return NULL;
+}
+
+static FwupdClientTestServer *
+fwupd_client_test_server_new(void)
+{
+	FwupdClientTestServer *server = g_new0(FwupdClientTestServer, 1);
+	gboolean ret;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInetAddress) address = g_inet_address_new_loopback(G_SOCKET_FAMILY_IPV4);
+	g_autoptr(GSocketAddress) saddr = g_inet_socket_address_new(address, 0);
+	g_autoptr(GSocketAddress) saddr_effective = NULL;
+
+	g_mutex_init(&server->mutex);
+	server->files =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_bytes_unref);
+	server->hits = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	server->cancellable = g_cancellable_new();
+	server->listener = g_socket_listener_new();
+	ret = g_socket_listener_add_address(server->listener,
+					    saddr,
+					    G_SOCKET_TYPE_STREAM,
+					    G_SOCKET_PROTOCOL_TCP,
+					    NULL,
+					    &saddr_effective,
+					    &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	server->port = g_inet_socket_address_get_port(G_INET_SOCKET_ADDRESS(saddr_effective));
+	server->thread =
+	    g_thread_new("fwupd-client-test-server", fwupd_client_test_server_thread_cb, server);
+	return server;
+}
+
+static void
+fwupd_client_test_server_set_file(FwupdClientTestServer *server, const gchar *path, GBytes *blob)
+{
+	g_mutex_lock(&server->mutex);
+	g_hash_table_insert(server->files, g_strdup(path), g_bytes_ref(blob));
+	g_mutex_unlock(&server->mutex);
+}
+
+static guint
+fwupd_client_test_server_get_hits(FwupdClientTestServer *server, const gchar *path)
+{
+	guint hits;
+	g_mutex_lock(&server->mutex);
+	hits = GPOINTER_TO_UINT(g_hash_table_lookup(server->hits, path));
+	g_mutex_unlock(&server->mutex);
+	return hits;
+}
+
+static gchar *
+fwupd_client_test_server_build_uri(FwupdClientTestServer *server, const gchar *path)
+{
+	return g_strdup_printf("http://127.0.0.1:%u%s", server->port, path);
+}
+
+static void
+fwupd_client_test_server_free(FwupdClientTestServer *server)
+{
+	g_cancellable_cancel(server->cancellable);
+	g_thread_join(server->thread);
+	g_socket_listener_close(server->listener);
+	g_object_unref(server->listener);
+	g_object_unref(server->cancellable);
+	g_hash_table_unref(server->files);
+	g_hash_table_unref(server->hits);
+	g_mutex_clear(&server->mutex);
+	g_free(server);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FwupdClientTestServer, fwupd_client_test_server_free)
+
+/* a signature for firmware.xml.gz that lists the SHA-256 of the metadata */
+static GBytes *
+fwupd_client_test_signature_new(GBytes *metadata)
+{
+	g_autofree gchar *checksum = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, metadata);
+	g_autoptr(FwupdJcatBlob) jcat_blob = NULL;
+	g_autoptr(FwupdJcatFile) jcat_file = fwupd_jcat_file_new();
+	g_autoptr(FwupdJcatItem) jcat_item = fwupd_jcat_item_new("firmware.xml.gz");
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	jcat_blob = fwupd_jcat_blob_new_utf8(FWUPD_JCAT_BLOB_KIND_SHA256, checksum);
+	fwupd_jcat_item_add_blob(jcat_item, jcat_blob);
+	fwupd_jcat_file_add_item(jcat_file, jcat_item);
+	blob = fwupd_jcat_file_export_bytes(jcat_file, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	return g_steal_pointer(&blob);
+}
+
+static void
+fwupd_client_refresh_not_modified_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *checksum_sig = NULL;
+	g_autofree gchar *fn_validators = NULL;
+	g_autofree gchar *uri = NULL;
+	g_autoptr(FwupdClient) client1 = fwupd_client_new();
+	g_autoptr(FwupdClient) client2 = fwupd_client_new();
+	g_autoptr(FwupdClient) client3 = fwupd_client_new();
+	g_autoptr(FwupdClientTestServer) server = fwupd_client_test_server_new();
+	g_autoptr(FwupdRemote) remote = fwupd_remote_new();
+	g_autoptr(GBytes) metadata = g_bytes_new_static("<components/>", 13);
+	g_autoptr(GBytes) signature = fwupd_client_test_signature_new(metadata);
+	g_autoptr(GError) error = NULL;
+
+	/* the daemon already has this signature cached, but the metadata is not served */
+	fwupd_client_test_server_set_file(server, "/firmware.xml.gz.jcat", signature);
+	uri = fwupd_client_test_server_build_uri(server, "/firmware.xml.gz");
+	checksum_sig = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, signature);
+	fwupd_remote_set_id(remote, "not-modified");
+	fwupd_remote_set_kind(remote, FWUPD_REMOTE_KIND_DOWNLOAD);
+	fwupd_remote_set_metadata_uri(remote, uri);
+	fwupd_remote_set_checksum_sig(remote, checksum_sig);
+	fn_validators = g_build_filename(g_get_user_cache_dir(),
+					 "fwupd",
+					 "remotes.d",
+					 "not-modified",
+					 "firmware.xml.gz.jcat.validators",
+					 NULL);
+	(void)g_unlink(fn_validators);
+
+	/* no validators, so the signature is transferred but is the same */
+	fwupd_client_set_user_agent_for_package(client1, PACKAGE_NAME, PACKAGE_VERSION);
+	ret = fwupd_client_sync_impl_refresh_remote(client1,
+						    remote,
+						    FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+						    NULL,
+						    NULL,
+						    &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fwupd_client_test_server_get_hits(server, "/firmware.xml.gz.jcat"), ==, 1);
+	g_assert_cmpint(server->not_modified, ==, 0);
+	g_assert_true(g_file_test(fn_validators, G_FILE_TEST_EXISTS));
+
+	/* the ETag matches, so the server responds with 304 */
+	fwupd_client_set_user_agent_for_package(client2, PACKAGE_NAME, PACKAGE_VERSION);
+	ret = fwupd_client_sync_impl_refresh_remote(client2,
+						    remote,
+						    FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+						    NULL,
+						    NULL,
+						    &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fwupd_client_test_server_get_hits(server, "/firmware.xml.gz.jcat"), ==, 1);
+	g_assert_cmpint(server->not_modified, ==, 1);
+
+	/* the daemon has a different signature, so the validators are not sent */
+	fwupd_remote_set_checksum_sig(remote, "0000000000000000000000000000000000000000");
+	fwupd_client_set_user_agent_for_package(client3, PACKAGE_NAME, PACKAGE_VERSION);
+	ret = fwupd_client_sync_impl_refresh_remote(client3,
+						    remote,
+						    FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+						    NULL,
+						    NULL,
+						    &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_false(ret);
+	g_assert_cmpint(fwupd_client_test_server_get_hits(server, "/firmware.xml.gz.jcat"), ==, 2);
+	g_assert_cmpint(server->not_modified, ==, 1);
+	g_assert_cmpint(fwupd_client_test_server_get_hits(server, "/firmware.xml.gz"), ==, 0);
+
+	(void)g_unlink(fn_validators);
+}
+
+static void
+fwupd_client_test_delta_append_uint32(GByteArray *buf, guint32 value)
+{
+	for (guint i = 0; i < 4; i++) {
+		guint8 tmp = (value >> (i * 8)) & 0xFF; /* nocheck:endian */
+		g_byte_array_append(buf, &tmp, 1);
+	}
+}
+
+/* copy the start of the basis, insert some data, then copy the end of the basis */
+static GBytes *
+fwupd_client_test_delta_new(guint32 offset, const gchar *insert, guint32 basis_sz)
+{
+	guint8 op_copy = 0x01;
+	guint8 op_insert = 0x02;
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+
+	g_byte_array_append(buf, (const guint8 *)"FWUPDDLT", 8);
+	g_byte_array_append(buf, &op_copy, 1);
+	fwupd_client_test_delta_append_uint32(buf, 0x0);
+	fwupd_client_test_delta_append_uint32(buf, offset);
+	g_byte_array_append(buf, &op_insert, 1);
+	fwupd_client_test_delta_append_uint32(buf, strlen(insert));
+	g_byte_array_append(buf, (const guint8 *)insert, strlen(insert));
+	g_byte_array_append(buf, &op_copy, 1);
+	fwupd_client_test_delta_append_uint32(buf, offset);
+	fwupd_client_test_delta_append_uint32(buf, basis_sz - offset);
+	return g_bytes_new(buf->data, buf->len);
+}
+
+static void
+fwupd_client_delta_limit_func(void)
+{
+	const gchar *basis_str = "<components/>";
+	guint8 op_copy = 0x01;
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GBytes) basis = g_bytes_new_static(basis_str, strlen(basis_str));
+	g_autoptr(GBytes) blob_ok = NULL;
+	g_autoptr(GBytes) blob_big = NULL;
+	g_autoptr(GBytes) delta_ok = NULL;
+	g_autoptr(GBytes) delta_big = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* copying the whole basis twice is allowed */
+	g_byte_array_append(buf, (const guint8 *)"FWUPDDLT", 8);
+	for (guint i = 0; i < 2; i++) {
+		g_byte_array_append(buf, &op_copy, 1);
+		fwupd_client_test_delta_append_uint32(buf, 0x0);
+		fwupd_client_test_delta_append_uint32(buf, strlen(basis_str));
+	}
+	delta_ok = g_bytes_new(buf->data, buf->len);
+	blob_ok = fwupd_client_metadata_delta_apply(basis, delta_ok, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_ok);
+	g_assert_cmpint(g_bytes_get_size(blob_ok), ==, 2 * strlen(basis_str));
+
+	/* a tiny delta must not be able to expand forever */
+	for (guint i = 0; i < 100; i++) {
+		g_byte_array_append(buf, &op_copy, 1);
+		fwupd_client_test_delta_append_uint32(buf, 0x0);
+		fwupd_client_test_delta_append_uint32(buf, strlen(basis_str));
+	}
+	delta_big = g_bytes_new(buf->data, buf->len);
+	blob_big = fwupd_client_metadata_delta_apply(basis, delta_big, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null(blob_big);
+}
+
+typedef struct {
+	GMainLoop *loop;
+	GBytes *blob;
+	GError *error;
+} FwupdClientDownloadMetadataHelper;
+
+static void
+fwupd_client_download_metadata_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientDownloadMetadataHelper *helper = (FwupdClientDownloadMetadataHelper *)user_data;
+	helper->blob =
+	    fwupd_client_download_metadata_finish(FWUPD_CLIENT(source), res, &helper->error);
+	g_main_loop_quit(helper->loop);
+}
+
+/* the same code path as fwupd_client_refresh_remote_async() uses for the metadata */
+static GBytes *
+fwupd_client_download_metadata_sync(FwupdClient *client, FwupdRemote *remote, GError **error)
+{
+	g_autoptr(GMainLoop) loop = g_main_loop_new(NULL, FALSE);
+	FwupdClientDownloadMetadataHelper helper = {.loop = loop};
+
+	fwupd_client_set_user_agent_for_package(client, PACKAGE_NAME, PACKAGE_VERSION);
+	fwupd_client_download_metadata_async(client,
+					     remote,
+					     FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+					     NULL,
+					     fwupd_client_download_metadata_cb,
+					     &helper);
+	g_main_loop_run(loop);
+	if (helper.blob == NULL) {
+		g_propagate_error(error, helper.error);
+		return NULL;
+	}
+	return helper.blob;
+}
+
+static void
+fwupd_client_refresh_delta_func(void)
+{
+	gboolean ret;
+	const gchar *basis_str = "<components><component id=\"a\"/></components>";
+	const gchar *metadata_str =
+	    "<components><component id=\"a\"/><component id=\"b\"/></components>";
+	g_autofree gchar *checksum_basis = NULL;
+	g_autofree gchar *fn_basis = NULL;
+	g_autofree gchar *path_delta = NULL;
+	g_autofree gchar *tmpdir = NULL;
+	g_autofree gchar *uri = NULL;
+	g_autoptr(FwupdClient) client1 = fwupd_client_new();
+	g_autoptr(FwupdClient) client2 = fwupd_client_new();
+	g_autoptr(FwupdClientTestServer) server = fwupd_client_test_server_new();
+	g_autoptr(FwupdRemote) remote = fwupd_remote_new();
+	g_autoptr(GBytes) blob1 = NULL;
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GBytes) delta = NULL;
+	g_autoptr(GBytes) delta_bad = NULL;
+	g_autoptr(GBytes) metadata = g_bytes_new_static(metadata_str, strlen(metadata_str));
+	g_autoptr(GBytes) signature = fwupd_client_test_signature_new(metadata);
+	g_autoptr(GError) error = NULL;
+
+	/* the daemon has the old metadata cached */
+	tmpdir = g_dir_make_tmp("fwupd-client-XXXXXX", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fn_basis = g_build_filename(tmpdir, "firmware.xml.gz", NULL);
+	ret = g_file_set_contents(fn_basis, basis_str, -1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	checksum_basis = g_compute_checksum_for_string(G_CHECKSUM_SHA256, basis_str, -1);
+
+	/* the delta inserts the second component before the closing tag */
+	path_delta = g_strdup_printf("/firmware.xml.gz.%s.delta", checksum_basis);
+	delta = fwupd_client_test_delta_new(31, "<component id=\"b\"/>", strlen(basis_str));
+	fwupd_client_test_server_set_file(server, path_delta, delta);
+	fwupd_client_test_server_set_file(server, "/firmware.xml.gz", metadata);
+
+	/* the signature has already been downloaded */
+	uri = fwupd_client_test_server_build_uri(server, "/firmware.xml.gz");
+	fwupd_remote_set_id(remote, "delta");
+	fwupd_remote_set_kind(remote, FWUPD_REMOTE_KIND_DOWNLOAD);
+	fwupd_remote_set_metadata_uri(remote, uri);
+	fwupd_remote_set_filename_cache(remote, fn_basis);
+	fwupd_remote_add_flag(remote, FWUPD_REMOTE_FLAG_ALLOW_DELTA_METADATA);
+	ret = fwupd_remote_load_signature_bytes(remote, signature, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* only the delta is transferred */
+	blob1 = fwupd_client_download_metadata_sync(client1, remote, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob1);
+	g_assert_true(g_bytes_equal(blob1, metadata));
+	g_assert_cmpint(fwupd_client_test_server_get_hits(server, path_delta), ==, 1);
+	g_assert_cmpint(fwupd_client_test_server_get_hits(server, "/firmware.xml.gz"), ==, 0);
+
+	/* the result of a bad delta does not match the signature, so download everything */
+	delta_bad = fwupd_client_test_delta_new(31, "<component id=\"c\"/>", strlen(basis_str));
+	fwupd_client_test_server_set_file(server, path_delta, delta_bad);
+	blob2 = fwupd_client_download_metadata_sync(client2, remote, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob2);
+	g_assert_true(g_bytes_equal(blob2, metadata));
+	g_assert_cmpint(fwupd_client_test_server_get_hits(server, path_delta), ==, 2);
+	g_assert_cmpint(fwupd_client_test_server_get_hits(server, "/firmware.xml.gz"), ==, 1);
+
+	(void)g_unlink(fn_basis);
+	(void)g_rmdir(tmpdir);
+}
+
+static FwupdRelease *
+fwupd_client_prefetch_release_new(const gchar *tmpdir, const gchar *basename, const gchar *data)
+{
+	FwupdRelease *release = fwupd_release_new();
+	g_autofree gchar *checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA256, data, -1);
+	g_autofree gchar *fn = g_build_filename(tmpdir, basename, NULL);
+	g_autofree gchar *uri = g_strdup_printf("file://%s", fn);
+	g_autoptr(GError) error = NULL;
+
+	g_assert_true(g_file_set_contents(fn, data, -1, &error));
+	g_assert_no_error(error);
+	fwupd_release_add_location(release, uri);
+	fwupd_release_add_checksum(release, checksum);
+	return release;
+}
+
+typedef struct {
+	GMainLoop *loop;
+	GBytes *blob;
+	GError *error;
+} FwupdClientDownloadReleaseHelper;
+
+static void
+fwupd_client_download_release_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientDownloadReleaseHelper *helper = (FwupdClientDownloadReleaseHelper *)user_data;
+	helper->blob =
+	    fwupd_client_download_release_finish(FWUPD_CLIENT(source), res, &helper->error);
+	g_main_loop_quit(helper->loop);
+}
+
+/* the same code path as fwupd_client_install_release_async() uses for the payload */
+static GBytes *
+fwupd_client_download_release_sync(FwupdClient *client, FwupdRelease *release, GError **error)
+{
+	g_autoptr(GMainLoop) loop = g_main_loop_new(NULL, FALSE);
+	FwupdClientDownloadReleaseHelper helper = {.loop = loop};
+
+	fwupd_client_download_release_async(client,
+					    release,
+					    NULL,
+					    FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+					    NULL,
+					    fwupd_client_download_release_cb,
+					    &helper);
+	g_main_loop_run(loop);
+	if (helper.blob == NULL) {
+		g_propagate_error(error, helper.error);
+		return NULL;
+	}
+	return helper.blob;
+}
+
+static void
+fwupd_client_prefetch_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *cachedir = NULL;
+	g_autofree gchar *cachedir_tmp = NULL;
+	g_autofree gchar *contents2 = NULL;
+	g_autofree gchar *checksum1 = g_compute_checksum_for_string(G_CHECKSUM_SHA256, "one", -1);
+	g_autofree gchar *checksum2 = g_compute_checksum_for_string(G_CHECKSUM_SHA256, "two", -1);
+	g_autofree gchar *checksum6 = g_compute_checksum_for_string(G_CHECKSUM_SHA256, "six", -1);
+	g_autofree gchar *fn1 = NULL;
+	g_autofree gchar *fn2 = NULL;
+	g_autofree gchar *fn6 = NULL;
+	g_autofree gchar *fn_src1 = NULL;
+	g_autofree gchar *fn_src2 = NULL;
+	g_autofree gchar *fn_src6 = NULL;
+	g_autofree gchar *tmpdir = NULL;
+	g_autoptr(FwupdClient) client = fwupd_client_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GFile) file1 = NULL;
+	g_autoptr(GPtrArray) releases = g_ptr_array_new_with_free_func(g_object_unref);
+
+	tmpdir = g_dir_make_tmp("fwupd-client-XXXXXX", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	cachedir = g_build_filename(tmpdir, "cache", NULL);
+	fn1 = g_build_filename(cachedir, checksum1, NULL);
+	fn2 = g_build_filename(cachedir, checksum2, NULL);
+	fn6 = g_build_filename(cachedir, checksum6, NULL);
+	fn_src1 = g_build_filename(tmpdir, "one.cab", NULL);
+	fn_src2 = g_build_filename(tmpdir, "two.cab", NULL);
+	fn_src6 = g_build_filename(tmpdir, "six.cab", NULL);
+
+	/* no cache set */
+	fwupd_client_set_user_agent_for_package(client, PACKAGE_NAME, PACKAGE_VERSION);
+	g_ptr_array_add(releases, fwupd_client_prefetch_release_new(tmpdir, "one.cab", "one"));
+	g_ptr_array_add(releases, fwupd_client_prefetch_release_new(tmpdir, "two.cab", "two"));
+	ret = fwupd_client_prefetch_releases(client,
+					     releases,
+					     FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+					     NULL,
+					     &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* both downloaded at the same time */
+	fwupd_client_set_download_cache_dir(client, cachedir);
+	cachedir_tmp = fwupd_client_get_download_cache_dir(client);
+	g_assert_cmpstr(cachedir_tmp, ==, cachedir);
+	ret = fwupd_client_prefetch_releases(client,
+					     releases,
+					     FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+					     NULL,
+					     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_true(g_file_test(fn1, G_FILE_TEST_EXISTS));
+	g_assert_true(g_file_test(fn2, G_FILE_TEST_EXISTS));
+
+	/* already cached, so the source file is not required */
+	g_ptr_array_set_size(releases, 0);
+	g_ptr_array_add(releases, fwupd_client_prefetch_release_new(tmpdir, "two.cab", "two"));
+	(void)g_unlink(fn_src2);
+	ret = fwupd_client_prefetch_releases(client,
+					     releases,
+					     FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+					     NULL,
+					     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* installing uses the cached payload */
+	blob = fwupd_client_download_release_sync(client, g_ptr_array_index(releases, 0), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	g_assert_cmpmem(g_bytes_get_data(blob, NULL), g_bytes_get_size(blob), "two", 3);
+	g_clear_pointer(&blob, g_bytes_unref);
+
+	/* a corrupt cached payload is downloaded again */
+	ret = g_file_set_contents(fn2, "owt", -1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = g_file_set_contents(fn_src2, "two", -1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	blob = fwupd_client_download_release_sync(client, g_ptr_array_index(releases, 0), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	g_assert_cmpmem(g_bytes_get_data(blob, NULL), g_bytes_get_size(blob), "two", 3);
+	g_clear_pointer(&blob, g_bytes_unref);
+	ret = g_file_get_contents(fn2, &contents2, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpstr(contents2, ==, "two");
+
+	/* the least recently used file is evicted when the cache is full */
+	file1 = g_file_new_for_path(fn1);
+	ret = g_file_set_attribute_uint64(file1,
+					  G_FILE_ATTRIBUTE_TIME_MODIFIED,
+					  1,
+					  G_FILE_QUERY_INFO_NONE,
+					  NULL,
+					  &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fwupd_client_set_download_cache_max_size(client, 6);
+	g_ptr_array_set_size(releases, 0);
+	g_ptr_array_add(releases, fwupd_client_prefetch_release_new(tmpdir, "six.cab", "six"));
+	ret = fwupd_client_prefetch_releases(client,
+					     releases,
+					     FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+					     NULL,
+					     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_false(g_file_test(fn1, G_FILE_TEST_EXISTS));
+	g_assert_true(g_file_test(fn2, G_FILE_TEST_EXISTS));
+	g_assert_true(g_file_test(fn6, G_FILE_TEST_EXISTS));
+
+	(void)g_unlink(fn2);
+	(void)g_unlink(fn6);
+	(void)g_rmdir(cachedir);
+	(void)g_unlink(fn_src1);
+	(void)g_unlink(fn_src2);
+	(void)g_unlink(fn_src6);
+	(void)g_rmdir(tmpdir);
+}
+
 static void
 fwupd_client_api_undefined_setter(void)
 {
@@ -406,6 +1032,322 @@ fwupd_client_devices_func(void)
 	g_assert_cmpstr(fwupd_device_get_id(dev), !=, NULL);
 }
 
+typedef struct {
+	GTestDBus *dbus;
+	GDBusConnection *conn;
+	GDBusConnection *conn2; /* takes over the bus name */
+	GMainContext *mock_ctx;
+	GMainLoop *mock_loop;
+	GThread *mock_thread;
+	guint reg_id;
+	guint reg_id2;
+	gint device_cnt;      /* atomic */
+	gint generation;      /* atomic */
+	gint get_devices_cnt; /* atomic */
+	gchar *system_bus_address;
+} FwupdClientTestFixture;
+
+static const gchar fwupd_client_test_introspection_xml[] =
+    "<node>"
+    "  <interface name='org.freedesktop.fwupd'>"
+    "    <method name='GetDevices'>"
+    "      <arg type='aa{sv}' name='devices' direction='out'/>"
+    "    </method>"
+    "    <signal name='DeviceAdded'>"
+    "      <arg type='a{sv}' name='device'/>"
+    "    </signal>"
+    "    <property name='DaemonVersion' type='s' access='read'/>"
+    "    <property name='DeviceGeneration' type='t' access='read'/>"
+    "  </interface>"
+    "</node>";
+
+static GVariant *
+fwupd_client_test_device_to_variant(gint idx)
+{
+	g_autofree gchar *id = g_strdup_printf("%i", idx);
+	g_autoptr(FwupdDevice) dev = fwupd_device_new();
+	fwupd_device_set_id(dev, id);
+	return fwupd_codec_to_variant(FWUPD_CODEC(dev), FWUPD_CODEC_FLAG_NONE);
+}
+
+static void
+fwupd_client_test_method_call(GDBusConnection *connection,
+			      const gchar *sender,
+			      const gchar *object_path,
+			      const gchar *interface_name,
+			      const gchar *method_name,
+			      GVariant *parameters,
+			      GDBusMethodInvocation *invocation,
+			      gpointer user_data)
+{
+	FwupdClientTestFixture *fix = user_data;
+	GVariantBuilder builder;
+
+	/* GetDevices is the only method */
+	g_atomic_int_inc(&fix->get_devices_cnt);
+	g_variant_builder_init(&builder, G_VARIANT_TYPE("aa{sv}"));
+	for (gint i = 0; i < g_atomic_int_get(&fix->device_cnt); i++)
+		g_variant_builder_add_value(&builder, fwupd_client_test_device_to_variant(i));
+	g_dbus_method_invocation_return_value(invocation, g_variant_new("(aa{sv})", &builder));
+}
+
+static GVariant *
+fwupd_client_test_get_property(GDBusConnection *connection,
+			       const gchar *sender,
+			       const gchar *object_path,
+			       const gchar *interface_name,
+			       const gchar *property_name,
+			       GError **error,
+			       gpointer user_data)
+{
+	FwupdClientTestFixture *fix = user_data;
+	if (g_strcmp0(property_name, "DaemonVersion") == 0)
+		return g_variant_new_string("2.2.1");
+	if (g_strcmp0(property_name, "DeviceGeneration") == 0)
+		return g_variant_new_uint64(g_atomic_int_get(&fix->generation));
+	return NULL;
+}
+
+static const GDBusInterfaceVTable fwupd_client_test_vtable = {
+    fwupd_client_test_method_call,
+    fwupd_client_test_get_property,
+    NULL,
+};
+
+static gpointer
+fwupd_client_test_mock_thread_cb(gpointer data)
+{
+	FwupdClientTestFixture *fix = data;
+	g_main_loop_run(fix->mock_loop);
+	return NULL;
+}
+
+static GDBusConnection *
+fwupd_client_test_mock_connect(FwupdClientTestFixture *fix, GDBusNodeInfo *node, guint *reg_id)
+{
+	g_autoptr(GDBusConnection) conn = NULL;
+	g_autoptr(GError) error = NULL;
+
+	conn = g_dbus_connection_new_for_address_sync(
+	    g_test_dbus_get_bus_address(fix->dbus),
+	    G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+		G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+	    NULL,
+	    NULL,
+	    &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(conn);
+	*reg_id = g_dbus_connection_register_object(conn,
+						    FWUPD_DBUS_PATH,
+						    node->interfaces[0],
+						    &fwupd_client_test_vtable,
+						    fix,
+						    NULL,
+						    &error);
+	g_assert_no_error(error);
+	return g_steal_pointer(&conn);
+}
+
+static void
+fwupd_client_test_mock_name(GDBusConnection *conn, const gchar *method, GVariant *parameters)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GVariant) result = NULL;
+
+	result = g_dbus_connection_call_sync(conn,
+					     "org.freedesktop.DBus",
+					     "/org/freedesktop/DBus",
+					     "org.freedesktop.DBus",
+					     method,
+					     parameters,
+					     G_VARIANT_TYPE("(u)"),
+					     G_DBUS_CALL_FLAGS_NONE,
+					     -1,
+					     NULL,
+					     &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(result);
+}
+
+static void
+fwupd_client_test_setup(FwupdClientTestFixture *fix, gconstpointer user_data)
+{
+	g_autoptr(GDBusNodeInfo) node = NULL;
+	g_autoptr(GError) error = NULL;
+
+	fix->device_cnt = 1;
+	fix->system_bus_address = g_strdup(g_getenv("DBUS_SYSTEM_BUS_ADDRESS"));
+	fix->dbus = g_test_dbus_new(G_TEST_DBUS_NONE);
+	g_test_dbus_up(fix->dbus);
+	(void)g_setenv("DBUS_SYSTEM_BUS_ADDRESS", g_test_dbus_get_bus_address(fix->dbus), TRUE);
+
+	/* callbacks are dispatched in the mock context, iterated by the mock thread */
+	fix->mock_ctx = g_main_context_new();
+	fix->mock_loop = g_main_loop_new(fix->mock_ctx, FALSE);
+	node = g_dbus_node_info_new_for_xml(fwupd_client_test_introspection_xml, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(node);
+	g_main_context_push_thread_default(fix->mock_ctx);
+	fix->conn = fwupd_client_test_mock_connect(fix, node, &fix->reg_id);
+	fix->conn2 = fwupd_client_test_mock_connect(fix, node, &fix->reg_id2);
+	g_main_context_pop_thread_default(fix->mock_ctx);
+
+	fwupd_client_test_mock_name(fix->conn,
+				    "RequestName",
+				    g_variant_new("(su)", FWUPD_DBUS_SERVICE, 0u));
+	fix->mock_thread = g_thread_new("mock-fwupd", fwupd_client_test_mock_thread_cb, fix);
+}
+
+static void
+fwupd_client_test_teardown(FwupdClientTestFixture *fix, gconstpointer user_data)
+{
+	g_main_loop_quit(fix->mock_loop);
+	g_thread_join(fix->mock_thread);
+	g_dbus_connection_unregister_object(fix->conn, fix->reg_id);
+	g_dbus_connection_unregister_object(fix->conn2, fix->reg_id2);
+	g_object_unref(fix->conn);
+	g_object_unref(fix->conn2);
+	g_main_loop_unref(fix->mock_loop);
+	g_main_context_unref(fix->mock_ctx);
+	g_test_dbus_down(fix->dbus);
+	g_object_unref(fix->dbus);
+	if (fix->system_bus_address != NULL) {
+		(void)g_setenv("DBUS_SYSTEM_BUS_ADDRESS", fix->system_bus_address, TRUE);
+	} else {
+		(void)g_unsetenv("DBUS_SYSTEM_BUS_ADDRESS"); /* nocheck:blocked */
+	}
+	g_free(fix->system_bus_address);
+}
+
+static gboolean
+fwupd_client_test_timeout_cb(gpointer user_data)
+{
+	GMainLoop *loop = (GMainLoop *)user_data;
+	g_main_loop_quit(loop);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+fwupd_client_test_changed_cb(FwupdClient *client, gpointer user_data)
+{
+	GMainLoop *loop = (GMainLoop *)user_data;
+	g_main_loop_quit(loop);
+}
+
+static void
+fwupd_client_device_cache_func(FwupdClientTestFixture *fix, gconstpointer user_data)
+{
+	gboolean ret;
+	GVariant *val;
+	guint timeout_id;
+	g_autoptr(FwupdClient) client = fwupd_client_new();
+	g_autoptr(FwupdDevice) dev = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GMainLoop) loop = g_main_loop_new(NULL, FALSE);
+	g_autoptr(GPtrArray) array1 = NULL;
+	g_autoptr(GPtrArray) array2 = NULL;
+	g_autoptr(GPtrArray) array3 = NULL;
+	g_autoptr(GPtrArray) array4 = NULL;
+	g_autoptr(GPtrArray) array5 = NULL;
+	g_autoptr(GPtrArray) array6 = NULL;
+
+	/* peer-to-peer does not use the mock bus */
+	if (g_getenv("FWUPD_DBUS_SOCKET") != NULL) {
+		g_test_skip("using FWUPD_DBUS_SOCKET");
+		return;
+	}
+
+	/* the device signals are dispatched in the same context as the method replies */
+	fwupd_client_set_main_context(client, g_main_context_default());
+	fwupd_client_set_device_cache_enabled(client, TRUE);
+	g_assert_true(fwupd_client_get_device_cache_enabled(client));
+	ret = fwupd_client_connect(client, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpstr(fwupd_client_get_daemon_version(client), ==, "2.2.1");
+
+	/* seeds the mirror */
+	array1 = fwupd_client_get_devices(client, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(array1);
+	g_assert_cmpint(array1->len, ==, 1);
+	g_assert_cmpint(g_atomic_int_get(&fix->get_devices_cnt), ==, 1);
+
+	/* served from the mirror */
+	array2 = fwupd_client_get_devices(client, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(array2);
+	g_assert_cmpint(array2->len, ==, 1);
+	g_assert_cmpint(g_atomic_int_get(&fix->get_devices_cnt), ==, 1);
+
+	/* the mirror is updated by the device signal */
+	g_atomic_int_inc(&fix->device_cnt);
+	g_atomic_int_inc(&fix->generation);
+	val = fwupd_client_test_device_to_variant(1);
+	ret = g_dbus_connection_emit_signal(fix->conn,
+					    NULL,
+					    FWUPD_DBUS_PATH,
+					    FWUPD_DBUS_INTERFACE,
+					    "DeviceAdded",
+					    g_variant_new_tuple(&val, 1),
+					    &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = g_dbus_connection_flush_sync(fix->conn, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	array3 = fwupd_client_get_devices(client, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(array3);
+	g_assert_cmpint(array3->len, ==, 2);
+	g_assert_cmpint(g_atomic_int_get(&fix->get_devices_cnt), ==, 1);
+
+	/* a missed signal invalidates the mirror */
+	g_atomic_int_inc(&fix->generation);
+	array4 = fwupd_client_get_devices(client, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(array4);
+	g_assert_cmpint(array4->len, ==, 2);
+	g_assert_cmpint(g_atomic_int_get(&fix->get_devices_cnt), ==, 2);
+	array5 = fwupd_client_get_devices(client, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(array5);
+	g_assert_cmpint(g_atomic_int_get(&fix->get_devices_cnt), ==, 2);
+
+	/* the daemon being replaced clears the mirror, even with the same generation */
+	g_signal_connect(client, "changed", G_CALLBACK(fwupd_client_test_changed_cb), loop);
+	fwupd_client_test_mock_name(fix->conn,
+				    "ReleaseName",
+				    g_variant_new("(s)", FWUPD_DBUS_SERVICE));
+	fwupd_client_test_mock_name(fix->conn2,
+				    "RequestName",
+				    g_variant_new("(su)", FWUPD_DBUS_SERVICE, 0u));
+	timeout_id = g_timeout_add_seconds(5, fwupd_client_test_timeout_cb, loop);
+	g_main_loop_run(loop);
+	g_source_remove(timeout_id);
+	array6 = fwupd_client_get_devices(client, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(array6);
+	g_assert_cmpint(array6->len, ==, 2);
+	g_assert_cmpint(g_atomic_int_get(&fix->get_devices_cnt), ==, 3);
+
+	/* uses the same code path */
+	dev = fwupd_client_get_device_by_id(client,
+					    fwupd_device_get_id(g_ptr_array_index(array6, 0)),
+					    NULL,
+					    &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(dev);
+	g_assert_cmpint(g_atomic_int_get(&fix->get_devices_cnt), ==, 3);
+
+	/* disabling clears the mirror */
+	fwupd_client_set_device_cache_enabled(client, FALSE);
+	g_assert_false(fwupd_client_get_device_cache_enabled(client));
+	ret = fwupd_client_disconnect(client, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+}
+
 static void
 fwupd_client_remotes_func(void)
 {
@@ -486,7 +1428,10 @@ int
 main(int argc, char **argv)
 {
 	g_autofree gchar *testsdir = g_build_filename(SRCDIR, "tests", NULL);
+	g_autofree gchar *cachedir = g_dir_make_tmp("fwupd-client-cache-XXXXXX", NULL);
 	(void)g_setenv("XDG_CONFIG_HOME", testsdir, TRUE);
+	(void)g_setenv("XDG_CACHE_HOME", cachedir, TRUE);
+	(void)g_setenv("FWUPD_IGNORE_NETWORK_REACHABLE", "1", TRUE);
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/client/api", fwupd_client_api);
 	if (g_test_undefined()) {
@@ -496,11 +1441,24 @@ main(int argc, char **argv)
 				fwupd_client_api_undefined_getter);
 		g_test_add_func("/fwupd/client/api/ro_props", fwupd_client_api_ro_props);
 	}
+#ifndef FWUPD_DBUS_SOCKET_ADDRESS
+	g_test_add("/fwupd/client/device-cache",
+		   FwupdClientTestFixture,
+		   NULL,
+		   fwupd_client_test_setup,
+		   fwupd_client_device_cache_func,
+		   fwupd_client_test_teardown);
+#endif
 	if (fwupd_has_system_bus()) {
 		g_test_add_func("/fwupd/client/remotes", fwupd_client_remotes_func);
 		g_test_add_func("/fwupd/client/devices", fwupd_client_devices_func);
 	}
 	g_test_add_func("/fwupd/client/download", fwupd_client_download_func);
+	g_test_add_func("/fwupd/client/prefetch", fwupd_client_prefetch_func);
+	g_test_add_func("/fwupd/client/refresh/not-modified",
+			fwupd_client_refresh_not_modified_func);
+	g_test_add_func("/fwupd/client/refresh/delta", fwupd_client_refresh_delta_func);
+	g_test_add_func("/fwupd/client/delta/limit", fwupd_client_delta_limit_func);
 	g_test_add_func("/fwupd/client/connect/func", fwupd_client_connect_func);
 	g_test_add_func("/fwupd/client/sync/impl", fwupd_client_sync_impl_func);
 	return g_test_run();
@@ -8,6 +8,7 @@
 
 #include <curl/curl.h>
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #ifdef HAVE_GIO_UNIX
 #include <gio/gunixfdlist.h>
 #endif
@@ -15,6 +16,7 @@
 #include <sys/utsname.h>
 #endif
 
+#include <errno.h>
 #include <fcntl.h>
 #include <locale.h>
 #include <string.h>
@@ -40,6 +42,14 @@
 
 static void
 fwupd_client_fixup_dbus_error(GError *error);
+static void
+fwupd_client_download_bytes_full_async(FwupdClient *self,
+				       GPtrArray *urls,
+				       FwupdClientDownloadFlags flags,
+				       FwupdRemote *remote,
+				       GCancellable *cancellable,
+				       GAsyncReadyCallback callback,
+				       gpointer callback_data);
 
 typedef GObject *(*FwupdClientObjectNewFunc)(void);
 
@@ -48,6 +58,15 @@ typedef GObject *(*FwupdClientObjectNewFunc)(void);
 /* the smallest amount of time between requests of the same URI from the same FwupdClient */
 #define FWUPD_CLIENT_DOWNLOAD_URI_DELTA 1500 /* ms */
 
+/* the default size of the content-addressed firmware cache */
+#define FWUPD_CLIENT_DOWNLOAD_CACHE_MAX_SIZE_DEFAULT (512 * 1024 * 1024) /* bytes */
+
+/* the magic at the start of a metadata delta, see fwupd-remotes.d(5) */
+#define FWUPD_CLIENT_METADATA_DELTA_MAGIC "FWUPDDLT"
+
+/* the most the copy operations of a metadata delta can add, as a multiple of the basis size */
+#define FWUPD_CLIENT_METADATA_DELTA_MAX_GROWTH 2
+
 /**
  * FwupdClient:
  *
@@ -95,6 +114,13 @@ typedef struct {
 	GPtrArray *connect_items; /* element-type FwupdClientConnectItem */
 	gpointer impl_userdata;
 	GDestroyNotify impl_userdata_destroy; /* nullable */
+	gboolean device_cache_enabled;
+	GMutex device_cache_mutex;	 /* for @device_cache and @device_cache_generation */
+	GPtrArray *device_cache;	 /* element-type FwupdDevice */
+	guint64 device_cache_generation; /* daemon DeviceGeneration the mirror corresponds to */
+	GMutex download_cache_mutex; /* for @download_cache_dir */
+	gchar *download_cache_dir;   /* nullable */
+	guint64 download_cache_max_size;
 } FwupdClientPrivate;
 
 typedef struct {
@@ -102,6 +128,10 @@ typedef struct {
 	CURL *curl;
 	curl_mime *mime;
 	struct curl_slist *headers;
+	gchar *validators_fn;	    /* nullable */
+	gchar *validators_checksum; /* nullable */
+	gchar *etag;		    /* nullable */
+	gchar *last_modified;	    /* nullable */
 } FwupdCurlHelper;
 
 typedef struct {
@@ -150,6 +180,7 @@ G_DEFINE_TYPE_WITH_PRIVATE(FwupdClient, fwupd_client, G_TYPE_OBJECT)
 #define GET_PRIVATE(o) (fwupd_client_get_instance_private(o))
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(CURLU, curl_url_cleanup)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(CURLM, curl_multi_cleanup)
 typedef char CURLSTR;
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(CURLSTR, curl_free)
 
@@ -182,6 +213,10 @@ fwupd_client_curl_helper_free(FwupdCurlHelper *helper)
 		curl_slist_free_all(helper->headers);
 	if (helper->urls != NULL)
 		g_ptr_array_unref(helper->urls);
+	g_free(helper->validators_fn);
+	g_free(helper->validators_checksum);
+	g_free(helper->etag);
+	g_free(helper->last_modified);
 	g_free(helper);
 }
 
@@ -550,6 +585,73 @@ fwupd_client_download_set_retries(FwupdClient *self, guint retries)
 	priv->download_retries = retries;
 }
 
+/**
+ * fwupd_client_set_download_cache_dir:
+ * @self: a #FwupdClient
+ * @download_cache_dir: (nullable): a directory, e.g. `/var/cache/fwupdmgr`
+ *
+ * Sets the directory used to cache downloaded firmware. Files are named using the release
+ * container checksum and are verified before use, so the directory may be shared between
+ * users if it is writable by all of them. Releases that are already in the cache are
+ * installed without using the network.
+ *
+ * The cache is disabled by default.
+ *
+ * Since: 2.2.1
+ **/
+void
+fwupd_client_set_download_cache_dir(FwupdClient *self, const gchar *download_cache_dir)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	g_return_if_fail(FWUPD_IS_CLIENT(self));
+
+	locker = g_mutex_locker_new(&priv->download_cache_mutex);
+	g_free(priv->download_cache_dir);
+	priv->download_cache_dir = g_strdup(download_cache_dir);
+}
+
+/**
+ * fwupd_client_get_download_cache_dir:
+ * @self: a #FwupdClient
+ *
+ * Gets the directory used to cache downloaded firmware.
+ *
+ * Returns: (transfer full): a directory, or %NULL if unset
+ *
+ * Since: 2.2.1
+ **/
+gchar *
+fwupd_client_get_download_cache_dir(FwupdClient *self)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	g_return_val_if_fail(FWUPD_IS_CLIENT(self), NULL);
+
+	locker = g_mutex_locker_new(&priv->download_cache_mutex);
+	return g_strdup(priv->download_cache_dir);
+}
+
+/**
+ * fwupd_client_set_download_cache_max_size:
+ * @self: a #FwupdClient
+ * @download_cache_max_size: size in bytes
+ *
+ * Sets the maximum total size of the firmware cache. The least recently used files are
+ * deleted when this is exceeded.
+ *
+ * Since: 2.2.1
+ **/
+void
+fwupd_client_set_download_cache_max_size(FwupdClient *self, guint64 download_cache_max_size)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FWUPD_IS_CLIENT(self));
+	priv->download_cache_max_size = download_cache_max_size;
+}
+
 static void
 fwupd_client_set_host_bkc(FwupdClient *self, const gchar *host_bkc)
 {
@@ -712,6 +814,85 @@ fwupd_client_properties_changed_cb(GDBusProxy *proxy,
 	}
 }
 
+static void
+fwupd_client_device_cache_invalidate(FwupdClient *self)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->device_cache_mutex);
+	g_ptr_array_set_size(priv->device_cache, 0);
+	priv->device_cache_generation = 0;
+}
+
+static void
+fwupd_client_device_cache_seed(FwupdClient *self, GPtrArray *devices, guint64 generation)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->device_cache_mutex);
+
+	g_ptr_array_set_size(priv->device_cache, 0);
+	for (guint i = 0; i < devices->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index(devices, i);
+		g_ptr_array_add(priv->device_cache, g_object_ref(dev));
+	}
+	priv->device_cache_generation = generation;
+}
+
+/* returns NULL if the mirror is empty or has missed a device signal */
+static GPtrArray *
+fwupd_client_device_cache_get_devices(FwupdClient *self, guint64 generation)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->device_cache_mutex);
+	g_autoptr(GPtrArray) devices = NULL;
+
+	if (priv->device_cache->len == 0)
+		return NULL;
+	if (generation != priv->device_cache_generation) {
+		g_debug("device mirror at generation %" G_GUINT64_FORMAT
+			" but daemon at %" G_GUINT64_FORMAT ", invalidating",
+			priv->device_cache_generation,
+			generation);
+		g_ptr_array_set_size(priv->device_cache, 0);
+		return NULL;
+	}
+	devices = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	for (guint i = 0; i < priv->device_cache->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index(priv->device_cache, i);
+		g_ptr_array_add(devices, g_object_ref(dev));
+	}
+	return g_steal_pointer(&devices);
+}
+
+static void
+fwupd_client_device_cache_update(FwupdClient *self, const gchar *signal_name, FwupdDevice *dev)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->device_cache_mutex);
+
+	/* nothing to update */
+	if (priv->device_cache->len == 0)
+		return;
+	priv->device_cache_generation++;
+
+	/* replace or remove any existing device with the same ID */
+	for (guint i = 0; i < priv->device_cache->len; i++) {
+		FwupdDevice *dev_tmp = g_ptr_array_index(priv->device_cache, i);
+		if (g_strcmp0(fwupd_device_get_id(dev_tmp), fwupd_device_get_id(dev)) != 0)
+			continue;
+		if (g_strcmp0(signal_name, "DeviceRemoved") == 0) {
+			g_ptr_array_remove_index(priv->device_cache, i);
+		} else {
+			g_object_unref(g_ptr_array_index(priv->device_cache, i));
+			g_ptr_array_index(priv->device_cache, i) = g_object_ref(dev);
+		}
+		fwupd_device_array_ensure_parents(priv->device_cache);
+		return;
+	}
+	if (g_strcmp0(signal_name, "DeviceRemoved") != 0)
+		g_ptr_array_add(priv->device_cache, g_object_ref(dev));
+	fwupd_device_array_ensure_parents(priv->device_cache);
+}
+
 static void
 fwupd_client_update_proxy_name_owner(FwupdClient *self)
 {
@@ -732,6 +913,9 @@ fwupd_client_update_proxy_name_owner(FwupdClient *self)
 		fwupd_client_set_status(self, FWUPD_STATUS_SHUTDOWN);
 	}
 
+	/* any device mirror is no longer valid */
+	fwupd_client_device_cache_invalidate(self);
+
 	/* save so we can detect when the daemon is replaced */
 	g_free(priv->proxy_name_owner);
 	priv->proxy_name_owner = g_steal_pointer(&name_owner);
@@ -865,6 +1049,7 @@ fwupd_client_signal_cb(GDBusProxy *proxy,
 			g_warning("failed to build FwupdDevice[DeviceAdded]: %s", error->message);
 			return;
 		}
+		fwupd_client_device_cache_update(self, signal_name, dev);
 		fwupd_client_emit_device_added(self, dev);
 		return;
 	}
@@ -874,6 +1059,7 @@ fwupd_client_signal_cb(GDBusProxy *proxy,
 			g_warning("failed to build FwupdDevice[DeviceRemoved]: %s", error->message);
 			return;
 		}
+		fwupd_client_device_cache_update(self, signal_name, dev);
 		fwupd_client_emit_device_removed(self, dev);
 		return;
 	}
@@ -883,6 +1069,7 @@ fwupd_client_signal_cb(GDBusProxy *proxy,
 			g_warning("failed to build FwupdDevice[DeviceChanged]: %s", error->message);
 			return;
 		}
+		fwupd_client_device_cache_update(self, signal_name, dev);
 		fwupd_client_emit_device_changed(self, dev);
 		return;
 	}
@@ -1433,6 +1620,7 @@ fwupd_client_disconnect(FwupdClient *self, GError **error)
 	}
 	g_signal_handlers_disconnect_by_data(priv->proxy, self);
 	g_clear_object(&priv->proxy);
+	fwupd_client_device_cache_invalidate(self);
 
 	/* success */
 	return TRUE;
@@ -2074,7 +2262,9 @@ fwupd_client_get_report_metadata_finish(FwupdClient *self, GAsyncResult *res, GE
 static void
 fwupd_client_get_devices_cb(GObject *source, GAsyncResult *res, gpointer user_data)
 {
+	FwupdClient *self = FWUPD_CLIENT(g_task_get_source_object(G_TASK(user_data)));
 	g_autoptr(GTask) task = G_TASK(user_data);
+	guint64 *generation = g_task_get_task_data(task);
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GPtrArray) array = NULL;
 	g_autoptr(GVariant) val = NULL;
@@ -2092,10 +2282,64 @@ fwupd_client_get_devices_cb(GObject *source, GAsyncResult *res, gpointer user_da
 	}
 	fwupd_device_array_ensure_parents(array);
 
+	/* any signal received since the generation was read makes this conservative */
+	if (generation != NULL && fwupd_client_get_device_cache_enabled(self))
+		fwupd_client_device_cache_seed(self, array, *generation);
+
 	/* success */
 	g_task_return_pointer(task, g_steal_pointer(&array), (GDestroyNotify)g_ptr_array_unref);
 }
 
+static void
+fwupd_client_get_devices_call(GTask *task)
+{
+	FwupdClient *self = g_task_get_source_object(task);
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_dbus_proxy_call(priv->proxy,
+			  "GetDevices",
+			  NULL,
+			  G_DBUS_CALL_FLAGS_NONE,
+			  FWUPD_CLIENT_DBUS_PROXY_TIMEOUT,
+			  g_task_get_cancellable(task),
+			  fwupd_client_get_devices_cb,
+			  task);
+}
+
+static void
+fwupd_client_get_devices_generation_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClient *self = FWUPD_CLIENT(g_task_get_source_object(G_TASK(user_data)));
+	g_autoptr(GTask) task = G_TASK(user_data);
+	guint64 *generation = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GVariant) val = NULL;
+	g_autoptr(GVariant) val_generation = NULL;
+
+	/* new libfwupd and old daemon, so do not use the mirror */
+	val = g_dbus_proxy_call_finish(G_DBUS_PROXY(source), res, &error);
+	if (val == NULL) {
+		g_debug("ignoring %s", error->message);
+		fwupd_client_device_cache_invalidate(self);
+		fwupd_client_get_devices_call(g_steal_pointer(&task));
+		return;
+	}
+	g_variant_get(val, "(v)", &val_generation);
+	generation = g_new0(guint64, 1);
+	*generation = fwupd_variant_get_uint64(val_generation);
+	g_task_set_task_data(task, generation, g_free);
+
+	/* the mirror is kept up to date using the device signals */
+	devices = fwupd_client_device_cache_get_devices(self, *generation);
+	if (devices != NULL) {
+		g_task_return_pointer(task,
+				      g_steal_pointer(&devices),
+				      (GDestroyNotify)g_ptr_array_unref);
+		return;
+	}
+	fwupd_client_get_devices_call(g_steal_pointer(&task));
+}
+
 /**
  * fwupd_client_get_devices_async:
  * @self: a #FwupdClient
@@ -2134,14 +2378,20 @@ fwupd_client_get_devices_async(FwupdClient *self,
 						"no proxy");
 		return;
 	}
-	g_dbus_proxy_call(priv->proxy,
-			  "GetDevices",
-			  NULL,
-			  G_DBUS_CALL_FLAGS_NONE,
-			  FWUPD_CLIENT_DBUS_PROXY_TIMEOUT,
-			  cancellable,
-			  fwupd_client_get_devices_cb,
-			  g_steal_pointer(&task));
+
+	/* the generation is not sent with each device signal, so read it on demand */
+	if (priv->device_cache_enabled) {
+		g_dbus_proxy_call(priv->proxy,
+				  "org.freedesktop.DBus.Properties.Get",
+				  g_variant_new("(ss)", FWUPD_DBUS_INTERFACE, "DeviceGeneration"),
+				  G_DBUS_CALL_FLAGS_NONE,
+				  FWUPD_CLIENT_DBUS_PROXY_TIMEOUT,
+				  cancellable,
+				  fwupd_client_get_devices_generation_cb,
+				  g_steal_pointer(&task));
+		return;
+	}
+	fwupd_client_get_devices_call(g_steal_pointer(&task));
 }
 
 /**
@@ -3907,6 +4157,198 @@ fwupd_client_install_finish(FwupdClient *self, GAsyncResult *res, GError **error
 	return g_task_propagate_boolean(G_TASK(res), error);
 }
 
+/* only called with @download_cache_mutex held */
+static gchar *
+fwupd_client_download_cache_build_filename(FwupdClient *self, const gchar *checksum)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+
+	if (priv->download_cache_dir == NULL || checksum == NULL)
+		return NULL;
+
+	/* never allow the checksum to escape the cache directory */
+	for (guint i = 0; checksum[i] != '\0'; i++) {
+		if (!g_ascii_isxdigit(checksum[i]))
+			return NULL;
+	}
+	return g_build_filename(priv->download_cache_dir, checksum, NULL);
+}
+
+static GBytes *
+fwupd_client_download_cache_lookup(FwupdClient *self, const gchar *checksum)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	gchar *data = NULL;
+	gsize datasz = 0;
+	g_autofree gchar *checksum_actual = NULL;
+	g_autofree gchar *fn = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->download_cache_mutex);
+
+	fn = fwupd_client_download_cache_build_filename(self, checksum);
+	if (fn == NULL || !g_file_get_contents(fn, &data, &datasz, NULL))
+		return NULL;
+	blob = g_bytes_new_take(data, datasz);
+
+	/* the directory may be shared, so never trust the filename */
+	checksum_actual = g_compute_checksum_for_bytes(fwupd_checksum_guess_kind(checksum), blob);
+	if (g_strcmp0(checksum, checksum_actual) != 0) {
+		g_warning("deleting corrupt cached firmware %s", fn);
+		(void)g_unlink(fn);
+		return NULL;
+	}
+
+	/* mark as recently used */
+	file = g_file_new_for_path(fn);
+	if (!g_file_set_attribute_uint64(file,
+					 G_FILE_ATTRIBUTE_TIME_MODIFIED,
+					 (guint64)g_get_real_time() / G_USEC_PER_SEC,
+					 G_FILE_QUERY_INFO_NONE,
+					 NULL,
+					 NULL))
+		g_debug("failed to update mtime of %s", fn);
+	return g_steal_pointer(&blob);
+}
+
+typedef struct {
+	gchar *fn;
+	guint64 size;
+	guint64 mtime;
+} FwupdClientDownloadCacheItem;
+
+static void
+fwupd_client_download_cache_item_free(FwupdClientDownloadCacheItem *item)
+{
+	g_free(item->fn);
+	g_free(item);
+}
+
+static gint
+fwupd_client_download_cache_item_sort_cb(gconstpointer a, gconstpointer b)
+{
+	FwupdClientDownloadCacheItem *item1 = *((FwupdClientDownloadCacheItem **)a);
+	FwupdClientDownloadCacheItem *item2 = *((FwupdClientDownloadCacheItem **)b);
+	if (item1->mtime < item2->mtime)
+		return -1;
+	if (item1->mtime > item2->mtime)
+		return 1;
+	return 0;
+}
+
+/* only called with @download_cache_mutex held */
+static void
+fwupd_client_download_cache_prune(FwupdClient *self)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	const gchar *fn;
+	guint64 total = 0;
+	g_autoptr(GDir) dir = NULL;
+	g_autoptr(GPtrArray) items =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fwupd_client_download_cache_item_free);
+
+	dir = g_dir_open(priv->download_cache_dir, 0, NULL);
+	if (dir == NULL)
+		return;
+	while ((fn = g_dir_read_name(dir)) != NULL) {
+		GStatBuf st = {0};
+		FwupdClientDownloadCacheItem *item;
+		g_autofree gchar *fn_full = g_build_filename(priv->download_cache_dir, fn, NULL);
+
+		if (g_stat(fn_full, &st) != 0 || !S_ISREG(st.st_mode))
+			continue;
+		item = g_new0(FwupdClientDownloadCacheItem, 1);
+		item->fn = g_steal_pointer(&fn_full);
+		item->size = st.st_size;
+		item->mtime = st.st_mtime;
+		g_ptr_array_add(items, item);
+		total += item->size;
+	}
+
+	/* delete the least recently used files first */
+	g_ptr_array_sort(items, fwupd_client_download_cache_item_sort_cb);
+	for (guint i = 0; i < items->len && total > priv->download_cache_max_size; i++) {
+		FwupdClientDownloadCacheItem *item = g_ptr_array_index(items, i);
+		g_debug("evicting %s from firmware cache", item->fn);
+		if (g_unlink(item->fn) != 0)
+			continue;
+		total -= item->size;
+	}
+}
+
+static void
+fwupd_client_download_cache_insert(FwupdClient *self, const gchar *checksum, GBytes *blob)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_autofree gchar *fn = NULL;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->download_cache_mutex);
+
+	fn = fwupd_client_download_cache_build_filename(self, checksum);
+	if (fn == NULL)
+		return;
+	if (g_mkdir_with_parents(priv->download_cache_dir, 0755) != 0) {
+		g_warning("failed to create %s", priv->download_cache_dir);
+		return;
+	}
+	if (!g_file_set_contents(fn,
+				 g_bytes_get_data(blob, NULL),
+				 g_bytes_get_size(blob),
+				 &error_local)) {
+		g_warning("failed to cache firmware: %s", error_local->message);
+		return;
+	}
+	fwupd_client_download_cache_prune(self);
+}
+
+static gboolean
+fwupd_client_download_cache_is_enabled(FwupdClient *self)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->download_cache_mutex);
+	return priv->download_cache_dir != NULL;
+}
+
+/* move a verified partial download into place */
+static gboolean
+fwupd_client_download_cache_commit(FwupdClient *self,
+				   GFile *file_tmp,
+				   const gchar *checksum,
+				   GError **error)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_autofree gchar *fn = NULL;
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->download_cache_mutex);
+
+	fn = fwupd_client_download_cache_build_filename(self, checksum);
+	if (fn == NULL) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "no download cache directory set");
+		return FALSE;
+	}
+	file = g_file_new_for_path(fn);
+	if (!g_file_move(file_tmp, file, G_FILE_COPY_OVERWRITE, NULL, NULL, NULL, error))
+		return FALSE;
+	fwupd_client_download_cache_prune(self);
+	return TRUE;
+}
+
+static void
+fwupd_client_download_cache_lookup_thread_cb(GTask *task,
+					     gpointer source_object,
+					     gpointer task_data,
+					     GCancellable *cancellable)
+{
+	FwupdClient *self = FWUPD_CLIENT(source_object);
+	const gchar *checksum = (const gchar *)task_data;
+	g_task_return_pointer(task,
+			      fwupd_client_download_cache_lookup(self, checksum),
+			      (GDestroyNotify)g_bytes_unref);
+}
+
 typedef struct {
 	FwupdDevice *device;
 	FwupdRelease *release;
@@ -3952,47 +4394,6 @@ fwupd_client_install_release_bytes_cb(GObject *source, GAsyncResult *res, gpoint
 	g_task_return_boolean(task, TRUE);
 }
 
-static void
-fwupd_client_install_release_download_cb(GObject *source, GAsyncResult *res, gpointer user_data)
-{
-	g_autoptr(GBytes) blob = NULL;
-	g_autoptr(GError) error = NULL;
-	g_autoptr(GTask) task = G_TASK(user_data);
-	FwupdClientInstallReleaseData *data = g_task_get_task_data(task);
-	GChecksumType checksum_type;
-	GCancellable *cancellable = g_task_get_cancellable(task);
-	const gchar *checksum_expected;
-	g_autofree gchar *checksum_actual = NULL;
-
-	blob = fwupd_client_download_bytes_finish(FWUPD_CLIENT(source), res, &error);
-	if (blob == NULL) {
-		g_task_return_error(task, g_steal_pointer(&error));
-		return;
-	}
-
-	/* verify checksum */
-	checksum_expected = fwupd_checksum_get_best(fwupd_release_get_checksums(data->release));
-	checksum_type = fwupd_checksum_guess_kind(checksum_expected);
-	checksum_actual = g_compute_checksum_for_bytes(checksum_type, blob);
-	if (g_strcmp0(checksum_expected, checksum_actual) != 0) {
-		g_task_return_new_error(task,
-					FWUPD_ERROR,
-					FWUPD_ERROR_INVALID_FILE,
-					"checksum invalid, expected %s got %s",
-					checksum_expected,
-					checksum_actual);
-		return;
-	}
-
-	fwupd_client_install_bytes_async(FWUPD_CLIENT(source),
-					 fwupd_device_get_id(data->device),
-					 blob,
-					 data->install_flags,
-					 cancellable,
-					 fwupd_client_install_release_bytes_cb,
-					 g_steal_pointer(&task));
-}
-
 static gboolean
 fwupd_client_is_url_http(const gchar *perhaps_url)
 {
@@ -4035,16 +4436,242 @@ fwupd_client_is_url_p2p(const gchar *perhaps_url)
 	return FALSE;
 }
 
-static void
-fwupd_client_install_release_remote_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+static GPtrArray *
+fwupd_client_release_build_uris(FwupdRelease *release, FwupdRemote *remote, GError **error)
 {
-	GPtrArray *locations;
-	const gchar *uri_tmp;
-	g_autofree gchar *fn = NULL;
-	g_autoptr(FwupdRemote) remote = NULL;
-	g_autoptr(GError) error = NULL;
-	g_autoptr(GTask) task = G_TASK(user_data);
+	GPtrArray *locations = fwupd_release_get_locations(release);
 	g_autoptr(GPtrArray) uris_built = g_ptr_array_new_with_free_func(g_free);
+
+	/* maybe get payload from Passim */
+	if (fwupd_remote_has_flag(remote, FWUPD_REMOTE_FLAG_ALLOW_P2P_FIRMWARE)) {
+		const gchar *checksum_sha256 =
+		    fwupd_checksum_get_by_kind(fwupd_release_get_checksums(release),
+					       G_CHECKSUM_SHA256);
+		if (checksum_sha256 != NULL) {
+			g_autofree gchar *basename =
+			    g_path_get_basename(fwupd_release_get_filename(release));
+			g_ptr_array_add(uris_built,
+					g_strdup_printf("https://localhost:27500/%s?sha256=%s",
+							basename,
+							checksum_sha256));
+		}
+	}
+
+	/* remote file */
+	for (guint i = 0; i < locations->len; i++) {
+		const gchar *uri_tmp = g_ptr_array_index(locations, i);
+		if (fwupd_client_is_url_p2p(uri_tmp)) {
+			g_ptr_array_add(uris_built, g_strdup(uri_tmp));
+		} else if (fwupd_client_is_url_http(uri_tmp)) {
+			g_autofree gchar *uri_str = NULL;
+			uri_str = fwupd_remote_build_firmware_uri(remote, uri_tmp, error);
+			if (uri_str == NULL)
+				return NULL;
+			g_ptr_array_add(uris_built, g_steal_pointer(&uri_str));
+		} else {
+			g_debug("do not how to handle URI %s", uri_tmp);
+		}
+	}
+	if (uris_built->len == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "No URIs to download");
+		return NULL;
+	}
+	return g_steal_pointer(&uris_built);
+}
+
+typedef struct {
+	FwupdRelease *release;
+	GPtrArray *urls; /* element-type utf8 */
+	FwupdClientDownloadFlags download_flags;
+	gchar *checksum; /* nullable */
+	GBytes *blob;	 /* nullable */
+} FwupdClientDownloadReleaseData;
+
+static void
+fwupd_client_download_release_data_free(FwupdClientDownloadReleaseData *data)
+{
+	g_object_unref(data->release);
+	if (data->urls != NULL)
+		g_ptr_array_unref(data->urls);
+	if (data->blob != NULL)
+		g_bytes_unref(data->blob);
+	g_free(data->checksum);
+	g_free(data);
+}
+
+static void
+fwupd_client_download_release_thread_cb(GTask *task,
+					gpointer source_object,
+					gpointer task_data,
+					GCancellable *cancellable)
+{
+	FwupdClientDownloadReleaseData *data = g_task_get_task_data(task);
+	g_autofree gchar *checksum_actual = NULL;
+
+	/* verify checksum */
+	if (data->checksum == NULL) {
+		g_task_return_new_error_literal(task,
+						FWUPD_ERROR,
+						FWUPD_ERROR_INVALID_FILE,
+						"release has no checksum");
+		return;
+	}
+	checksum_actual =
+	    g_compute_checksum_for_bytes(fwupd_checksum_guess_kind(data->checksum), data->blob);
+	if (g_strcmp0(data->checksum, checksum_actual) != 0) {
+		g_task_return_new_error(task,
+					FWUPD_ERROR,
+					FWUPD_ERROR_INVALID_FILE,
+					"checksum invalid, expected %s got %s",
+					data->checksum,
+					checksum_actual);
+		return;
+	}
+	fwupd_client_download_cache_insert(FWUPD_CLIENT(source_object), data->checksum, data->blob);
+
+	/* success */
+	g_task_return_pointer(task, g_bytes_ref(data->blob), (GDestroyNotify)g_bytes_unref);
+}
+
+static void
+fwupd_client_download_release_download_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTask) task = G_TASK(user_data);
+	FwupdClientDownloadReleaseData *data = g_task_get_task_data(task);
+
+	data->blob = fwupd_client_download_bytes_finish(FWUPD_CLIENT(source), res, &error);
+	if (data->blob == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+
+	/* hashing the payload and saving it to the cache may take some time */
+	g_task_run_in_thread(task, fwupd_client_download_release_thread_cb);
+}
+
+static void
+fwupd_client_download_release_cache_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GTask) task = G_TASK(user_data);
+	FwupdClientDownloadReleaseData *data = g_task_get_task_data(task);
+
+	/* already downloaded, perhaps using fwupd_client_prefetch_releases_async() */
+	blob = g_task_propagate_pointer(G_TASK(res), NULL);
+	if (blob != NULL) {
+		g_info("using cached firmware for %s", fwupd_release_get_version(data->release));
+		g_task_return_pointer(task, g_steal_pointer(&blob), (GDestroyNotify)g_bytes_unref);
+		return;
+	}
+	fwupd_client_download_bytes2_async(FWUPD_CLIENT(source),
+					   data->urls,
+					   data->download_flags,
+					   g_task_get_cancellable(task),
+					   fwupd_client_download_release_download_cb,
+					   g_steal_pointer(&task));
+}
+
+/* returns the verified payload, from the download cache if possible */
+void
+fwupd_client_download_release_async(FwupdClient *self,
+				    FwupdRelease *release,
+				    FwupdRemote *remote,
+				    FwupdClientDownloadFlags download_flags,
+				    GCancellable *cancellable,
+				    GAsyncReadyCallback callback,
+				    gpointer callback_data)
+{
+	FwupdClientDownloadReleaseData *data;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTask) task = NULL;
+	g_autoptr(GTask) task_lookup = NULL;
+
+	g_return_if_fail(FWUPD_IS_CLIENT(self));
+	g_return_if_fail(FWUPD_IS_RELEASE(release));
+	g_return_if_fail(remote == NULL || FWUPD_IS_REMOTE(remote));
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+	task = g_task_new(self, cancellable, callback, callback_data);
+	g_task_set_source_tag(task, fwupd_client_download_release_async);
+	data = g_new0(FwupdClientDownloadReleaseData, 1);
+	data->release = g_object_ref(release);
+	data->download_flags = download_flags;
+	data->checksum = g_strdup(fwupd_checksum_get_best(fwupd_release_get_checksums(release)));
+	g_task_set_task_data(task, data, (GDestroyNotify)fwupd_client_download_release_data_free);
+
+	/* remote-specific URIs, perhaps including Passim */
+	if (remote != NULL) {
+		data->urls = fwupd_client_release_build_uris(release, remote, &error);
+		if (data->urls == NULL) {
+			g_task_return_error(task, g_steal_pointer(&error));
+			return;
+		}
+	} else {
+		data->urls = g_ptr_array_ref(fwupd_release_get_locations(release));
+	}
+
+	/* reading and hashing the cached file is done in a thread */
+	if (data->checksum == NULL || !fwupd_client_download_cache_is_enabled(self)) {
+		fwupd_client_download_bytes2_async(self,
+						   data->urls,
+						   download_flags,
+						   cancellable,
+						   fwupd_client_download_release_download_cb,
+						   g_steal_pointer(&task));
+		return;
+	}
+	task_lookup = g_task_new(self,
+				 cancellable,
+				 fwupd_client_download_release_cache_cb,
+				 g_steal_pointer(&task));
+	g_task_set_task_data(task_lookup, g_strdup(data->checksum), g_free);
+	g_task_run_in_thread(task_lookup, fwupd_client_download_cache_lookup_thread_cb);
+}
+
+GBytes *
+fwupd_client_download_release_finish(FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail(FWUPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(g_task_is_valid(res, self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+	return g_task_propagate_pointer(G_TASK(res), error);
+}
+
+static void
+fwupd_client_install_release_download_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTask) task = G_TASK(user_data);
+	FwupdClientInstallReleaseData *data = g_task_get_task_data(task);
+
+	blob = fwupd_client_download_release_finish(FWUPD_CLIENT(source), res, &error);
+	if (blob == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	fwupd_client_install_bytes_async(FWUPD_CLIENT(source),
+					 fwupd_device_get_id(data->device),
+					 blob,
+					 data->install_flags,
+					 g_task_get_cancellable(task),
+					 fwupd_client_install_release_bytes_cb,
+					 g_steal_pointer(&task));
+}
+
+static void
+fwupd_client_install_release_remote_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	GPtrArray *locations;
+	const gchar *uri_tmp;
+	g_autofree gchar *fn = NULL;
+	g_autoptr(FwupdRemote) remote = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTask) task = G_TASK(user_data);
 	FwupdClientInstallReleaseData *data = g_task_get_task_data(task);
 	GCancellable *cancellable = g_task_get_cancellable(task);
 
@@ -4089,53 +4716,14 @@ fwupd_client_install_release_remote_cb(GObject *source, GAsyncResult *res, gpoin
 		return;
 	}
 
-	/* maybe get payload from Passim */
-	if (fwupd_remote_has_flag(remote, FWUPD_REMOTE_FLAG_ALLOW_P2P_FIRMWARE)) {
-		const gchar *checksum_sha256 =
-		    fwupd_checksum_get_by_kind(fwupd_release_get_checksums(data->release),
-					       G_CHECKSUM_SHA256);
-		if (checksum_sha256 != NULL) {
-			g_autofree gchar *basename =
-			    g_path_get_basename(fwupd_release_get_filename(data->release));
-			g_ptr_array_add(uris_built,
-					g_strdup_printf("https://localhost:27500/%s?sha256=%s",
-							basename,
-							checksum_sha256));
-		}
-	}
-
 	/* remote file */
-	for (guint i = 0; i < locations->len; i++) {
-		uri_tmp = g_ptr_array_index(locations, i);
-		if (fwupd_client_is_url_p2p(uri_tmp)) {
-			g_ptr_array_add(uris_built, g_strdup(uri_tmp));
-		} else if (fwupd_client_is_url_http(uri_tmp)) {
-			g_autofree gchar *uri_str = NULL;
-			uri_str = fwupd_remote_build_firmware_uri(remote, uri_tmp, &error);
-			if (uri_str == NULL) {
-				g_task_return_error(task, g_steal_pointer(&error));
-				return;
-			}
-			g_ptr_array_add(uris_built, g_steal_pointer(&uri_str));
-		} else {
-			g_debug("do not how to handle URI %s", uri_tmp);
-		}
-	}
-	if (uris_built->len == 0) {
-		g_task_return_new_error_literal(task,
-						FWUPD_ERROR,
-						FWUPD_ERROR_INVALID_FILE,
-						"No URIs to download");
-		return;
-	}
-
-	/* download file */
-	fwupd_client_download_bytes2_async(FWUPD_CLIENT(source),
-					   uris_built,
-					   data->download_flags,
-					   cancellable,
-					   fwupd_client_install_release_download_cb,
-					   g_steal_pointer(&task));
+	fwupd_client_download_release_async(FWUPD_CLIENT(source),
+					    data->release,
+					    remote,
+					    data->download_flags,
+					    cancellable,
+					    fwupd_client_install_release_download_cb,
+					    g_steal_pointer(&task));
 }
 
 static GPtrArray *
@@ -4216,12 +4804,13 @@ fwupd_client_install_release_async(FwupdClient *self,
 	/* work out what remote-specific URI fields this should use */
 	remote_id = fwupd_release_get_remote_id(release);
 	if (remote_id == NULL) {
-		fwupd_client_download_bytes2_async(self,
-						   fwupd_release_get_locations(release),
-						   download_flags,
-						   cancellable,
-						   fwupd_client_install_release_download_cb,
-						   g_steal_pointer(&task));
+		fwupd_client_download_release_async(self,
+						    release,
+						    NULL,
+						    download_flags,
+						    cancellable,
+						    fwupd_client_install_release_download_cb,
+						    g_steal_pointer(&task));
 		return;
 	}
 
@@ -4961,33 +5550,13 @@ fwupd_client_refresh_remote_metadata_cb(GObject *source, GAsyncResult *res, gpoi
 	GCancellable *cancellable = g_task_get_cancellable(task);
 
 	/* save metadata */
-	bytes = fwupd_client_download_bytes_finish(FWUPD_CLIENT(source), res, &error);
+	bytes = fwupd_client_download_metadata_finish(FWUPD_CLIENT(source), res, &error);
 	if (bytes == NULL) {
-		g_prefix_error(&error,
-			       "Failed to download metadata for %s: ",
-			       fwupd_remote_get_id(data->remote));
 		g_task_return_error(task, g_steal_pointer(&error));
 		return;
 	}
 	data->metadata = g_steal_pointer(&bytes);
 
-	/* verify this was what we expected */
-	if (fwupd_remote_get_checksum_metadata(data->remote) != NULL) {
-		GChecksumType checksum_kind =
-		    fwupd_checksum_guess_kind(fwupd_remote_get_checksum_metadata(data->remote));
-		g_autofree gchar *checksum =
-		    g_compute_checksum_for_bytes(checksum_kind, data->metadata);
-		if (g_strcmp0(checksum, fwupd_remote_get_checksum_metadata(data->remote)) != 0) {
-			g_task_return_new_error(task,
-						FWUPD_ERROR,
-						FWUPD_ERROR_INVALID_FILE,
-						"metadata checksum expected %s and got %s",
-						fwupd_remote_get_checksum_metadata(data->remote),
-						checksum);
-			return;
-		}
-	}
-
 	/* send all this to fwupd */
 	fwupd_client_update_metadata_bytes_async(self,
 						 fwupd_remote_get_id(data->remote),
@@ -4998,6 +5567,44 @@ fwupd_client_refresh_remote_metadata_cb(GObject *source, GAsyncResult *res, gpoi
 						 g_steal_pointer(&task));
 }
 
+/* the server says nothing changed, so resend the cached blobs to let the daemon reset the age */
+static void
+fwupd_client_refresh_remote_touch(FwupdClient *self, gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK(user_data);
+	FwupdClientRefreshRemoteData *data = g_task_get_task_data(task);
+	GCancellable *cancellable = g_task_get_cancellable(task);
+	const gchar *fn_raw = fwupd_remote_get_filename_cache(data->remote);
+	const gchar *fn_sig = fwupd_remote_get_filename_cache_sig(data->remote);
+	gsize bufsz_raw = 0;
+	gsize bufsz_sig = 0;
+	g_autofree gchar *buf_raw = NULL;
+	g_autofree gchar *buf_sig = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	if (fn_raw == NULL || fn_sig == NULL) {
+		g_task_return_boolean(task, TRUE);
+		return;
+	}
+	if (!g_file_get_contents(fn_sig, &buf_sig, &bufsz_sig, &error_local) ||
+	    !g_file_get_contents(fn_raw, &buf_raw, &bufsz_raw, &error_local)) {
+		g_info("cannot reuse cached metadata for %s: %s",
+		       fwupd_remote_get_id(data->remote),
+		       error_local->message);
+		g_task_return_boolean(task, TRUE);
+		return;
+	}
+	data->signature = g_bytes_new_take(g_steal_pointer(&buf_sig), bufsz_sig);
+	data->metadata = g_bytes_new_take(g_steal_pointer(&buf_raw), bufsz_raw);
+	fwupd_client_update_metadata_bytes_async(self,
+						 fwupd_remote_get_id(data->remote),
+						 data->metadata,
+						 data->signature,
+						 cancellable,
+						 fwupd_client_refresh_remote_update_cb,
+						 g_steal_pointer(&task));
+}
+
 static void
 fwupd_client_refresh_remote_signature_cb(GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -5007,11 +5614,16 @@ fwupd_client_refresh_remote_signature_cb(GObject *source, GAsyncResult *res, gpo
 	FwupdClientRefreshRemoteData *data = g_task_get_task_data(task);
 	FwupdClient *self = g_task_get_source_object(task);
 	GCancellable *cancellable = g_task_get_cancellable(task);
-	g_autoptr(GPtrArray) urls = g_ptr_array_new_with_free_func(g_free);
 
 	/* save signature */
 	bytes = fwupd_client_download_bytes_finish(FWUPD_CLIENT(source), res, &error);
 	if (bytes == NULL) {
+		if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO)) {
+			g_info("metadata signature of %s is not modified, skipping",
+			       fwupd_remote_get_id(data->remote));
+			fwupd_client_refresh_remote_touch(self, g_steal_pointer(&task));
+			return;
+		}
 		g_prefix_error(&error,
 			       "Failed to download metadata for %s: ",
 			       fwupd_remote_get_id(data->remote));
@@ -5036,37 +5648,19 @@ fwupd_client_refresh_remote_signature_cb(GObject *source, GAsyncResult *res, gpo
 		if (g_strcmp0(checksum, fwupd_remote_get_checksum(data->remote)) == 0) {
 			g_info("metadata signature of %s is unchanged, skipping",
 			       fwupd_remote_get_id(data->remote));
-			g_task_return_boolean(task, TRUE);
+			g_clear_pointer(&data->signature, g_bytes_unref);
+			fwupd_client_refresh_remote_touch(self, g_steal_pointer(&task));
 			return;
 		}
 	}
 
-	/* maybe get metadata from Passim */
-	if (fwupd_remote_has_flag(data->remote, FWUPD_REMOTE_FLAG_ALLOW_P2P_METADATA) &&
-	    fwupd_remote_get_checksum_metadata(data->remote) != NULL &&
-	    fwupd_remote_get_username(data->remote) == NULL &&
-	    fwupd_remote_get_password(data->remote) == NULL) {
-		g_autofree gchar *basename =
-		    g_path_get_basename(fwupd_remote_get_metadata_uri(data->remote));
-		g_ptr_array_add(urls,
-				g_strdup_printf("https://localhost:27500/%s?sha256=%s",
-						basename,
-						fwupd_remote_get_checksum_metadata(data->remote)));
-	}
-	if ((data->download_flags & FWUPD_CLIENT_DOWNLOAD_FLAG_ONLY_P2P) == 0) {
-		g_autofree gchar *uri = fwupd_remote_build_metadata_uri(data->remote, &error);
-		if (uri == NULL) {
-			g_task_return_error(task, g_steal_pointer(&error));
-			return;
-		}
-		g_ptr_array_add(urls, g_steal_pointer(&uri));
-	}
-	fwupd_client_download_bytes2_async(self,
-					   urls,
-					   FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
-					   cancellable,
-					   fwupd_client_refresh_remote_metadata_cb,
-					   g_steal_pointer(&task));
+	/* download the metadata itself, perhaps as a delta */
+	fwupd_client_download_metadata_async(self,
+					     data->remote,
+					     data->download_flags,
+					     cancellable,
+					     fwupd_client_refresh_remote_metadata_cb,
+					     g_steal_pointer(&task));
 }
 
 /**
@@ -5095,9 +5689,12 @@ fwupd_client_refresh_remote_async(FwupdClient *self,
 				  gpointer callback_data)
 {
 	FwupdClientRefreshRemoteData *data;
+	FwupdClientDownloadFlags download_flags_sig =
+	    download_flags & ~FWUPD_CLIENT_DOWNLOAD_FLAG_ONLY_P2P;
 	g_autofree gchar *uri = NULL;
 	g_autoptr(GTask) task = NULL;
 	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) urls = g_ptr_array_new_with_free_func(g_free);
 
 	g_return_if_fail(FWUPD_IS_CLIENT(self));
 	g_return_if_fail(FWUPD_IS_REMOTE(remote));
@@ -5138,12 +5735,14 @@ fwupd_client_refresh_remote_async(FwupdClient *self,
 		g_task_return_error(task, g_steal_pointer(&error));
 		return;
 	}
-	fwupd_client_download_bytes_async(self,
-					  uri,
-					  download_flags & ~FWUPD_CLIENT_DOWNLOAD_FLAG_ONLY_P2P,
-					  cancellable,
-					  fwupd_client_refresh_remote_signature_cb,
-					  g_steal_pointer(&task));
+	g_ptr_array_add(urls, g_steal_pointer(&uri));
+	fwupd_client_download_bytes_full_async(self,
+					       urls,
+					       download_flags_sig,
+					       remote,
+					       cancellable,
+					       fwupd_client_refresh_remote_signature_cb,
+					       g_steal_pointer(&task));
 }
 
 /**
@@ -6153,6 +6752,49 @@ fwupd_client_set_user_agent(FwupdClient *self, const gchar *user_agent)
 	priv->user_agent = g_strdup(user_agent);
 }
 
+/**
+ * fwupd_client_set_device_cache_enabled:
+ * @self: a #FwupdClient
+ * @device_cache_enabled: %TRUE to mirror the device list
+ *
+ * Sets if the client should keep a local copy of the device list, updated using the
+ * `DeviceAdded`, `DeviceRemoved` and `DeviceChanged` signals. When enabled, calls to
+ * [method@Client.get_devices_async] and [method@Client.get_device_by_id_async] only read the
+ * small `DeviceGeneration` property from the daemon, and the device list is only transferred
+ * again if a signal was missed.
+ *
+ * The returned devices are shared with the mirror and should not be modified.
+ *
+ * Since: 2.2.1
+ **/
+void
+fwupd_client_set_device_cache_enabled(FwupdClient *self, gboolean device_cache_enabled)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FWUPD_IS_CLIENT(self));
+	priv->device_cache_enabled = device_cache_enabled;
+	if (!device_cache_enabled)
+		fwupd_client_device_cache_invalidate(self);
+}
+
+/**
+ * fwupd_client_get_device_cache_enabled:
+ * @self: a #FwupdClient
+ *
+ * Gets if the client keeps a local copy of the device list.
+ *
+ * Returns: %TRUE if enabled
+ *
+ * Since: 2.2.1
+ **/
+gboolean
+fwupd_client_get_device_cache_enabled(FwupdClient *self)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FWUPD_IS_CLIENT(self), FALSE);
+	return priv->device_cache_enabled;
+}
+
 /**
  * fwupd_client_get_user_agent:
  * @self: a #FwupdClient
@@ -6263,14 +6905,9 @@ fwupd_client_download_ipfs(FwupdClient *self,
 	return g_steal_pointer(&bstdout);
 }
 
-static GBytes *
-fwupd_client_download_http(FwupdClient *self, CURL *curl, const gchar *url, GError **error)
+static void
+fwupd_client_curl_set_ssl_verify(CURL *curl, const gchar *url)
 {
-	CURLcode res;
-	gchar errbuf[CURL_ERROR_SIZE] = {'\0'};
-	glong status_code = 0;
-	g_autoptr(GByteArray) buf = g_byte_array_new();
-
 	/* relax the SSL checks on localhost URLs and broken corporate proxies */
 	if (fwupd_client_is_localhost(url) || g_getenv("DISABLE_SSL_STRICT") != NULL) {
 		(void)curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
@@ -6279,7 +6916,17 @@ fwupd_client_download_http(FwupdClient *self, CURL *curl, const gchar *url, GErr
 		(void)curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
 		(void)curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
 	}
+}
+
+static GBytes *
+fwupd_client_download_http(FwupdClient *self, CURL *curl, const gchar *url, GError **error)
+{
+	CURLcode res;
+	gchar errbuf[CURL_ERROR_SIZE] = {'\0'};
+	glong status_code = 0;
+	g_autoptr(GByteArray) buf = g_byte_array_new();
 
+	fwupd_client_curl_set_ssl_verify(curl, url);
 	fwupd_client_set_status(self, FWUPD_STATUS_DOWNLOADING);
 	(void)curl_easy_setopt(curl, CURLOPT_URL, url);
 	(void)curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errbuf);
@@ -6320,6 +6967,16 @@ fwupd_client_download_http(FwupdClient *self, CURL *curl, const gchar *url, GErr
 	/* check for server limit */
 	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
 	g_info("status-code was %ld", status_code);
+
+	/* the If-None-Match or If-Modified-Since validators matched */
+	if (status_code == 304) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOTHING_TO_DO,
+			    "%s has not been modified",
+			    url);
+		return NULL;
+	}
 	if (status_code == 429) {
 		g_autofree gchar *str = g_strndup((const gchar *)buf->data, MIN(buf->len, 4000));
 		if (g_str_is_ascii(str)) {
@@ -6537,6 +7194,138 @@ fwupd_client_download_http_retry(FwupdClient *self, CURL *curl, const gchar *url
 	}
 	return NULL;
 }
+
+/* the HTTP validators of the signature that was last downloaded by this user */
+static gchar *
+fwupd_client_build_validators_filename(FwupdRemote *remote)
+{
+	g_autofree gchar *basename = NULL;
+	g_autofree gchar *fn = NULL;
+
+	if (fwupd_remote_get_id(remote) == NULL ||
+	    fwupd_remote_get_metadata_uri_sig(remote) == NULL)
+		return NULL;
+	basename = g_path_get_basename(fwupd_remote_get_metadata_uri_sig(remote));
+	fn = g_strdup_printf("%s.validators", basename);
+	return g_build_filename(g_get_user_cache_dir(),
+				"fwupd",
+				"remotes.d",
+				fwupd_remote_get_id(remote),
+				fn,
+				NULL);
+}
+
+static gboolean
+fwupd_client_validator_is_valid(const gchar *value)
+{
+	if (value == NULL || value[0] == '\0' || !g_str_is_ascii(value))
+		return FALSE;
+	for (guint i = 0; value[i] != '\0'; i++) {
+		if (g_ascii_iscntrl(value[i]))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static gsize
+fwupd_client_download_header_cb(gchar *ptr, gsize size, gsize nmemb, gpointer user_data)
+{
+	FwupdCurlHelper *helper = (FwupdCurlHelper *)user_data;
+	gsize realsize = size * nmemb;
+	g_autofree gchar *line = g_strstrip(g_strndup(ptr, realsize));
+
+	/* a new response, e.g. after a redirect */
+	if (g_str_has_prefix(line, "HTTP/")) {
+		g_clear_pointer(&helper->etag, g_free);
+		g_clear_pointer(&helper->last_modified, g_free);
+	} else if (g_ascii_strncasecmp(line, "ETag:", 5) == 0) {
+		g_free(helper->etag);
+		helper->etag = g_strdup(g_strstrip(line + 5));
+	} else if (g_ascii_strncasecmp(line, "Last-Modified:", 14) == 0) {
+		g_free(helper->last_modified);
+		helper->last_modified = g_strdup(g_strstrip(line + 14));
+	}
+	return realsize;
+}
+
+/* only send the validators if the daemon still has the signature they were saved for */
+static void
+fwupd_client_curl_helper_load_validators(FwupdCurlHelper *helper)
+{
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *etag = NULL;
+	g_autofree gchar *last_modified = NULL;
+	g_autoptr(GKeyFile) kf = g_key_file_new();
+	g_autoptr(GError) error_local = NULL;
+
+	if (helper->validators_fn == NULL)
+		return;
+	(void)curl_easy_setopt(helper->curl,
+			       CURLOPT_HEADERFUNCTION,
+			       fwupd_client_download_header_cb);
+	(void)curl_easy_setopt(helper->curl, CURLOPT_HEADERDATA, helper);
+	if (helper->validators_checksum == NULL)
+		return;
+	if (!g_key_file_load_from_file(kf, helper->validators_fn, G_KEY_FILE_NONE, &error_local)) {
+		g_debug("ignoring validators: %s", error_local->message);
+		return;
+	}
+	checksum = g_key_file_get_string(kf, "fwupd Validators", "Checksum", NULL);
+	if (g_strcmp0(checksum, helper->validators_checksum) != 0) {
+		g_debug("validators are for %s, but cached signature is %s",
+			checksum,
+			helper->validators_checksum);
+		return;
+	}
+	etag = g_key_file_get_string(kf, "fwupd Validators", "ETag", NULL);
+	if (fwupd_client_validator_is_valid(etag)) {
+		g_autofree gchar *header = g_strdup_printf("If-None-Match: %s", etag);
+		helper->headers = curl_slist_append(helper->headers, header);
+	}
+	last_modified = g_key_file_get_string(kf, "fwupd Validators", "LastModified", NULL);
+	if (fwupd_client_validator_is_valid(last_modified)) {
+		g_autofree gchar *header = g_strdup_printf("If-Modified-Since: %s", last_modified);
+		helper->headers = curl_slist_append(helper->headers, header);
+	}
+	if (helper->headers != NULL)
+		(void)curl_easy_setopt(helper->curl, CURLOPT_HTTPHEADER, helper->headers);
+}
+
+static void
+fwupd_client_curl_helper_save_validators(FwupdCurlHelper *helper, GBytes *blob)
+{
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *dirname = NULL;
+	g_autoptr(GKeyFile) kf = g_key_file_new();
+	g_autoptr(GError) error_local = NULL;
+
+	if (helper->validators_fn == NULL)
+		return;
+	if (!fwupd_client_validator_is_valid(helper->etag) &&
+	    !fwupd_client_validator_is_valid(helper->last_modified)) {
+		(void)g_unlink(helper->validators_fn);
+		return;
+	}
+	if (fwupd_client_validator_is_valid(helper->etag))
+		g_key_file_set_string(kf, "fwupd Validators", "ETag", helper->etag);
+	if (fwupd_client_validator_is_valid(helper->last_modified))
+		g_key_file_set_string(kf,
+				      "fwupd Validators",
+				      "LastModified",
+				      helper->last_modified);
+
+	/* the daemon uses SHA-256 for the cached signature checksum */
+	checksum = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob);
+	g_key_file_set_string(kf, "fwupd Validators", "Checksum", checksum);
+	dirname = g_path_get_dirname(helper->validators_fn);
+	if (g_mkdir_with_parents(dirname, 0700) == -1) {
+		g_debug("failed to create %s: %s", dirname, fwupd_strerror(errno));
+		return;
+	}
+	if (!g_key_file_save_to_file(kf, helper->validators_fn, &error_local))
+		g_debug("failed to save validators: %s", error_local->message);
+}
+
 static void
 fwupd_client_download_bytes_thread_cb(GTask *task,
 				      gpointer source_object,
@@ -6547,6 +7336,7 @@ fwupd_client_download_bytes_thread_cb(GTask *task,
 	FwupdCurlHelper *helper = g_task_get_task_data(task);
 	g_autoptr(GBytes) blob = NULL;
 
+	fwupd_client_curl_helper_load_validators(helper);
 	for (guint i = 0; i < helper->urls->len; i++) {
 		const gchar *url = g_ptr_array_index(helper->urls, i);
 		g_autoptr(GError) error = NULL;
@@ -6557,8 +7347,14 @@ fwupd_client_download_bytes_thread_cb(GTask *task,
 		}
 		if (fwupd_client_is_url_http(url)) {
 			blob = fwupd_client_download_http_retry(self, helper->curl, url, &error);
-			if (blob != NULL)
+			if (blob != NULL) {
+				fwupd_client_curl_helper_save_validators(helper, blob);
 				break;
+			}
+			if (g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO)) {
+				g_task_return_error(task, g_steal_pointer(&error));
+				return;
+			}
 		} else if (fwupd_client_is_url_ipfs(url)) {
 			blob = fwupd_client_download_ipfs(self, url, cancellable, &error);
 			if (blob != NULL)
@@ -6581,6 +7377,49 @@ fwupd_client_download_bytes_thread_cb(GTask *task,
 	g_task_return_pointer(task, g_steal_pointer(&blob), (GDestroyNotify)g_bytes_unref);
 }
 
+static void
+fwupd_client_download_bytes_full_async(FwupdClient *self,
+				       GPtrArray *urls,
+				       FwupdClientDownloadFlags flags,
+				       FwupdRemote *remote,
+				       GCancellable *cancellable,
+				       GAsyncReadyCallback callback,
+				       gpointer callback_data)
+{
+	g_autoptr(GTask) task = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(FwupdCurlHelper) helper = NULL;
+
+	/* ensure networking set up */
+	task = g_task_new(self, cancellable, callback, callback_data);
+	g_task_set_source_tag(task, fwupd_client_download_bytes2_async);
+	helper = fwupd_client_curl_new(self, &error);
+	if (helper == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	helper->urls = fwupd_client_filter_locations(urls, flags, &error);
+	if (helper->urls == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+
+	/* only transfer the signature if it is different to the one the daemon has cached */
+	if (remote != NULL) {
+		helper->validators_fn = fwupd_client_build_validators_filename(remote);
+		helper->validators_checksum = g_strdup(fwupd_remote_get_checksum(remote));
+	}
+	g_task_set_task_data(task,
+			     g_steal_pointer(&helper),
+			     (GDestroyNotify)fwupd_client_curl_helper_free);
+
+	/* keep list sane */
+	fwupd_client_download_item_prune(self);
+
+	/* download data */
+	g_task_run_in_thread(task, fwupd_client_download_bytes_thread_cb);
+}
+
 /**
  * fwupd_client_download_bytes2_async:
  * @self: a #FwupdClient
@@ -6610,37 +7449,17 @@ fwupd_client_download_bytes2_async(FwupdClient *self,
 				   GAsyncReadyCallback callback,
 				   gpointer callback_data)
 {
-	g_autoptr(GTask) task = NULL;
-	g_autoptr(GError) error = NULL;
-	g_autoptr(GMutexLocker) download_items_locker = NULL;
-	g_autoptr(FwupdCurlHelper) helper = NULL;
-
 	g_return_if_fail(FWUPD_IS_CLIENT(self));
 	g_return_if_fail(urls != NULL);
 	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
 
-	/* ensure networking set up */
-	task = g_task_new(self, cancellable, callback, callback_data);
-	g_task_set_source_tag(task, fwupd_client_download_bytes2_async);
-	helper = fwupd_client_curl_new(self, &error);
-	if (helper == NULL) {
-		g_task_return_error(task, g_steal_pointer(&error));
-		return;
-	}
-	helper->urls = fwupd_client_filter_locations(urls, flags, &error);
-	if (helper->urls == NULL) {
-		g_task_return_error(task, g_steal_pointer(&error));
-		return;
-	}
-	g_task_set_task_data(task,
-			     g_steal_pointer(&helper),
-			     (GDestroyNotify)fwupd_client_curl_helper_free);
-
-	/* keep list sane */
-	fwupd_client_download_item_prune(self);
-
-	/* download data */
-	g_task_run_in_thread(task, fwupd_client_download_bytes_thread_cb);
+	fwupd_client_download_bytes_full_async(self,
+					       urls,
+					       flags,
+					       NULL,
+					       cancellable,
+					       callback,
+					       callback_data);
 }
 
 /**
@@ -6725,6 +7544,986 @@ fwupd_client_download_bytes_finish(FwupdClient *self, GAsyncResult *res, GError
 	return g_task_propagate_pointer(G_TASK(res), error);
 }
 
+static gboolean
+fwupd_client_metadata_delta_read_uint32(GBytes *delta,
+					gsize *offset,
+					guint32 *value,
+					GError **error)
+{
+	gsize bufsz = 0;
+	const guint8 *buf = g_bytes_get_data(delta, &bufsz);
+
+	if (*offset > bufsz || bufsz - *offset < sizeof(guint32)) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_FILE,
+			    "delta truncated at 0x%x",
+			    (guint)*offset);
+		return FALSE;
+	}
+	/* libfwupd has no fu_memread_uint32() */
+	*value = (guint32)buf[*offset] | (guint32)buf[*offset + 1] << 8 | /* nocheck:endian */
+		 (guint32)buf[*offset + 2] << 16 | (guint32)buf[*offset + 3] << 24;
+	*offset += sizeof(guint32);
+	return TRUE;
+}
+
+/* the format is documented in fwupd-remotes.d(5) */
+GBytes *
+fwupd_client_metadata_delta_apply(GBytes *basis, GBytes *delta, GError **error)
+{
+	gsize basis_sz = 0;
+	gsize bufsz = 0;
+	gsize offset = strlen(FWUPD_CLIENT_METADATA_DELTA_MAGIC);
+	const guint8 *basis_buf = g_bytes_get_data(basis, &basis_sz);
+	const guint8 *buf = g_bytes_get_data(delta, &bufsz);
+	gsize result_max;
+	g_autoptr(GByteArray) result = g_byte_array_new();
+
+	if (bufsz < offset || memcmp(buf, FWUPD_CLIENT_METADATA_DELTA_MAGIC, offset) != 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "delta has invalid magic");
+		return NULL;
+	}
+
+	/* inserts are limited by the delta size, but copies can be repeated forever */
+	result_max = (basis_sz * FWUPD_CLIENT_METADATA_DELTA_MAX_GROWTH) + bufsz;
+	while (offset < bufsz) {
+		guint8 op = buf[offset++];
+		guint32 length = 0;
+
+		if (op == 0x01) {
+			guint32 basis_offset = 0;
+			if (!fwupd_client_metadata_delta_read_uint32(delta,
+								     &offset,
+								     &basis_offset,
+								     error))
+				return NULL;
+			if (!fwupd_client_metadata_delta_read_uint32(delta,
+								     &offset,
+								     &length,
+								     error))
+				return NULL;
+			if (basis_offset > basis_sz || basis_sz - basis_offset < length) {
+				g_set_error(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_FILE,
+					    "delta copy of 0x%x bytes @0x%x is outside basis",
+					    length,
+					    basis_offset);
+				return NULL;
+			}
+			if (length > result_max - result->len) {
+				g_set_error(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_FILE,
+					    "delta copy of 0x%x bytes exceeds limit of 0x%x",
+					    length,
+					    (guint)result_max);
+				return NULL;
+			}
+			g_byte_array_append(result, basis_buf + basis_offset, length);
+		} else if (op == 0x02) {
+			if (!fwupd_client_metadata_delta_read_uint32(delta,
+								     &offset,
+								     &length,
+								     error))
+				return NULL;
+			if (bufsz - offset < length) {
+				g_set_error(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_FILE,
+					    "delta insert of 0x%x bytes @0x%x truncated",
+					    length,
+					    (guint)offset);
+				return NULL;
+			}
+			g_byte_array_append(result, buf + offset, length);
+			offset += length;
+		} else {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "delta has invalid operation 0x%02x @0x%x",
+				    op,
+				    (guint)offset - 1);
+			return NULL;
+		}
+	}
+
+	/* success */
+	return g_bytes_new(result->data, result->len);
+}
+
+static gboolean
+fwupd_client_metadata_verify_checksum(FwupdRemote *remote, GBytes *blob, GError **error)
+{
+	const gchar *checksum_metadata = fwupd_remote_get_checksum_metadata(remote);
+	g_autofree gchar *checksum = NULL;
+
+	if (checksum_metadata == NULL)
+		return TRUE;
+	checksum = g_compute_checksum_for_bytes(fwupd_checksum_guess_kind(checksum_metadata), blob);
+	if (g_strcmp0(checksum, checksum_metadata) != 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_FILE,
+			    "metadata checksum expected %s and got %s",
+			    checksum_metadata,
+			    checksum);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+typedef struct {
+	FwupdRemote *remote;
+	FwupdClientDownloadFlags download_flags;
+	FwupdCurlHelper *helper; /* nullable */
+} FwupdClientDownloadMetadataData;
+
+static void
+fwupd_client_download_metadata_data_free(FwupdClientDownloadMetadataData *data)
+{
+	if (data->helper != NULL)
+		fwupd_client_curl_helper_free(data->helper);
+	g_object_unref(data->remote);
+	g_free(data);
+}
+
+static void
+fwupd_client_download_metadata_full_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK(user_data);
+	FwupdClientDownloadMetadataData *data = g_task_get_task_data(task);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	blob = fwupd_client_download_bytes_finish(FWUPD_CLIENT(source), res, &error);
+	if (blob == NULL) {
+		g_prefix_error(&error,
+			       "Failed to download metadata for %s: ",
+			       fwupd_remote_get_id(data->remote));
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	if (!fwupd_client_metadata_verify_checksum(data->remote, blob, &error)) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	g_task_return_pointer(task, g_steal_pointer(&blob), (GDestroyNotify)g_bytes_unref);
+}
+
+static void
+fwupd_client_download_metadata_full(GTask *task)
+{
+	FwupdClient *self = g_task_get_source_object(task);
+	FwupdClientDownloadMetadataData *data = g_task_get_task_data(task);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) urls = g_ptr_array_new_with_free_func(g_free);
+
+	/* maybe get metadata from Passim */
+	if (fwupd_remote_has_flag(data->remote, FWUPD_REMOTE_FLAG_ALLOW_P2P_METADATA) &&
+	    fwupd_remote_get_checksum_metadata(data->remote) != NULL &&
+	    fwupd_remote_get_username(data->remote) == NULL &&
+	    fwupd_remote_get_password(data->remote) == NULL) {
+		g_autofree gchar *basename =
+		    g_path_get_basename(fwupd_remote_get_metadata_uri(data->remote));
+		g_ptr_array_add(urls,
+				g_strdup_printf("https://localhost:27500/%s?sha256=%s",
+						basename,
+						fwupd_remote_get_checksum_metadata(data->remote)));
+	}
+	if ((data->download_flags & FWUPD_CLIENT_DOWNLOAD_FLAG_ONLY_P2P) == 0) {
+		g_autofree gchar *uri = fwupd_remote_build_metadata_uri(data->remote, &error);
+		if (uri == NULL) {
+			g_task_return_error(task, g_steal_pointer(&error));
+			return;
+		}
+		g_ptr_array_add(urls, g_steal_pointer(&uri));
+	}
+	fwupd_client_download_bytes2_async(self,
+					   urls,
+					   FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+					   g_task_get_cancellable(task),
+					   fwupd_client_download_metadata_full_cb,
+					   g_object_ref(task));
+}
+
+static void
+fwupd_client_download_metadata_delta_thread_cb(GTask *task,
+					       gpointer source_object,
+					       gpointer task_data,
+					       GCancellable *cancellable)
+{
+	FwupdClient *self = FWUPD_CLIENT(source_object);
+	FwupdClientDownloadMetadataData *data = task_data;
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *url = NULL;
+	g_autoptr(GBytes) basis = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) delta = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GMappedFile) mmap = NULL;
+
+	/* the delta is against the exact metadata the daemon has cached */
+	mmap = g_mapped_file_new(fwupd_remote_get_filename_cache(data->remote), FALSE, &error);
+	if (mmap == NULL) {
+		fwupd_error_convert(&error);
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	basis = g_mapped_file_get_bytes(mmap);
+	checksum = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, basis);
+	url = g_strdup_printf("%s.%s.delta", fwupd_remote_get_metadata_uri(data->remote), checksum);
+	g_info("downloading %s", url);
+	if (!fwupd_client_curl_helper_set_proxy(self, data->helper, url, &error)) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	delta = fwupd_client_download_http_retry(self, data->helper->curl, url, &error);
+	if (delta == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+
+	/* the signature has already been verified to be from the server */
+	blob = fwupd_client_metadata_delta_apply(basis, delta, &error);
+	if (blob == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	if (!fwupd_client_metadata_verify_checksum(data->remote, blob, &error)) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	g_info("used %u byte delta for %u bytes of metadata",
+	       (guint)g_bytes_get_size(delta),
+	       (guint)g_bytes_get_size(blob));
+	g_task_return_pointer(task, g_steal_pointer(&blob), (GDestroyNotify)g_bytes_unref);
+}
+
+static void
+fwupd_client_download_metadata_delta_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK(user_data);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	blob = g_task_propagate_pointer(G_TASK(res), &error);
+	if (blob == NULL) {
+		g_info("failed to use metadata delta, downloading everything: %s", error->message);
+		fwupd_client_download_metadata_full(task);
+		return;
+	}
+	g_task_return_pointer(task, g_steal_pointer(&blob), (GDestroyNotify)g_bytes_unref);
+}
+
+static gboolean
+fwupd_client_download_metadata_delta_is_possible(FwupdRemote *remote,
+						 FwupdClientDownloadFlags download_flags)
+{
+	const gchar *uri = fwupd_remote_get_metadata_uri(remote);
+
+	if (!fwupd_remote_has_flag(remote, FWUPD_REMOTE_FLAG_ALLOW_DELTA_METADATA))
+		return FALSE;
+	if ((download_flags & FWUPD_CLIENT_DOWNLOAD_FLAG_ONLY_P2P) > 0)
+		return FALSE;
+
+	/* the result can only be used if it can be verified */
+	if (fwupd_remote_get_checksum_metadata(remote) == NULL)
+		return FALSE;
+	if (fwupd_remote_get_filename_cache(remote) == NULL ||
+	    !g_file_test(fwupd_remote_get_filename_cache(remote), G_FILE_TEST_IS_REGULAR))
+		return FALSE;
+
+	/* authenticated remotes use a different URI for the metadata */
+	if (fwupd_remote_get_username(remote) != NULL || fwupd_remote_get_password(remote) != NULL)
+		return FALSE;
+	return uri != NULL && fwupd_client_is_url_http(uri);
+}
+
+/* used by fwupd_client_refresh_remote_async() after the signature has been loaded */
+void
+fwupd_client_download_metadata_async(FwupdClient *self,
+				     FwupdRemote *remote,
+				     FwupdClientDownloadFlags download_flags,
+				     GCancellable *cancellable,
+				     GAsyncReadyCallback callback,
+				     gpointer callback_data)
+{
+	FwupdClientDownloadMetadataData *data;
+	g_autoptr(GTask) task = NULL;
+	g_autoptr(GTask) task_delta = NULL;
+	g_autoptr(GError) error = NULL;
+
+	g_return_if_fail(FWUPD_IS_CLIENT(self));
+	g_return_if_fail(FWUPD_IS_REMOTE(remote));
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+	task = g_task_new(self, cancellable, callback, callback_data);
+	g_task_set_source_tag(task, fwupd_client_download_metadata_async);
+	data = g_new0(FwupdClientDownloadMetadataData, 1);
+	data->remote = g_object_ref(remote);
+	data->download_flags = download_flags;
+	g_task_set_task_data(task, data, (GDestroyNotify)fwupd_client_download_metadata_data_free);
+
+	/* try a delta first, falling back to the full metadata on any failure */
+	if (!fwupd_client_download_metadata_delta_is_possible(remote, download_flags)) {
+		fwupd_client_download_metadata_full(task);
+		return;
+	}
+	data->helper = fwupd_client_curl_new(self, &error);
+	if (data->helper == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	fwupd_client_download_item_prune(self);
+	task_delta = g_task_new(self,
+				cancellable,
+				fwupd_client_download_metadata_delta_cb,
+				g_steal_pointer(&task));
+	g_task_set_task_data(task_delta, data, NULL);
+	g_task_run_in_thread(task_delta, fwupd_client_download_metadata_delta_thread_cb);
+}
+
+GBytes *
+fwupd_client_download_metadata_finish(FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail(FWUPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(g_task_is_valid(res, self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+	return g_task_propagate_pointer(G_TASK(res), error);
+}
+
+/* the maximum number of prefetch transfers that can be in progress at the same time */
+#define FWUPD_CLIENT_PREFETCH_TRANSFERS_MAX 4
+
+typedef struct {
+	gchar *checksum;
+	GPtrArray *urls; /* element-type utf8 */
+	guint url_idx;	 /* of @urls currently being tried */
+	guint retries;
+	gint64 retry_after;	 /* monotonic time, in µs */
+	FwupdCurlHelper *helper; /* nullable */
+	GFile *file_tmp;	 /* nullable */
+	GOutputStream *ostream;	 /* nullable */
+	GChecksum *csum;	 /* nullable */
+	GError *error_write;	 /* nullable */
+	GError *error;		 /* nullable, of the last failure */
+	gboolean active;	 /* added to the multi handle */
+} FwupdClientPrefetchItem;
+
+/* remove the partially downloaded file, if any */
+static void
+fwupd_client_prefetch_item_reset(FwupdClientPrefetchItem *item)
+{
+	if (item->ostream != NULL) {
+		(void)g_output_stream_close(item->ostream, NULL, NULL);
+		g_clear_object(&item->ostream);
+	}
+	if (item->file_tmp != NULL) {
+		(void)g_file_delete(item->file_tmp, NULL, NULL);
+		g_clear_object(&item->file_tmp);
+	}
+	g_clear_pointer(&item->csum, g_checksum_free);
+	g_clear_error(&item->error_write);
+}
+
+static void
+fwupd_client_prefetch_item_free(FwupdClientPrefetchItem *item)
+{
+	fwupd_client_prefetch_item_reset(item);
+	if (item->helper != NULL)
+		fwupd_client_curl_helper_free(item->helper);
+	if (item->error != NULL)
+		g_error_free(item->error);
+	g_free(item->checksum);
+	g_ptr_array_unref(item->urls);
+	g_free(item);
+}
+
+typedef struct {
+	GPtrArray *releases; /* element-type FwupdRelease */
+	FwupdClientDownloadFlags download_flags;
+	GPtrArray *items; /* element-type FwupdClientPrefetchItem */
+	gchar *cachedir;
+} FwupdClientPrefetchData;
+
+static void
+fwupd_client_prefetch_data_free(FwupdClientPrefetchData *data)
+{
+	g_ptr_array_unref(data->releases);
+	g_ptr_array_unref(data->items);
+	g_free(data->cachedir);
+	g_free(data);
+}
+
+static gboolean
+fwupd_client_download_cache_contains(FwupdClient *self, const gchar *checksum)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_autofree gchar *fn = NULL;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->download_cache_mutex);
+
+	fn = fwupd_client_download_cache_build_filename(self, checksum);
+	return fn != NULL && g_file_test(fn, G_FILE_TEST_EXISTS);
+}
+
+static const gchar *
+fwupd_client_prefetch_item_get_url(FwupdClientPrefetchItem *item)
+{
+	return g_ptr_array_index(item->urls, item->url_idx);
+}
+
+/* the payload is streamed to disk rather than being kept in memory */
+static size_t
+fwupd_client_prefetch_write_callback_cb(char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	FwupdClientPrefetchItem *item = (FwupdClientPrefetchItem *)userdata;
+	gsize realsize = size * nmemb;
+
+	if (item->error_write != NULL)
+		return 0;
+	if (!g_output_stream_write_all(item->ostream,
+				       ptr,
+				       realsize,
+				       NULL,
+				       NULL,
+				       &item->error_write))
+		return 0;
+	g_checksum_update(item->csum, (const guchar *)ptr, realsize);
+	return realsize;
+}
+
+static gboolean
+fwupd_client_prefetch_item_download_ipfs(FwupdClient *self,
+					 FwupdClientPrefetchItem *item,
+					 GCancellable *cancellable,
+					 GError **error)
+{
+	const gchar *url = fwupd_client_prefetch_item_get_url(item);
+	g_autofree gchar *checksum = NULL;
+	g_autoptr(GBytes) blob = NULL;
+
+	blob = fwupd_client_download_ipfs(self, url, cancellable, error);
+	if (blob == NULL)
+		return FALSE;
+	checksum = g_compute_checksum_for_bytes(fwupd_checksum_guess_kind(item->checksum), blob);
+	if (g_strcmp0(checksum, item->checksum) != 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_FILE,
+			    "checksum invalid, expected %s got %s",
+			    item->checksum,
+			    checksum);
+		return FALSE;
+	}
+	fwupd_client_download_cache_insert(self, item->checksum, blob);
+	return TRUE;
+}
+
+static gboolean
+fwupd_client_prefetch_item_start(FwupdClient *self,
+				 CURLM *multi,
+				 FwupdClientPrefetchItem *item,
+				 const gchar *cachedir,
+				 GError **error)
+{
+	const gchar *url = fwupd_client_prefetch_item_get_url(item);
+	g_autofree gchar *basename = NULL;
+	g_autoptr(GFileOutputStream) ostream = NULL;
+	g_autoptr(GFile) file_tmp = NULL;
+
+	/* test if we can reach this network */
+	if (!g_str_has_prefix(url, "file://")) {
+		if (!fwupd_client_test_network(url, error))
+			return FALSE;
+	}
+	if (item->helper == NULL) {
+		item->helper = fwupd_client_curl_new(self, error);
+		if (item->helper == NULL)
+			return FALSE;
+	}
+	if (!fwupd_client_curl_helper_set_proxy(self, item->helper, url, error))
+		return FALSE;
+
+	/* the cache may be shared, so use a unique name until the payload is verified */
+	basename = g_strdup_printf("%s.%08x.part", item->checksum, g_random_int());
+	file_tmp = g_file_new_build_filename(cachedir, basename, NULL);
+	ostream = g_file_create(file_tmp, G_FILE_CREATE_NONE, NULL, error);
+	if (ostream == NULL)
+		return FALSE;
+	item->file_tmp = g_steal_pointer(&file_tmp);
+	item->ostream = G_OUTPUT_STREAM(g_steal_pointer(&ostream));
+	item->csum = g_checksum_new(fwupd_checksum_guess_kind(item->checksum));
+
+	fwupd_client_curl_set_ssl_verify(item->helper->curl, url);
+	(void)curl_easy_setopt(item->helper->curl, CURLOPT_URL, url);
+	(void)curl_easy_setopt(item->helper->curl, CURLOPT_NOPROGRESS, 1L);
+	(void)curl_easy_setopt(item->helper->curl, CURLOPT_PRIVATE, item);
+	(void)curl_easy_setopt(item->helper->curl,
+			       CURLOPT_WRITEFUNCTION,
+			       fwupd_client_prefetch_write_callback_cb);
+	(void)curl_easy_setopt(item->helper->curl, CURLOPT_WRITEDATA, item);
+	if (curl_multi_add_handle(multi, item->helper->curl) != CURLM_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INTERNAL,
+			    "failed to add %s to the transfer",
+			    url);
+		return FALSE;
+	}
+	item->active = TRUE;
+	return TRUE;
+}
+
+static gboolean
+fwupd_client_prefetch_item_finish(FwupdClient *self,
+				  FwupdClientPrefetchItem *item,
+				  CURLcode res,
+				  GError **error)
+{
+	const gchar *checksum;
+	glong status_code = 0;
+
+	if (item->error_write != NULL) {
+		g_propagate_error(error, g_steal_pointer(&item->error_write));
+		return FALSE;
+	}
+	(void)curl_easy_getinfo(item->helper->curl, CURLINFO_RESPONSE_CODE, &status_code);
+	if (res == CURLE_SEND_ERROR || res == CURLE_RECV_ERROR || res == CURLE_HTTP2_STREAM ||
+	    res == CURLE_SSL_CONNECT_ERROR || status_code == 429) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_TIMED_OUT,
+			    "transient failure: %s [%u, %ld]",
+			    curl_easy_strerror(res),
+			    (guint)res,
+			    status_code);
+		return FALSE;
+	}
+	if (res != CURLE_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_FILE,
+			    "failed to download file: %s [%u]",
+			    curl_easy_strerror(res),
+			    (guint)res);
+		return FALSE;
+	}
+	if (status_code >= 400) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_FILE,
+			    "failed to download file, status %ld",
+			    status_code);
+		return FALSE;
+	}
+	if (!g_output_stream_close(item->ostream, NULL, error))
+		return FALSE;
+	g_clear_object(&item->ostream);
+
+	/* verify */
+	checksum = g_checksum_get_string(item->csum);
+	if (g_strcmp0(checksum, item->checksum) != 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_FILE,
+			    "checksum invalid, expected %s got %s",
+			    item->checksum,
+			    checksum);
+		return FALSE;
+	}
+	if (!fwupd_client_download_cache_commit(self, item->file_tmp, item->checksum, error))
+		return FALSE;
+	g_clear_object(&item->file_tmp);
+	g_clear_pointer(&item->csum, g_checksum_free);
+	return TRUE;
+}
+
+/* returns TRUE if the item should be tried again */
+static gboolean
+fwupd_client_prefetch_item_failed(FwupdClient *self, FwupdClientPrefetchItem *item, GError *error)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+
+	fwupd_client_prefetch_item_reset(item);
+	if (!fwupd_client_download_error_is_fatal(error) &&
+	    item->retries < priv->download_retries) {
+		g_debug("ignoring and trying again: %s", error->message);
+		item->retry_after = g_get_monotonic_time() + ((gint64)2500 << item->retries) * 1000;
+		item->retries++;
+	} else {
+		g_info("failed to download %s: %s",
+		       fwupd_client_prefetch_item_get_url(item),
+		       error->message);
+		item->url_idx++;
+		item->retries = 0;
+		item->retry_after = 0;
+	}
+	if (item->error != NULL)
+		g_error_free(item->error);
+	item->error = error;
+	return item->url_idx < item->urls->len;
+}
+
+static gboolean
+fwupd_client_prefetch_releases_transfer(FwupdClient *self,
+					CURLM *multi,
+					FwupdClientPrefetchData *data,
+					GCancellable *cancellable,
+					GError **error)
+{
+	guint active = 0;
+	guint done = 0;
+	g_autoptr(GPtrArray) pending = g_ptr_array_new();
+
+	for (guint i = 0; i < data->items->len; i++)
+		g_ptr_array_add(pending, g_ptr_array_index(data->items, i));
+	while (pending->len > 0 || active > 0) {
+		CURLMsg *msg = NULL;
+		gint msgs_left = 0;
+		gint running = 0;
+		gint64 now = g_get_monotonic_time();
+
+		if (g_cancellable_set_error_if_cancelled(cancellable, error))
+			return FALSE;
+
+		/* start more transfers, falling back to the next URL of each item */
+		for (guint i = 0; i < pending->len && active < FWUPD_CLIENT_PREFETCH_TRANSFERS_MAX;
+		     i++) {
+			FwupdClientPrefetchItem *item = g_ptr_array_index(pending, i);
+			const gchar *url = fwupd_client_prefetch_item_get_url(item);
+			gboolean ret = FALSE;
+			g_autoptr(GError) error_local = NULL;
+
+			if (item->retry_after > now)
+				continue;
+			g_ptr_array_remove_index(pending, i--);
+			g_info("downloading %s", url);
+			if (fwupd_client_is_url_http(url)) {
+				if (fwupd_client_prefetch_item_start(self,
+								     multi,
+								     item,
+								     data->cachedir,
+								     &error_local)) {
+					active++;
+					continue;
+				}
+			} else if (fwupd_client_is_url_ipfs(url)) {
+				ret = fwupd_client_prefetch_item_download_ipfs(self,
+									       item,
+									       cancellable,
+									       &error_local);
+			} else {
+				g_set_error(&error_local,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_FILE,
+					    "not sure how to handle: %s",
+					    url);
+			}
+			if (!ret &&
+			    fwupd_client_prefetch_item_failed(self,
+							      item,
+							      g_steal_pointer(&error_local))) {
+				g_ptr_array_add(pending, item);
+				continue;
+			}
+			done++;
+		}
+
+		/* process the transfers that are in progress */
+		if (curl_multi_perform(multi, &running) != CURLM_OK) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INTERNAL,
+					    "failed to perform transfer");
+			return FALSE;
+		}
+		while ((msg = curl_multi_info_read(multi, &msgs_left)) != NULL) {
+			CURL *curl = msg->easy_handle;
+			CURLcode res = msg->data.result;
+			FwupdClientPrefetchItem *item = NULL;
+			g_autoptr(GError) error_local = NULL;
+
+			if (msg->msg != CURLMSG_DONE)
+				continue;
+			(void)curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char **)&item);
+			(void)curl_multi_remove_handle(multi, curl);
+			item->active = FALSE;
+			active--;
+			if (!fwupd_client_prefetch_item_finish(self, item, res, &error_local) &&
+			    fwupd_client_prefetch_item_failed(self,
+							      item,
+							      g_steal_pointer(&error_local))) {
+				g_ptr_array_add(pending, item);
+				continue;
+			}
+			done++;
+		}
+		fwupd_client_set_percentage(self, (100.0 * done) / data->items->len);
+
+		/* wait for network activity, or for the next retry */
+		if (active > 0)
+			(void)curl_multi_wait(multi, NULL, 0, 1000, NULL);
+		else if (pending->len > 0)
+			g_usleep(G_USEC_PER_SEC / 10);
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static void
+fwupd_client_prefetch_releases_thread_cb(GTask *task,
+					 gpointer source_object,
+					 gpointer task_data,
+					 GCancellable *cancellable)
+{
+	FwupdClient *self = FWUPD_CLIENT(source_object);
+	FwupdClientPrefetchData *data = g_task_get_task_data(task);
+	gboolean ret;
+	g_autoptr(CURLM) multi = curl_multi_init();
+	g_autoptr(GError) error = NULL;
+
+	if (g_mkdir_with_parents(data->cachedir, 0755) != 0) {
+		g_task_return_new_error(task,
+					FWUPD_ERROR,
+					FWUPD_ERROR_PERMISSION_DENIED,
+					"failed to create %s",
+					data->cachedir);
+		return;
+	}
+
+	/* download all the payloads at the same time */
+	fwupd_client_set_status(self, FWUPD_STATUS_DOWNLOADING);
+	ret = fwupd_client_prefetch_releases_transfer(self, multi, data, cancellable, &error);
+	for (guint i = 0; i < data->items->len; i++) {
+		FwupdClientPrefetchItem *item = g_ptr_array_index(data->items, i);
+		if (item->active) {
+			(void)curl_multi_remove_handle(multi, item->helper->curl);
+			item->active = FALSE;
+		}
+		fwupd_client_prefetch_item_reset(item);
+	}
+	fwupd_client_set_percentage(self, 100.f);
+	if (!ret) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+
+	/* return the error of the first release that could not be downloaded */
+	for (guint i = 0; i < data->items->len; i++) {
+		FwupdClientPrefetchItem *item = g_ptr_array_index(data->items, i);
+		if (item->url_idx >= item->urls->len) {
+			g_task_return_error(task, g_error_copy(item->error));
+			return;
+		}
+	}
+	g_task_return_boolean(task, TRUE);
+}
+
+static void
+fwupd_client_prefetch_releases_start(GTask *task, GPtrArray *remotes)
+{
+	FwupdClient *self = g_task_get_source_object(task);
+	FwupdClientPrefetchData *data = g_task_get_task_data(task);
+
+	for (guint i = 0; i < data->releases->len; i++) {
+		FwupdRelease *release = g_ptr_array_index(data->releases, i);
+		FwupdRemote *remote = NULL;
+		FwupdClientPrefetchItem *item;
+		GPtrArray *checksums = fwupd_release_get_checksums(release);
+		const gchar *checksum = fwupd_checksum_get_best(checksums);
+		const gchar *remote_id = fwupd_release_get_remote_id(release);
+		g_autoptr(GError) error = NULL;
+		g_autoptr(GPtrArray) urls = NULL;
+		gboolean is_duplicate = FALSE;
+
+		/* already downloaded, or the same payload used for another device */
+		if (checksum == NULL) {
+			g_debug("no checksum for %s, skipping", fwupd_release_get_version(release));
+			continue;
+		}
+		if (fwupd_client_download_cache_contains(self, checksum))
+			continue;
+		for (guint j = 0; j < data->items->len; j++) {
+			FwupdClientPrefetchItem *item_tmp = g_ptr_array_index(data->items, j);
+			if (g_strcmp0(item_tmp->checksum, checksum) == 0) {
+				is_duplicate = TRUE;
+				break;
+			}
+		}
+		if (is_duplicate)
+			continue;
+
+		/* local and directory remotes already have the firmware */
+		if (remote_id != NULL && remotes != NULL) {
+			for (guint j = 0; j < remotes->len; j++) {
+				FwupdRemote *remote_tmp = g_ptr_array_index(remotes, j);
+				if (g_strcmp0(fwupd_remote_get_id(remote_tmp), remote_id) == 0) {
+					remote = remote_tmp;
+					break;
+				}
+			}
+			if (remote == NULL) {
+				g_task_return_new_error(task,
+							FWUPD_ERROR,
+							FWUPD_ERROR_NOT_FOUND,
+							"no remote %s",
+							remote_id);
+				return;
+			}
+			if (fwupd_remote_get_kind(remote) != FWUPD_REMOTE_KIND_DOWNLOAD)
+				continue;
+		}
+		if (remote != NULL) {
+			g_autoptr(GPtrArray) uris_built = NULL;
+			uris_built = fwupd_client_release_build_uris(release, remote, &error);
+			if (uris_built == NULL) {
+				g_task_return_error(task, g_steal_pointer(&error));
+				return;
+			}
+			urls = fwupd_client_filter_locations(uris_built,
+							     data->download_flags,
+							     &error);
+		} else {
+			urls = fwupd_client_filter_locations(fwupd_release_get_locations(release),
+							     data->download_flags,
+							     &error);
+		}
+		if (urls == NULL) {
+			g_task_return_error(task, g_steal_pointer(&error));
+			return;
+		}
+		item = g_new0(FwupdClientPrefetchItem, 1);
+		item->checksum = g_strdup(checksum);
+		item->urls = g_steal_pointer(&urls);
+		g_ptr_array_add(data->items, item);
+	}
+
+	/* nothing to do */
+	if (data->items->len == 0) {
+		g_task_return_boolean(task, TRUE);
+		return;
+	}
+	g_task_run_in_thread(task, fwupd_client_prefetch_releases_thread_cb);
+}
+
+static void
+fwupd_client_prefetch_releases_remotes_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK(user_data);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) remotes = NULL;
+
+	remotes = fwupd_client_get_remotes_finish(FWUPD_CLIENT(source), res, &error);
+	if (remotes == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	fwupd_client_prefetch_releases_start(task, remotes);
+}
+
+/**
+ * fwupd_client_prefetch_releases_async:
+ * @self: a #FwupdClient
+ * @releases: (element-type FwupdRelease): releases
+ * @download_flags: download flags, e.g. %FWUPD_CLIENT_DOWNLOAD_FLAG_ONLY_P2P
+ * @cancellable: (nullable): optional #GCancellable
+ * @callback: (scope async) (closure callback_data): the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Downloads the firmware for several releases at the same time, and saves each verified
+ * payload into the directory set with [method@Client.set_download_cache_dir].
+ *
+ * Releases that are already cached, or that are provided by local remotes, are skipped.
+ * Each location of a release is tried in turn, and no more than four transfers are in
+ * progress at the same time.
+ *
+ * NOTE: This method is thread-safe, but progress signals will be
+ * emitted in the global default main context, if not explicitly set with
+ * [method@Client.set_main_context].
+ *
+ * Since: 2.2.1
+ **/
+void
+fwupd_client_prefetch_releases_async(FwupdClient *self,
+				     GPtrArray *releases,
+				     FwupdClientDownloadFlags download_flags,
+				     GCancellable *cancellable,
+				     GAsyncReadyCallback callback,
+				     gpointer callback_data)
+{
+	FwupdClientPrefetchData *data;
+	gboolean needs_remotes = FALSE;
+	g_autoptr(GTask) task = NULL;
+
+	g_return_if_fail(FWUPD_IS_CLIENT(self));
+	g_return_if_fail(releases != NULL);
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+	task = g_task_new(self, cancellable, callback, callback_data);
+	g_task_set_source_tag(task, fwupd_client_prefetch_releases_async);
+	data = g_new0(FwupdClientPrefetchData, 1);
+	data->releases = g_ptr_array_ref(releases);
+	data->download_flags = download_flags;
+	data->items =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fwupd_client_prefetch_item_free);
+	g_task_set_task_data(task, data, (GDestroyNotify)fwupd_client_prefetch_data_free);
+
+	/* sanity check */
+	data->cachedir = fwupd_client_get_download_cache_dir(self);
+	if (data->cachedir == NULL) {
+		g_task_return_new_error_literal(task,
+						FWUPD_ERROR,
+						FWUPD_ERROR_NOT_SUPPORTED,
+						"no download cache directory set");
+		return;
+	}
+
+	/* only ask the daemon for the remotes if required */
+	for (guint i = 0; i < releases->len; i++) {
+		FwupdRelease *release = g_ptr_array_index(releases, i);
+		if (fwupd_release_get_remote_id(release) != NULL) {
+			needs_remotes = TRUE;
+			break;
+		}
+	}
+	if (needs_remotes) {
+		fwupd_client_get_remotes_async(self,
+					       cancellable,
+					       fwupd_client_prefetch_releases_remotes_cb,
+					       g_steal_pointer(&task));
+		return;
+	}
+	fwupd_client_prefetch_releases_start(task, NULL);
+}
+
+/**
+ * fwupd_client_prefetch_releases_finish:
+ * @self: a #FwupdClient
+ * @res: (not nullable): the asynchronous result
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets the result of [method@FwupdClient.prefetch_releases_async].
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.2.1
+ **/
+gboolean
+fwupd_client_prefetch_releases_finish(FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail(FWUPD_IS_CLIENT(self), FALSE);
+	g_return_val_if_fail(g_task_is_valid(res, self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+	return g_task_propagate_boolean(G_TASK(res), error);
+}
+
 static void
 fwupd_client_upload_bytes_thread_cb(GTask *task,
 				    gpointer source_object,
@@ -8602,6 +10401,10 @@ fwupd_client_init(FwupdClient *self)
 	priv->immediate_requests =
 	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_object_unref);
 	g_mutex_init(&priv->immediate_requests_mutex);
+	g_mutex_init(&priv->device_cache_mutex);
+	priv->device_cache = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	g_mutex_init(&priv->download_cache_mutex);
+	priv->download_cache_max_size = FWUPD_CLIENT_DOWNLOAD_CACHE_MAX_SIZE_DEFAULT;
 	priv->hwids = g_ptr_array_new_with_free_func((GDestroyNotify)fwupd_client_hwid_free);
 	priv->connect_items =
 	    g_ptr_array_new_with_free_func((GDestroyNotify)fwupd_client_connect_item_free);
@@ -8633,6 +10436,10 @@ fwupd_client_finalize(GObject *object)
 	g_mutex_clear(&priv->idle_mutex);
 	g_mutex_clear(&priv->download_items_mutex);
 	g_mutex_clear(&priv->immediate_requests_mutex);
+	g_mutex_clear(&priv->device_cache_mutex);
+	g_ptr_array_unref(priv->device_cache);
+	g_mutex_clear(&priv->download_cache_mutex);
+	g_free(priv->download_cache_dir);
 	if (priv->idle_id != 0)
 		g_source_remove(priv->idle_id);
 	g_ptr_array_unref(priv->idle_sources);
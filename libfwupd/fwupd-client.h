@@ -334,6 +334,18 @@ fwupd_client_install_release_finish(FwupdClient *self,
 				    GAsyncResult *res,
 				    GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
 void
+fwupd_client_prefetch_releases_async(FwupdClient *self,
+				     GPtrArray *releases,
+				     FwupdClientDownloadFlags download_flags,
+				     GCancellable *cancellable,
+				     GAsyncReadyCallback callback,
+				     gpointer callback_data) G_GNUC_NON_NULL(1, 2);
+gboolean
+fwupd_client_prefetch_releases_finish(FwupdClient *self,
+				      GAsyncResult *res,
+				      GError **error) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_NON_NULL(1, 2);
+void
 fwupd_client_update_metadata_bytes_async(FwupdClient *self,
 					 const gchar *remote_id,
 					 GBytes *metadata,
@@ -586,6 +598,11 @@ const gchar *
 fwupd_client_get_user_agent(FwupdClient *self) G_GNUC_NON_NULL(1);
 void
 fwupd_client_set_user_agent(FwupdClient *self, const gchar *user_agent) G_GNUC_NON_NULL(1);
+gboolean
+fwupd_client_get_device_cache_enabled(FwupdClient *self) G_GNUC_NON_NULL(1);
+void
+fwupd_client_set_device_cache_enabled(FwupdClient *self, gboolean device_cache_enabled)
+    G_GNUC_NON_NULL(1);
 void
 fwupd_client_set_user_agent_for_package(FwupdClient *self,
 					const gchar *package_name,
@@ -616,6 +633,14 @@ fwupd_client_download_bytes2_finish(FwupdClient *self,
 void
 fwupd_client_download_set_retries(FwupdClient *self, guint retries) G_GNUC_NON_NULL(1);
 void
+fwupd_client_set_download_cache_dir(FwupdClient *self, const gchar *download_cache_dir)
+    G_GNUC_NON_NULL(1);
+gchar *
+fwupd_client_get_download_cache_dir(FwupdClient *self) G_GNUC_NON_NULL(1);
+void
+fwupd_client_set_download_cache_max_size(FwupdClient *self, guint64 download_cache_max_size)
+    G_GNUC_NON_NULL(1);
+void
 fwupd_client_upload_bytes_async(FwupdClient *self,
 				const gchar *url,
 				const gchar *payload,
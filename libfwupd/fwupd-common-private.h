@@ -29,4 +29,11 @@ fwupd_unix_output_stream_from_fn(const gchar *fn, GError **error) G_GNUC_WARN_UN
     G_GNUC_NON_NULL(1);
 #endif
 
+gchar *
+fwupd_ref_string_new(const gchar *str) G_GNUC_WARN_UNUSED_RESULT;
+gboolean
+fwupd_ref_string_set(gchar **dst, const gchar *src) G_GNUC_NON_NULL(1);
+void
+fwupd_ref_string_clear(gchar **dst) G_GNUC_NON_NULL(1);
+
 G_END_DECLS
@@ -595,3 +595,59 @@ fwupd_percentage_delta_notify(gdouble value_old, gdouble value_new)
 		return TRUE;
 	return FALSE;
 }
+
+/**
+ * fwupd_ref_string_new: (skip):
+ * @str: (nullable): a string
+ *
+ * Creates an interned #GRefString, sharing the storage with every other user of the same value.
+ * This is useful for the vendor, protocol and version strings that are repeated across thousands
+ * of devices and releases.
+ *
+ * Returns: (transfer full) (nullable): a #GRefString, free with g_ref_string_release()
+ **/
+gchar *
+fwupd_ref_string_new(const gchar *str)
+{
+	if (str == NULL)
+		return NULL;
+	return g_ref_string_new_intern(str);
+}
+
+/**
+ * fwupd_ref_string_set: (skip):
+ * @dst: (inout): an interned #GRefString, or %NULL
+ * @src: (nullable): a string
+ *
+ * Replaces an interned string with a new value.
+ *
+ * Returns: %TRUE if the value was changed
+ **/
+gboolean
+fwupd_ref_string_set(gchar **dst, const gchar *src)
+{
+	gchar *tmp;
+
+	if (g_strcmp0(*dst, src) == 0)
+		return FALSE;
+
+	/* @src may point into the old value */
+	tmp = fwupd_ref_string_new(src);
+	fwupd_ref_string_clear(dst);
+	*dst = tmp;
+	return TRUE;
+}
+
+/**
+ * fwupd_ref_string_clear: (skip):
+ * @dst: (inout): an interned #GRefString, or %NULL
+ *
+ * Releases an interned string and sets the pointer to %NULL.
+ **/
+void
+fwupd_ref_string_clear(gchar **dst)
+{
+	if (*dst == NULL)
+		return;
+	g_ref_string_release(g_steal_pointer(dst));
+}
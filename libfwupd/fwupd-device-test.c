@@ -224,11 +224,40 @@ fwupd_device_func(void)
 	g_assert_false(fwupd_device_has_flag(dev2, FWUPD_DEVICE_FLAG_LOCKED));
 }
 
+static void
+fwupd_device_intern_func(void)
+{
+	g_autoptr(FwupdDevice) dev1 = fwupd_device_new();
+	g_autoptr(FwupdDevice) dev2 = fwupd_device_new();
+	g_autofree gchar *vendor = g_strdup("ACME");
+
+	/* the same value shares the same storage */
+	fwupd_device_set_vendor(dev1, vendor);
+	fwupd_device_set_vendor(dev2, "ACME");
+	g_assert_true(fwupd_device_get_vendor(dev1) == fwupd_device_get_vendor(dev2));
+	fwupd_device_add_protocol(dev1, "com.acme.dfu");
+	fwupd_device_add_protocol(dev2, "com.acme.dfu");
+	g_assert_true(g_ptr_array_index(fwupd_device_get_protocols(dev1), 0) ==
+		      g_ptr_array_index(fwupd_device_get_protocols(dev2), 0));
+
+	/* setting the existing value is safe */
+	fwupd_device_set_vendor(dev1, fwupd_device_get_vendor(dev1));
+	g_assert_cmpstr(fwupd_device_get_vendor(dev1), ==, "ACME");
+
+	/* changing one device does not affect the other */
+	fwupd_device_set_vendor(dev1, "Globex");
+	g_assert_cmpstr(fwupd_device_get_vendor(dev1), ==, "Globex");
+	g_assert_cmpstr(fwupd_device_get_vendor(dev2), ==, "ACME");
+	fwupd_device_set_vendor(dev2, NULL);
+	g_assert_null(fwupd_device_get_vendor(dev2));
+}
+
 int
 main(int argc, char **argv)
 {
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/device", fwupd_device_func);
 	g_test_add_func("/fwupd/device/filter", fwupd_device_filter_func);
+	g_test_add_func("/fwupd/device/intern", fwupd_device_intern_func);
 	return g_test_run();
 }
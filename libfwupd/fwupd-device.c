@@ -191,7 +191,7 @@ fwupd_device_ensure_issues(FwupdDevice *self)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	if (priv->issues == NULL)
-		priv->issues = g_ptr_array_new_with_free_func(g_free);
+		priv->issues = g_ptr_array_new_with_free_func((GDestroyNotify)g_ref_string_release);
 }
 
 /**
@@ -235,7 +235,7 @@ fwupd_device_add_issue(FwupdDevice *self, const gchar *issue)
 		if (g_strcmp0(issue_tmp, issue) == 0)
 			return;
 	}
-	g_ptr_array_add(priv->issues, g_strdup(issue));
+	g_ptr_array_add(priv->issues, fwupd_ref_string_new(issue));
 }
 
 static void
@@ -384,8 +384,7 @@ fwupd_device_set_branch(FwupdDevice *self, const gchar *branch)
 	if (g_strcmp0(priv->branch, branch) == 0)
 		return;
 
-	g_free(priv->branch);
-	priv->branch = g_strdup(branch);
+	fwupd_ref_string_set(&priv->branch, branch);
 }
 
 /**
@@ -782,7 +781,7 @@ fwupd_device_ensure_guids(FwupdDevice *self)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	if (priv->guids == NULL)
-		priv->guids = g_ptr_array_new_with_free_func(g_free);
+		priv->guids = g_ptr_array_new_with_free_func((GDestroyNotify)g_ref_string_release);
 }
 
 /**
@@ -851,7 +850,7 @@ fwupd_device_add_guid(FwupdDevice *self, const gchar *guid)
 	if (fwupd_device_has_guid(self, guid))
 		return;
 	fwupd_device_ensure_guids(self);
-	g_ptr_array_add(priv->guids, g_strdup(guid));
+	g_ptr_array_add(priv->guids, fwupd_ref_string_new(guid));
 }
 
 /**
@@ -956,7 +955,7 @@ fwupd_device_ensure_icons(FwupdDevice *self)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	if (priv->icons == NULL)
-		priv->icons = g_ptr_array_new_with_free_func(g_free);
+		priv->icons = g_ptr_array_new_with_free_func((GDestroyNotify)g_ref_string_release);
 }
 
 /**
@@ -1024,7 +1023,7 @@ fwupd_device_add_icon(FwupdDevice *self, const gchar *icon)
 	if (fwupd_device_has_icon(self, icon))
 		return;
 	fwupd_device_ensure_icons(self);
-	g_ptr_array_add(priv->icons, g_strdup(icon));
+	g_ptr_array_add(priv->icons, fwupd_ref_string_new(icon));
 }
 
 /**
@@ -1105,8 +1104,7 @@ fwupd_device_set_vendor(FwupdDevice *self, const gchar *vendor)
 	if (g_strcmp0(priv->vendor, vendor) == 0)
 		return;
 
-	g_free(priv->vendor);
-	priv->vendor = g_strdup(vendor);
+	fwupd_ref_string_set(&priv->vendor, vendor);
 	g_object_notify(G_OBJECT(self), "vendor");
 }
 
@@ -1115,7 +1113,8 @@ fwupd_device_ensure_vendor_ids(FwupdDevice *self)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	if (priv->vendor_ids == NULL)
-		priv->vendor_ids = g_ptr_array_new_with_free_func(g_free);
+		priv->vendor_ids =
+		    g_ptr_array_new_with_free_func((GDestroyNotify)g_ref_string_release);
 }
 
 /**
@@ -1186,7 +1185,7 @@ fwupd_device_add_vendor_id(FwupdDevice *self, const gchar *vendor_id)
 	if (fwupd_device_has_vendor_id(self, vendor_id))
 		return;
 	fwupd_device_ensure_vendor_ids(self);
-	g_ptr_array_add(priv->vendor_ids, g_strdup(vendor_id));
+	g_ptr_array_add(priv->vendor_ids, fwupd_ref_string_new(vendor_id));
 }
 
 /**
@@ -1226,8 +1225,7 @@ fwupd_device_set_version(FwupdDevice *self, const gchar *version)
 	if (g_strcmp0(priv->version, version) == 0)
 		return;
 
-	g_free(priv->version);
-	priv->version = g_strdup(version);
+	fwupd_ref_string_set(&priv->version, version);
 	g_object_notify(G_OBJECT(self), "version");
 }
 
@@ -1268,8 +1266,7 @@ fwupd_device_set_version_lowest(FwupdDevice *self, const gchar *version_lowest)
 	if (g_strcmp0(priv->version_lowest, version_lowest) == 0)
 		return;
 
-	g_free(priv->version_lowest);
-	priv->version_lowest = g_strdup(version_lowest);
+	fwupd_ref_string_set(&priv->version_lowest, version_lowest);
 }
 
 /**
@@ -1344,8 +1341,7 @@ fwupd_device_set_version_highest(FwupdDevice *self, const gchar *version_highest
 	if (g_strcmp0(priv->version_highest, version_highest) == 0)
 		return;
 
-	g_free(priv->version_highest);
-	priv->version_highest = g_strdup(version_highest);
+	fwupd_ref_string_set(&priv->version_highest, version_highest);
 }
 
 /**
@@ -1420,8 +1416,7 @@ fwupd_device_set_version_bootloader(FwupdDevice *self, const gchar *version_boot
 	if (g_strcmp0(priv->version_bootloader, version_bootloader) == 0)
 		return;
 
-	g_free(priv->version_bootloader);
-	priv->version_bootloader = g_strdup(version_bootloader);
+	fwupd_ref_string_set(&priv->version_bootloader, version_bootloader);
 }
 
 /**
@@ -1664,8 +1659,7 @@ fwupd_device_set_plugin(FwupdDevice *self, const gchar *plugin)
 	if (g_strcmp0(priv->plugin, plugin) == 0)
 		return;
 
-	g_free(priv->plugin);
-	priv->plugin = g_strdup(plugin);
+	fwupd_ref_string_set(&priv->plugin, plugin);
 }
 
 static void
@@ -1673,7 +1667,8 @@ fwupd_device_ensure_protocols(FwupdDevice *self)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE(self);
 	if (priv->protocols == NULL)
-		priv->protocols = g_ptr_array_new_with_free_func(g_free);
+		priv->protocols =
+		    g_ptr_array_new_with_free_func((GDestroyNotify)g_ref_string_release);
 }
 
 /**
@@ -1744,7 +1739,7 @@ fwupd_device_add_protocol(FwupdDevice *self, const gchar *protocol)
 	if (fwupd_device_has_protocol(self, protocol))
 		return;
 	fwupd_device_ensure_protocols(self);
-	g_ptr_array_add(priv->protocols, g_strdup(protocol));
+	g_ptr_array_add(priv->protocols, fwupd_ref_string_new(protocol));
 }
 
 /**
@@ -4182,14 +4177,14 @@ fwupd_device_finalize(GObject *object)
 	g_free(priv->serial);
 	g_free(priv->summary);
 	g_free(priv->details_url);
-	g_free(priv->branch);
-	g_free(priv->vendor);
-	g_free(priv->plugin);
+	fwupd_ref_string_clear(&priv->branch);
+	fwupd_ref_string_clear(&priv->vendor);
+	fwupd_ref_string_clear(&priv->plugin);
 	g_free(priv->update_error);
-	g_free(priv->version);
-	g_free(priv->version_lowest);
-	g_free(priv->version_highest);
-	g_free(priv->version_bootloader);
+	fwupd_ref_string_clear(&priv->version);
+	fwupd_ref_string_clear(&priv->version_lowest);
+	fwupd_ref_string_clear(&priv->version_highest);
+	fwupd_ref_string_clear(&priv->version_bootloader);
 	if (priv->guids != NULL)
 		g_ptr_array_unref(priv->guids);
 	if (priv->vendor_ids != NULL)
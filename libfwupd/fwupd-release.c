@@ -119,8 +119,7 @@ fwupd_release_set_remote_id(FwupdRelease *self, const gchar *remote_id)
 	if (g_strcmp0(priv->remote_id, remote_id) == 0)
 		return;
 
-	g_free(priv->remote_id);
-	priv->remote_id = g_strdup(remote_id);
+	fwupd_ref_string_set(&priv->remote_id, remote_id);
 	g_object_notify(G_OBJECT(self), "remote-id");
 }
 
@@ -161,8 +160,7 @@ fwupd_release_set_version(FwupdRelease *self, const gchar *version)
 	if (g_strcmp0(priv->version, version) == 0)
 		return;
 
-	g_free(priv->version);
-	priv->version = g_strdup(version);
+	fwupd_ref_string_set(&priv->version, version);
 }
 
 /**
@@ -325,8 +323,7 @@ fwupd_release_set_protocol(FwupdRelease *self, const gchar *protocol)
 	if (g_strcmp0(priv->protocol, protocol) == 0)
 		return;
 
-	g_free(priv->protocol);
-	priv->protocol = g_strdup(protocol);
+	fwupd_ref_string_set(&priv->protocol, protocol);
 }
 
 static void
@@ -334,7 +331,7 @@ fwupd_release_ensure_issues(FwupdRelease *self)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE(self);
 	if (priv->issues == NULL)
-		priv->issues = g_ptr_array_new_with_free_func(g_free);
+		priv->issues = g_ptr_array_new_with_free_func((GDestroyNotify)g_ref_string_release);
 }
 
 /**
@@ -377,7 +374,7 @@ fwupd_release_add_issue(FwupdRelease *self, const gchar *issue)
 		if (g_strcmp0(issue_tmp, issue) == 0)
 			return;
 	}
-	g_ptr_array_add(priv->issues, g_strdup(issue));
+	g_ptr_array_add(priv->issues, fwupd_ref_string_new(issue));
 }
 
 static void
@@ -385,7 +382,8 @@ fwupd_release_ensure_categories(FwupdRelease *self)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE(self);
 	if (priv->categories == NULL)
-		priv->categories = g_ptr_array_new_with_free_func(g_free);
+		priv->categories =
+		    g_ptr_array_new_with_free_func((GDestroyNotify)g_ref_string_release);
 }
 
 /**
@@ -425,7 +423,7 @@ fwupd_release_add_category(FwupdRelease *self, const gchar *category)
 	if (fwupd_release_has_category(self, category))
 		return;
 	fwupd_release_ensure_categories(self);
-	g_ptr_array_add(priv->categories, g_strdup(category));
+	g_ptr_array_add(priv->categories, fwupd_ref_string_new(category));
 }
 
 /**
@@ -535,7 +533,7 @@ fwupd_release_ensure_tags(FwupdRelease *self)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE(self);
 	if (priv->tags == NULL)
-		priv->tags = g_ptr_array_new_with_free_func(g_free);
+		priv->tags = g_ptr_array_new_with_free_func((GDestroyNotify)g_ref_string_release);
 }
 
 /**
@@ -575,7 +573,7 @@ fwupd_release_add_tag(FwupdRelease *self, const gchar *tag)
 	if (fwupd_release_has_tag(self, tag))
 		return;
 	fwupd_release_ensure_tags(self);
-	g_ptr_array_add(priv->tags, g_strdup(tag));
+	g_ptr_array_add(priv->tags, fwupd_ref_string_new(tag));
 }
 
 /**
@@ -794,8 +792,7 @@ fwupd_release_set_homepage(FwupdRelease *self, const gchar *homepage)
 	if (g_strcmp0(priv->homepage, homepage) == 0)
 		return;
 
-	g_free(priv->homepage);
-	priv->homepage = g_strdup(homepage);
+	fwupd_ref_string_set(&priv->homepage, homepage);
 }
 
 /**
@@ -835,8 +832,7 @@ fwupd_release_set_details_url(FwupdRelease *self, const gchar *details_url)
 	if (g_strcmp0(priv->details_url, details_url) == 0)
 		return;
 
-	g_free(priv->details_url);
-	priv->details_url = g_strdup(details_url);
+	fwupd_ref_string_set(&priv->details_url, details_url);
 }
 
 /**
@@ -876,8 +872,7 @@ fwupd_release_set_source_url(FwupdRelease *self, const gchar *source_url)
 	if (g_strcmp0(priv->source_url, source_url) == 0)
 		return;
 
-	g_free(priv->source_url);
-	priv->source_url = g_strdup(source_url);
+	fwupd_ref_string_set(&priv->source_url, source_url);
 }
 
 /**
@@ -999,8 +994,7 @@ fwupd_release_set_appstream_id(FwupdRelease *self, const gchar *appstream_id)
 	if (g_strcmp0(priv->appstream_id, appstream_id) == 0)
 		return;
 
-	g_free(priv->appstream_id);
-	priv->appstream_id = g_strdup(appstream_id);
+	fwupd_ref_string_set(&priv->appstream_id, appstream_id);
 }
 
 /**
@@ -1081,8 +1075,7 @@ fwupd_release_set_detach_caption(FwupdRelease *self, const gchar *detach_caption
 	if (g_strcmp0(priv->detach_caption, detach_caption) == 0)
 		return;
 
-	g_free(priv->detach_caption);
-	priv->detach_caption = g_strdup(detach_caption);
+	fwupd_ref_string_set(&priv->detach_caption, detach_caption);
 }
 
 /**
@@ -1122,8 +1115,7 @@ fwupd_release_set_detach_image(FwupdRelease *self, const gchar *detach_image)
 	if (g_strcmp0(priv->detach_image, detach_image) == 0)
 		return;
 
-	g_free(priv->detach_image);
-	priv->detach_image = g_strdup(detach_image);
+	fwupd_ref_string_set(&priv->detach_image, detach_image);
 }
 
 /**
@@ -1233,8 +1225,7 @@ fwupd_release_set_summary(FwupdRelease *self, const gchar *summary)
 	if (g_strcmp0(priv->summary, summary) == 0)
 		return;
 
-	g_free(priv->summary);
-	priv->summary = g_strdup(summary);
+	fwupd_ref_string_set(&priv->summary, summary);
 }
 
 /**
@@ -1274,8 +1265,7 @@ fwupd_release_set_branch(FwupdRelease *self, const gchar *branch)
 	if (g_strcmp0(priv->branch, branch) == 0)
 		return;
 
-	g_free(priv->branch);
-	priv->branch = g_strdup(branch);
+	fwupd_ref_string_set(&priv->branch, branch);
 }
 
 /**
@@ -1315,8 +1305,7 @@ fwupd_release_set_vendor(FwupdRelease *self, const gchar *vendor)
 	if (g_strcmp0(priv->vendor, vendor) == 0)
 		return;
 
-	g_free(priv->vendor);
-	priv->vendor = g_strdup(vendor);
+	fwupd_ref_string_set(&priv->vendor, vendor);
 }
 
 /**
@@ -1356,8 +1345,7 @@ fwupd_release_set_license(FwupdRelease *self, const gchar *license)
 	if (g_strcmp0(priv->license, license) == 0)
 		return;
 
-	g_free(priv->license);
-	priv->license = g_strdup(license);
+	fwupd_ref_string_set(&priv->license, license);
 }
 
 /**
@@ -1397,8 +1385,7 @@ fwupd_release_set_name(FwupdRelease *self, const gchar *name)
 	if (g_strcmp0(priv->name, name) == 0)
 		return;
 
-	g_free(priv->name);
-	priv->name = g_strdup(name);
+	fwupd_ref_string_set(&priv->name, name);
 }
 
 /**
@@ -1438,8 +1425,7 @@ fwupd_release_set_name_variant_suffix(FwupdRelease *self, const gchar *name_vari
 	if (g_strcmp0(priv->name_variant_suffix, name_variant_suffix) == 0)
 		return;
 
-	g_free(priv->name_variant_suffix);
-	priv->name_variant_suffix = g_strdup(name_variant_suffix);
+	fwupd_ref_string_set(&priv->name_variant_suffix, name_variant_suffix);
 }
 
 /**
@@ -2385,25 +2371,25 @@ fwupd_release_finalize(GObject *object)
 
 	g_free(priv->description);
 	g_free(priv->filename);
-	g_free(priv->protocol);
-	g_free(priv->appstream_id);
+	fwupd_ref_string_clear(&priv->protocol);
+	fwupd_ref_string_clear(&priv->appstream_id);
 	g_free(priv->id);
-	g_free(priv->detach_caption);
-	g_free(priv->detach_image);
-	g_free(priv->license);
-	g_free(priv->name);
-	g_free(priv->name_variant_suffix);
-	g_free(priv->summary);
-	g_free(priv->branch);
+	fwupd_ref_string_clear(&priv->detach_caption);
+	fwupd_ref_string_clear(&priv->detach_image);
+	fwupd_ref_string_clear(&priv->license);
+	fwupd_ref_string_clear(&priv->name);
+	fwupd_ref_string_clear(&priv->name_variant_suffix);
+	fwupd_ref_string_clear(&priv->summary);
+	fwupd_ref_string_clear(&priv->branch);
 	if (priv->locations != NULL)
 		g_ptr_array_unref(priv->locations);
-	g_free(priv->homepage);
-	g_free(priv->details_url);
-	g_free(priv->source_url);
+	fwupd_ref_string_clear(&priv->homepage);
+	fwupd_ref_string_clear(&priv->details_url);
+	fwupd_ref_string_clear(&priv->source_url);
 	g_free(priv->sbom_url);
-	g_free(priv->vendor);
-	g_free(priv->version);
-	g_free(priv->remote_id);
+	fwupd_ref_string_clear(&priv->vendor);
+	fwupd_ref_string_clear(&priv->version);
+	fwupd_ref_string_clear(&priv->remote_id);
 	g_free(priv->update_message);
 	g_free(priv->update_image);
 	if (priv->categories != NULL)
@@ -42,4 +42,7 @@ enum FwupdRemoteFlags {
     // A username and/or password is required
     // Since: 2.1.4
     RequiresAuth = 1 << 7,
+    // Download a delta against the cached metadata when the server provides one.
+    // Since: 2.2.1
+    AllowDeltaMetadata = 1 << 8,
 }
@@ -243,7 +243,7 @@ fwupd_security_attr_add_obsolete(FwupdSecurityAttr *self, const gchar *appstream
 	g_return_if_fail(appstream_id != NULL);
 	if (fwupd_security_attr_has_obsolete(self, appstream_id))
 		return;
-	g_ptr_array_add(priv->obsoletes, g_strdup(appstream_id));
+	g_ptr_array_add(priv->obsoletes, fwupd_ref_string_new(appstream_id));
 }
 
 /**
@@ -307,7 +307,7 @@ fwupd_security_attr_add_guid(FwupdSecurityAttr *self, const gchar *guid)
 	g_return_if_fail(fwupd_guid_is_valid(guid));
 	if (fwupd_security_attr_has_guid(self, guid))
 		return;
-	g_ptr_array_add(priv->guids, g_strdup(guid));
+	g_ptr_array_add(priv->guids, fwupd_ref_string_new(guid));
 }
 
 /**
@@ -397,8 +397,7 @@ fwupd_security_attr_set_appstream_id(FwupdSecurityAttr *self, const gchar *appst
 	if (appstream_id != NULL && !g_str_has_prefix(appstream_id, "org.fwupd.hsi."))
 		g_critical("HSI attributes need to have a 'org.fwupd.hsi.' prefix");
 
-	g_free(priv->appstream_id);
-	priv->appstream_id = g_strdup(appstream_id);
+	fwupd_ref_string_set(&priv->appstream_id, appstream_id);
 }
 
 /**
@@ -438,8 +437,7 @@ fwupd_security_attr_set_name(FwupdSecurityAttr *self, const gchar *name)
 	if (g_strcmp0(priv->name, name) == 0)
 		return;
 
-	g_free(priv->name);
-	priv->name = g_strdup(name);
+	fwupd_ref_string_set(&priv->name, name);
 }
 
 /**
@@ -622,8 +620,7 @@ fwupd_security_attr_set_title(FwupdSecurityAttr *self, const gchar *title)
 	if (g_strcmp0(priv->title, title) == 0)
 		return;
 
-	g_free(priv->title);
-	priv->title = g_strdup(title);
+	fwupd_ref_string_set(&priv->title, title);
 }
 
 /**
@@ -668,8 +665,7 @@ fwupd_security_attr_set_plugin(FwupdSecurityAttr *self, const gchar *plugin)
 	if (g_strcmp0(priv->plugin, plugin) == 0)
 		return;
 
-	g_free(priv->plugin);
-	priv->plugin = g_strdup(plugin);
+	fwupd_ref_string_set(&priv->plugin, plugin);
 }
 
 /**
@@ -691,8 +687,7 @@ fwupd_security_attr_set_fwupd_version(FwupdSecurityAttr *self, const gchar *fwup
 	if (g_strcmp0(priv->fwupd_version, fwupd_version) == 0)
 		return;
 
-	g_free(priv->fwupd_version);
-	priv->fwupd_version = g_strdup(fwupd_version);
+	fwupd_ref_string_set(&priv->fwupd_version, fwupd_version);
 }
 
 /**
@@ -714,8 +709,7 @@ fwupd_security_attr_set_url(FwupdSecurityAttr *self, const gchar *url)
 	if (g_strcmp0(priv->url, url) == 0)
 		return;
 
-	g_free(priv->url);
-	priv->url = g_strdup(url);
+	fwupd_ref_string_set(&priv->url, url);
 }
 /**
  * fwupd_security_attr_get_created:
@@ -1710,8 +1704,8 @@ fwupd_security_attr_init(FwupdSecurityAttr *self)
 {
 	FwupdSecurityAttrPrivate *priv = GET_PRIVATE(self);
 	priv->level = FWUPD_SECURITY_ATTR_LEVEL_NONE;
-	priv->obsoletes = g_ptr_array_new_with_free_func(g_free);
-	priv->guids = g_ptr_array_new_with_free_func(g_free);
+	priv->obsoletes = g_ptr_array_new_with_free_func((GDestroyNotify)g_ref_string_release);
+	priv->guids = g_ptr_array_new_with_free_func((GDestroyNotify)g_ref_string_release);
 	priv->created = (guint64)g_get_real_time() / G_USEC_PER_SEC;
 }
 
@@ -1728,13 +1722,13 @@ fwupd_security_attr_finalize(GObject *object)
 	g_free(priv->bios_setting_current_value);
 	g_free(priv->kernel_current_value);
 	g_free(priv->kernel_target_value);
-	g_free(priv->appstream_id);
-	g_free(priv->name);
-	g_free(priv->title);
+	fwupd_ref_string_clear(&priv->appstream_id);
+	fwupd_ref_string_clear(&priv->name);
+	fwupd_ref_string_clear(&priv->title);
 	g_free(priv->description);
-	g_free(priv->plugin);
-	g_free(priv->fwupd_version);
-	g_free(priv->url);
+	fwupd_ref_string_clear(&priv->plugin);
+	fwupd_ref_string_clear(&priv->fwupd_version);
+	fwupd_ref_string_clear(&priv->url);
 	g_ptr_array_unref(priv->obsoletes);
 	g_ptr_array_unref(priv->guids);
 
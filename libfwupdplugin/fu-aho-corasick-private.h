@@ -0,0 +1,28 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-input-stream.h"
+
+G_BEGIN_DECLS
+
+typedef struct FuAhoCorasick FuAhoCorasick;
+
+FuAhoCorasick *
+fu_aho_corasick_new(GPtrArray *patterns) G_GNUC_NON_NULL(1);
+void
+fu_aho_corasick_free(FuAhoCorasick *self);
+gboolean
+fu_aho_corasick_search_stream(FuAhoCorasick *self,
+			      FuInputStream *stream,
+			      gsize offset,
+			      gsize *offsets,
+			      GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2, 4);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuAhoCorasick, fu_aho_corasick_free)
+
+G_END_DECLS
@@ -0,0 +1,240 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuAhoCorasick"
+
+#include "config.h"
+
+#include "fu-aho-corasick-private.h"
+
+/*
+ * A multi-pattern matcher that finds the first offset of every pattern by reading the data once.
+ *
+ * The patterns are compiled into a DFA where every state has a transition for every possible
+ * byte value, so that the search loop is just one table lookup per byte.
+ */
+
+#define FU_AHO_CORASICK_STATE_NONE G_MAXUINT32
+
+struct FuAhoCorasick {
+	GArray *lengths;    /* element-type gsize */
+	GArray *delta;	    /* element-type guint32, 0x100 for each state */
+	GPtrArray *outputs; /* element-type GArray of guint, one for each state */
+};
+
+static guint32
+fu_aho_corasick_add_state(FuAhoCorasick *self)
+{
+	guint32 state = self->outputs->len;
+	for (guint i = 0; i < 0x100; i++) {
+		guint32 tmp = FU_AHO_CORASICK_STATE_NONE;
+		g_array_append_val(self->delta, tmp);
+	}
+	g_ptr_array_add(self->outputs, g_array_new(FALSE, FALSE, sizeof(guint)));
+	return state;
+}
+
+static guint32 *
+fu_aho_corasick_get_delta(FuAhoCorasick *self, guint32 state, guint8 value)
+{
+	return &g_array_index(self->delta, guint32, (gsize)state * 0x100 + value);
+}
+
+static void
+fu_aho_corasick_add_pattern(FuAhoCorasick *self, guint idx, GBytes *blob)
+{
+	gsize bufsz = 0;
+	const guint8 *buf = g_bytes_get_data(blob, &bufsz);
+	guint32 state = 0;
+
+	for (gsize i = 0; i < bufsz; i++) {
+		guint32 state_next = *fu_aho_corasick_get_delta(self, state, buf[i]);
+		if (state_next == FU_AHO_CORASICK_STATE_NONE) {
+			state_next = fu_aho_corasick_add_state(self);
+			*fu_aho_corasick_get_delta(self, state, buf[i]) = state_next;
+		}
+		state = state_next;
+	}
+	g_array_append_val(g_ptr_array_index(self->outputs, state), idx);
+	g_array_append_val(self->lengths, bufsz);
+}
+
+/* convert the trie into a DFA using the failure links, in breadth-first order */
+static void
+fu_aho_corasick_build(FuAhoCorasick *self)
+{
+	g_autofree guint32 *fail = g_new0(guint32, self->outputs->len);
+	g_autoptr(GArray) queue = g_array_new(FALSE, FALSE, sizeof(guint32));
+
+	for (guint i = 0; i < 0x100; i++) {
+		guint32 *state = fu_aho_corasick_get_delta(self, 0, i);
+		if (*state == FU_AHO_CORASICK_STATE_NONE) {
+			*state = 0;
+			continue;
+		}
+		g_array_append_val(queue, *state);
+	}
+	for (guint j = 0; j < queue->len; j++) {
+		guint32 state = g_array_index(queue, guint32, j);
+		for (guint i = 0; i < 0x100; i++) {
+			guint32 state_fail = *fu_aho_corasick_get_delta(self, fail[state], i);
+			guint32 *state_next = fu_aho_corasick_get_delta(self, state, i);
+			GArray *outputs;
+			GArray *outputs_fail;
+
+			if (*state_next == FU_AHO_CORASICK_STATE_NONE) {
+				*state_next = state_fail;
+				continue;
+			}
+
+			/* anything matching the suffix also matches here */
+			fail[*state_next] = state_fail;
+			outputs = g_ptr_array_index(self->outputs, *state_next);
+			outputs_fail = g_ptr_array_index(self->outputs, state_fail);
+			g_array_append_vals(outputs, outputs_fail->data, outputs_fail->len);
+			g_array_append_val(queue, *state_next);
+		}
+	}
+}
+
+/**
+ * fu_aho_corasick_new:
+ * @patterns: (element-type GBytes): the patterns to search for, which cannot be empty
+ *
+ * Compiles the patterns into a matcher that can be used many times.
+ *
+ * Returns: (transfer full): a #FuAhoCorasick
+ *
+ * Since: 2.2.1
+ **/
+FuAhoCorasick *
+fu_aho_corasick_new(GPtrArray *patterns)
+{
+	FuAhoCorasick *self = g_new0(FuAhoCorasick, 1);
+
+	g_return_val_if_fail(patterns != NULL, NULL);
+
+	self->lengths = g_array_new(FALSE, FALSE, sizeof(gsize));
+	self->delta = g_array_new(FALSE, FALSE, sizeof(guint32));
+	self->outputs = g_ptr_array_new_with_free_func((GDestroyNotify)g_array_unref);
+	fu_aho_corasick_add_state(self);
+	for (guint i = 0; i < patterns->len; i++)
+		fu_aho_corasick_add_pattern(self, i, g_ptr_array_index(patterns, i));
+	fu_aho_corasick_build(self);
+	return self;
+}
+
+/**
+ * fu_aho_corasick_free:
+ * @self: a #FuAhoCorasick
+ *
+ * Frees the matcher.
+ *
+ * Since: 2.2.1
+ **/
+void
+fu_aho_corasick_free(FuAhoCorasick *self)
+{
+	if (self == NULL)
+		return;
+	g_array_unref(self->lengths);
+	g_array_unref(self->delta);
+	g_ptr_array_unref(self->outputs);
+	g_free(self);
+}
+
+/* returns TRUE when every pattern has been found */
+static gboolean
+fu_aho_corasick_search_buf(FuAhoCorasick *self,
+			   guint32 *state,
+			   const guint8 *buf,
+			   gsize bufsz,
+			   gsize offset,
+			   gsize *offsets,
+			   guint *remaining)
+{
+	const guint32 *delta = (const guint32 *)self->delta->data;
+
+	for (gsize i = 0; i < bufsz; i++) {
+		GArray *outputs;
+
+		*state = delta[(gsize)*state * 0x100 + buf[i]];
+		outputs = g_ptr_array_index(self->outputs, *state);
+		for (guint j = 0; j < outputs->len; j++) {
+			guint idx = g_array_index(outputs, guint, j);
+			if (offsets[idx] != G_MAXSIZE)
+				continue;
+			offsets[idx] = offset + i + 1 - g_array_index(self->lengths, gsize, idx);
+			if (--(*remaining) == 0)
+				return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/**
+ * fu_aho_corasick_search_stream:
+ * @self: a #FuAhoCorasick
+ * @stream: a #FuInputStream
+ * @offset: offset in @stream to start searching
+ * @offsets: (out caller-allocates): the offset of the first match of each pattern
+ * @error: (nullable): optional return location for an error
+ *
+ * Finds the first offset of every pattern at or after @offset, reading @stream only once.
+ * Any patterns that are not found are set to %G_MAXSIZE in @offsets.
+ *
+ * Returns: %TRUE if @stream could be read
+ *
+ * Since: 2.2.1
+ **/
+gboolean
+fu_aho_corasick_search_stream(FuAhoCorasick *self,
+			      FuInputStream *stream,
+			      gsize offset,
+			      gsize *offsets,
+			      GError **error)
+{
+	const gsize blocksz = 0x10000;
+	gsize offset_cur = offset;
+	guint32 state = 0;
+	guint remaining = self->lengths->len;
+
+	g_return_val_if_fail(self != NULL, FALSE);
+	g_return_val_if_fail(FU_IS_INPUT_STREAM(stream), FALSE);
+	g_return_val_if_fail(offsets != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	for (guint i = 0; i < self->lengths->len; i++)
+		offsets[i] = G_MAXSIZE;
+	while (remaining > 0) {
+		g_autoptr(GByteArray) buf = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		buf = fu_input_stream_read_byte_array(stream,
+						      offset_cur,
+						      blocksz,
+						      NULL,
+						      &error_local);
+		if (buf == NULL) {
+			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE))
+				break;
+			g_propagate_error(error, g_steal_pointer(&error_local));
+			return FALSE;
+		}
+		if (fu_aho_corasick_search_buf(self,
+					       &state,
+					       buf->data,
+					       buf->len,
+					       offset_cur,
+					       offsets,
+					       &remaining))
+			break;
+		offset_cur += buf->len;
+	}
+
+	/* success */
+	return TRUE;
+}
@@ -0,0 +1,948 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuBenchmark"
+
+#include "config.h"
+
+#include <fwupdplugin.h>
+
+/* each benchmark runs for at least this long, in ms */
+#define FU_BENCHMARK_DURATION_DEFAULT 200
+
+/* percentage slower than the baseline before it is considered a regression */
+#define FU_BENCHMARK_THRESHOLD_DEFAULT 10
+
+/* the size of the file used for the input-stream-read benchmarks, in MB */
+#define FU_BENCHMARK_READ_SIZE_DEFAULT 256
+
+typedef gboolean (*FuBenchmarkFunc)(gpointer user_data, GError **error);
+
+typedef struct {
+	FuContext *ctx;
+	FwupdJsonObject *results;
+	gchar *filter;
+	gint64 duration; /* us */
+	guint read_size; /* MB */
+	gchar *metadata; /* nullable */
+} FuBenchmarkHelper;
+
+static void
+fu_benchmark_helper_free(FuBenchmarkHelper *self)
+{
+	g_object_unref(self->ctx);
+	fwupd_json_object_unref(self->results);
+	g_free(self->filter);
+	g_free(self->metadata);
+	g_free(self);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuBenchmarkHelper, fu_benchmark_helper_free)
+
+static void
+fu_benchmark_add_result(FuBenchmarkHelper *self, const gchar *name, gint64 value, const gchar *unit)
+{
+	g_print("%-56s %12" G_GINT64_FORMAT " %s\n", name, value, unit); /* nocheck:print */
+	fwupd_json_object_add_integer(self->results, name, value);
+}
+
+static gboolean
+fu_benchmark_run(FuBenchmarkHelper *self,
+		 const gchar *name,
+		 FuBenchmarkFunc func,
+		 gpointer user_data,
+		 GError **error)
+{
+	gint64 elapsed;
+	gint64 start;
+	guint64 iterations = 0;
+	guint64 nsecs;
+
+	/* filtered out */
+	if (self->filter != NULL && !g_pattern_match_simple(self->filter, name))
+		return TRUE;
+
+	/* warm up any caches, and make sure the function actually works */
+	if (!func(user_data, error)) {
+		g_prefix_error(error, "failed to run %s: ", name);
+		return FALSE;
+	}
+
+	/* run for a fixed period rather than a fixed count */
+	start = g_get_monotonic_time();
+	do {
+		if (!func(user_data, error)) {
+			g_prefix_error(error, "failed to run %s: ", name);
+			return FALSE;
+		}
+		iterations++;
+		elapsed = g_get_monotonic_time() - start;
+	} while (elapsed < self->duration);
+
+	nsecs = ((guint64)elapsed * 1000) / iterations;
+	fu_benchmark_add_result(self, name, (gint64)nsecs, "ns/iter");
+	return TRUE;
+}
+
+typedef struct {
+	FuCrcKind kind;
+	GBytes *blob;
+	guint32 crc;
+} FuBenchmarkCrcHelper;
+
+static gboolean
+fu_benchmark_crc_cb(gpointer user_data, GError **error)
+{
+	FuBenchmarkCrcHelper *helper = (FuBenchmarkCrcHelper *)user_data;
+	gsize bufsz = 0;
+	const guint8 *buf = g_bytes_get_data(helper->blob, &bufsz);
+	guint size = fu_crc_size(helper->kind);
+
+	if (size == 32)
+		helper->crc = fu_crc32(helper->kind, buf, bufsz);
+	else if (size == 16)
+		helper->crc = fu_crc16(helper->kind, buf, bufsz);
+	else
+		helper->crc = fu_crc8(helper->kind, buf, bufsz);
+	return TRUE;
+}
+
+static gboolean
+fu_benchmark_crc(FuBenchmarkHelper *self, GBytes *blob, GError **error)
+{
+	for (guint i = FU_CRC_KIND_UNKNOWN + 1; i < FU_CRC_KIND_LAST; i++) {
+		FuBenchmarkCrcHelper helper = {.kind = i, .blob = blob};
+		g_autofree gchar *name = g_strdup_printf("crc/%s", fu_crc_kind_to_string(i));
+		if (!fu_benchmark_run(self, name, fu_benchmark_crc_cb, &helper, error))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+typedef struct {
+	FuInputStream *stream;
+	GChecksumType checksum_type;
+} FuBenchmarkChecksumHelper;
+
+static gboolean
+fu_benchmark_checksum_cb(gpointer user_data, GError **error)
+{
+	FuBenchmarkChecksumHelper *helper = (FuBenchmarkChecksumHelper *)user_data;
+	g_autofree gchar *checksum = NULL;
+
+	checksum = fu_input_stream_compute_checksum(helper->stream, helper->checksum_type, error);
+	return checksum != NULL;
+}
+
+static gboolean
+fu_benchmark_checksum(FuBenchmarkHelper *self, GBytes *blob, GError **error)
+{
+	g_autoptr(FuInputStream) stream = fu_memory_input_stream_new_from_bytes(blob);
+	struct {
+		const gchar *name;
+		GChecksumType checksum_type;
+	} map[] = {
+	    {"input-stream-checksum/sha1", G_CHECKSUM_SHA1},
+	    {"input-stream-checksum/sha256", G_CHECKSUM_SHA256},
+	    {"input-stream-checksum/sha512", G_CHECKSUM_SHA512},
+	};
+	for (guint i = 0; i < G_N_ELEMENTS(map); i++) {
+		FuBenchmarkChecksumHelper helper = {.stream = stream,
+						    .checksum_type = map[i].checksum_type};
+		if (!fu_benchmark_run(self, map[i].name, fu_benchmark_checksum_cb, &helper, error))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+typedef struct {
+	const gchar *filename;
+	gboolean mapped;
+} FuBenchmarkReadHelper;
+
+static gboolean
+fu_benchmark_read_cb(gpointer user_data, GError **error)
+{
+	FuBenchmarkReadHelper *helper = (FuBenchmarkReadHelper *)user_data;
+	gsize streamsz = 0;
+	g_autoptr(FuInputStream) stream = NULL;
+
+	/* open the file, then read it back in the slices a firmware parser would use */
+	if (helper->mapped)
+		stream = fu_memory_input_stream_new_from_path(helper->filename, error);
+	else
+		stream = fu_input_stream_from_path(helper->filename, error);
+	if (stream == NULL)
+		return FALSE;
+	if (!fu_input_stream_size(stream, &streamsz, error))
+		return FALSE;
+	for (gsize offset = 0; offset < streamsz; offset += 0x10000) {
+		g_autoptr(GBytes) blob = NULL;
+		blob = fu_input_stream_read_bytes(stream, offset, 0x10000, NULL, error);
+		if (blob == NULL)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_benchmark_read(FuBenchmarkHelper *self, GBytes *blob, GError **error)
+{
+	g_autofree gchar *filename = NULL;
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(GFileOutputStream) ostr = NULL;
+	FuBenchmarkReadHelper helper = {0};
+
+	/* filtered out, so do not write the large file */
+	if (self->filter != NULL && !g_pattern_match_simple(self->filter, "input-stream-read/*"))
+		return TRUE;
+
+	/* firmware can be hundreds of MB, so build the file from the 1MB blob */
+	tmpdir = fu_temporary_directory_new("benchmark", error);
+	if (tmpdir == NULL)
+		return FALSE;
+	filename = fu_temporary_directory_build(tmpdir, "firmware.bin", NULL);
+	file = g_file_new_for_path(filename);
+	ostr = g_file_replace(file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, error);
+	if (ostr == NULL) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	for (guint i = 0; i < self->read_size; i++) {
+		if (!g_output_stream_write_all(G_OUTPUT_STREAM(ostr),
+					       g_bytes_get_data(blob, NULL),
+					       g_bytes_get_size(blob),
+					       NULL,
+					       NULL,
+					       error)) {
+			fwupd_error_convert(error);
+			return FALSE;
+		}
+	}
+	if (!g_output_stream_close(G_OUTPUT_STREAM(ostr), NULL, error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	helper.filename = filename;
+
+	/* lseek() and read() into a new buffer for each slice */
+	helper.mapped = FALSE;
+	if (!fu_benchmark_run(self, "input-stream-read/read", fu_benchmark_read_cb, &helper, error))
+		return FALSE;
+
+	/* a GBytes view of the mapped file for each slice */
+	helper.mapped = TRUE;
+	return fu_benchmark_run(self,
+				"input-stream-read/mmap",
+				fu_benchmark_read_cb,
+				&helper,
+				error);
+}
+
+typedef struct {
+	GType gtype;
+	FuInputStream *stream;
+} FuBenchmarkFirmwareHelper;
+
+static gboolean
+fu_benchmark_firmware_cb(gpointer user_data, GError **error)
+{
+	FuBenchmarkFirmwareHelper *helper = (FuBenchmarkFirmwareHelper *)user_data;
+	g_autoptr(FuFirmware) firmware = g_object_new(helper->gtype, NULL);
+	return fu_firmware_parse_stream(firmware,
+					helper->stream,
+					0x0,
+					FU_FIRMWARE_PARSE_FLAG_NONE,
+					error);
+}
+
+static gint
+fu_benchmark_strcmp_cb(gconstpointer a, gconstpointer b)
+{
+	return g_strcmp0(*(const gchar **)a, *(const gchar **)b);
+}
+
+static gboolean
+fu_benchmark_firmware(FuBenchmarkHelper *self, GError **error)
+{
+	const gchar *fn;
+	g_autofree gchar *testdatadir = g_build_filename(SRCDIR, "tests", NULL);
+	g_autoptr(GDir) dir = NULL;
+	g_autoptr(GPtrArray) filenames = g_ptr_array_new_with_free_func(g_free);
+
+	/* sort so that the output order is stable */
+	dir = g_dir_open(testdatadir, 0, error);
+	if (dir == NULL)
+		return FALSE;
+	while ((fn = g_dir_read_name(dir)) != NULL) {
+		if (g_str_has_suffix(fn, ".builder.xml"))
+			g_ptr_array_add(filenames, g_strdup(fn));
+	}
+	g_ptr_array_sort(filenames, fu_benchmark_strcmp_cb);
+
+	for (guint i = 0; i < filenames->len; i++) {
+		const gchar *basename = g_ptr_array_index(filenames, i);
+		FuBenchmarkFirmwareHelper helper = {0};
+		g_autofree gchar *filename = g_build_filename(testdatadir, basename, NULL);
+		g_autofree gchar *id = g_strndup(basename, strlen(basename) - 12);
+		g_autofree gchar *name = g_strdup_printf("firmware-parse/%s", id);
+		g_autoptr(FuFirmware) firmware = NULL;
+		g_autoptr(FuInputStream) stream = NULL;
+		g_autoptr(GBytes) blob = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		/* not all builders produce something that can be parsed again */
+		firmware = fu_firmware_new_from_filename(filename, &error_local);
+		if (firmware == NULL) {
+			g_debug("ignoring %s: %s", basename, error_local->message);
+			continue;
+		}
+		blob = fu_firmware_write(firmware, &error_local);
+		if (blob == NULL) {
+			g_debug("ignoring %s: %s", basename, error_local->message);
+			continue;
+		}
+		stream = fu_memory_input_stream_new_from_bytes(blob);
+		helper.gtype = G_OBJECT_TYPE(firmware);
+		helper.stream = stream;
+		if (!fu_benchmark_firmware_cb(&helper, &error_local)) {
+			g_debug("ignoring %s: %s", basename, error_local->message);
+			continue;
+		}
+		if (!fu_benchmark_run(self, name, fu_benchmark_firmware_cb, &helper, error))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_benchmark_firmware_search_cb(gpointer user_data, GError **error)
+{
+	FuBenchmarkFirmwareHelper *helper = (FuBenchmarkFirmwareHelper *)user_data;
+	g_autoptr(FuFirmware) firmware = g_object_new(helper->gtype, NULL);
+	g_autoptr(GError) error_local = NULL;
+
+	/* the data does not contain any magic, so every byte has to be searched */
+	if (fu_firmware_parse_stream(firmware,
+				     helper->stream,
+				     0x0,
+				     FU_FIRMWARE_PARSE_FLAG_NONE,
+				     &error_local)) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INTERNAL,
+				    "unexpectedly found magic");
+		return FALSE;
+	}
+	if (!g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE)) {
+		g_propagate_error(error, g_steal_pointer(&error_local));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_benchmark_firmware_search(FuBenchmarkHelper *self, GBytes *blob, GError **error)
+{
+	g_autoptr(FuInputStream) stream = fu_memory_input_stream_new_from_bytes(blob);
+	FuBenchmarkFirmwareHelper helper = {.gtype = FU_TYPE_EFI_SIGNATURE_LIST, .stream = stream};
+
+	/* several magic values, searched in one pass */
+	if (!fu_benchmark_run(self,
+			      "firmware-search/efi-signature-list",
+			      fu_benchmark_firmware_search_cb,
+			      &helper,
+			      error))
+		return FALSE;
+
+	/* a single magic value */
+	helper.gtype = FU_TYPE_FMAP_FIRMWARE;
+	return fu_benchmark_run(self,
+				"firmware-search/fmap",
+				fu_benchmark_firmware_search_cb,
+				&helper,
+				error);
+}
+
+typedef struct {
+	FuQuirks *quirks;
+	const gchar *guid;
+} FuBenchmarkQuirksHelper;
+
+static gboolean
+fu_benchmark_quirks_cb(gpointer user_data, GError **error)
+{
+	FuBenchmarkQuirksHelper *helper = (FuBenchmarkQuirksHelper *)user_data;
+	if (fu_quirks_lookup_by_id(helper->quirks, helper->guid, "Name") == NULL) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "no quirk found for %s",
+			    helper->guid);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_benchmark_quirks(FuBenchmarkHelper *self, GError **error)
+{
+	FuBenchmarkQuirksHelper helper = {0};
+	g_autofree gchar *guid = NULL;
+	g_autofree gchar *testdatadir = g_build_filename(SRCDIR, "tests", "quirks.d", NULL);
+	g_autoptr(FuQuirks) quirks = fu_quirks_new(self->ctx);
+
+	fu_context_set_path(self->ctx, FU_PATH_KIND_DATADIR_QUIRKS, testdatadir);
+	fu_context_add_flag(self->ctx, FU_CONTEXT_FLAG_NO_CACHE);
+	if (!fu_quirks_load(quirks, error))
+		return FALSE;
+	guid = fwupd_guid_hash_string("USB\\VID_0BDA&PID_1100");
+	helper.quirks = quirks;
+	helper.guid = guid;
+	return fu_benchmark_run(self,
+				"quirks/lookup-by-id",
+				fu_benchmark_quirks_cb,
+				&helper,
+				error);
+}
+
+static gboolean
+fu_benchmark_silo_cb(gpointer user_data, GError **error)
+{
+	XbSilo *silo = XB_SILO(user_data);
+	g_autoptr(XbNode) n = NULL;
+
+	n = xb_silo_query_first(silo,
+				"components/component[@type='firmware']/provides/"
+				"firmware[@type='flashed'][text()='guid-0999']/../..",
+				error);
+	return n != NULL;
+}
+
+static gboolean
+fu_benchmark_silo(FuBenchmarkHelper *self, GError **error)
+{
+	g_autoptr(GString) xml = g_string_new("<components>\n");
+	g_autoptr(XbBuilder) builder = xb_builder_new();
+	g_autoptr(XbBuilderSource) source = xb_builder_source_new();
+	g_autoptr(XbSilo) silo = NULL;
+
+	/* roughly the shape of a remote with a thousand components */
+	for (guint i = 0; i < 1000; i++) {
+		g_string_append_printf(xml,
+				       "<component type=\"firmware\">"
+				       "<id>com.example.device%04u.firmware</id>"
+				       "<provides><firmware type=\"flashed\">guid-%04u</firmware>"
+				       "</provides><releases><release version=\"1.2.%u\">"
+				       "<checksum type=\"sha256\" target=\"container\">"
+				       "%064x</checksum>"
+				       "</release></releases></component>\n",
+				       i,
+				       i,
+				       i,
+				       i);
+	}
+	g_string_append(xml, "</components>\n");
+	if (!xb_builder_source_load_xml(source, xml->str, XB_BUILDER_SOURCE_FLAG_NONE, error))
+		return FALSE;
+	xb_builder_import_source(builder, source);
+	silo = xb_builder_compile(builder, XB_BUILDER_COMPILE_FLAG_NONE, NULL, error);
+	if (silo == NULL)
+		return FALSE;
+	return fu_benchmark_run(self, "silo/query-first", fu_benchmark_silo_cb, silo, error);
+}
+
+typedef struct {
+	GFile *file;	  /* nullable */
+	const gchar *xml; /* nullable */
+} FuBenchmarkMetadataHelper;
+
+static XbSilo *
+fu_benchmark_metadata_compile(FuBenchmarkMetadataHelper *helper, GError **error)
+{
+	g_autoptr(XbBuilder) builder = xb_builder_new();
+	g_autoptr(XbBuilderSource) source = xb_builder_source_new();
+
+	if (helper->file != NULL) {
+		if (!xb_builder_source_load_file(source,
+						 helper->file,
+						 XB_BUILDER_SOURCE_FLAG_NONE,
+						 NULL,
+						 error))
+			return NULL;
+	} else {
+		if (!xb_builder_source_load_xml(source,
+						helper->xml,
+						XB_BUILDER_SOURCE_FLAG_NONE,
+						error))
+			return NULL;
+	}
+	xb_builder_import_source(builder, source);
+	return xb_builder_compile(builder, XB_BUILDER_COMPILE_FLAG_NONE, NULL, error);
+}
+
+static gboolean
+fu_benchmark_metadata_parse_cb(gpointer user_data, GError **error)
+{
+	FuBenchmarkMetadataHelper *helper = (FuBenchmarkMetadataHelper *)user_data;
+	g_autoptr(XbSilo) silo = fu_benchmark_metadata_compile(helper, error);
+	return silo != NULL;
+}
+
+static gint
+fu_benchmark_version_sort_cb(gconstpointer a, gconstpointer b)
+{
+	return fu_version_compare(*(const gchar **)a,
+				  *(const gchar **)b,
+				  FWUPD_VERSION_FORMAT_UNKNOWN);
+}
+
+static gboolean
+fu_benchmark_version_sort_strings_cb(gpointer user_data, GError **error)
+{
+	GPtrArray *versions = (GPtrArray *)user_data;
+	g_autoptr(GPtrArray) versions_tmp = g_ptr_array_sized_new(versions->len);
+	g_ptr_array_extend(versions_tmp, versions, NULL, NULL);
+	g_ptr_array_sort(versions_tmp, fu_benchmark_version_sort_cb);
+	return TRUE;
+}
+
+static gint
+fu_benchmark_version_key_sort_cb(gconstpointer a, gconstpointer b)
+{
+	return fu_version_key_compare(*(FuVersionKey **)a, *(FuVersionKey **)b);
+}
+
+static gboolean
+fu_benchmark_version_sort_keys_cb(gpointer user_data, GError **error)
+{
+	GPtrArray *keys = (GPtrArray *)user_data;
+	g_autoptr(GPtrArray) keys_tmp = g_ptr_array_sized_new(keys->len);
+	g_ptr_array_extend(keys_tmp, keys, NULL, NULL);
+	g_ptr_array_sort(keys_tmp, fu_benchmark_version_key_sort_cb);
+	return TRUE;
+}
+
+static gboolean
+fu_benchmark_metadata(FuBenchmarkHelper *self, GError **error)
+{
+	FuBenchmarkMetadataHelper helper = {0};
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(GPtrArray) keys =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_version_key_unref);
+	g_autoptr(GPtrArray) releases = NULL;
+	g_autoptr(GPtrArray) versions = g_ptr_array_new();
+	g_autoptr(GString) xml = g_string_new("<components>\n");
+	g_autoptr(XbSilo) silo = NULL;
+
+	/* use a real LVFS snapshot if provided, e.g. firmware.xml.zst from /var/lib/fwupd */
+	if (self->metadata != NULL) {
+		file = g_file_new_for_path(self->metadata);
+		helper.file = file;
+	} else {
+		for (guint i = 0; i < 1000; i++) {
+			g_string_append_printf(xml,
+					       "<component type=\"firmware\">"
+					       "<id>com.example.device%04u.firmware</id>"
+					       "<releases>",
+					       i);
+			for (guint j = 0; j < 10; j++) {
+				g_string_append_printf(xml,
+						       "<release version=\"%u.%u.%u\"/>",
+						       i % 7,
+						       j,
+						       (i * j) % 1000);
+			}
+			g_string_append(xml, "</releases></component>\n");
+		}
+		g_string_append(xml, "</components>\n");
+		helper.xml = xml->str;
+	}
+	if (!fu_benchmark_run(self,
+			      "metadata/parse",
+			      fu_benchmark_metadata_parse_cb,
+			      &helper,
+			      error))
+		return FALSE;
+
+	/* sort every release version, as done when getting upgrades */
+	silo = fu_benchmark_metadata_compile(&helper, error);
+	if (silo == NULL)
+		return FALSE;
+	releases = xb_silo_query(silo, "components/component/releases/release", 0, error);
+	if (releases == NULL)
+		return FALSE;
+	for (guint i = 0; i < releases->len; i++) {
+		XbNode *n = g_ptr_array_index(releases, i);
+		const gchar *version = xb_node_get_attr(n, "version");
+		if (version == NULL)
+			continue;
+		g_ptr_array_add(versions, (gpointer)version);
+		g_ptr_array_add(keys, fu_version_key_new(version, FWUPD_VERSION_FORMAT_UNKNOWN));
+	}
+	if (!fu_benchmark_run(self,
+			      "metadata/sort-versions/string",
+			      fu_benchmark_version_sort_strings_cb,
+			      versions,
+			      error))
+		return FALSE;
+	return fu_benchmark_run(self,
+				"metadata/sort-versions/key",
+				fu_benchmark_version_sort_keys_cb,
+				keys,
+				error);
+}
+
+static FwupdDevice *
+fu_benchmark_build_device(guint idx)
+{
+	FwupdDevice *dev = fwupd_device_new();
+	g_autofree gchar *id = g_strdup_printf("%040x", idx);
+	g_autofree gchar *instance_id = g_strdup_printf("USB\\VID_273F&PID_%04X", idx);
+
+	fwupd_device_set_id(dev, id);
+	fwupd_device_set_name(dev, "ColorHug2");
+	fwupd_device_set_vendor(dev, "Hughski Limited");
+	fwupd_device_set_version(dev, "1.2.3");
+	fwupd_device_set_version_bootloader(dev, "0.1.2");
+	fwupd_device_set_summary(dev, "An open source display colorimeter");
+	fwupd_device_add_protocol(dev, "com.hughski.colorhug");
+	fwupd_device_add_vendor_id(dev, "USB:0x273F");
+	fwupd_device_add_instance_id(dev, instance_id);
+	fwupd_device_add_guid(dev, "2082b5e0-7a64-478a-b1b2-e3404fab6dad");
+	fwupd_device_add_icon(dev, "input-gaming");
+	fwupd_device_add_flag(dev, FWUPD_DEVICE_FLAG_UPDATABLE);
+	fwupd_device_add_flag(dev, FWUPD_DEVICE_FLAG_REQUIRE_AC);
+	for (guint i = 0; i < 5; i++) {
+		g_autoptr(FwupdRelease) rel = fwupd_release_new();
+		g_autofree gchar *version = g_strdup_printf("1.2.%u", i);
+		fwupd_release_set_version(rel, version);
+		fwupd_release_set_summary(rel, "Firmware for the ColorHug2");
+		fwupd_release_add_checksum(rel, "deadbeefdeadbeefdeadbeefdeadbeefdeadbeef");
+		fwupd_release_add_location(rel, "https://fwupd.org/downloads/firmware.cab");
+		fwupd_device_add_release(dev, rel);
+	}
+	return dev;
+}
+
+static gboolean
+fu_benchmark_json_cb(gpointer user_data, GError **error)
+{
+	const gchar *text = (const gchar *)user_data;
+	g_autoptr(FwupdJsonParser) parser = fwupd_json_parser_new();
+	g_autoptr(FwupdJsonNode) json_node = NULL;
+
+	json_node =
+	    fwupd_json_parser_load_from_data(parser, text, FWUPD_JSON_LOAD_FLAG_NONE, error);
+	return json_node != NULL;
+}
+
+static gboolean
+fu_benchmark_json(FuBenchmarkHelper *self, GError **error)
+{
+	g_autofree gchar *text = NULL;
+	g_autoptr(FwupdJsonArray) json_arr = fwupd_json_array_new();
+	g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+
+	/* the same kind of payload as `fwupdmgr get-devices --json` */
+	for (guint i = 0; i < 50; i++) {
+		g_autoptr(FwupdDevice) dev = fu_benchmark_build_device(i);
+		g_autoptr(FwupdJsonObject) json_dev = fwupd_json_object_new();
+		fwupd_codec_to_json(FWUPD_CODEC(dev), json_dev, FWUPD_CODEC_FLAG_TRUSTED);
+		fwupd_json_array_add_object(json_arr, json_dev);
+	}
+	fwupd_json_object_add_array(json_obj, "Devices", json_arr);
+	text = fwupd_json_object_to_string(json_obj, FWUPD_JSON_EXPORT_FLAG_INDENT);
+	return fu_benchmark_run(self, "json/parse", fu_benchmark_json_cb, text, error);
+}
+
+static gboolean
+fu_benchmark_variant_cb(gpointer user_data, GError **error)
+{
+	FwupdCodec *codec = FWUPD_CODEC(user_data);
+	g_autoptr(GVariant) value = fwupd_codec_to_variant(codec, FWUPD_CODEC_FLAG_TRUSTED);
+
+	/* force the serialization */
+	if (g_variant_get_data(value) == NULL) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INTERNAL,
+				    "failed to serialize variant");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_benchmark_variant(FuBenchmarkHelper *self, GError **error)
+{
+	g_autoptr(FwupdDevice) dev = fu_benchmark_build_device(0);
+	return fu_benchmark_run(self, "variant/device", fu_benchmark_variant_cb, dev, error);
+}
+
+/* returns the resident set size in kB, or 0 if unknown */
+static guint64
+fu_benchmark_get_rss(void)
+{
+	g_autofree gchar *buf = NULL;
+	g_auto(GStrv) lines = NULL;
+
+	if (!g_file_get_contents("/proc/self/status", &buf, NULL, NULL))
+		return 0;
+	lines = g_strsplit(buf, "\n", -1);
+	for (guint i = 0; lines[i] != NULL; i++) {
+		guint64 value = 0;
+		g_autofree gchar *str = NULL;
+
+		if (!g_str_has_prefix(lines[i], "VmRSS:"))
+			continue;
+		str = g_strdup(lines[i] + strlen("VmRSS:"));
+		g_strstrip(str);
+		if (g_str_has_suffix(str, " kB"))
+			str[strlen(str) - 3] = '\0';
+		if (!fu_strtoull(str, &value, 0, G_MAXUINT64, FU_INTEGER_BASE_10, NULL))
+			return 0;
+		return value;
+	}
+	return 0;
+}
+
+static FwupdRelease *
+fu_benchmark_build_release(guint idx)
+{
+	FwupdRelease *rel = fwupd_release_new();
+	g_autofree gchar *checksum = g_strdup_printf("%064x", idx);
+	g_autofree gchar *location = g_strdup_printf("https://fwupd.org/downloads/%064x.cab", idx);
+	g_autofree gchar *version = g_strdup_printf("1.2.%u", idx % 100);
+
+	/* a few values are unique, most are shared with the other releases */
+	fwupd_release_add_checksum(rel, checksum);
+	fwupd_release_add_location(rel, location);
+	fwupd_release_set_version(rel, version);
+	fwupd_release_set_remote_id(rel, "lvfs");
+	fwupd_release_set_vendor(rel, "Hughski Limited");
+	fwupd_release_set_protocol(rel, "com.hughski.colorhug");
+	fwupd_release_set_license(rel, "LicenseRef-proprietary");
+	fwupd_release_set_branch(rel, "stable");
+	fwupd_release_set_appstream_id(rel, "com.hughski.ColorHug2.firmware");
+	fwupd_release_add_category(rel, "X-Device");
+	fwupd_release_add_tag(rel, "vendor-2024q1");
+	return rel;
+}
+
+static gboolean
+fu_benchmark_memory(FuBenchmarkHelper *self, GError **error)
+{
+	const gchar *name = "memory/releases-10k";
+	guint64 rss_after;
+	guint64 rss_before;
+	g_autoptr(GPtrArray) releases = g_ptr_array_new_with_free_func(g_object_unref);
+
+	/* filtered out */
+	if (self->filter != NULL && !g_pattern_match_simple(self->filter, name))
+		return TRUE;
+
+	/* not supported on this OS */
+	rss_before = fu_benchmark_get_rss();
+	if (rss_before == 0) {
+		g_debug("cannot get RSS, skipping %s", name);
+		return TRUE;
+	}
+
+	/* like the releases returned from GetReleases for a large remote */
+	for (guint i = 0; i < 10000; i++)
+		g_ptr_array_add(releases, fu_benchmark_build_release(i));
+	rss_after = fu_benchmark_get_rss();
+	fu_benchmark_add_result(self,
+				name,
+				rss_after > rss_before ? (gint64)(rss_after - rss_before) : 0,
+				"kB");
+	return TRUE;
+}
+
+static gboolean
+fu_benchmark_compare(FuBenchmarkHelper *self,
+		     const gchar *filename,
+		     guint threshold,
+		     GError **error)
+{
+	guint regressions = 0;
+	g_autoptr(FwupdJsonParser) parser = fwupd_json_parser_new();
+	g_autoptr(FwupdJsonNode) json_node = NULL;
+	g_autoptr(FwupdJsonObject) json_obj = NULL;
+	g_autoptr(FwupdJsonObject) json_results = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GPtrArray) keys = NULL;
+
+	blob = fu_bytes_get_contents(filename, error);
+	if (blob == NULL)
+		return FALSE;
+	json_node =
+	    fwupd_json_parser_load_from_bytes(parser, blob, FWUPD_JSON_LOAD_FLAG_NONE, error);
+	if (json_node == NULL)
+		return FALSE;
+	json_obj = fwupd_json_node_get_object(json_node, error);
+	if (json_obj == NULL)
+		return FALSE;
+	json_results = fwupd_json_object_get_object(json_obj, "Results", error);
+	if (json_results == NULL)
+		return FALSE;
+
+	/* only compare benchmarks that exist in both */
+	keys = fwupd_json_object_get_keys(self->results);
+	for (guint i = 0; i < keys->len; i++) {
+		const gchar *key = g_ptr_array_index(keys, i);
+		gint64 current = 0;
+		gint64 baseline = 0;
+
+		if (!fwupd_json_object_get_integer(self->results, key, &current, error))
+			return FALSE;
+		if (!fwupd_json_object_get_integer_with_default(json_results,
+								key,
+								&baseline,
+								0,
+								error))
+			return FALSE;
+		if (baseline <= 0)
+			continue;
+		if (current * 100 > baseline * (100 + threshold)) {
+			g_printerr("REGRESSION: %s was %" G_GINT64_FORMAT /* nocheck:print */
+				   ", baseline was %" G_GINT64_FORMAT
+				   " (+%" G_GINT64_FORMAT "%%)\n",
+				   key,
+				   current,
+				   baseline,
+				   ((current - baseline) * 100) / baseline);
+			regressions++;
+		}
+	}
+	if (regressions > 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INTERNAL,
+			    "%u benchmarks regressed by more than %u%%",
+			    regressions,
+			    threshold);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_benchmark_save(FuBenchmarkHelper *self, const gchar *filename, GError **error)
+{
+	g_autofree gchar *text = NULL;
+	g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+
+	fwupd_json_object_add_string(json_obj, "Version", PACKAGE_VERSION);
+	fwupd_json_object_add_object(json_obj, "Results", self->results);
+	text = fwupd_json_object_to_string(json_obj,
+					   FWUPD_JSON_EXPORT_FLAG_INDENT |
+					       FWUPD_JSON_EXPORT_FLAG_TRAILING_NEWLINE);
+	return g_file_set_contents(filename, text, -1, error);
+}
+
+int
+main(int argc, char **argv)
+{
+	gint duration = FU_BENCHMARK_DURATION_DEFAULT;
+	gint threshold = FU_BENCHMARK_THRESHOLD_DEFAULT;
+	gint read_size = FU_BENCHMARK_READ_SIZE_DEFAULT;
+	g_autofree gchar *baseline = NULL;
+	g_autofree gchar *output = NULL;
+	g_autoptr(FuBenchmarkHelper) self = g_new0(FuBenchmarkHelper, 1);
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GOptionContext) context = g_option_context_new(NULL);
+
+	const GOptionEntry options[] = {
+	    {"output", 'o', 0, G_OPTION_ARG_FILENAME, &output, "Save results as JSON", "FILE"},
+	    {"baseline",
+	     'b',
+	     0,
+	     G_OPTION_ARG_FILENAME,
+	     &baseline,
+	     "Compare results against a previously saved JSON file",
+	     "FILE"},
+	    {"threshold",
+	     't',
+	     0,
+	     G_OPTION_ARG_INT,
+	     &threshold,
+	     "Percentage slower than the baseline to count as a regression",
+	     "PERCENT"},
+	    {"duration",
+	     'd',
+	     0,
+	     G_OPTION_ARG_INT,
+	     &duration,
+	     "Minimum time to run each benchmark",
+	     "MS"},
+	    {"read-size",
+	     'r',
+	     0,
+	     G_OPTION_ARG_INT,
+	     &read_size,
+	     "Size of the file used for the input-stream-read benchmarks, default 256",
+	     "MB"},
+	    {"metadata",
+	     'm',
+	     0,
+	     G_OPTION_ARG_FILENAME,
+	     &self->metadata,
+	     "LVFS metadata to use for the metadata benchmarks, default is generated",
+	     "FILE"},
+	    {"filter",
+	     'f',
+	     0,
+	     G_OPTION_ARG_STRING,
+	     &self->filter,
+	     "Only run benchmarks matching a glob, e.g. crc/*",
+	     "GLOB"},
+	    {NULL}};
+
+	g_option_context_set_summary(context, "Microbenchmarks for common fwupd operations");
+	g_option_context_add_main_entries(context, options, NULL);
+	if (!g_option_context_parse(context, &argc, &argv, &error)) {
+		g_printerr("Failed to parse arguments: %s\n", error->message); /* nocheck:print */
+		return EXIT_FAILURE;
+	}
+	if (duration <= 0 || threshold < 0 || read_size <= 0) {
+		g_printerr("Invalid duration, threshold or read size\n"); /* nocheck:print */
+		return EXIT_FAILURE;
+	}
+	self->duration = (gint64)duration * 1000;
+	self->read_size = (guint)read_size;
+	self->results = fwupd_json_object_new();
+	self->ctx = fu_context_new();
+	fu_context_add_firmware_gtypes(self->ctx);
+
+	/* 1MB of pseudo-random data */
+	for (guint32 i = 0; i < 0x100000; i++)
+		fu_byte_array_append_uint8(buf, (guint8)((i * 2654435761u) >> 24));
+	blob = g_bytes_new(buf->data, buf->len);
+
+	if (!fu_benchmark_crc(self, blob, &error) || !fu_benchmark_checksum(self, blob, &error) ||
+	    !fu_benchmark_read(self, blob, &error) || !fu_benchmark_firmware(self, &error) ||
+	    !fu_benchmark_firmware_search(self, blob, &error) ||
+	    !fu_benchmark_quirks(self, &error) || !fu_benchmark_silo(self, &error) ||
+	    !fu_benchmark_json(self, &error) || !fu_benchmark_variant(self, &error) ||
+	    !fu_benchmark_metadata(self, &error) || !fu_benchmark_memory(self, &error)) {
+		g_printerr("%s\n", error->message); /* nocheck:print */
+		return EXIT_FAILURE;
+	}
+	if (output != NULL && !fu_benchmark_save(self, output, &error)) {
+		g_printerr("Failed to save %s: %s\n", output, error->message); /* nocheck:print */
+		return EXIT_FAILURE;
+	}
+	if (baseline != NULL && !fu_benchmark_compare(self, baseline, threshold, &error)) {
+		g_printerr("%s\n", error->message); /* nocheck:print */
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -12,6 +12,16 @@
 
 #include "fu-common-private.h"
 
+void
+fu_common_refresh_block_devices(void)
+{
+}
+
+void
+fu_common_free_block_devices(void)
+{
+}
+
 GPtrArray *
 fu_common_get_block_devices(GError **error)
 {
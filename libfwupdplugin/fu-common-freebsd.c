@@ -20,6 +20,16 @@
 #define UDISKS_DBUS_MANAGER_INTERFACE "org.freedesktop.DBus.ObjectManager"
 #define UDISKS_BLOCK_DEVICE_PATH      "/org/freedesktop/UDisks2/block_devices/"
 
+void
+fu_common_refresh_block_devices(void)
+{
+}
+
+void
+fu_common_free_block_devices(void)
+{
+}
+
 GPtrArray *
 fu_common_get_block_devices(GError **error)
 {
@@ -15,141 +15,124 @@
 #include "fu-kernel.h"
 #include "fu-path.h"
 
-#define UDISKS_DBUS_PATH	      "/org/freedesktop/UDisks2"
-#define UDISKS_DBUS_MANAGER_PATH      "/org/freedesktop/UDisks2/Manager"
-#define UDISKS_DBUS_MANAGER_INTERFACE "org.freedesktop.UDisks2.Manager"
+#define UDISKS_DBUS_PATH "/org/freedesktop/UDisks2"
 
-#define UDISKS_METHOD_TIMEOUT 10000 /* ms */
+/* shared between all callers, and kept current by the object manager signals */
+static GDBusObjectManager *fu_common_udisks_manager = NULL;
+static GMainContext *fu_common_udisks_context = NULL;
+G_LOCK_DEFINE_STATIC(fu_common_udisks);
 
-/* required for udisks <= 2.1.7 */
-static GPtrArray *
-fu_common_get_block_devices_legacy(GError **error)
+/* apply any pending InterfacesAdded, InterfacesRemoved and PropertiesChanged */
+static void
+fu_common_udisks_drain_locked(void)
+{
+	if (fu_common_udisks_context == NULL)
+		return;
+	while (g_main_context_iteration(fu_common_udisks_context, FALSE)) {
+		/* nothing */
+	}
+}
+
+static GDBusObjectManager *
+fu_common_get_udisks_manager(GError **error)
 {
-	g_autolist(GDBusObject) dbus_objects = NULL;
 	g_autoptr(GDBusConnection) connection = NULL;
-	g_autoptr(GDBusObjectManager) dbus_object_manager = NULL;
-	g_autoptr(GPtrArray) devices =
-	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	g_autoptr(GDBusObjectManager) manager = NULL;
+	g_autoptr(GMainContext) context = NULL;
+
+	/* already populated */
+	if (fu_common_udisks_manager != NULL)
+		return fu_common_udisks_manager;
 
 	connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, error);
 	if (connection == NULL) {
 		g_prefix_error_literal(error, "failed to get system bus: ");
 		return NULL;
 	}
-	dbus_object_manager =
-	    g_dbus_object_manager_client_new_sync(connection,
-						  G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_NONE,
-						  UDISKS_DBUS_SERVICE,
-						  UDISKS_DBUS_PATH,
-						  NULL,
-						  NULL,
-						  NULL,
-						  NULL,
-						  error);
-	if (dbus_object_manager == NULL)
-		return NULL;
-	dbus_objects = g_dbus_object_manager_get_objects(dbus_object_manager);
-	for (GList *l = dbus_objects; l != NULL; l = l->next) {
-		GDBusObject *dbus_object = G_DBUS_OBJECT(l->data);
-		const gchar *obj = g_dbus_object_get_object_path(dbus_object);
-		g_autoptr(GDBusInterface) dbus_iface_blk = NULL;
-		g_autoptr(GDBusProxy) proxy_blk = NULL;
 
-		dbus_iface_blk =
-		    g_dbus_object_get_interface(dbus_object, UDISKS_DBUS_INTERFACE_BLOCK);
-		if (dbus_iface_blk == NULL) {
-			g_debug("skipping %s as has no block interface", obj);
-			continue;
-		}
-		proxy_blk = g_dbus_proxy_new_sync(connection,
-						  G_DBUS_PROXY_FLAGS_NONE,
-						  NULL,
-						  UDISKS_DBUS_SERVICE,
-						  obj,
-						  UDISKS_DBUS_INTERFACE_BLOCK,
-						  NULL,
-						  error);
-		if (proxy_blk == NULL) {
-			g_prefix_error(error, "failed to initialize d-bus proxy for %s: ", obj);
-			return NULL;
-		}
-		g_ptr_array_add(devices, g_steal_pointer(&proxy_blk));
+	/* the signals are dispatched on a private context that is only iterated when the cache is
+	 * used, so that callers without a main loop still see the latest state */
+	context = g_main_context_new();
+	g_main_context_push_thread_default(context);
+	manager = g_dbus_object_manager_client_new_sync(connection,
+							G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_NONE,
+							UDISKS_DBUS_SERVICE,
+							UDISKS_DBUS_PATH,
+							NULL,
+							NULL,
+							NULL,
+							NULL,
+							error);
+	g_main_context_pop_thread_default(context);
+	if (manager == NULL) {
+		g_prefix_error(error, "failed to find %s: ", UDISKS_DBUS_SERVICE);
+		return NULL;
 	}
+	fu_common_udisks_context = g_steal_pointer(&context);
+	fu_common_udisks_manager = g_steal_pointer(&manager);
+	return fu_common_udisks_manager;
+}
 
-	/* success */
-	return g_steal_pointer(&devices);
+void
+fu_common_refresh_block_devices(void)
+{
+	G_LOCK(fu_common_udisks);
+	fu_common_udisks_drain_locked();
+	G_UNLOCK(fu_common_udisks);
+}
+
+void
+fu_common_free_block_devices(void)
+{
+	G_LOCK(fu_common_udisks);
+	g_clear_object(&fu_common_udisks_manager);
+	fu_common_udisks_drain_locked();
+	g_clear_pointer(&fu_common_udisks_context, g_main_context_unref);
+	G_UNLOCK(fu_common_udisks);
 }
 
 GPtrArray *
 fu_common_get_block_devices(GError **error)
 {
-	GVariantBuilder builder;
-	const gchar *obj;
-	g_autoptr(GError) error_local = NULL;
-	g_autoptr(GVariant) output = NULL;
-	g_autoptr(GDBusProxy) proxy = NULL;
-	g_autoptr(GPtrArray) devices = NULL;
-	g_autoptr(GVariantIter) obj_iter = NULL;
-	g_autoptr(GDBusConnection) connection = NULL;
+	GDBusObjectManager *manager;
+	g_autofree gchar *name_owner = NULL;
+	g_autolist(GDBusObject) dbus_objects = NULL;
+	g_autoptr(GPtrArray) devices =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 
-	connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, error);
-	if (connection == NULL) {
-		g_prefix_error_literal(error, "failed to get system bus: ");
-		return NULL;
-	}
-	proxy = g_dbus_proxy_new_sync(connection,
-				      G_DBUS_PROXY_FLAGS_NONE,
-				      NULL,
-				      UDISKS_DBUS_SERVICE,
-				      UDISKS_DBUS_MANAGER_PATH,
-				      UDISKS_DBUS_MANAGER_INTERFACE,
-				      NULL,
-				      error);
-	if (proxy == NULL) {
-		g_prefix_error(error, "failed to find %s: ", UDISKS_DBUS_SERVICE);
+	G_LOCK(fu_common_udisks);
+	manager = fu_common_get_udisks_manager(error);
+	if (manager == NULL) {
+		G_UNLOCK(fu_common_udisks);
 		return NULL;
 	}
 
-	devices = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	g_variant_builder_init(&builder, G_VARIANT_TYPE_VARDICT);
-	output = g_dbus_proxy_call_sync(proxy,
-					"GetBlockDevices",
-					g_variant_new("(a{sv})", &builder),
-					G_DBUS_CALL_FLAGS_NONE,
-					UDISKS_METHOD_TIMEOUT,
-					NULL,
-					&error_local);
-	if (output == NULL) {
-		if (g_error_matches(error_local, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD)) {
-			g_debug("ignoring %s, trying fallback", error_local->message);
-			return fu_common_get_block_devices_legacy(error);
-		}
-		g_dbus_error_strip_remote_error(error_local);
-		g_propagate_prefixed_error(error,
-					   g_steal_pointer(&error_local),
-					   "failed to call %s.%s(): ",
-					   UDISKS_DBUS_MANAGER_INTERFACE,
-					   "GetBlockDevices");
+	fu_common_udisks_drain_locked();
+	name_owner =
+	    g_dbus_object_manager_client_get_name_owner(G_DBUS_OBJECT_MANAGER_CLIENT(manager));
+	if (name_owner == NULL) {
+		G_UNLOCK(fu_common_udisks);
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "%s is not running",
+			    UDISKS_DBUS_SERVICE);
 		return NULL;
 	}
 
-	g_variant_get(output, "(ao)", &obj_iter);
-	while (g_variant_iter_next(obj_iter, "&o", &obj)) {
-		g_autoptr(GDBusProxy) proxy_blk = NULL;
-		proxy_blk = g_dbus_proxy_new_sync(connection,
-						  G_DBUS_PROXY_FLAGS_NONE,
-						  NULL,
-						  UDISKS_DBUS_SERVICE,
-						  obj,
-						  UDISKS_DBUS_INTERFACE_BLOCK,
-						  NULL,
-						  error);
-		if (proxy_blk == NULL) {
-			g_prefix_error(error, "failed to initialize d-bus proxy for %s: ", obj);
-			return NULL;
-		}
-		g_ptr_array_add(devices, g_steal_pointer(&proxy_blk));
+	/* the proxies already have the cached properties, so this does not use the bus */
+	dbus_objects = g_dbus_object_manager_get_objects(manager);
+	for (GList *l = dbus_objects; l != NULL; l = l->next) {
+		GDBusObject *dbus_object = G_DBUS_OBJECT(l->data);
+		GDBusInterface *dbus_iface_blk =
+		    g_dbus_object_get_interface(dbus_object, UDISKS_DBUS_INTERFACE_BLOCK);
+		if (dbus_iface_blk == NULL)
+			continue;
+		g_ptr_array_add(devices, dbus_iface_blk);
 	}
+	G_UNLOCK(fu_common_udisks);
+
+	/* success */
 	return g_steal_pointer(&devices);
 }
 
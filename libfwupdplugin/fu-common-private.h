@@ -17,6 +17,10 @@ G_BEGIN_DECLS
 
 GPtrArray *
 fu_common_get_block_devices(GError **error);
+void
+fu_common_refresh_block_devices(void);
+void
+fu_common_free_block_devices(void);
 guint64
 fu_common_get_memory_size_impl(void);
 gchar *
@@ -9,6 +9,7 @@
 #include "fu-config.h"
 #include "fu-context.h"
 #include "fu-hwids.h"
+#include "fu-input-stream.h"
 #include "fu-path-store.h"
 #include "fu-progress.h"
 #include "fu-quirks.h"
@@ -29,6 +30,9 @@ void
 fu_context_set_main_context(FuContext *self, GMainContext *main_ctx) G_GNUC_NON_NULL(1);
 void
 fu_context_housekeeping(FuContext *self) G_GNUC_NON_NULL(1);
+gchar *
+fu_context_get_instance_id_guid(FuContext *self, const gchar *instance_id)
+    G_GNUC_NON_NULL(1, 2);
 gboolean
 fu_context_reload_bios_settings(FuContext *self, GError **error);
 gboolean
@@ -42,6 +46,10 @@ void
 fu_context_add_firmware_gtype(FuContext *self, GType gtype) G_GNUC_NON_NULL(1);
 GPtrArray *
 fu_context_get_firmware_gtype_ids(FuContext *self) G_GNUC_NON_NULL(1);
+GPtrArray *
+fu_context_get_firmware_gtype_ids_for_stream(FuContext *self,
+					     FuInputStream *stream,
+					     GError **error) G_GNUC_NON_NULL(1, 2);
 GArray *
 fu_context_get_firmware_gtypes(FuContext *self) G_GNUC_NON_NULL(1);
 GType
@@ -84,6 +92,12 @@ fu_context_set_chassis_kind(FuContext *self, FuSmbiosChassisKind chassis_kind) G
 void
 fu_context_set_cpu_vendor(FuContext *self, FuCpuVendor cpu_vendor) G_GNUC_NON_NULL(1);
 
+guint
+fu_context_get_ready_time(FuContext *self, const gchar *device_id) G_GNUC_NON_NULL(1, 2);
+void
+fu_context_set_ready_time(FuContext *self, const gchar *device_id, guint ready_time)
+    G_GNUC_NON_NULL(1, 2);
+
 gpointer
 fu_context_get_data(FuContext *self, const gchar *key);
 void
@@ -199,6 +199,143 @@ fu_context_firmware_gtypes_func(void)
 	g_assert_cmpint(fu_context_get_firmware_gtype_by_id(ctx, "n/a"), ==, G_TYPE_INVALID);
 }
 
+static void
+fu_context_firmware_gtypes_for_stream_func(void)
+{
+	const gchar *buf_fmap = "__FMAP__ and then some more data";
+	const gchar *buf_unknown = "hello world";
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuInputStream) stream_fmap = NULL;
+	g_autoptr(FuInputStream) stream_unknown = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) ids_fmap = NULL;
+	g_autoptr(GPtrArray) ids_unknown = NULL;
+
+	fu_context_add_firmware_gtype(ctx, FU_TYPE_FIRMWARE);
+	fu_context_add_firmware_gtype(ctx, FU_TYPE_FMAP_FIRMWARE);
+	fu_context_add_firmware_gtype(ctx, FU_TYPE_USWID_FIRMWARE);
+
+	/* magic matches, so try that first */
+	stream_fmap =
+	    fu_memory_input_stream_new_from_data((const guint8 *)buf_fmap, strlen(buf_fmap), NULL);
+	ids_fmap = fu_context_get_firmware_gtype_ids_for_stream(ctx, stream_fmap, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(ids_fmap);
+	g_assert_cmpint(ids_fmap->len, ==, 3);
+	g_assert_cmpstr(g_ptr_array_index(ids_fmap, 0), ==, "fmap");
+	g_assert_cmpstr(g_ptr_array_index(ids_fmap, 1), ==, "raw");
+	g_assert_cmpstr(g_ptr_array_index(ids_fmap, 2), ==, "uswid");
+
+	/* uSWID can be found anywhere so cannot be ruled out */
+	stream_unknown = fu_memory_input_stream_new_from_data((const guint8 *)buf_unknown,
+							      strlen(buf_unknown),
+							      NULL);
+	ids_unknown = fu_context_get_firmware_gtype_ids_for_stream(ctx, stream_unknown, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(ids_unknown);
+	g_assert_cmpint(ids_unknown->len, ==, 2);
+	g_assert_cmpstr(g_ptr_array_index(ids_unknown, 0), ==, "raw");
+	g_assert_cmpstr(g_ptr_array_index(ids_unknown, 1), ==, "uswid");
+}
+
+static gint
+fu_context_test_strcmp_cb(gconstpointer a, gconstpointer b)
+{
+	return g_strcmp0(*(const gchar **)a, *(const gchar **)b);
+}
+
+/* the same as `fwupdtool firmware-parse auto`, returning every type that parsed */
+static gchar *
+fu_context_test_parse_auto(FuContext *ctx, FuInputStream *stream, GPtrArray *gtype_ids)
+{
+	g_autoptr(GPtrArray) gtype_ids_parsed = g_ptr_array_new();
+
+	for (guint i = 0; i < gtype_ids->len; i++) {
+		const gchar *gtype_id = g_ptr_array_index(gtype_ids, i);
+		GType gtype = fu_context_get_firmware_gtype_by_id(ctx, gtype_id);
+		g_autoptr(FuFirmware) firmware = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		if (g_strcmp0(gtype_id, "raw") == 0)
+			continue;
+		g_assert_cmpint(gtype, !=, G_TYPE_INVALID);
+		firmware = g_object_new(gtype, NULL);
+		if (fu_firmware_has_flag(firmware, FU_FIRMWARE_FLAG_NO_AUTO_DETECTION))
+			continue;
+		if (!fu_firmware_parse_stream(firmware,
+					      stream,
+					      0x0,
+					      FU_FIRMWARE_PARSE_FLAG_NO_SEARCH,
+					      &error_local)) {
+			g_debug("failed to parse as %s: %s", gtype_id, error_local->message);
+			continue;
+		}
+		g_ptr_array_add(gtype_ids_parsed, (gpointer)gtype_id);
+	}
+	g_ptr_array_sort(gtype_ids_parsed, fu_context_test_strcmp_cb);
+	g_ptr_array_add(gtype_ids_parsed, NULL);
+	return g_strjoinv(",", (gchar **)gtype_ids_parsed->pdata);
+}
+
+static void
+fu_context_firmware_gtypes_for_stream_corpus_func(void)
+{
+	const gchar *fn;
+	guint cnt = 0;
+	g_autofree gchar *testdatadir = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(GDir) dir = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) gtype_ids_all = NULL;
+
+	fu_context_add_firmware_gtypes(ctx);
+	gtype_ids_all = fu_context_get_firmware_gtype_ids(ctx);
+
+	/* the prefilter must never drop a type that would have parsed the blob */
+	testdatadir = g_test_build_filename(G_TEST_DIST, "tests", NULL);
+	dir = g_dir_open(testdatadir, 0, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(dir);
+	while ((fn = g_dir_read_name(dir)) != NULL) {
+		g_autofree gchar *filename = NULL;
+		g_autofree gchar *str_all = NULL;
+		g_autofree gchar *str_prefiltered = NULL;
+		g_autoptr(FuFirmware) firmware = NULL;
+		g_autoptr(FuInputStream) stream = NULL;
+		g_autoptr(GBytes) blob = NULL;
+		g_autoptr(GError) error_local = NULL;
+		g_autoptr(GPtrArray) gtype_ids = NULL;
+
+		if (!g_str_has_suffix(fn, ".builder.xml"))
+			continue;
+
+		/* not all builders produce something that can be parsed again */
+		filename = g_build_filename(testdatadir, fn, NULL);
+		firmware = fu_firmware_new_from_filename(filename, &error_local);
+		if (firmware == NULL) {
+			g_debug("ignoring %s: %s", fn, error_local->message);
+			continue;
+		}
+		blob = fu_firmware_write(firmware, &error_local);
+		if (blob == NULL) {
+			g_debug("ignoring %s: %s", fn, error_local->message);
+			continue;
+		}
+		stream = fu_memory_input_stream_new_from_bytes(blob);
+		gtype_ids = fu_context_get_firmware_gtype_ids_for_stream(ctx, stream, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(gtype_ids);
+		g_assert_cmpint(gtype_ids->len, <=, gtype_ids_all->len);
+
+		str_all = fu_context_test_parse_auto(ctx, stream, gtype_ids_all);
+		str_prefiltered = fu_context_test_parse_auto(ctx, stream, gtype_ids);
+		g_debug("%s parsed as: %s", fn, str_all);
+		g_assert_cmpstr(str_prefiltered, ==, str_all);
+		cnt++;
+	}
+	g_assert_cmpint(cnt, >, 0);
+}
+
 static void
 fu_context_hwids_dmi_func(void)
 {
@@ -378,6 +515,10 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/context/hwids-unset", fu_context_hwids_unset_func);
 	g_test_add_func("/fwupd/context/hwids-fdt", fu_context_hwids_fdt_func);
 	g_test_add_func("/fwupd/context/firmware-gtypes", fu_context_firmware_gtypes_func);
+	g_test_add_func("/fwupd/context/firmware-gtypes-for-stream",
+			fu_context_firmware_gtypes_for_stream_func);
+	g_test_add_func("/fwupd/context/firmware-gtypes-for-stream/corpus",
+			fu_context_firmware_gtypes_for_stream_corpus_func);
 	g_test_add_func("/fwupd/context/state", fu_context_state_func);
 	g_test_add_func("/fwupd/context/udev-subsystems", fu_context_udev_subsystems_func);
 	return g_test_run();
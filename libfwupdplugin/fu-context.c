@@ -13,6 +13,7 @@
 #endif
 
 #include "fu-bios-settings-private.h"
+#include "fu-bytes.h"
 #include "fu-common-private.h"
 #include "fu-config-private.h"
 #include "fu-context-helper.h"
@@ -22,10 +23,15 @@
 #include "fu-efi-file-path-device-path.h"
 #include "fu-efi-hard-drive-device-path.h"
 #include "fu-fdt-firmware.h"
+#include "fu-firmware-private.h"
 #include "fu-hwids-private.h"
+#include "fu-input-stream.h"
+#include "fu-mem.h"
 #include "fu-path-store.h"
 #include "fu-path.h"
+#include "fu-pefile-cache-private.h"
 #include "fu-pefile-firmware.h"
+#include "fu-quirks-private.h"
 #include "fu-volume-locker.h"
 #include "fu-volume-private.h"
 
@@ -52,6 +58,11 @@ typedef struct {
 	GHashTable *udev_subsystems; /* utf8:GPtrArray */
 	GPtrArray *esp_volumes;
 	GHashTable *firmware_gtypes; /* utf8:GType */
+	GHashTable *firmware_magic;  /* nullable, (offset,byte):GPtrArray */
+	GHashTable *firmware_magic_ids; /* nullable, utf8: */
+	GArray *firmware_magic_offsets; /* nullable, element-type gsize */
+	gsize firmware_magic_hdrsz;
+	GMutex firmware_magic_mutex;
 	GHashTable *hwid_flags;	     /* str: */
 	FuPowerState power_state;
 	FuLidState lid_state;
@@ -62,8 +73,23 @@ typedef struct {
 	FuFirmware *fdt; /* optional */
 	gchar *esp_location;
 	FuCpuVendor cpu_vendor;
+	FuPefileCache *pefile_cache;
+	gboolean pefile_cache_loaded;
+	GHashTable *instance_id_guids; /* instance-id:guid */
+	GMutex instance_id_guids_mutex;
+	guint64 instance_id_guids_hits;
+	guint64 instance_id_guids_misses;
+	GHashTable *ready_times; /* device-id:ms */
+	GMutex ready_times_mutex;
+	gboolean ready_times_loaded;
 } FuContextPrivate;
 
+typedef struct {
+	gchar *id;
+	GBytes *blob;
+	gsize offset;
+} FuContextFirmwareMagic;
+
 enum {
 	SIGNAL_SECURITY_CHANGED,
 	SIGNAL_HOUSEKEEPING,
@@ -88,6 +114,12 @@ G_DEFINE_TYPE_WITH_PRIVATE(FuContext, fu_context, G_TYPE_OBJECT)
 
 #define GET_PRIVATE(o) (fu_context_get_instance_private(o))
 
+/* the same instance IDs are generated on every replug and for every composite child */
+#define FU_CONTEXT_INSTANCE_ID_GUIDS_MAX 4096
+
+/* only a handful of devices are updated on any one machine */
+#define FU_CONTEXT_READY_TIMES_MAX 1024
+
 static gboolean
 fu_context_ensure_smbios_uefi_enabled(FuContext *self, GError **error)
 {
@@ -1105,6 +1137,110 @@ fu_context_convert_firmware_gtype_to_id(GType gtype)
 	return g_string_free(g_steal_pointer(&str), FALSE);
 }
 
+static void
+fu_context_firmware_magic_free(FuContextFirmwareMagic *magic)
+{
+	g_free(magic->id);
+	g_bytes_unref(magic->blob);
+	g_free(magic);
+}
+
+static guint64
+fu_context_firmware_magic_key(gsize offset, guint8 value)
+{
+	return ((guint64)offset << 8) | value;
+}
+
+static void
+fu_context_invalidate_firmware_magic(FuContext *self)
+{
+	FuContextPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->firmware_magic_mutex);
+	g_clear_pointer(&priv->firmware_magic, g_hash_table_unref);
+	g_clear_pointer(&priv->firmware_magic_ids, g_hash_table_unref);
+	g_clear_pointer(&priv->firmware_magic_offsets, g_array_unref);
+	priv->firmware_magic_hdrsz = 0;
+}
+
+typedef struct {
+	FuContext *self;
+	const gchar *id;
+} FuContextFirmwareMagicHelper;
+
+static void
+fu_context_add_firmware_magic_cb(FuFirmware *firmware,
+				 GBytes *blob,
+				 gsize offset,
+				 gpointer user_data)
+{
+	FuContextFirmwareMagicHelper *helper = (FuContextFirmwareMagicHelper *)user_data;
+	FuContextPrivate *priv = GET_PRIVATE(helper->self);
+	const guint8 *buf = g_bytes_get_data(blob, NULL);
+	guint64 key = fu_context_firmware_magic_key(offset, buf[0]);
+	FuContextFirmwareMagic *magic = g_new0(FuContextFirmwareMagic, 1);
+	GPtrArray *magics = g_hash_table_lookup(priv->firmware_magic, &key);
+
+	if (magics == NULL) {
+		magics = g_ptr_array_new_with_free_func(
+		    (GDestroyNotify)fu_context_firmware_magic_free);
+		g_hash_table_insert(priv->firmware_magic, g_memdup2(&key, sizeof(key)), magics);
+	}
+	magic->id = g_strdup(helper->id);
+	magic->blob = g_bytes_ref(blob);
+	magic->offset = offset;
+	g_ptr_array_add(magics, magic);
+	g_hash_table_add(priv->firmware_magic_ids, g_strdup(helper->id));
+	priv->firmware_magic_hdrsz =
+	    MAX(priv->firmware_magic_hdrsz, offset + g_bytes_get_size(blob));
+	for (guint i = 0; i < priv->firmware_magic_offsets->len; i++) {
+		if (g_array_index(priv->firmware_magic_offsets, gsize, i) == offset)
+			return;
+	}
+	g_array_append_val(priv->firmware_magic_offsets, offset);
+}
+
+/* index the magic of every type so that a header can be matched with one lookup per offset */
+static void
+fu_context_ensure_firmware_magic(FuContext *self)
+{
+	FuContextPrivate *priv = GET_PRIVATE(self);
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	if (priv->firmware_magic != NULL)
+		return;
+	priv->firmware_magic = g_hash_table_new_full(g_int64_hash,
+						     g_int64_equal,
+						     g_free,
+						     (GDestroyNotify)g_ptr_array_unref);
+	priv->firmware_magic_ids = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	priv->firmware_magic_offsets = g_array_new(FALSE, FALSE, sizeof(gsize));
+	g_hash_table_iter_init(&iter, priv->firmware_gtypes);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		FuContextFirmwareMagicHelper helper = {.self = self, .id = key};
+		g_autoptr(FuFirmware) firmware = g_object_new(GPOINTER_TO_SIZE(value), NULL);
+
+		/* the magic is only used with ->validate(), and can be anywhere when searching */
+		if (FU_FIRMWARE_GET_CLASS(firmware)->validate == NULL ||
+		    fu_firmware_has_flag(firmware, FU_FIRMWARE_FLAG_ALWAYS_SEARCH))
+			continue;
+		fu_firmware_magic_foreach(firmware, fu_context_add_firmware_magic_cb, &helper);
+	}
+}
+
+static gint
+fu_context_firmware_magic_sort_cb(gconstpointer a, gconstpointer b)
+{
+	FuContextFirmwareMagic *magic1 = *((FuContextFirmwareMagic **)a);
+	FuContextFirmwareMagic *magic2 = *((FuContextFirmwareMagic **)b);
+	gsize size1 = g_bytes_get_size(magic1->blob);
+	gsize size2 = g_bytes_get_size(magic2->blob);
+	if (size1 != size2)
+		return size1 < size2 ? 1 : -1;
+	return g_strcmp0(magic1->id, magic2->id);
+}
+
 /**
  * fu_context_add_firmware_gtype:
  * @self: a #FuContext
@@ -1128,6 +1264,7 @@ fu_context_add_firmware_gtype(FuContext *self, GType gtype)
 	g_hash_table_insert(priv->firmware_gtypes,
 			    fu_context_convert_firmware_gtype_to_id(gtype),
 			    GSIZE_TO_POINTER(gtype));
+	fu_context_invalidate_firmware_magic(self);
 }
 
 /**
@@ -1185,6 +1322,104 @@ fu_context_get_firmware_gtype_ids(FuContext *self)
 	return firmware_gtypes;
 }
 
+/**
+ * fu_context_get_firmware_gtype_ids_for_stream:
+ * @self: a #FuContext
+ * @stream: a #FuInputStream
+ * @error: (nullable): optional return location for an error
+ *
+ * Returns the firmware #GType IDs that could parse @stream without searching, most likely first.
+ *
+ * Types that have magic are only included when the magic is found at the expected offset, with
+ * the longest match first. Types without any magic cannot be ruled out and are always included
+ * afterwards, sorted by ID.
+ *
+ * Returns: (transfer container) (element-type utf8): firmware IDs, or %NULL on error
+ *
+ * Since: 2.2.1
+ **/
+GPtrArray *
+fu_context_get_firmware_gtype_ids_for_stream(FuContext *self,
+					     FuInputStream *stream,
+					     GError **error)
+{
+	FuContextPrivate *priv = GET_PRIVATE(self);
+	gsize streamsz = 0;
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GHashTable) ids_found = g_hash_table_new(g_str_hash, g_str_equal);
+	g_autoptr(GMutexLocker) locker = NULL;
+	g_autoptr(GPtrArray) gtype_ids = NULL;
+	g_autoptr(GPtrArray) ids = g_ptr_array_new_with_free_func(g_free);
+	g_autoptr(GPtrArray) magics = g_ptr_array_new();
+
+	g_return_val_if_fail(FU_IS_CONTEXT(self), NULL);
+	g_return_val_if_fail(FU_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* read the header just once */
+	if (!fu_input_stream_size(stream, &streamsz, error))
+		return NULL;
+	locker = g_mutex_locker_new(&priv->firmware_magic_mutex);
+	fu_context_ensure_firmware_magic(self);
+	if (MIN(streamsz, priv->firmware_magic_hdrsz) > 0) {
+		g_byte_array_unref(buf);
+		buf = fu_input_stream_read_byte_array(stream,
+						      0x0,
+						      MIN(streamsz, priv->firmware_magic_hdrsz),
+						      NULL,
+						      error);
+		if (buf == NULL)
+			return NULL;
+	}
+
+	/* find all the magic that matches */
+	for (guint i = 0; i < priv->firmware_magic_offsets->len; i++) {
+		gsize offset = g_array_index(priv->firmware_magic_offsets, gsize, i);
+		guint64 key;
+		GPtrArray *magics_tmp;
+
+		if (offset >= buf->len)
+			continue;
+		key = fu_context_firmware_magic_key(offset, buf->data[offset]);
+		magics_tmp = g_hash_table_lookup(priv->firmware_magic, &key);
+		if (magics_tmp == NULL)
+			continue;
+		for (guint j = 0; j < magics_tmp->len; j++) {
+			FuContextFirmwareMagic *magic = g_ptr_array_index(magics_tmp, j);
+			gsize magicsz = 0;
+			const guint8 *magicbuf = g_bytes_get_data(magic->blob, &magicsz);
+			if (!fu_memcmp_safe(buf->data,
+					    buf->len,
+					    offset,
+					    magicbuf,
+					    magicsz,
+					    0x0,
+					    magicsz,
+					    NULL))
+				continue;
+			g_ptr_array_add(magics, magic);
+		}
+	}
+
+	/* a longer magic is less likely to be a coincidence */
+	g_ptr_array_sort(magics, fu_context_firmware_magic_sort_cb);
+	for (guint i = 0; i < magics->len; i++) {
+		FuContextFirmwareMagic *magic = g_ptr_array_index(magics, i);
+		if (g_hash_table_add(ids_found, magic->id))
+			g_ptr_array_add(ids, g_strdup(magic->id));
+	}
+
+	/* then everything that does not have magic */
+	gtype_ids = fu_context_get_firmware_gtype_ids(self);
+	for (guint i = 0; i < gtype_ids->len; i++) {
+		const gchar *id = g_ptr_array_index(gtype_ids, i);
+		if (g_hash_table_contains(priv->firmware_magic_ids, id))
+			continue;
+		g_ptr_array_add(ids, g_strdup(id));
+	}
+	return g_steal_pointer(&ids);
+}
+
 /**
  * fu_context_get_firmware_gtypes:
  * @self: a #FuContext
@@ -1344,10 +1579,56 @@ fu_context_security_changed(FuContext *self)
 void
 fu_context_housekeeping(FuContext *self)
 {
+	FuContextPrivate *priv = GET_PRIVATE(self);
+
 	g_return_if_fail(FU_IS_CONTEXT(self));
+
+	g_debug("instance ID GUIDs: %" G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT " misses",
+		priv->instance_id_guids_hits,
+		priv->instance_id_guids_misses);
+	g_debug("quirk results: %" G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT " misses",
+		fu_quirks_get_results_hits(priv->quirks),
+		fu_quirks_get_results_misses(priv->quirks));
 	g_signal_emit(self, signals[SIGNAL_HOUSEKEEPING], 0);
 }
 
+/**
+ * fu_context_get_instance_id_guid: (skip)
+ * @self: a #FuContext
+ * @instance_id: an instance ID, e.g. `USB\VID_273F&PID_1004`
+ *
+ * Gets the GUID for an instance ID, using a cached value if the same instance ID has been hashed
+ * before.
+ *
+ * Returns: (transfer full): a GUID
+ *
+ * Since: 2.2.1
+ **/
+gchar *
+fu_context_get_instance_id_guid(FuContext *self, const gchar *instance_id)
+{
+	FuContextPrivate *priv = GET_PRIVATE(self);
+	const gchar *guid_tmp;
+	gchar *guid;
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	g_return_val_if_fail(FU_IS_CONTEXT(self), NULL);
+	g_return_val_if_fail(instance_id != NULL, NULL);
+
+	locker = g_mutex_locker_new(&priv->instance_id_guids_mutex);
+	guid_tmp = g_hash_table_lookup(priv->instance_id_guids, instance_id);
+	if (guid_tmp != NULL) {
+		priv->instance_id_guids_hits++;
+		return g_strdup(guid_tmp);
+	}
+	priv->instance_id_guids_misses++;
+	guid = fwupd_guid_hash_string(instance_id);
+	if (g_hash_table_size(priv->instance_id_guids) >= FU_CONTEXT_INSTANCE_ID_GUIDS_MAX)
+		g_hash_table_remove_all(priv->instance_id_guids);
+	g_hash_table_insert(priv->instance_id_guids, g_strdup(instance_id), g_strdup(guid));
+	return guid;
+}
+
 typedef gboolean (*FuContextHwidsSetupFunc)(FuContext *self, FuHwids *hwids, GError **error);
 
 static void
@@ -2158,11 +2439,17 @@ static gboolean
 fu_context_is_esp_linux(FuVolume *esp, GError **error)
 {
 	const gchar *prefixes[] = {"grub", "shim", "systemd-boot", "zfsbootmenu", NULL};
+	const gchar *dirs[] = {
+	    "EFI/*/",	/* e.g. EFI/BOOT/ or EFI/fedora/ */
+	    "EFI/",	/* installed without a vendor directory */
+	    "",		/* installed in the root of the ESP */
+	    "EFI/*/*/", /* e.g. EFI/ubuntu/grub/ */
+	    NULL,
+	};
 	g_autofree gchar *prefixes_str = NULL;
 	g_autofree gchar *mount_point = fu_volume_get_mount_point(esp);
-	g_autoptr(GPtrArray) files = NULL;
 
-	/* look for any likely basenames */
+	/* look for any likely basenames in the places bootloaders are installed */
 	if (mount_point == NULL) {
 		g_set_error_literal(error,
 				    FWUPD_ERROR,
@@ -2170,20 +2457,29 @@ fu_context_is_esp_linux(FuVolume *esp, GError **error)
 				    "no mountpoint for ESP");
 		return FALSE;
 	}
-	files = fu_path_get_files(mount_point, error);
-	if (files == NULL)
-		return FALSE;
-	for (guint i = 0; i < files->len; i++) {
-		const gchar *fn = g_ptr_array_index(files, i);
-		g_autofree gchar *basename = g_path_get_basename(fn);
-		g_autofree gchar *basename_lower = g_utf8_strdown(basename, -1);
+	for (guint j = 0; dirs[j] != NULL; j++) {
+		for (guint i = 0; prefixes[i] != NULL; i++) {
+			g_autofree gchar *pattern =
+			    g_strdup_printf("%s%s*.efi", dirs[j], prefixes[i]);
+			g_autoptr(GPtrArray) files = NULL;
+			g_autoptr(GError) error_local = NULL;
 
-		for (guint j = 0; prefixes[j] != NULL; j++) {
-			if (!g_str_has_prefix(basename_lower, prefixes[j]))
-				continue;
-			if (!g_str_has_suffix(basename_lower, ".efi"))
-				continue;
-			g_info("found %s which indicates a Linux ESP, using %s", fn, mount_point);
+			files = fu_volume_glob(esp,
+					       pattern,
+					       FU_PATH_GLOB_FLAG_CASE_INSENSITIVE |
+						   FU_PATH_GLOB_FLAG_FIRST_MATCH,
+					       &error_local);
+			if (files == NULL) {
+				if (g_error_matches(error_local,
+						    FWUPD_ERROR,
+						    FWUPD_ERROR_NOT_FOUND))
+					continue;
+				g_propagate_error(error, g_steal_pointer(&error_local));
+				return FALSE;
+			}
+			g_info("found %s which indicates a Linux ESP, using %s",
+			       (const gchar *)g_ptr_array_index(files, 0),
+			       mount_point);
 			return TRUE;
 		}
 	}
@@ -2387,13 +2683,66 @@ fu_context_get_esp_volume_by_hard_drive_device_path(FuContext *self,
 	return NULL;
 }
 
+static gchar *
+fu_context_get_pefile_cache_filename(FuContext *self, GError **error)
+{
+	if (fu_context_has_flag(self, FU_CONTEXT_FLAG_NO_CACHE)) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "caching is disabled");
+		return NULL;
+	}
+	return fu_context_build_filename(self,
+					 error,
+					 FU_PATH_KIND_CACHEDIR_PKG,
+					 "pefile.json",
+					 NULL);
+}
+
+static void
+fu_context_pefile_cache_load(FuContext *self)
+{
+	FuContextPrivate *priv = GET_PRIVATE(self);
+	g_autofree gchar *filename = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	if (priv->pefile_cache_loaded)
+		return;
+	priv->pefile_cache_loaded = TRUE;
+	filename = fu_context_get_pefile_cache_filename(self, &error_local);
+	if (filename == NULL) {
+		g_debug("not loading PE cache: %s", error_local->message);
+		return;
+	}
+	if (!fu_pefile_cache_load(priv->pefile_cache, filename, &error_local))
+		g_debug("failed to load PE cache %s: %s", filename, error_local->message);
+}
+
+static void
+fu_context_pefile_cache_save(FuContext *self)
+{
+	FuContextPrivate *priv = GET_PRIVATE(self);
+	g_autofree gchar *filename = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	filename = fu_context_get_pefile_cache_filename(self, &error_local);
+	if (filename == NULL) {
+		g_debug("not saving PE cache: %s", error_local->message);
+		return;
+	}
+	if (!fu_pefile_cache_save(priv->pefile_cache, filename, &error_local))
+		g_debug("failed to save PE cache %s: %s", filename, error_local->message);
+}
+
 static FuFirmware *
-fu_context_esp_load_pe_file(const gchar *filename, GError **error)
+fu_context_esp_load_pe_file(FuContext *self, const gchar *filename, GError **error)
 {
-	g_autoptr(FuFirmware) firmware = fu_pefile_firmware_new();
-	g_autoptr(GFile) file = g_file_new_for_path(filename);
-	fu_firmware_set_filename(firmware, filename);
-	if (!fu_firmware_parse_file(firmware, file, FU_FIRMWARE_PARSE_FLAG_NONE, error)) {
+	FuContextPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(FuFirmware) firmware = NULL;
+
+	firmware = fu_pefile_cache_parse_file(priv->pefile_cache, filename, error);
+	if (firmware == NULL) {
 		g_prefix_error(error, "failed to load %s: ", filename);
 		return NULL;
 	}
@@ -2493,7 +2842,7 @@ fu_context_get_esp_files_for_entry(FuContext *self,
 		g_autoptr(GError) error_local = NULL;
 
 		/* ignore if the file cannot be loaded as a PE file */
-		firmware = fu_context_esp_load_pe_file(filename, &error_local);
+		firmware = fu_context_esp_load_pe_file(self, filename, &error_local);
 		if (firmware == NULL) {
 			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED) ||
 			    g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE)) {
@@ -2528,7 +2877,7 @@ fu_context_get_esp_files_for_entry(FuContext *self,
 		g_debug("check for 2nd stage bootloader: %s", filename2->str);
 
 		/* ignore if the file cannot be loaded as a PE file */
-		firmware = fu_context_esp_load_pe_file(filename2->str, &error_local);
+		firmware = fu_context_esp_load_pe_file(self, filename2->str, &error_local);
 		if (firmware == NULL) {
 			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED) ||
 			    g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE)) {
@@ -2554,7 +2903,7 @@ fu_context_get_esp_files_for_entry(FuContext *self,
 		g_debug("check for revocation: %s", filename2->str);
 
 		/* ignore if the file cannot be loaded as a PE file */
-		firmware = fu_context_esp_load_pe_file(filename2->str, &error_local);
+		firmware = fu_context_esp_load_pe_file(self, filename2->str, &error_local);
 		if (firmware == NULL) {
 			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED) ||
 			    g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE)) {
@@ -2598,6 +2947,7 @@ fu_context_get_esp_files(FuContext *self, FuContextEspFileFlags flags, GError **
 	entries = fu_efivars_get_boot_entries(priv->efivars, error);
 	if (entries == NULL)
 		return NULL;
+	fu_context_pefile_cache_load(self);
 	for (guint i = 0; i < entries->len; i++) {
 		FuEfiLoadOption *entry = g_ptr_array_index(entries, i);
 		g_autoptr(GError) error_local = NULL;
@@ -2615,6 +2965,9 @@ fu_context_get_esp_files(FuContext *self, FuContextEspFileFlags flags, GError **
 		}
 	}
 
+	/* only writes if any checksums were calculated */
+	fu_context_pefile_cache_save(self);
+
 	/* success */
 	return g_steal_pointer(&files);
 }
@@ -2704,6 +3057,175 @@ fu_context_has_backend(FuContext *self, const gchar *name)
 	return FALSE;
 }
 
+static gchar *
+fu_context_get_ready_times_filename(FuContext *self, GError **error)
+{
+	if (fu_context_has_flag(self, FU_CONTEXT_FLAG_NO_CACHE)) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "caching is disabled");
+		return NULL;
+	}
+	return fu_context_build_filename(self,
+					 error,
+					 FU_PATH_KIND_CACHEDIR_PKG,
+					 "ready.json",
+					 NULL);
+}
+
+static gboolean
+fu_context_ready_times_load_file(FuContext *self, const gchar *filename, GError **error)
+{
+	FuContextPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(FwupdJsonArray) json_arr = NULL;
+	g_autoptr(FwupdJsonNode) json_node = NULL;
+	g_autoptr(FwupdJsonObject) json_obj = NULL;
+	g_autoptr(FwupdJsonParser) json_parser = fwupd_json_parser_new();
+	g_autoptr(GBytes) blob = NULL;
+
+	/* nothing saved yet */
+	if (!g_file_test(filename, G_FILE_TEST_EXISTS))
+		return TRUE;
+
+	/* set appropriate limits */
+	fwupd_json_parser_set_max_depth(json_parser, 5);
+	fwupd_json_parser_set_max_items(json_parser, FU_CONTEXT_READY_TIMES_MAX * 3);
+
+	blob = fu_bytes_get_contents(filename, error);
+	if (blob == NULL)
+		return FALSE;
+	json_node =
+	    fwupd_json_parser_load_from_bytes(json_parser, blob, FWUPD_JSON_LOAD_FLAG_NONE, error);
+	if (json_node == NULL)
+		return FALSE;
+	json_obj = fwupd_json_node_get_object(json_node, error);
+	if (json_obj == NULL)
+		return FALSE;
+	json_arr = fwupd_json_object_get_array(json_obj, "Devices", error);
+	if (json_arr == NULL)
+		return FALSE;
+	for (guint i = 0; i < fwupd_json_array_get_size(json_arr); i++) {
+		gint64 ready_time = 0;
+		g_autoptr(FwupdJsonObject) json_item = NULL;
+		g_autoptr(GRefString) device_id = NULL;
+
+		json_item = fwupd_json_array_get_object(json_arr, i, error);
+		if (json_item == NULL)
+			return FALSE;
+		device_id = fwupd_json_object_get_string(json_item, "DeviceId", error);
+		if (device_id == NULL)
+			return FALSE;
+		if (!fwupd_json_object_get_integer(json_item, "ReadyTime", &ready_time, error))
+			return FALSE;
+		if (ready_time <= 0 || ready_time > G_MAXUINT) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "invalid ready time for %s",
+				    device_id);
+			return FALSE;
+		}
+		g_hash_table_insert(priv->ready_times,
+				    g_strdup(device_id),
+				    GUINT_TO_POINTER((guint)ready_time));
+	}
+
+	/* success */
+	return TRUE;
+}
+
+/* must be called with ready_times_mutex held */
+static void
+fu_context_ready_times_load(FuContext *self)
+{
+	FuContextPrivate *priv = GET_PRIVATE(self);
+	g_autofree gchar *filename = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	if (priv->ready_times_loaded)
+		return;
+	priv->ready_times_loaded = TRUE;
+	filename = fu_context_get_ready_times_filename(self, &error_local);
+	if (filename == NULL) {
+		g_debug("not loading ready times: %s", error_local->message);
+		return;
+	}
+	if (!fu_context_ready_times_load_file(self, filename, &error_local)) {
+		g_debug("failed to load ready times %s: %s", filename, error_local->message);
+		g_hash_table_remove_all(priv->ready_times);
+	}
+}
+
+/* must be called with ready_times_mutex held */
+static void
+fu_context_ready_times_save(FuContext *self)
+{
+	FuContextPrivate *priv = GET_PRIVATE(self);
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	g_autofree gchar *filename = NULL;
+	g_autoptr(FwupdJsonArray) json_arr = fwupd_json_array_new();
+	g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	filename = fu_context_get_ready_times_filename(self, &error_local);
+	if (filename == NULL) {
+		g_debug("not saving ready times: %s", error_local->message);
+		return;
+	}
+	g_hash_table_iter_init(&iter, priv->ready_times);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		g_autoptr(FwupdJsonObject) json_item = fwupd_json_object_new();
+		fwupd_json_object_add_string(json_item, "DeviceId", (const gchar *)key);
+		fwupd_json_object_add_integer(json_item, "ReadyTime", GPOINTER_TO_UINT(value));
+		fwupd_json_array_add_object(json_arr, json_item);
+	}
+	fwupd_json_object_add_array(json_obj, "Devices", json_arr);
+	blob = fwupd_json_object_to_bytes(json_obj, FWUPD_JSON_EXPORT_FLAG_TRAILING_NEWLINE);
+	if (!fu_bytes_set_contents(filename, blob, &error_local))
+		g_debug("failed to save ready times %s: %s", filename, error_local->message);
+}
+
+/* private */
+guint
+fu_context_get_ready_time(FuContext *self, const gchar *device_id)
+{
+	FuContextPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->ready_times_mutex);
+
+	g_return_val_if_fail(FU_IS_CONTEXT(self), 0);
+	g_return_val_if_fail(device_id != NULL, 0);
+
+	fu_context_ready_times_load(self);
+	return GPOINTER_TO_UINT(g_hash_table_lookup(priv->ready_times, device_id));
+}
+
+/* private */
+void
+fu_context_set_ready_time(FuContext *self, const gchar *device_id, guint ready_time)
+{
+	FuContextPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&priv->ready_times_mutex);
+
+	g_return_if_fail(FU_IS_CONTEXT(self));
+	g_return_if_fail(device_id != NULL);
+	g_return_if_fail(ready_time > 0);
+
+	fu_context_ready_times_load(self);
+	if (GPOINTER_TO_UINT(g_hash_table_lookup(priv->ready_times, device_id)) == ready_time)
+		return;
+	if (g_hash_table_size(priv->ready_times) >= FU_CONTEXT_READY_TIMES_MAX &&
+	    !g_hash_table_contains(priv->ready_times, device_id)) {
+		g_debug("too many ready times, not saving %s", device_id);
+		return;
+	}
+	g_hash_table_insert(priv->ready_times, g_strdup(device_id), GUINT_TO_POINTER(ready_time));
+	fu_context_ready_times_save(self);
+}
+
 /* private */
 gpointer
 fu_context_get_data(FuContext *self, const gchar *key)
@@ -2934,6 +3456,7 @@ fu_context_finalize(GObject *object)
 	FuContextPrivate *priv = GET_PRIVATE(self);
 
 	g_clear_pointer(&priv->main_ctx, g_main_context_unref);
+	fu_common_free_block_devices();
 	if (priv->fdt != NULL)
 		g_object_unref(priv->fdt);
 	if (priv->efivars != NULL)
@@ -2942,6 +3465,11 @@ fu_context_finalize(GObject *object)
 	g_hash_table_unref(priv->runtime_versions);
 	g_hash_table_unref(priv->compile_versions);
 	g_object_unref(priv->pstore);
+	g_object_unref(priv->pefile_cache);
+	g_hash_table_unref(priv->instance_id_guids);
+	g_mutex_clear(&priv->instance_id_guids_mutex);
+	g_hash_table_unref(priv->ready_times);
+	g_mutex_clear(&priv->ready_times_mutex);
 	g_object_unref(priv->hwids);
 	g_object_unref(priv->config);
 	g_hash_table_unref(priv->hwid_flags);
@@ -2949,6 +3477,13 @@ fu_context_finalize(GObject *object)
 	g_object_unref(priv->smbios);
 	g_object_unref(priv->host_bios_settings);
 	g_hash_table_unref(priv->firmware_gtypes);
+	if (priv->firmware_magic != NULL)
+		g_hash_table_unref(priv->firmware_magic);
+	if (priv->firmware_magic_ids != NULL)
+		g_hash_table_unref(priv->firmware_magic_ids);
+	if (priv->firmware_magic_offsets != NULL)
+		g_array_unref(priv->firmware_magic_offsets);
+	g_mutex_clear(&priv->firmware_magic_mutex);
 	g_hash_table_unref(priv->udev_subsystems);
 	g_ptr_array_unref(priv->esp_volumes);
 	g_ptr_array_unref(priv->backends);
@@ -3147,6 +3682,11 @@ fu_context_init(FuContext *self)
 	priv->battery_level = FWUPD_BATTERY_LEVEL_INVALID;
 	priv->battery_threshold = FWUPD_BATTERY_LEVEL_INVALID;
 	priv->pstore = fu_path_store_new();
+	priv->pefile_cache = fu_pefile_cache_new();
+	priv->instance_id_guids = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	g_mutex_init(&priv->instance_id_guids_mutex);
+	priv->ready_times = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	g_mutex_init(&priv->ready_times_mutex);
 	priv->smbios = fu_smbios_new(priv->pstore);
 	priv->hwids = fu_hwids_new();
 	priv->config = fu_config_new(priv->pstore);
@@ -3156,6 +3696,7 @@ fu_context_init(FuContext *self)
 						      g_free,
 						      (GDestroyNotify)g_ptr_array_unref);
 	priv->firmware_gtypes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	g_mutex_init(&priv->firmware_magic_mutex);
 	priv->quirks = fu_quirks_new(self);
 	priv->host_bios_settings = fu_bios_settings_new(self);
 	priv->esp_volumes = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
@@ -10,6 +10,7 @@
 
 #include "fu-backend.h"
 #include "fu-device.h"
+#include "fu-version-common.h"
 
 G_BEGIN_DECLS
 
@@ -108,5 +109,7 @@ fu_device_from_json(FuDevice *self, FwupdJsonObject *json_obj, GError **error)
     G_GNUC_NON_NULL(1, 2);
 gchar *
 fu_device_convert_version(FuDevice *self, guint64 version_raw, GError **error) G_GNUC_NON_NULL(1);
+FuVersionKey *
+fu_device_get_version_key(FuDevice *self) G_GNUC_NON_NULL(1);
 
 G_END_DECLS
@@ -289,6 +289,153 @@ fu_device_poll_cb(FuDevice *device, GError **error)
 	return G_SOURCE_CONTINUE;
 }
 
+static gboolean
+fu_device_check_ready_cb(FuDevice *device, GError **error)
+{
+	guint64 cnt = fu_device_get_metadata_integer(device, "cnt");
+	fu_device_set_metadata_integer(device, "cnt", cnt + 1);
+	if (cnt < 2) {
+		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_BUSY, "not ready");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static void
+fu_device_poll_until_ready_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuDevice) device = fu_device_new(ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GError) error = NULL;
+	FuDeviceClass *klass = FU_DEVICE_GET_CLASS(device);
+
+	/* set up test harness */
+	tmpdir = fu_temporary_directory_new("device-poll-until-ready", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_CACHEDIR_PKG, tmpdir);
+	fu_device_set_id(device, "USB\\VID_273F&PID_1004");
+	klass->check_ready = fu_device_check_ready_cb;
+
+	/* ready on the third check, well before the worst case */
+	fu_device_set_metadata_integer(device, "cnt", 0);
+	ret = fu_device_poll_until_ready(device, 5000, progress, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_device_get_metadata_integer(device, "cnt"), ==, 3);
+	g_assert_cmpint(fu_context_get_ready_time(ctx, fu_device_get_id(device)), >, 0);
+	g_assert_cmpint(fu_context_get_ready_time(ctx, fu_device_get_id(device)), <, 5000);
+
+	/* the quirk sets the worst case */
+	fu_device_set_metadata_integer(device, "cnt", 0);
+	fu_device_set_ready_timeout(device, 1);
+	ret = fu_device_poll_until_ready(device, 5000, progress, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_BUSY);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* emulated devices never sleep */
+	fu_device_set_metadata_integer(device, "cnt", 0);
+	fu_device_add_flag(device, FWUPD_DEVICE_FLAG_EMULATED);
+	ret = fu_device_poll_until_ready(device, 5000, progress, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_device_get_metadata_integer(device, "cnt"), ==, 3);
+
+	klass->check_ready = NULL;
+}
+
+static gboolean
+fu_device_read_data_cb(FuDevice *device, guint32 address, guint8 *buf, gsize bufsz, GError **error)
+{
+	const guint8 mem[] = "xxhello worldxxxx";
+	return fu_memcpy_safe(buf, bufsz, 0x0, mem, sizeof(mem), address, bufsz, error);
+}
+
+static gboolean
+fu_device_read_crc_cb(FuDevice *device,
+		      FuCrcKind kind,
+		      guint32 address,
+		      gsize bufsz,
+		      guint32 *crc,
+		      GError **error)
+{
+	g_assert_cmpint(kind, ==, FU_CRC_KIND_B32_STANDARD);
+	g_assert_cmpint(address, ==, 0x2);
+	g_assert_cmpint(bufsz, ==, 11);
+	*crc = fu_device_get_metadata_integer(device, "crc");
+	return TRUE;
+}
+
+static GBytes *
+fu_device_dump_firmware_cb(FuDevice *device, FuProgress *progress, GError **error)
+{
+	return g_bytes_new_static("hello worldxxxx", 15);
+}
+
+static void
+fu_device_verify_crc_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuDevice) device = fu_device_new(NULL);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GBytes) blob = g_bytes_new_static("hello world", 11);
+	g_autoptr(GError) error = NULL;
+	FuDeviceClass *klass = FU_DEVICE_GET_CLASS(device);
+
+	/* neither vfunc */
+	ret = fu_device_verify_crc(device, FU_CRC_KIND_B32_STANDARD, 0x2, blob, progress, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* read back */
+	klass->dump_firmware = fu_device_dump_firmware_cb;
+	ret = fu_device_verify_crc(device, FU_CRC_KIND_B32_STANDARD, 0x0, blob, progress, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* the dumped image has no base address */
+	ret = fu_device_verify_crc(device, FU_CRC_KIND_B32_STANDARD, 0x2, blob, progress, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* read back the range */
+	klass->read_data = fu_device_read_data_cb;
+	fu_progress_reset(progress);
+	ret = fu_device_verify_crc(device, FU_CRC_KIND_B32_STANDARD, 0x2, blob, progress, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_progress_reset(progress);
+	ret = fu_device_verify_crc(device, FU_CRC_KIND_B32_STANDARD, 0x3, blob, progress, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* device calculates CRC */
+	klass->read_crc = fu_device_read_crc_cb;
+	fu_device_set_metadata_integer(device,
+				       "crc",
+				       fu_crc32_bytes(FU_CRC_KIND_B32_STANDARD, blob));
+	ret = fu_device_verify_crc(device, FU_CRC_KIND_B32_STANDARD, 0x2, blob, progress, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* wrong CRC */
+	fu_device_set_metadata_integer(device, "crc", 0x12345678);
+	ret = fu_device_verify_crc(device, FU_CRC_KIND_B32_STANDARD, 0x2, blob, progress, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
+
+	klass->dump_firmware = NULL;
+	klass->read_crc = NULL;
+	klass->read_data = NULL;
+}
+
 static void
 fu_device_poll_func(void)
 {
@@ -962,6 +1109,78 @@ fu_device_retry_hardware_func(void)
 	g_assert_cmpint(helper.cnt_failed, ==, 2);
 }
 
+static void
+fu_device_retry_policy_func(void)
+{
+	gboolean ret;
+	const gchar *stats;
+	gint64 attempts = 0;
+	g_autoptr(FuDevice) device = fu_device_new(NULL);
+	g_autoptr(FwupdJsonArray) json_arr = NULL;
+	g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+	g_autoptr(FwupdJsonObject) json_stats = NULL;
+	g_autoptr(GHashTable) metadata = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+	FuDeviceRetryHelper helper = {
+	    .cnt_success = 0,
+	    .cnt_failed = 0,
+	};
+
+	/* delays of 50ms and 100ms rather than 400ms each */
+	fu_device_set_retry_policy(device, FU_DEVICE_RETRY_POLICY_EXPONENTIAL);
+	ret = fu_device_retry_full(device,
+				   fu_device_retry_success_3rd_try_cb,
+				   3,
+				   400,
+				   &helper,
+				   &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(helper.cnt_success, ==, 1);
+	g_assert_cmpint(helper.cnt_failed, ==, 2);
+	g_assert_cmpfloat(g_timer_elapsed(timer, NULL), <, 0.6);
+
+	/* keeps trying until 400ms has passed, even though only 2 tries were requested */
+	helper.cnt_success = 0;
+	helper.cnt_failed = 0;
+	fu_device_set_retry_policy(device, FU_DEVICE_RETRY_POLICY_DEADLINE);
+	ret = fu_device_retry_full(device,
+				   fu_device_retry_success_3rd_try_cb,
+				   2,
+				   400,
+				   &helper,
+				   &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(helper.cnt_success, ==, 1);
+	g_assert_cmpint(helper.cnt_failed, ==, 2);
+
+	/* both calls were recorded */
+	metadata = fu_device_report_metadata_post(device);
+	g_assert_nonnull(metadata);
+	stats = g_hash_table_lookup(metadata, "RetryStats:fu_device_retry_policy_func");
+	g_assert_nonnull(stats);
+	g_assert_true(g_str_has_prefix(stats, "Calls=2,Attempts=6,Failures=0,"));
+
+	/* also shown in get-devices --json */
+	fwupd_codec_to_json(FWUPD_CODEC(device), json_obj, FWUPD_CODEC_FLAG_NONE);
+	json_arr = fwupd_json_object_get_array(json_obj, "RetryStats", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(json_arr);
+	g_assert_cmpint(fwupd_json_array_get_size(json_arr), ==, 1);
+	json_stats = fwupd_json_array_get_object(json_arr, 0, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(json_stats);
+	g_assert_cmpstr(fwupd_json_object_get_string(json_stats, "Id", NULL),
+			==,
+			"fu_device_retry_policy_func");
+	ret = fwupd_json_object_get_integer(json_stats, "Attempts", &attempts, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(attempts, ==, 6);
+}
+
 static void
 fu_device_possible_plugin_func(void)
 {
@@ -1080,8 +1299,11 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/device/version-format", fu_device_version_format_func);
 	g_test_add_func("/fwupd/device/version-format-raw", fu_device_version_format_raw_func);
 	g_test_add_func("/fwupd/device/retry-success", fu_device_retry_success_func);
+	g_test_add_func("/fwupd/device/poll-until-ready", fu_device_poll_until_ready_func);
+	g_test_add_func("/fwupd/device/verify-crc", fu_device_verify_crc_func);
 	g_test_add_func("/fwupd/device/retry-failed", fu_device_retry_failed_func);
 	g_test_add_func("/fwupd/device/retry-hardware", fu_device_retry_hardware_func);
+	g_test_add_func("/fwupd/device/retry-policy", fu_device_retry_policy_func);
 	g_test_add_func("/fwupd/device/cfi-device", fu_device_cfi_device_func);
 	g_test_add_func("/fwupd/device/progress", fu_device_progress_func);
 	g_test_add_func("/fwupd/device/inhibit-children", fu_device_inhibit_children_func);
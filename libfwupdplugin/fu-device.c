@@ -18,10 +18,13 @@
 #include "fu-byte-array.h"
 #include "fu-bytes.h"
 #include "fu-chunk-array.h"
+#include "fu-common.h"
+#include "fu-context-private.h"
 #include "fu-device-event-private.h"
 #include "fu-device-poll-locker.h"
 #include "fu-device-private.h"
 #include "fu-input-stream.h"
+#include "fu-mem.h"
 #include "fu-memory-input-stream.h"
 #include "fu-output-stream.h"
 #include "fu-progress-private.h"
@@ -33,6 +36,16 @@
 #define FU_DEVICE_RETRY_OPEN_COUNT 5
 #define FU_DEVICE_RETRY_OPEN_DELAY 500 /* ms */
 
+#define FU_DEVICE_READY_DELAY_MIN   10      /* ms */
+#define FU_DEVICE_READY_TIMEOUT_MAX 1000000 /* ms */
+#define FU_DEVICE_READY_CHECKS_MAX  100
+
+/* the first backoff is this fraction of the delay */
+#define FU_DEVICE_RETRY_BACKOFF_DIVISOR 8
+
+/* read back in small chunks when the device cannot calculate the CRC */
+#define FU_DEVICE_VERIFY_CHUNK_SIZE 0x1000
+
 /**
  * FuDevice:
  *
@@ -80,6 +93,7 @@ typedef struct {
 	guint remove_delay;    /* ms */
 	guint acquiesce_delay; /* ms */
 	guint poll_interval;   /* ms */
+	guint ready_timeout;   /* ms */
 	guint request_cnts[FWUPD_REQUEST_KIND_LAST];
 	gint order;
 	guint priority;
@@ -99,11 +113,14 @@ typedef struct {
 	GPtrArray *instance_ids;     /* (nullable) (element-type FuDeviceInstanceIdItem) */
 	GPtrArray *retry_recs;	     /* (nullable) (element-type FuDeviceRetryRecovery) */
 	guint retry_delay;
+	FuDeviceRetryPolicy retry_policy;
+	GHashTable *retry_stats; /* (nullable) (element-type utf8 FuDeviceRetryStats) */
 	GArray *private_flags; /* (nullable) (element-type GQuark) */
 	gchar *custom_flags;
 	gulong notify_flags_proxy_id;
 	GHashTable *instance_hash; /* (nullable) */
 	FuProgress *progress;	   /* provided for FuDevice notify callbacks */
+	FuVersionKey *version_key; /* (nullable) */
 } FuDevicePrivate;
 
 typedef struct {
@@ -112,6 +129,13 @@ typedef struct {
 	FuDeviceRetryFunc recovery_func;
 } FuDeviceRetryRecovery;
 
+typedef struct {
+	guint calls;
+	guint attempts;
+	guint failures;
+	guint64 duration; /* ms */
+} FuDeviceRetryStats;
+
 typedef struct {
 	FwupdDeviceProblem problem;
 	gchar *inhibit_id;
@@ -167,9 +191,16 @@ typedef struct {
 	guint quarks_cnt;
 } FuDeviceClassPrivate;
 
+static void
+fu_device_codec_iface_init(FwupdCodecInterface *iface);
+
+/* the FwupdDevice implementation, chained up to from ours */
+static FwupdCodecInterface *fu_device_codec_parent_iface = NULL;
+
 /* nocheck:name */
 G_DEFINE_TYPE_WITH_CODE(FuDevice, fu_device, FWUPD_TYPE_DEVICE, G_ADD_PRIVATE(FuDevice);
-			g_type_add_class_private(g_define_type_id, sizeof(FuDeviceClassPrivate)));
+			g_type_add_class_private(g_define_type_id, sizeof(FuDeviceClassPrivate));
+			G_IMPLEMENT_INTERFACE(FWUPD_TYPE_CODEC, fu_device_codec_iface_init));
 
 #define GET_PRIVATE(o) (fu_device_get_instance_private(o))
 
@@ -610,52 +641,179 @@ fu_device_retry_set_delay(FuDevice *self, guint delay)
 }
 
 /**
- * fu_device_retry_full:
+ * fu_device_retry_get_delay:
  * @self: a #FuDevice
- * @func: (scope async) (closure user_data): a function to execute
- * @count: the number of tries to try the function
- * @delay: the delay between each try in ms
- * @user_data: (nullable): a helper to pass to @func
- * @error: (nullable): optional return location for an error
  *
- * Calls a specific function a number of times, optionally handling the error
- * with a reset action.
+ * Gets the recovery delay between failed retries.
  *
- * If fu_device_retry_add_recovery() has not been used then all errors are
- * considered non-fatal until the last try.
+ * Returns: delay in ms
  *
- * If the reset function returns %FALSE, then the function returns straight away
- * without processing any pending retries.
+ * Since: 2.2.1
+ **/
+guint
+fu_device_retry_get_delay(FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_DEVICE(self), 0);
+	return priv->retry_delay;
+}
+
+/**
+ * fu_device_get_retry_policy:
+ * @self: a #FuDevice
  *
- * Since: 1.5.5
+ * Gets the policy used to delay between failed retries.
+ *
+ * Returns: a #FuDeviceRetryPolicy, e.g. %FU_DEVICE_RETRY_POLICY_FIXED
+ *
+ * Since: 2.2.1
  **/
-gboolean
-fu_device_retry_full(FuDevice *self,
+FuDeviceRetryPolicy
+fu_device_get_retry_policy(FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_DEVICE(self), FU_DEVICE_RETRY_POLICY_UNKNOWN);
+	return priv->retry_policy;
+}
+
+/**
+ * fu_device_set_retry_policy:
+ * @self: a #FuDevice
+ * @retry_policy: a #FuDeviceRetryPolicy, e.g. %FU_DEVICE_RETRY_POLICY_EXPONENTIAL
+ *
+ * Sets the policy used to delay between failed retries. This can be also be set using
+ * `RetryPolicy=` in a quirk file.
+ *
+ * Since: 2.2.1
+ **/
+void
+fu_device_set_retry_policy(FuDevice *self, FuDeviceRetryPolicy retry_policy)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FU_IS_DEVICE(self));
+	priv->retry_policy = retry_policy;
+}
+
+static FuDeviceRetryStats *
+fu_device_ensure_retry_stats(FuDevice *self, const gchar *id)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	FuDeviceRetryStats *stats;
+
+	if (priv->retry_stats == NULL)
+		priv->retry_stats = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	stats = g_hash_table_lookup(priv->retry_stats, id);
+	if (stats == NULL) {
+		stats = g_new0(FuDeviceRetryStats, 1);
+		g_hash_table_insert(priv->retry_stats, g_strdup(id), stats);
+	}
+	return stats;
+}
+
+static void
+fu_device_add_retry_stats(FuDevice *self, GHashTable *metadata)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	if (priv->retry_stats == NULL)
+		return;
+	g_hash_table_iter_init(&iter, priv->retry_stats);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		FuDeviceRetryStats *stats = (FuDeviceRetryStats *)value;
+		g_autofree gchar *str = NULL;
+
+		str = g_strdup_printf("Calls=%u,Attempts=%u,Failures=%u,Duration=%" G_GUINT64_FORMAT
+				      "ms",
+				      stats->calls,
+				      stats->attempts,
+				      stats->failures,
+				      stats->duration);
+		g_hash_table_insert(metadata,
+				    g_strdup_printf("RetryStats:%s", (const gchar *)key),
+				    g_steal_pointer(&str));
+	}
+}
+
+static void
+fu_device_add_retry_stats_json(FuDevice *self, FwupdJsonObject *json_obj)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	g_autoptr(FwupdJsonArray) json_arr = fwupd_json_array_new();
+	g_autoptr(GList) keys = NULL;
+
+	if (priv->retry_stats == NULL)
+		return;
+	keys = g_hash_table_get_keys(priv->retry_stats);
+	keys = g_list_sort(keys, (GCompareFunc)g_strcmp0);
+	for (GList *l = keys; l != NULL; l = l->next) {
+		const gchar *id = (const gchar *)l->data;
+		FuDeviceRetryStats *stats = g_hash_table_lookup(priv->retry_stats, id);
+		g_autoptr(FwupdJsonObject) json_stats = fwupd_json_object_new();
+
+		fwupd_json_object_add_string(json_stats, "Id", id);
+		fwupd_json_object_add_integer(json_stats, "Calls", stats->calls);
+		fwupd_json_object_add_integer(json_stats, "Attempts", stats->attempts);
+		fwupd_json_object_add_integer(json_stats, "Failures", stats->failures);
+		fwupd_json_object_add_integer(json_stats, "DurationMs", stats->duration);
+		fwupd_json_array_add_object(json_arr, json_stats);
+	}
+	fwupd_json_object_add_array(json_obj, "RetryStats", json_arr);
+}
+
+/* @failures is the number of tries that have already failed */
+static guint
+fu_device_retry_get_backoff(FuDeviceRetryPolicy retry_policy, guint delay, guint failures)
+{
+	guint backoff;
+
+	if (retry_policy == FU_DEVICE_RETRY_POLICY_UNKNOWN ||
+	    retry_policy == FU_DEVICE_RETRY_POLICY_FIXED)
+		return delay;
+
+	/* start short, and double up to the delay */
+	backoff = MAX(delay / FU_DEVICE_RETRY_BACKOFF_DIVISOR, 1);
+	for (guint i = 1; i < failures && backoff < delay; i++)
+		backoff *= 2;
+	backoff = MIN(backoff, delay);
+
+	/* somewhere between half and all of the backoff, or all if no random data */
+	if (retry_policy == FU_DEVICE_RETRY_POLICY_JITTER && backoff > 1) {
+		g_autoptr(GByteArray) buf = fu_common_get_random(sizeof(guint32), NULL);
+		if (buf != NULL) {
+			guint32 value = fu_memread_uint32(buf->data, G_LITTLE_ENDIAN);
+			backoff = (backoff / 2) + (value % (backoff - (backoff / 2) + 1));
+		}
+	}
+	return backoff;
+}
+
+static gboolean
+fu_device_retry_loop(FuDevice *self,
 		     FuDeviceRetryFunc func,
 		     guint count,
 		     guint delay,
+		     FuDeviceRetryPolicy retry_policy,
+		     FuDeviceRetryStats *stats,
 		     gpointer user_data,
 		     GError **error)
 {
 	FuDevicePrivate *priv = GET_PRIVATE(self);
-
-	g_return_val_if_fail(FU_IS_DEVICE(self), FALSE);
-	g_return_val_if_fail(func != NULL, FALSE);
-	g_return_val_if_fail(count >= 1, FALSE);
-	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
-
-	/* fuzzing, so just do each action once */
-	if (fu_device_has_private_flag(FU_DEVICE(self), FU_DEVICE_PRIVATE_FLAG_IS_FAKE))
-		count = 1;
+	guint64 deadline = (guint64)(count - 1) * delay;
+	g_autoptr(GTimer) timer = g_timer_new();
 
 	for (guint i = 0;; i++) {
 		g_autoptr(GError) error_local = NULL;
 
 		/* delay */
 		if (i > 0)
-			fu_device_sleep(self, delay);
+			fu_device_sleep(self, fu_device_retry_get_backoff(retry_policy, delay, i));
 
 		/* run function, if success return success */
+		if (stats != NULL)
+			stats->attempts++;
 		if (func(self, user_data, &error_local))
 			break;
 
@@ -668,12 +826,13 @@ fu_device_retry_full(FuDevice *self,
 			return FALSE;
 		}
 
-		/* too many retries */
-		if (i >= count - 1) {
+		/* too many retries, but the deadline policy also uses all of the time */
+		if (i >= count - 1 && (retry_policy != FU_DEVICE_RETRY_POLICY_DEADLINE ||
+				       g_timer_elapsed(timer, NULL) * 1000 >= deadline)) {
 			g_propagate_prefixed_error(error,
 						   g_steal_pointer(&error_local),
 						   "failed after %u retries: ",
-						   count);
+						   i + 1);
 			return FALSE;
 		}
 
@@ -705,6 +864,108 @@ fu_device_retry_full(FuDevice *self,
 	return TRUE;
 }
 
+/**
+ * fu_device_retry_full_with_id:
+ * @self: a #FuDevice
+ * @id: (nullable): an identifier for the caller, typically `G_STRFUNC`
+ * @func: (scope async) (closure user_data): a function to execute
+ * @count: the number of tries to try the function
+ * @delay: the delay between each try in ms
+ * @user_data: (nullable): a helper to pass to @func
+ * @error: (nullable): optional return location for an error
+ *
+ * Calls a specific function a number of times, optionally handling the error
+ * with a reset action.
+ *
+ * The delay between each try depends on the retry policy set with
+ * fu_device_set_retry_policy(), which defaults to a fixed delay of @delay.
+ *
+ * If @id is set then the number of calls, tries, failures and the time taken are recorded
+ * and included in the report metadata.
+ *
+ * NOTE: fu_device_retry() and fu_device_retry_full() call this with `G_STRFUNC` automatically.
+ *
+ * Returns: %TRUE if @func eventually succeeded
+ *
+ * Since: 2.2.1
+ **/
+gboolean
+fu_device_retry_full_with_id(FuDevice *self,
+			     const gchar *id,
+			     FuDeviceRetryFunc func,
+			     guint count,
+			     guint delay,
+			     gpointer user_data,
+			     GError **error)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	FuDeviceRetryPolicy retry_policy = priv->retry_policy;
+	FuDeviceRetryStats *stats = NULL;
+	gboolean ret;
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	g_return_val_if_fail(FU_IS_DEVICE(self), FALSE);
+	g_return_val_if_fail(func != NULL, FALSE);
+	g_return_val_if_fail(count >= 1, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* fuzzing, so just do each action once */
+	if (fu_device_has_private_flag(FU_DEVICE(self), FU_DEVICE_PRIVATE_FLAG_IS_FAKE))
+		count = 1;
+
+	/* the recorded events include exactly as many tries as the real device needed */
+	if (fu_device_has_flag(self, FWUPD_DEVICE_FLAG_EMULATED) ||
+	    (priv->proxy != NULL && fu_device_has_flag(priv->proxy, FWUPD_DEVICE_FLAG_EMULATED)))
+		retry_policy = FU_DEVICE_RETRY_POLICY_FIXED;
+
+	if (id != NULL) {
+		stats = fu_device_ensure_retry_stats(self, id);
+		stats->calls++;
+	}
+	ret = fu_device_retry_loop(self, func, count, delay, retry_policy, stats, user_data, error);
+	if (stats != NULL) {
+		stats->duration += g_timer_elapsed(timer, NULL) * 1000;
+		if (!ret)
+			stats->failures++;
+	}
+	return ret;
+}
+
+/* the real symbols, for callers that cannot use the macros in fu-device.h */
+#undef fu_device_retry
+#undef fu_device_retry_full
+
+/**
+ * fu_device_retry_full:
+ * @self: a #FuDevice
+ * @func: (scope async) (closure user_data): a function to execute
+ * @count: the number of tries to try the function
+ * @delay: the delay between each try in ms
+ * @user_data: (nullable): a helper to pass to @func
+ * @error: (nullable): optional return location for an error
+ *
+ * Calls a specific function a number of times, optionally handling the error
+ * with a reset action.
+ *
+ * If fu_device_retry_add_recovery() has not been used then all errors are
+ * considered non-fatal until the last try.
+ *
+ * If the reset function returns %FALSE, then the function returns straight away
+ * without processing any pending retries.
+ *
+ * Since: 1.5.5
+ **/
+gboolean
+fu_device_retry_full(FuDevice *self,
+		     FuDeviceRetryFunc func,
+		     guint count,
+		     guint delay,
+		     gpointer user_data,
+		     GError **error)
+{
+	return fu_device_retry_full_with_id(self, NULL, func, count, delay, user_data, error);
+}
+
 /**
  * fu_device_retry:
  * @self: a #FuDevice
@@ -732,7 +993,13 @@ fu_device_retry(FuDevice *self,
 		GError **error)
 {
 	FuDevicePrivate *priv = GET_PRIVATE(self);
-	return fu_device_retry_full(self, func, count, priv->retry_delay, user_data, error);
+	return fu_device_retry_full_with_id(self,
+					    NULL,
+					    func,
+					    count,
+					    priv->retry_delay,
+					    user_data,
+					    error);
 }
 
 /**
@@ -815,6 +1082,133 @@ fu_device_sleep_idle(FuDevice *self, guint duration_ms, FuProgress *progress)
 	fu_progress_sleep_idle(progress, fu_context_get_main_context(priv->ctx), duration_ms);
 }
 
+static gboolean
+fu_device_check_ready(FuDevice *self, GError **error)
+{
+	FuDeviceClass *device_class = FU_DEVICE_GET_CLASS(self);
+	g_autoptr(GError) error_local = NULL;
+
+	if (device_class->check_ready(self, &error_local))
+		return TRUE;
+	if (error_local == NULL) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INTERNAL,
+				    "check_ready failed but no error set!");
+		return FALSE;
+	}
+	g_propagate_error(error, g_steal_pointer(&error_local));
+	return FALSE;
+}
+
+/**
+ * fu_device_poll_until_ready:
+ * @self: a #FuDevice
+ * @timeout_ms: worst case delay in milliseconds
+ * @progress: a #FuProgress
+ * @error: (nullable): optional return location for an error
+ *
+ * Waits for the device to become ready, typically after a detach, attach or erase.
+ *
+ * If the device implements `FuDeviceClass->check_ready` then it is polled with an exponential
+ * backoff, starting from the time the device needed the last time it was polled. The time
+ * needed is saved using the device ID so that future updates sleep for roughly the right time.
+ *
+ * If the device does not implement `FuDeviceClass->check_ready` then this is equivalent to
+ * fu_device_sleep_full().
+ *
+ * The @timeout_ms value can be overridden using fu_device_set_ready_timeout().
+ * If the device is emulated then no delays are performed.
+ *
+ * Returns: %TRUE if the device became ready
+ *
+ * Since: 2.2.1
+ **/
+gboolean
+fu_device_poll_until_ready(FuDevice *self, guint timeout_ms, FuProgress *progress, GError **error)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	FuDeviceClass *device_class = FU_DEVICE_GET_CLASS(self);
+	const gchar *device_id = fu_device_get_id(self);
+	guint delay = FU_DEVICE_READY_DELAY_MIN;
+	guint step = FU_DEVICE_READY_DELAY_MIN;
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	g_return_val_if_fail(FU_IS_DEVICE(self), FALSE);
+	g_return_val_if_fail(FU_IS_PROGRESS(progress), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	g_return_val_if_fail(timeout_ms <= FU_DEVICE_READY_TIMEOUT_MAX, FALSE);
+
+	/* the quirk is a better worst case than the plugin */
+	if (priv->ready_timeout > 0)
+		timeout_ms = priv->ready_timeout;
+
+	/* no way of knowing when it is ready */
+	if (device_class->check_ready == NULL) {
+		fu_device_sleep_full(self, timeout_ms, progress);
+		return TRUE;
+	}
+
+	/* fuzzing, so just check once */
+	if (fu_device_has_private_flag(self, FU_DEVICE_PRIVATE_FLAG_IS_FAKE))
+		return fu_device_check_ready(self, error);
+
+	/* the recorded events include exactly as many checks as the real device needed */
+	if (fu_device_has_flag(self, FWUPD_DEVICE_FLAG_EMULATED) ||
+	    (priv->proxy != NULL && fu_device_has_flag(priv->proxy, FWUPD_DEVICE_FLAG_EMULATED))) {
+		for (guint i = 0;; i++) {
+			g_autoptr(GError) error_local = NULL;
+			if (fu_device_check_ready(self, &error_local))
+				return TRUE;
+			if (i >= FU_DEVICE_READY_CHECKS_MAX) {
+				g_propagate_prefixed_error(error,
+							   g_steal_pointer(&error_local),
+							   "device not ready after %u checks: ",
+							   i + 1);
+				return FALSE;
+			}
+		}
+	}
+
+	/* start just before what the device needed last time, so that it can also get faster */
+	if (device_id != NULL && priv->ctx != NULL) {
+		guint ready_time = fu_context_get_ready_time(priv->ctx, device_id);
+		if (ready_time > 0) {
+			delay = MAX((ready_time / 4) * 3, FU_DEVICE_READY_DELAY_MIN);
+			step = MAX(ready_time / 8, FU_DEVICE_READY_DELAY_MIN);
+		}
+	}
+	delay = MIN(delay, timeout_ms);
+
+	for (;;) {
+		guint elapsed;
+		g_autoptr(GError) error_local = NULL;
+
+		fu_device_sleep(self, delay);
+		elapsed = (guint)(g_timer_elapsed(timer, NULL) * 1000);
+		if (fu_device_check_ready(self, &error_local)) {
+			g_debug("device ready after %ums, worst case %ums", elapsed, timeout_ms);
+			if (device_id != NULL && priv->ctx != NULL)
+				fu_context_set_ready_time(priv->ctx, device_id, MAX(elapsed, 1));
+			fu_progress_finished(progress);
+			return TRUE;
+		}
+		if (elapsed >= timeout_ms) {
+			g_propagate_prefixed_error(error,
+						   g_steal_pointer(&error_local),
+						   "device not ready after %ums: ",
+						   elapsed);
+			return FALSE;
+		}
+		fu_progress_set_percentage_full(progress, elapsed, timeout_ms);
+
+		/* back off, but never past the worst case */
+		delay = MAX(MIN(step, timeout_ms - elapsed), FU_DEVICE_READY_DELAY_MIN);
+		step = MIN(step * 2, timeout_ms);
+	}
+}
+
 /**
  * fu_device_set_contents:
  * @self: a #FuDevice
@@ -2069,6 +2463,15 @@ fu_device_has_parent_guid(FuDevice *self, const gchar *guid)
 	return FALSE;
 }
 
+static gchar *
+fu_device_hash_instance_id(FuDevice *self, const gchar *instance_id)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	if (priv->ctx != NULL)
+		return fu_context_get_instance_id_guid(priv->ctx, instance_id);
+	return fwupd_guid_hash_string(instance_id);
+}
+
 /**
  * fu_device_add_parent_guid:
  * @self: a #FuDevice
@@ -2098,7 +2501,7 @@ fu_device_add_parent_guid(FuDevice *self, const gchar *guid)
 
 	/* make valid */
 	if (!fwupd_guid_is_valid(guid)) {
-		g_autofree gchar *tmp = fwupd_guid_hash_string(guid);
+		g_autofree gchar *tmp = fu_device_hash_instance_id(self, guid);
 		if (fu_device_has_parent_guid(self, tmp))
 			return;
 		g_debug("using %s for %s", tmp, guid);
@@ -2550,6 +2953,30 @@ fu_device_set_quirk_kv(FuDevice *self,
 		fu_device_set_acquiesce_delay(self, tmp);
 		return TRUE;
 	}
+	if (g_strcmp0(key, FU_QUIRKS_READY_TIMEOUT) == 0) {
+		if (!fu_strtoull(value,
+				 &tmp,
+				 0,
+				 FU_DEVICE_READY_TIMEOUT_MAX,
+				 FU_INTEGER_BASE_AUTO,
+				 error))
+			return FALSE;
+		fu_device_set_ready_timeout(self, tmp);
+		return TRUE;
+	}
+	if (g_strcmp0(key, FU_QUIRKS_RETRY_POLICY) == 0) {
+		FuDeviceRetryPolicy retry_policy = fu_device_retry_policy_from_string(value);
+		if (retry_policy == FU_DEVICE_RETRY_POLICY_UNKNOWN) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "invalid retry policy %s",
+				    value);
+			return FALSE;
+		}
+		fu_device_set_retry_policy(self, retry_policy);
+		return TRUE;
+	}
 	if (g_strcmp0(key, FU_QUIRKS_VERSION_FORMAT) == 0) {
 		fu_device_set_version_format(self, fwupd_version_format_from_string(value));
 		return TRUE;
@@ -2938,7 +3365,7 @@ fu_device_has_guid(FuDevice *self, const gchar *guid)
 
 	/* make valid */
 	if (!fwupd_guid_is_valid(guid)) {
-		g_autofree gchar *tmp = fwupd_guid_hash_string(guid);
+		g_autofree gchar *tmp = fu_device_hash_instance_id(self, guid);
 		return fwupd_device_has_guid(FWUPD_DEVICE(self), tmp);
 	}
 
@@ -3057,7 +3484,7 @@ fu_device_add_instance_id_full(FuDevice *self,
 			item->guid = g_strdup(instance_id);
 		} else {
 			item->instance_id = g_strdup(instance_id);
-			item->guid = fwupd_guid_hash_string(instance_id);
+			item->guid = fu_device_hash_instance_id(self, instance_id);
 		}
 		item->flags |= flags;
 		if (priv->instance_ids == NULL)
@@ -3765,6 +4192,37 @@ fu_device_set_version_highest_raw(FuDevice *self, guint64 version_raw)
 	}
 }
 
+/**
+ * fu_device_get_version_key:
+ * @self: a #FuDevice
+ *
+ * Gets the device version split and normalized using the device version format. The key is
+ * cached, and only rebuilt if the version or version format changes.
+ *
+ * Returns: (transfer full): a #FuVersionKey
+ *
+ * Since: 2.2.1
+ **/
+FuVersionKey *
+fu_device_get_version_key(FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	FwupdVersionFormat fmt;
+	const gchar *version;
+
+	g_return_val_if_fail(FU_IS_DEVICE(self), NULL);
+
+	fmt = fu_device_get_version_format(self);
+	version = fu_device_get_version(self);
+	if (priv->version_key == NULL || fu_version_key_get_format(priv->version_key) != fmt ||
+	    g_strcmp0(fu_version_key_get_version(priv->version_key), version) != 0) {
+		if (priv->version_key != NULL)
+			fu_version_key_unref(priv->version_key);
+		priv->version_key = fu_version_key_new(version, fmt);
+	}
+	return fu_version_key_ref(priv->version_key);
+}
+
 /**
  * fu_device_convert_version:
  * @self: a #FuDevice
@@ -5081,6 +5539,42 @@ fu_device_set_acquiesce_delay(FuDevice *self, guint acquiesce_delay)
 	priv->acquiesce_delay = acquiesce_delay;
 }
 
+/**
+ * fu_device_get_ready_timeout:
+ * @self: a #FuDevice
+ *
+ * Returns the maximum time to wait for the device to become ready.
+ *
+ * Returns: time in milliseconds, or 0 for unset
+ *
+ * Since: 2.2.1
+ **/
+guint
+fu_device_get_ready_timeout(FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	g_return_val_if_fail(FU_IS_DEVICE(self), 0);
+	return priv->ready_timeout;
+}
+
+/**
+ * fu_device_set_ready_timeout:
+ * @self: a #FuDevice
+ * @ready_timeout: the value in milliseconds
+ *
+ * Sets the maximum time to wait in fu_device_poll_until_ready(), overriding the worst case value
+ * used by the plugin. This can be also be set using `ReadyTimeout=` in a quirk file.
+ *
+ * Since: 2.2.1
+ **/
+void
+fu_device_set_ready_timeout(FuDevice *self, guint ready_timeout)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FU_IS_DEVICE(self));
+	priv->ready_timeout = ready_timeout;
+}
+
 /**
  * fu_device_set_update_state:
  * @self: a #FuDevice
@@ -5408,6 +5902,25 @@ fu_device_to_string_impl(FuDevice *self, guint idt, GString *str)
 	fwupd_codec_string_append_int(str, idt, "RemoveDelay", priv->remove_delay);
 	fwupd_codec_string_append_int(str, idt, "AcquiesceDelay", priv->acquiesce_delay);
 	fwupd_codec_string_append_int(str, idt, "PollInterval", priv->poll_interval);
+	fwupd_codec_string_append_int(str, idt, "ReadyTimeout", priv->ready_timeout);
+	if (priv->retry_policy != FU_DEVICE_RETRY_POLICY_UNKNOWN) {
+		fwupd_codec_string_append(str,
+					  idt,
+					  "RetryPolicy",
+					  fu_device_retry_policy_to_string(priv->retry_policy));
+	}
+	if (priv->retry_stats != NULL) {
+		g_autoptr(GHashTable) metadata =
+		    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+		g_autoptr(GList) keys = NULL;
+		fu_device_add_retry_stats(self, metadata);
+		keys = g_list_sort(g_hash_table_get_keys(metadata), (GCompareFunc)g_strcmp0);
+		for (GList *l = keys; l != NULL; l = l->next) {
+			const gchar *key = l->data;
+			const gchar *value = g_hash_table_lookup(metadata, key);
+			fwupd_codec_string_append(str, idt, key, value);
+		}
+	}
 	fwupd_codec_string_append(str, idt, "CustomFlags", priv->custom_flags);
 	if (priv->specialized_gtype != G_TYPE_INVALID)
 		fwupd_codec_string_append(str, idt, "GType", g_type_name(priv->specialized_gtype));
@@ -5925,6 +6438,164 @@ fu_device_dump_firmware(FuDevice *self, FuProgress *progress, GError **error)
 	return device_class->dump_firmware(self, progress, error);
 }
 
+static guint32
+fu_device_crc_bytes(FuCrcKind kind, GBytes *blob)
+{
+	guint bitwidth = fu_crc_size(kind);
+	if (bitwidth == 8)
+		return fu_crc8_bytes(kind, blob);
+	if (bitwidth == 16)
+		return fu_crc16_bytes(kind, blob);
+	return fu_crc32_bytes(kind, blob);
+}
+
+static gboolean
+fu_device_verify_read_data(FuDevice *self,
+			   guint32 address,
+			   GBytes *blob,
+			   FuProgress *progress,
+			   GError **error)
+{
+	FuDeviceClass *device_class = FU_DEVICE_GET_CLASS(self);
+	g_autoptr(FuChunkArray) chunks = NULL;
+
+	chunks = fu_chunk_array_new_from_bytes(blob,
+					       address,
+					       FU_CHUNK_PAGESZ_NONE,
+					       FU_DEVICE_VERIFY_CHUNK_SIZE,
+					       error);
+	if (chunks == NULL)
+		return FALSE;
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_set_steps(progress, fu_chunk_array_length(chunks));
+	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
+		g_autofree guint8 *buf = NULL;
+		g_autoptr(FuChunk) chk = NULL;
+
+		chk = fu_chunk_array_index(chunks, i, error);
+		if (chk == NULL)
+			return FALSE;
+		buf = g_malloc0(fu_chunk_get_data_sz(chk));
+		if (!device_class->read_data(self,
+					     fu_chunk_get_address(chk),
+					     buf,
+					     fu_chunk_get_data_sz(chk),
+					     error)) {
+			g_prefix_error(error,
+				       "failed to read @0x%x: ",
+				       (guint)fu_chunk_get_address(chk));
+			return FALSE;
+		}
+		if (!fu_memcmp_safe(buf,
+				    fu_chunk_get_data_sz(chk),
+				    0x0,
+				    fu_chunk_get_data(chk),
+				    fu_chunk_get_data_sz(chk),
+				    0x0,
+				    fu_chunk_get_data_sz(chk),
+				    error)) {
+			g_prefix_error(error,
+				       "failed to verify @0x%x: ",
+				       (guint)fu_chunk_get_address(chk));
+			return FALSE;
+		}
+		fu_progress_step_done(progress);
+	}
+	return TRUE;
+}
+
+/**
+ * fu_device_verify_crc:
+ * @self: a #FuDevice
+ * @kind: a #FuCrcKind, typically %FU_CRC_KIND_B32_STANDARD
+ * @address: start address on the device
+ * @blob: the data that was written to @address
+ * @progress: a #FuProgress
+ * @error: (nullable): optional return location for an error
+ *
+ * Verifies the data written to the device by asking the device for the CRC of the range using
+ * the `FuDeviceClass->read_crc` vfunc, which is much quicker than reading the data back.
+ *
+ * If the device does not implement `FuDeviceClass->read_crc` then the range is read back in
+ * chunks using `FuDeviceClass->read_data` and compared byte-for-byte instead.
+ *
+ * If neither vfunc is implemented then the image is read back using fu_device_dump_firmware().
+ * As the dumped image has no base address this last fallback assumes it starts at device
+ * address 0x0, and so only an @address of 0x0 is supported.
+ *
+ * Returns: %TRUE if the data on the device matches @blob
+ *
+ * Since: 2.2.1
+ **/
+gboolean
+fu_device_verify_crc(FuDevice *self,
+		     FuCrcKind kind,
+		     guint32 address,
+		     GBytes *blob,
+		     FuProgress *progress,
+		     GError **error)
+{
+	FuDeviceClass *device_class = FU_DEVICE_GET_CLASS(self);
+	guint32 crc = 0;
+	guint32 crc_expected;
+
+	g_return_val_if_fail(FU_IS_DEVICE(self), FALSE);
+	g_return_val_if_fail(blob != NULL, FALSE);
+	g_return_val_if_fail(FU_IS_PROGRESS(progress), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* fall back to reading back the range */
+	if (device_class->read_crc == NULL && device_class->read_data != NULL)
+		return fu_device_verify_read_data(self, address, blob, progress, error);
+
+	/* fall back to reading back the whole image, which starts at 0x0 */
+	if (device_class->read_crc == NULL) {
+		g_autoptr(GBytes) fw = NULL;
+		g_autoptr(GBytes) fw_range = NULL;
+
+		if (address != 0x0) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "cannot read back from 0x%x without FuDeviceClass->read_data",
+				    address);
+			return FALSE;
+		}
+		fw = fu_device_dump_firmware(self, progress, error);
+		if (fw == NULL)
+			return FALSE;
+		fw_range = fu_bytes_new_offset(fw, 0x0, g_bytes_get_size(blob), error);
+		if (fw_range == NULL)
+			return FALSE;
+		return fu_bytes_compare(fw_range, blob, error);
+	}
+
+	/* ask the device */
+	if (fu_crc_size(kind) == 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "CRC kind %s not supported",
+			    fu_crc_kind_to_string(kind));
+		return FALSE;
+	}
+	if (!device_class->read_crc(self, kind, address, g_bytes_get_size(blob), &crc, error))
+		return FALSE;
+	crc_expected = fu_device_crc_bytes(kind, blob);
+	if (crc != crc_expected) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "CRC @0x%x invalid, got 0x%x and expected 0x%x",
+			    address,
+			    crc,
+			    crc_expected);
+		return FALSE;
+	}
+	fu_progress_finished(progress);
+	return TRUE;
+}
+
 /**
  * fu_device_detach:
  * @self: a #FuDevice
@@ -6149,12 +6820,13 @@ fu_device_open_internal(FuDevice *self, GError **error)
 	/* subclassed */
 	if (device_class->open != NULL) {
 		if (fu_device_has_private_flag(self, FU_DEVICE_PRIVATE_FLAG_RETRY_OPEN)) {
-			if (!fu_device_retry_full(self,
-						  fu_device_open_cb,
-						  FU_DEVICE_RETRY_OPEN_COUNT,
-						  FU_DEVICE_RETRY_OPEN_DELAY,
-						  NULL,
-						  error)) {
+			if (!fu_device_retry_full_with_id(self,
+							  G_STRFUNC,
+							  fu_device_open_cb,
+							  FU_DEVICE_RETRY_OPEN_COUNT,
+							  FU_DEVICE_RETRY_OPEN_DELAY,
+							  NULL,
+							  error)) {
 				g_prefix_error_literal(error, "failed to retry subclass open: ");
 				return FALSE;
 			}
@@ -6649,17 +7321,20 @@ GHashTable *
 fu_device_report_metadata_post(FuDevice *self)
 {
 	FuDeviceClass *device_class = FU_DEVICE_GET_CLASS(self);
+	FuDevicePrivate *priv = GET_PRIVATE(self);
 	g_autoptr(GHashTable) metadata = NULL;
 
 	g_return_val_if_fail(FU_IS_DEVICE(self), NULL);
 
 	/* not implemented */
-	if (device_class->report_metadata_post == NULL)
+	if (device_class->report_metadata_post == NULL && priv->retry_stats == NULL)
 		return NULL;
 
 	/* metadata for all devices */
 	metadata = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
-	device_class->report_metadata_post(self, metadata);
+	fu_device_add_retry_stats(self, metadata);
+	if (device_class->report_metadata_post != NULL)
+		device_class->report_metadata_post(self, metadata);
 	return g_steal_pointer(&metadata);
 }
 
@@ -7110,7 +7785,7 @@ fu_device_incorporate(FuDevice *self, FuDevice *donor, FuDeviceIncorporateFlags
 		GPtrArray *instance_ids = fu_device_get_instance_ids(donor);
 		for (guint i = 0; i < instance_ids->len; i++) {
 			const gchar *instance_id = g_ptr_array_index(instance_ids, i);
-			g_autofree gchar *guid = fwupd_guid_hash_string(instance_id);
+			g_autofree gchar *guid = fu_device_hash_instance_id(self, instance_id);
 			fu_device_add_guid_quirks(self, guid, FU_DEVICE_INSTANCE_FLAG_NONE);
 		}
 	}
@@ -8440,6 +9115,21 @@ fu_device_dispose(GObject *object)
 	G_OBJECT_CLASS(fu_device_parent_class)->dispose(object);
 }
 
+static void
+fu_device_codec_add_json(FwupdCodec *codec, FwupdJsonObject *json_obj, FwupdCodecFlags flags)
+{
+	FuDevice *self = FU_DEVICE(codec);
+	fu_device_codec_parent_iface->add_json(codec, json_obj, flags);
+	fu_device_add_retry_stats_json(self, json_obj);
+}
+
+static void
+fu_device_codec_iface_init(FwupdCodecInterface *iface)
+{
+	fu_device_codec_parent_iface = g_type_interface_peek_parent(iface);
+	iface->add_json = fu_device_codec_add_json;
+}
+
 static void
 fu_device_class_init(FuDeviceClass *klass)
 {
@@ -8806,6 +9496,8 @@ fu_device_finalize(GObject *object)
 
 	if (priv->progress != NULL)
 		g_object_unref(priv->progress);
+	if (priv->version_key != NULL)
+		fu_version_key_unref(priv->version_key);
 	if (priv->proxy != NULL) {
 		if (priv->notify_flags_proxy_id != 0)
 			g_clear_signal_handler(&priv->notify_flags_proxy_id, priv->proxy);
@@ -8836,6 +9528,8 @@ fu_device_finalize(GObject *object)
 		g_ptr_array_unref(priv->events);
 	if (priv->retry_recs != NULL)
 		g_ptr_array_unref(priv->retry_recs);
+	if (priv->retry_stats != NULL)
+		g_hash_table_unref(priv->retry_stats);
 	if (priv->instance_ids != NULL)
 		g_ptr_array_unref(priv->instance_ids);
 	if (priv->parent_guids != NULL)
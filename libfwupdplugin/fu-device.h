@@ -9,6 +9,7 @@
 #include <fwupd.h>
 
 #include "fu-context.h"
+#include "fu-crc.h"
 #include "fu-device-event.h"
 #include "fu-device-struct.h"
 #include "fu-firmware.h"
@@ -101,6 +102,18 @@ struct _FuDeviceClass {
 				   FuFirmwareParseFlags flags,
 				   GError **error) G_GNUC_WARN_UNUSED_RESULT;
 	void (*incorporate_from_proxy)(FuDevice *self, FuDevice *donor);
+	gboolean (*check_ready)(FuDevice *self, GError **error) G_GNUC_WARN_UNUSED_RESULT;
+	gboolean (*read_crc)(FuDevice *self,
+			     FuCrcKind kind,
+			     guint32 address,
+			     gsize bufsz,
+			     guint32 *crc,
+			     GError **error) G_GNUC_WARN_UNUSED_RESULT;
+	gboolean (*read_data)(FuDevice *self,
+			      guint32 address,
+			      guint8 *buf,
+			      gsize bufsz,
+			      GError **error) G_GNUC_WARN_UNUSED_RESULT;
 #endif
 };
 
@@ -1133,6 +1146,10 @@ guint
 fu_device_get_acquiesce_delay(FuDevice *self) G_GNUC_NON_NULL(1);
 void
 fu_device_set_acquiesce_delay(FuDevice *self, guint acquiesce_delay) G_GNUC_NON_NULL(1);
+guint
+fu_device_get_ready_timeout(FuDevice *self) G_GNUC_NON_NULL(1);
+void
+fu_device_set_ready_timeout(FuDevice *self, guint ready_timeout) G_GNUC_NON_NULL(1);
 void
 fu_device_set_firmware_size(FuDevice *self, guint64 size) G_GNUC_NON_NULL(1);
 void
@@ -1222,6 +1239,13 @@ fu_device_dump_firmware(FuDevice *self,
 			FuProgress *progress,
 			GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
 gboolean
+fu_device_verify_crc(FuDevice *self,
+		     FuCrcKind kind,
+		     guint32 address,
+		     GBytes *blob,
+		     FuProgress *progress,
+		     GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 4, 5);
+gboolean
 fu_device_attach(FuDevice *self, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
 gboolean
 fu_device_detach(FuDevice *self, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
@@ -1270,6 +1294,12 @@ void
 fu_device_set_poll_interval(FuDevice *self, guint interval) G_GNUC_NON_NULL(1);
 void
 fu_device_retry_set_delay(FuDevice *self, guint delay) G_GNUC_NON_NULL(1);
+guint
+fu_device_retry_get_delay(FuDevice *self) G_GNUC_NON_NULL(1);
+FuDeviceRetryPolicy
+fu_device_get_retry_policy(FuDevice *self) G_GNUC_NON_NULL(1);
+void
+fu_device_set_retry_policy(FuDevice *self, FuDeviceRetryPolicy retry_policy) G_GNUC_NON_NULL(1);
 void
 fu_device_retry_add_recovery(FuDevice *self, GQuark domain, gint code, FuDeviceRetryFunc func)
     G_GNUC_NON_NULL(1);
@@ -1286,6 +1316,27 @@ fu_device_retry_full(FuDevice *self,
 		     guint delay,
 		     gpointer user_data,
 		     GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
+gboolean
+fu_device_retry_full_with_id(FuDevice *self,
+			     const gchar *id,
+			     FuDeviceRetryFunc func,
+			     guint count,
+			     guint delay,
+			     gpointer user_data,
+			     GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
+#ifndef __GI_SCANNER__
+/* so that the retry statistics can be recorded for each caller */
+#define fu_device_retry(self, func, count, user_data, error)                                       \
+	fu_device_retry_full_with_id(self,                                                         \
+				     G_STRFUNC,                                                    \
+				     func,                                                         \
+				     count,                                                        \
+				     fu_device_retry_get_delay(self),                              \
+				     user_data,                                                    \
+				     error)
+#define fu_device_retry_full(self, func, count, delay, user_data, error)                           \
+	fu_device_retry_full_with_id(self, G_STRFUNC, func, count, delay, user_data, error)
+#endif
 void
 fu_device_sleep(FuDevice *self, guint delay_ms) G_GNUC_NON_NULL(1);
 void
@@ -1293,6 +1344,9 @@ fu_device_sleep_full(FuDevice *self, guint delay_ms, FuProgress *progress) G_GNU
 void
 fu_device_sleep_idle(FuDevice *self, guint duration_ms, FuProgress *progress) G_GNUC_NON_NULL(1);
 gboolean
+fu_device_poll_until_ready(FuDevice *self, guint timeout_ms, FuProgress *progress, GError **error)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 3);
+gboolean
 fu_device_bind_driver(FuDevice *self, const gchar *subsystem, const gchar *driver, GError **error)
     G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
 gboolean
@@ -93,3 +93,18 @@ enum FuDeviceIncorporateFlags {
     // All flags
     All = u64::MAX,
 }
+
+// The policy used to delay between each try in fu_device_retry_full().
+// Since: 2.2.1
+#[derive(ToString, FromString)]
+enum FuDeviceRetryPolicy {
+    Unknown,
+    // Wait for the same delay before each try.
+    Fixed,
+    // Start with a short delay, doubling after each failure up to the delay.
+    Exponential,
+    // Like exponential, but with a random delay so that identical devices do not retry together.
+    Jitter,
+    // Like exponential, but keep retrying until the time a fixed delay would have taken.
+    Deadline,
+}
@@ -12,7 +12,15 @@ G_BEGIN_DECLS
 
 #define FU_FIRMWARE_SIZE_MAX_DEFAULT ((100 * FU_MB) + 1)
 
+typedef void (*FuFirmwareMagicFunc)(FuFirmware *self,
+				    GBytes *blob,
+				    gsize offset,
+				    gpointer user_data);
+
 const GType *
 fu_firmware_get_image_gtypes(FuFirmware *self, guint *n_gtypes) G_GNUC_NON_NULL(1);
+void
+fu_firmware_magic_foreach(FuFirmware *self, FuFirmwareMagicFunc func, gpointer user_data)
+    G_GNUC_NON_NULL(1, 2);
 
 G_END_DECLS
@@ -8,6 +8,7 @@
 
 #include "config.h"
 
+#include "fu-aho-corasick-private.h"
 #include "fu-byte-array.h"
 #include "fu-bytes.h"
 #include "fu-chunk-private.h"
@@ -51,6 +52,8 @@ typedef struct {
 	GPtrArray *chunks;  /* nullable, element-type FuChunk */
 	GPtrArray *patches; /* nullable, element-type FuFirmwarePatch */
 	GPtrArray *magic;   /* nullable, element-type FuFirmwarePatch */
+	gboolean magic_from_class;
+	FuAhoCorasick *magic_search; /* nullable, only when !magic_from_class */
 } FuFirmwarePrivate;
 
 #define FU_FIRMWARE_IMAGE_GTYPES_MAX 10
@@ -60,8 +63,12 @@ typedef struct {
 	gsize size_max;
 	GType image_gtypes[FU_FIRMWARE_IMAGE_GTYPES_MAX];
 	guint image_gtypes_cnt;
+	GType magic_search_gtype; /* class private is copied from the parent class */
+	FuAhoCorasick *magic_search;
 } FuFirmwareClassPrivate;
 
+static GMutex fu_firmware_magic_search_mutex;
+
 static void
 fu_firmware_fuzzer_iface_init(FuFuzzerInterface *iface);
 
@@ -869,6 +876,36 @@ fu_firmware_add_magic(FuFirmware *self, const guint8 *buf, gsize bufsz, gsize of
 	patch->blob = g_bytes_new(buf, bufsz);
 	patch->offset = offset;
 	g_ptr_array_add(priv->magic, g_steal_pointer(&patch));
+
+	/* no longer the same as every other instance of this type */
+	priv->magic_from_class = FALSE;
+	g_clear_pointer(&priv->magic_search, fu_aho_corasick_free);
+}
+
+/**
+ * fu_firmware_magic_foreach:
+ * @self: a #FuFirmware
+ * @func: (scope call): a #FuFirmwareMagicFunc
+ * @user_data: user data to pass to @func
+ *
+ * Calls @func for each magic signature added with fu_firmware_add_magic().
+ *
+ * Since: 2.2.1
+ **/
+void
+fu_firmware_magic_foreach(FuFirmware *self, FuFirmwareMagicFunc func, gpointer user_data)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+
+	g_return_if_fail(FU_IS_FIRMWARE(self));
+	g_return_if_fail(func != NULL);
+
+	if (priv->magic == NULL)
+		return;
+	for (guint i = 0; i < priv->magic->len; i++) {
+		FuFirmwarePatch *patch = g_ptr_array_index(priv->magic, i);
+		func(self, patch->blob, patch->offset, user_data);
+	}
 }
 
 /**
@@ -992,6 +1029,40 @@ fu_firmware_check_compatible(FuFirmware *self,
 	return klass->check_compatible(self, other, flags, error);
 }
 
+static FuAhoCorasick *
+fu_firmware_magic_search_new(FuFirmware *self)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GPtrArray) patterns = g_ptr_array_new();
+	for (guint i = 0; i < priv->magic->len; i++) {
+		FuFirmwarePatch *patch = g_ptr_array_index(priv->magic, i);
+		g_ptr_array_add(patterns, patch->blob);
+	}
+	return fu_aho_corasick_new(patterns);
+}
+
+/* the magic added in ->add_magic() is the same for every instance, so only compile it once */
+static FuAhoCorasick *
+fu_firmware_get_magic_search(FuFirmware *self)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	FuFirmwareClassPrivate *cpriv;
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	if (!priv->magic_from_class) {
+		if (priv->magic_search == NULL)
+			priv->magic_search = fu_firmware_magic_search_new(self);
+		return priv->magic_search;
+	}
+	cpriv = fu_firmware_get_class_private(FU_FIRMWARE_GET_CLASS(self));
+	locker = g_mutex_locker_new(&fu_firmware_magic_search_mutex);
+	if (cpriv->magic_search_gtype != G_OBJECT_TYPE(self)) {
+		cpriv->magic_search = fu_firmware_magic_search_new(self);
+		cpriv->magic_search_gtype = G_OBJECT_TYPE(self);
+	}
+	return cpriv->magic_search;
+}
+
 static gboolean
 fu_firmware_validate_with_magic(FuFirmware *self,
 				FuInputStream *stream,
@@ -1002,22 +1073,40 @@ fu_firmware_validate_with_magic(FuFirmware *self,
 	FuFirmwareClass *klass = FU_FIRMWARE_GET_CLASS(self);
 	FuFirmwarePrivate *priv = GET_PRIVATE(self);
 	gsize offset_lowest = G_MAXSIZE;
+	g_autofree gsize *offsets = g_new0(gsize, priv->magic->len);
+	g_autoptr(GError) error_search = NULL;
 
-	for (guint i = 0; i < priv->magic->len; i++) {
-		FuFirmwarePatch *patch = g_ptr_array_index(priv->magic, i);
-		gsize offset_tmp = 0;
-		g_autoptr(GError) error_local = NULL;
-
+	/* a single magic is found faster with memmem, otherwise find the first occurrence of
+	 * every magic in one pass */
+	if (priv->magic->len == 1) {
+		FuFirmwarePatch *patch = g_ptr_array_index(priv->magic, 0);
 		g_debug("searching for 0x%zx bytes of magic", g_bytes_get_size(patch->blob));
 		if (!fu_input_stream_find(stream,
 					  g_bytes_get_data(patch->blob, NULL),
 					  g_bytes_get_size(patch->blob),
 					  offset,
-					  &offset_tmp,
-					  &error_local)) {
-			g_debug("ignoring: %s", error_local->message);
-			continue;
+					  &offsets[0],
+					  &error_search)) {
+			g_debug("ignoring: %s", error_search->message);
+			offsets[0] = G_MAXSIZE;
 		}
+	} else {
+		g_debug("searching for %u magic values", priv->magic->len);
+		if (!fu_aho_corasick_search_stream(fu_firmware_get_magic_search(self),
+						   stream,
+						   offset,
+						   offsets,
+						   &error_search))
+			g_debug("ignoring: %s", error_search->message);
+	}
+
+	for (guint i = 0; i < priv->magic->len; i++) {
+		FuFirmwarePatch *patch = g_ptr_array_index(priv->magic, i);
+		gsize offset_tmp = offsets[i];
+		g_autoptr(GError) error_local = NULL;
+
+		if (offset_tmp == G_MAXSIZE)
+			continue;
 
 		/* ensure magic found at or after expected offset */
 		if (offset_tmp < patch->offset) {
@@ -2745,8 +2834,11 @@ fu_firmware_constructed(GObject *obj)
 {
 	FuFirmware *self = FU_FIRMWARE(obj);
 	FuFirmwareClass *klass = FU_FIRMWARE_GET_CLASS(self);
-	if (klass->add_magic != NULL)
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	if (klass->add_magic != NULL) {
 		klass->add_magic(self);
+		priv->magic_from_class = priv->magic != NULL;
+	}
 	if (G_TYPE_FROM_CLASS(klass) != FU_TYPE_FIRMWARE && klass->parse_full == NULL &&
 	    klass->parse == NULL)
 		fu_firmware_add_flag(self, FU_FIRMWARE_FLAG_IS_ABSTRACT);
@@ -2773,6 +2865,8 @@ fu_firmware_finalize(GObject *object)
 		g_ptr_array_unref(priv->patches);
 	if (priv->magic != NULL)
 		g_ptr_array_unref(priv->magic);
+	if (priv->magic_search != NULL)
+		fu_aho_corasick_free(priv->magic_search);
 	if (priv->parent != NULL)
 		g_object_remove_weak_pointer(G_OBJECT(priv->parent), (gpointer *)&priv->parent);
 	g_ptr_array_unref(priv->images);
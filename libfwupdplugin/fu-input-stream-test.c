@@ -8,6 +8,44 @@
 
 #include <fwupdplugin.h>
 
+#include "fu-aho-corasick-private.h"
+
+static void
+fu_input_stream_aho_corasick_func(void)
+{
+	const gchar *haystack = "I write free software. Firmware troublemaker, writing Firmware.";
+	const gchar *needles[] = {"Firmware", "ware", "XXX", "writing"};
+	gboolean ret;
+	gsize offsets[G_N_ELEMENTS(needles)] = {0};
+	g_autoptr(FuAhoCorasick) search = NULL;
+	g_autoptr(FuInputStream) stream = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) patterns =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+
+	for (guint i = 0; i < G_N_ELEMENTS(needles); i++)
+		g_ptr_array_add(patterns, g_bytes_new_static(needles[i], strlen(needles[i])));
+	search = fu_aho_corasick_new(patterns);
+	stream =
+	    fu_memory_input_stream_new_from_data((const guint8 *)haystack, strlen(haystack), NULL);
+	ret = fu_aho_corasick_search_stream(search, stream, 0x0, offsets, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offsets[0], ==, 23);
+	g_assert_cmpint(offsets[1], ==, 17);
+	g_assert_cmpint(offsets[2], ==, G_MAXSIZE);
+	g_assert_cmpint(offsets[3], ==, 46);
+
+	/* find second matches */
+	ret = fu_aho_corasick_search_stream(search, stream, 44, offsets, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offsets[0], ==, 54);
+	g_assert_cmpint(offsets[1], ==, 58);
+	g_assert_cmpint(offsets[2], ==, G_MAXSIZE);
+	g_assert_cmpint(offsets[3], ==, 46);
+}
+
 static void
 fu_input_stream_find_func(void)
 {
@@ -52,6 +90,65 @@ fu_input_stream_find_func(void)
 	g_assert_false(ret);
 }
 
+static void
+fu_input_stream_mapped_func(void)
+{
+	const gchar *data = "0123456789abcdef";
+	gboolean ret;
+	g_autofree gchar *fn = NULL;
+	g_autoptr(FuInputStream) stream = NULL;
+	g_autoptr(FuInputStream) stream_partial = NULL;
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GBytes) blob1 = NULL;
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GBytes) blob3 = NULL;
+	g_autoptr(GBytes) blob4 = NULL;
+	g_autoptr(GError) error = NULL;
+
+	tmpdir = fu_temporary_directory_new("input-stream-mapped", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fn = fu_temporary_directory_build(tmpdir, "firmware.bin", NULL);
+	ret = g_file_set_contents(fn, data, -1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	stream = fu_memory_input_stream_new_from_path(fn, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+
+	/* both slices point into the same mapping */
+	blob1 = fu_input_stream_read_bytes(stream, 0x0, 4, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob1);
+	blob2 = fu_input_stream_read_bytes(stream, 0x4, 4, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob2);
+	g_assert_true((const guint8 *)g_bytes_get_data(blob1, NULL) + 4 ==
+		      (const guint8 *)g_bytes_get_data(blob2, NULL));
+	g_assert_cmpmem(g_bytes_get_data(blob2, NULL), g_bytes_get_size(blob2), "4567", 4);
+	g_assert_cmpint(g_seekable_tell(G_SEEKABLE(stream)), ==, 8);
+
+	/* truncated at the end of the stream */
+	blob3 = fu_input_stream_read_bytes(stream, 0xC, G_MAXSIZE, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob3);
+	g_assert_cmpmem(g_bytes_get_data(blob3, NULL), g_bytes_get_size(blob3), "cdef", 4);
+
+	/* a slice of a slice */
+	stream_partial = fu_partial_input_stream_new(stream, 0x8, 0x4, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream_partial);
+	blob4 = fu_input_stream_read_bytes(stream_partial, 0x2, G_MAXSIZE, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob4);
+	g_assert_cmpmem(g_bytes_get_data(blob4, NULL), g_bytes_get_size(blob4), "ab", 2);
+
+	/* nothing left to read */
+	g_assert_null(fu_input_stream_read_bytes(stream_partial, 0x4, 1, NULL, &error));
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+}
+
 static void
 fu_input_stream_sum_overflow_func(void)
 {
@@ -217,7 +314,9 @@ main(int argc, char **argv)
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/input-stream", fu_input_stream_func);
 	g_test_add_func("/fwupd/input-stream/sum-overflow", fu_input_stream_sum_overflow_func);
+	g_test_add_func("/fwupd/input-stream/mapped", fu_input_stream_mapped_func);
 	g_test_add_func("/fwupd/input-stream/chunkify", fu_input_stream_chunkify_func);
 	g_test_add_func("/fwupd/input-stream/find", fu_input_stream_find_func);
+	g_test_add_func("/fwupd/input-stream/aho-corasick", fu_input_stream_aho_corasick_func);
 	return g_test_run();
 }
@@ -550,6 +550,9 @@ fu_input_stream_read_byte_array(FuInputStream *stream,
  *
  * Read a #GBytes from a stream in a safe way.
  *
+ * If the stream is backed by memory, for instance a mapped file, then the returned buffer
+ * references the existing data rather than copying it.
+ *
  * NOTE: The returned buffer may be smaller than @count!
  *
  * Returns: (transfer full): buffer
@@ -563,10 +566,26 @@ fu_input_stream_read_bytes(FuInputStream *stream,
 			   FuProgress *progress,
 			   GError **error)
 {
+	FuInputStreamClass *klass;
 	g_autoptr(GByteArray) buf = NULL;
+
 	g_return_val_if_fail(FU_IS_INPUT_STREAM(stream), NULL);
 	g_return_val_if_fail(progress == NULL || FU_IS_PROGRESS(progress), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* the subclass may be able to return a view of the data rather than a copy */
+	klass = FU_INPUT_STREAM_GET_CLASS(stream);
+	if (klass->read_bytes != NULL) {
+		if (count == 0) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_NOT_SUPPORTED,
+					    "read size must be non-zero");
+			return NULL;
+		}
+		return klass->read_bytes(stream, offset, count, progress, error);
+	}
+
 	buf = fu_input_stream_read_byte_array(stream, offset, count, progress, error);
 	if (buf == NULL)
 		return NULL;
@@ -31,6 +31,11 @@ struct _FuInputStreamClass {
 			 GSeekType type,
 			 GCancellable *cancellable,
 			 GError **error);
+	GBytes *(*read_bytes)(FuInputStream *stream,
+			      gsize offset,
+			      gsize count,
+			      FuProgress *progress,
+			      GError **error);
 };
 
 FuInputStream *
@@ -8,6 +8,9 @@
 
 #include "config.h"
 
+#include <fcntl.h>
+#include <glib/gstdio.h>
+
 #include "fu-mem.h"
 #include "fu-memory-input-stream.h"
 
@@ -52,6 +55,40 @@ fu_memory_input_stream_read_fn(FuInputStream *stream,
 	return (gssize)count;
 }
 
+static GBytes *
+fu_memory_input_stream_read_bytes(FuInputStream *stream,
+				  gsize offset,
+				  gsize count,
+				  FuProgress *progress,
+				  GError **error)
+{
+	FuMemoryInputStream *self = FU_MEMORY_INPUT_STREAM(stream);
+	gsize data_sz = g_bytes_get_size(self->bytes);
+
+	if (offset > data_sz) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "seek to 0x%" G_GSIZE_MODIFIER
+			    "x is outside stream of size 0x%" G_GSIZE_MODIFIER "x",
+			    offset,
+			    data_sz);
+		return NULL;
+	}
+	if (offset == data_sz) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "no data could be read");
+		return NULL;
+	}
+
+	/* same position as if the data had been read */
+	count = MIN(count, data_sz - offset);
+	self->pos = offset + count;
+	return g_bytes_new_from_bytes(self->bytes, offset, count);
+}
+
 static goffset
 fu_memory_input_stream_tell(FuInputStream *stream)
 {
@@ -127,6 +164,7 @@ fu_memory_input_stream_class_init(FuMemoryInputStreamClass *klass)
 	istream_class->tell = fu_memory_input_stream_tell;
 	istream_class->can_seek = fu_memory_input_stream_can_seek;
 	istream_class->seek = fu_memory_input_stream_seek;
+	istream_class->read_bytes = fu_memory_input_stream_read_bytes;
 }
 
 static void
@@ -186,3 +224,90 @@ fu_memory_input_stream_new_from_data(const void *data, gssize len, GDestroyNotif
 
 	return fu_memory_input_stream_new_from_bytes(bytes);
 }
+
+/**
+ * fu_memory_input_stream_new_from_fd:
+ * @fd: a file descriptor
+ * @error: (nullable): optional return location for an error
+ *
+ * Creates a new input stream by mapping @fd into memory, which means that the data does not need
+ * to be copied when using fu_input_stream_read_bytes().
+ *
+ * The file descriptor can be closed after this function has returned.
+ *
+ * NOTE: The file must not be truncated while the stream is in use, and so this should only be
+ * used for sealed memfds or files that are not going to be modified.
+ *
+ * Returns: (transfer full): a #FuInputStream, or %NULL on error
+ *
+ * Since: 2.2.1
+ **/
+FuInputStream *
+fu_memory_input_stream_new_from_fd(gint fd, GError **error)
+{
+	GStatBuf st = {0};
+	g_autoptr(GBytes) bytes = NULL;
+	g_autoptr(GMappedFile) mapped_file = NULL;
+
+	g_return_val_if_fail(fd >= 0, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* pipes and character devices cannot be mapped */
+	if (fstat(fd, &st) != 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_FILE,
+			    "failed to stat fd: %s",
+			    fwupd_strerror(errno));
+		return NULL;
+	}
+	if (!S_ISREG(st.st_mode)) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "fd must be a regular file, got mode 0%o",
+			    (guint)st.st_mode);
+		return NULL;
+	}
+	mapped_file = g_mapped_file_new_from_fd(fd, FALSE, error);
+	if (mapped_file == NULL) {
+		fwupd_error_convert(error);
+		return NULL;
+	}
+	bytes = g_mapped_file_get_bytes(mapped_file);
+	return fu_memory_input_stream_new_from_bytes(bytes);
+}
+
+/**
+ * fu_memory_input_stream_new_from_path:
+ * @path: a filename
+ * @error: (nullable): optional return location for an error
+ *
+ * Creates a new input stream by mapping a local file into memory.
+ *
+ * NOTE: The file must not be truncated while the stream is in use.
+ *
+ * Returns: (transfer full): a #FuInputStream, or %NULL on error
+ *
+ * Since: 2.2.1
+ **/
+FuInputStream *
+fu_memory_input_stream_new_from_path(const gchar *path, GError **error)
+{
+	g_autofd gint fd = -1;
+
+	g_return_val_if_fail(path != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	fd = g_open(path, O_RDONLY, 0);
+	if (fd < 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "failed to open %s: %s",
+			    path,
+			    fwupd_strerror(errno));
+		return NULL;
+	}
+	return fu_memory_input_stream_new_from_fd(fd, error);
+}
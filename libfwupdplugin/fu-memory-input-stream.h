@@ -23,5 +23,10 @@ FuInputStream *
 fu_memory_input_stream_new_from_data(const void *data,
 				     gssize len,
 				     GDestroyNotify destroy) G_GNUC_WARN_UNUSED_RESULT;
+FuInputStream *
+fu_memory_input_stream_new_from_fd(gint fd, GError **error) G_GNUC_WARN_UNUSED_RESULT;
+FuInputStream *
+fu_memory_input_stream_new_from_path(const gchar *path, GError **error) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_NON_NULL(1);
 
 G_END_DECLS
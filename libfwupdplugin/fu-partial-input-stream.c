@@ -225,6 +225,28 @@ fu_partial_input_stream_read_fn(FuInputStream *stream,
 	return fu_input_stream_read(self->base_stream, buffer, count, cancellable, error);
 }
 
+static GBytes *
+fu_partial_input_stream_read_bytes(FuInputStream *stream,
+				   gsize offset,
+				   gsize count,
+				   FuProgress *progress,
+				   GError **error)
+{
+	FuPartialInputStream *self = FU_PARTIAL_INPUT_STREAM(stream);
+	if (offset >= self->size) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_FILE,
+				    "no data could be read");
+		return NULL;
+	}
+	return fu_input_stream_read_bytes(self->base_stream,
+					  self->offset + offset,
+					  MIN(count, self->size - offset),
+					  progress,
+					  error);
+}
+
 static void
 fu_partial_input_stream_finalize(GObject *object)
 {
@@ -243,6 +265,7 @@ fu_partial_input_stream_class_init(FuPartialInputStreamClass *klass)
 	istream_class->tell = fu_partial_input_stream_tell;
 	istream_class->can_seek = fu_partial_input_stream_can_seek;
 	istream_class->seek = fu_partial_input_stream_seek;
+	istream_class->read_bytes = fu_partial_input_stream_read_bytes;
 	object_class->finalize = fu_partial_input_stream_finalize;
 }
 
@@ -0,0 +1,26 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-path.h"
+
+G_BEGIN_DECLS
+
+typedef GPtrArray *(*FuPathListDirFunc)(const gchar *directory, gpointer user_data, GError **error);
+
+GPtrArray *
+fu_path_list_dir(const gchar *directory, GError **error) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_NON_NULL(1);
+GPtrArray *
+fu_path_glob_with_func(const gchar *directory,
+		       const gchar *pattern,
+		       FuPathGlobFlags flags,
+		       FuPathListDirFunc func,
+		       gpointer user_data,
+		       GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2, 4);
+
+G_END_DECLS
@@ -73,6 +73,78 @@ fu_path_sanitize_basename_func(void)
 	}
 }
 
+static void
+fu_path_glob_full_func(void)
+{
+	const gchar *fns[] = {
+	    "EFI/ubuntu/shimx64.efi",
+	    "EFI/ubuntu/fw/fwupd-abc.cap",
+	    "EFI/ubuntu/fw/other.cap",
+	    "EFI/BOOT/GRUBX64.EFI",
+	    "EFI/Microsoft/Boot/en-US/grubx64.efi",
+	    "grubx64.efi",
+	};
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) files1 = NULL;
+	g_autoptr(GPtrArray) files2 = NULL;
+	g_autoptr(GPtrArray) files3 = NULL;
+	g_autoptr(GPtrArray) files4 = NULL;
+
+	/* build a synthetic ESP */
+	tmpdir = fu_temporary_directory_new("path-glob-full", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	for (guint i = 0; i < G_N_ELEMENTS(fns); i++) {
+		gboolean ret;
+		g_autofree gchar *fn = fu_temporary_directory_build(tmpdir, fns[i], NULL);
+		ret = fu_path_mkdir_parent(fn, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+		ret = g_file_set_contents(fn, "", 0, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+
+	/* only the OS directories are searched */
+	files1 = fu_path_glob_full(fu_temporary_directory_get_path(tmpdir),
+				   "EFI/*/fw/fwupd*.cap",
+				   FU_PATH_GLOB_FLAG_NONE,
+				   &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(files1);
+	g_assert_cmpint(files1->len, ==, 1);
+	g_assert_true(g_str_has_suffix(g_ptr_array_index(files1, 0), "fwupd-abc.cap"));
+
+	/* FAT is not case sensitive, and deeper files are not matched */
+	files2 = fu_path_glob_full(fu_temporary_directory_get_path(tmpdir),
+				   "efi/*/grub*.efi",
+				   FU_PATH_GLOB_FLAG_CASE_INSENSITIVE,
+				   &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(files2);
+	g_assert_cmpint(files2->len, ==, 1);
+	g_assert_true(g_str_has_suffix(g_ptr_array_index(files2, 0), "GRUBX64.EFI"));
+
+	/* stop at the first result */
+	files3 = fu_path_glob_full(fu_temporary_directory_get_path(tmpdir),
+				   "EFI/*/*.efi",
+				   FU_PATH_GLOB_FLAG_CASE_INSENSITIVE |
+				       FU_PATH_GLOB_FLAG_FIRST_MATCH,
+				   &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(files3);
+	g_assert_cmpint(files3->len, ==, 1);
+
+	/* nothing matched */
+	files4 = fu_path_glob_full(fu_temporary_directory_get_path(tmpdir),
+				   "EFI/*/systemd-boot*.efi",
+				   FU_PATH_GLOB_FLAG_NONE,
+				   &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(files4);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -80,5 +152,6 @@ main(int argc, char **argv)
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/path/verify_safe", fu_path_verify_safe_func);
 	g_test_add_func("/fwupd/path/sanitize_basename", fu_path_sanitize_basename_func);
+	g_test_add_func("/fwupd/path/glob-full", fu_path_glob_full_func);
 	return g_test_run();
 }
@@ -18,7 +18,7 @@
 #include "fwupd-error.h"
 
 #include "fu-common.h"
-#include "fu-path.h"
+#include "fu-path-private.h"
 
 static gboolean
 fu_path_delete(const gchar *path, GError **error)
@@ -229,6 +229,167 @@ fu_path_glob(const gchar *directory, const gchar *pattern, GError **error)
 	return g_steal_pointer(&files);
 }
 
+/* private */
+GPtrArray *
+fu_path_list_dir(const gchar *directory, GError **error)
+{
+	const gchar *basename;
+	g_autoptr(GDir) dir = NULL;
+	g_autoptr(GPtrArray) basenames = g_ptr_array_new_with_free_func(g_free);
+
+	dir = g_dir_open(directory, 0, error);
+	if (dir == NULL) {
+		fwupd_error_convert(error);
+		return NULL;
+	}
+	while ((basename = g_dir_read_name(dir)) != NULL)
+		g_ptr_array_add(basenames, g_strdup(basename));
+	return g_steal_pointer(&basenames);
+}
+
+static GPtrArray *
+fu_path_list_dir_cb(const gchar *directory, gpointer user_data, GError **error)
+{
+	return fu_path_list_dir(directory, error);
+}
+
+typedef struct {
+	GPtrArray *parts; /* (element-type utf8) */
+	FuPathGlobFlags flags;
+	FuPathListDirFunc func;
+	gpointer user_data;
+	GPtrArray *files; /* (element-type utf8) */
+} FuPathGlobHelper;
+
+static gboolean
+fu_path_glob_match(FuPathGlobHelper *helper, const gchar *part, const gchar *basename)
+{
+	if (helper->flags & FU_PATH_GLOB_FLAG_CASE_INSENSITIVE) {
+		g_autofree gchar *basename_lower = g_utf8_strdown(basename, -1);
+		return g_pattern_match_simple(part, basename_lower);
+	}
+	return g_pattern_match_simple(part, basename);
+}
+
+static gboolean
+fu_path_glob_internal(FuPathGlobHelper *helper, const gchar *directory, guint depth, GError **error)
+{
+	const gchar *part = g_ptr_array_index(helper->parts, depth);
+	gboolean is_last = depth + 1 == helper->parts->len;
+	g_autoptr(GPtrArray) basenames = NULL;
+
+	basenames = helper->func(directory, helper->user_data, error);
+	if (basenames == NULL)
+		return FALSE;
+	for (guint i = 0; i < basenames->len; i++) {
+		const gchar *basename = g_ptr_array_index(basenames, i);
+		g_autofree gchar *fn = NULL;
+
+		if (!fu_path_glob_match(helper, part, basename))
+			continue;
+		fn = g_build_filename(directory, basename, NULL);
+		if (is_last) {
+			g_ptr_array_add(helper->files, g_steal_pointer(&fn));
+			if (helper->flags & FU_PATH_GLOB_FLAG_FIRST_MATCH)
+				return TRUE;
+			continue;
+		}
+
+		/* only descend into directories that can match the rest of the pattern */
+		if (g_file_test(fn, G_FILE_TEST_IS_SYMLINK) || !g_file_test(fn, G_FILE_TEST_IS_DIR))
+			continue;
+		if (!fu_path_glob_internal(helper, fn, depth + 1, error))
+			return FALSE;
+		if ((helper->flags & FU_PATH_GLOB_FLAG_FIRST_MATCH) > 0 && helper->files->len > 0)
+			return TRUE;
+	}
+	return TRUE;
+}
+
+/* private */
+GPtrArray *
+fu_path_glob_with_func(const gchar *directory,
+		       const gchar *pattern,
+		       FuPathGlobFlags flags,
+		       FuPathListDirFunc func,
+		       gpointer user_data,
+		       GError **error)
+{
+	g_autofree gchar *pattern_safe = NULL;
+	g_auto(GStrv) split = NULL;
+	g_autoptr(GPtrArray) files = g_ptr_array_new_with_free_func(g_free);
+	g_autoptr(GPtrArray) parts = g_ptr_array_new();
+	FuPathGlobHelper helper = {
+	    .parts = parts,
+	    .flags = flags,
+	    .func = func,
+	    .user_data = user_data,
+	    .files = files,
+	};
+
+	/* each section of the pattern matches exactly one level of the tree */
+	if (flags & FU_PATH_GLOB_FLAG_CASE_INSENSITIVE)
+		pattern_safe = g_utf8_strdown(pattern, -1);
+	else
+		pattern_safe = g_strdup(pattern);
+	split = g_strsplit(pattern_safe, "/", -1);
+	for (guint i = 0; split[i] != NULL; i++) {
+		if (split[i][0] == '\0')
+			continue;
+		g_ptr_array_add(parts, split[i]);
+	}
+	if (parts->len == 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "invalid pattern %s",
+			    pattern);
+		return NULL;
+	}
+	if (!fu_path_glob_internal(&helper, directory, 0, error))
+		return NULL;
+	if (files->len == 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "no files matched pattern %s in %s",
+			    pattern,
+			    directory);
+		return NULL;
+	}
+	g_ptr_array_sort(files, fu_path_glob_sort_cb);
+	return g_steal_pointer(&files);
+}
+
+/**
+ * fu_path_glob_full:
+ * @directory: a directory path
+ * @pattern: a glob pattern with one section per directory level, e.g. `EFI/BOOT/boot*.efi`
+ * @flags: some #FuPathGlobFlags, e.g. %FU_PATH_GLOB_FLAG_CASE_INSENSITIVE
+ * @error: (nullable): optional return location for an error
+ *
+ * Returns all the filenames that match a glob pattern in @directory and its subdirectories.
+ *
+ * Unlike fu_path_get_files() only the directories that match each section of @pattern are
+ * opened, and so large unrelated trees are never walked. Symlinked directories are not followed.
+ * Any results are sorted. No matching files will set @error.
+ *
+ * Returns:  (element-type utf8) (transfer container): matching files, or %NULL
+ *
+ * Since: 2.2.1
+ **/
+GPtrArray *
+fu_path_glob_full(const gchar *directory,
+		  const gchar *pattern,
+		  FuPathGlobFlags flags,
+		  GError **error)
+{
+	g_return_val_if_fail(directory != NULL, NULL);
+	g_return_val_if_fail(pattern != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+	return fu_path_glob_with_func(directory, pattern, flags, fu_path_list_dir_cb, NULL, error);
+}
+
 /**
  * fu_path_make_absolute:
  * @filename: a path to a filename, perhaps symlinked
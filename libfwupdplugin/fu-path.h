@@ -15,6 +15,11 @@ G_BEGIN_DECLS
 GPtrArray *
 fu_path_glob(const gchar *directory, const gchar *pattern, GError **error) G_GNUC_WARN_UNUSED_RESULT
     G_GNUC_NON_NULL(1, 2);
+GPtrArray *
+fu_path_glob_full(const gchar *directory,
+		  const gchar *pattern,
+		  FuPathGlobFlags flags,
+		  GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
 gboolean
 fu_path_rmtree(const gchar *directory, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
 GPtrArray *
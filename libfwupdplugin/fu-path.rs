@@ -75,3 +75,9 @@ enum FuPathKind {
     // The UEFI ESP, typically autodetected using udisks
     UefiEsp,
 }
+
+enum FuPathGlobFlags {
+    None                    = 0,
+    CaseInsensitive         = 1 << 0, // e.g. for FAT filesystems
+    FirstMatch              = 1 << 1, // stop looking after the first result
+}
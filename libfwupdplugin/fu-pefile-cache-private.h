@@ -0,0 +1,32 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-firmware.h"
+
+G_BEGIN_DECLS
+
+#define FU_TYPE_PEFILE_CACHE (fu_pefile_cache_get_type())
+
+G_DECLARE_FINAL_TYPE(FuPefileCache, fu_pefile_cache, FU, PEFILE_CACHE, GObject)
+
+gboolean
+fu_pefile_cache_load(FuPefileCache *self, const gchar *filename, GError **error)
+    G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_pefile_cache_save(FuPefileCache *self, const gchar *filename, GError **error)
+    G_GNUC_NON_NULL(1, 2);
+FuFirmware *
+fu_pefile_cache_parse_file(FuPefileCache *self, const gchar *filename, GError **error)
+    G_GNUC_NON_NULL(1, 2) G_GNUC_WARN_UNUSED_RESULT;
+guint
+fu_pefile_cache_get_hits(FuPefileCache *self) G_GNUC_NON_NULL(1);
+
+FuPefileCache *
+fu_pefile_cache_new(void) G_GNUC_WARN_UNUSED_RESULT;
+
+G_END_DECLS
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <fwupdplugin.h>
+
+#include "fu-pefile-cache-private.h"
+
+static void
+fu_pefile_cache_write_file(const gchar *filename, const gchar *text)
+{
+	gboolean ret;
+	g_autoptr(FuFirmware) firmware = fu_pefile_firmware_new();
+	g_autoptr(FuFirmware) img = fu_firmware_new();
+	g_autoptr(GBytes) blob_img = g_bytes_new(text, strlen(text));
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+
+	fu_firmware_set_id(img, ".text");
+	fu_firmware_set_bytes(img, blob_img);
+	ret = fu_firmware_add_image(firmware, img, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	blob = fu_firmware_write(firmware, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	ret = fu_bytes_set_contents(filename, blob, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+}
+
+/* overwrite in place so the size and inode stay the same, then restore the mtime */
+static void
+fu_pefile_cache_modify_file_in_place(const gchar *filename)
+{
+	gboolean ret;
+	gsize offset = 0;
+	guint64 mtime;
+	guint32 mtime_usec;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GFile) file = g_file_new_for_path(filename);
+	g_autoptr(GFileInfo) info = NULL;
+	g_autoptr(GFileIOStream) iostream = NULL;
+
+	info = g_file_query_info(file,
+				 G_FILE_ATTRIBUTE_TIME_MODIFIED
+				 "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+				 G_FILE_QUERY_INFO_NONE,
+				 NULL,
+				 &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(info);
+	mtime = g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+	mtime_usec = g_file_info_get_attribute_uint32(info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+
+	/* change the first byte of the section data */
+	blob = fu_bytes_get_contents(filename, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	ret = fu_memmem_safe(g_bytes_get_data(blob, NULL),
+			     g_bytes_get_size(blob),
+			     (const guint8 *)"hello",
+			     5,
+			     &offset,
+			     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	iostream = g_file_open_readwrite(file, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(iostream);
+	ret = g_seekable_seek(G_SEEKABLE(iostream), offset, G_SEEK_SET, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = g_output_stream_write_all(g_io_stream_get_output_stream(G_IO_STREAM(iostream)),
+					"j",
+					1,
+					NULL,
+					NULL,
+					&error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = g_io_stream_close(G_IO_STREAM(iostream), NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* like a tool that preserves timestamps */
+	ret = g_file_set_attribute_uint64(file,
+					  G_FILE_ATTRIBUTE_TIME_MODIFIED,
+					  mtime,
+					  G_FILE_QUERY_INFO_NONE,
+					  NULL,
+					  &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = g_file_set_attribute_uint32(file,
+					  G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+					  mtime_usec,
+					  G_FILE_QUERY_INFO_NONE,
+					  NULL,
+					  &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+}
+
+static gchar *
+fu_pefile_cache_parse_checksum(FuPefileCache *cache, const gchar *filename)
+{
+	g_autofree gchar *checksum = NULL;
+	g_autoptr(FuFirmware) firmware = NULL;
+	g_autoptr(GError) error = NULL;
+
+	firmware = fu_pefile_cache_parse_file(cache, filename, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(firmware);
+	checksum = fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA256, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(checksum);
+	return g_steal_pointer(&checksum);
+}
+
+static void
+fu_pefile_cache_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *checksum1 = NULL;
+	g_autofree gchar *checksum2 = NULL;
+	g_autofree gchar *checksum3 = NULL;
+	g_autofree gchar *checksum4 = NULL;
+	g_autofree gchar *checksum5 = NULL;
+	g_autofree gchar *fn_cache = NULL;
+	g_autofree gchar *fn_efi = NULL;
+	g_autoptr(FuPefileCache) cache1 = fu_pefile_cache_new();
+	g_autoptr(FuPefileCache) cache2 = fu_pefile_cache_new();
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(FuFirmware) firmware = NULL;
+	g_autoptr(GError) error = NULL;
+
+	tmpdir = fu_temporary_directory_new("pefile-cache", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fn_efi = fu_temporary_directory_build(tmpdir, "EFI", "fedora", "shimx64.efi", NULL);
+	fn_cache = fu_temporary_directory_build(tmpdir, "cache", "pefile.json", NULL);
+	fu_pefile_cache_write_file(fn_efi, "hello world");
+
+	/* not saved yet */
+	ret = fu_pefile_cache_load(cache1, fn_cache, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* calculated, then cached */
+	checksum1 = fu_pefile_cache_parse_checksum(cache1, fn_efi);
+	g_assert_cmpint(fu_pefile_cache_get_hits(cache1), ==, 0);
+	checksum2 = fu_pefile_cache_parse_checksum(cache1, fn_efi);
+	g_assert_cmpint(fu_pefile_cache_get_hits(cache1), ==, 1);
+	g_assert_cmpstr(checksum1, ==, checksum2);
+
+	/* reload from disk */
+	ret = fu_pefile_cache_save(cache1, fn_cache, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_pefile_cache_load(cache2, fn_cache, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	checksum3 = fu_pefile_cache_parse_checksum(cache2, fn_efi);
+	g_assert_cmpint(fu_pefile_cache_get_hits(cache2), ==, 1);
+	g_assert_cmpstr(checksum1, ==, checksum3);
+
+	/* file replaced, so the cached value must not be used */
+	fu_pefile_cache_write_file(fn_efi, "hello fwupd");
+	checksum4 = fu_pefile_cache_parse_checksum(cache2, fn_efi);
+	g_assert_cmpint(fu_pefile_cache_get_hits(cache2), ==, 1);
+	g_assert_cmpstr(checksum1, !=, checksum4);
+
+	/* same size, inode and mtime, but different contents */
+	fu_pefile_cache_modify_file_in_place(fn_efi);
+	checksum5 = fu_pefile_cache_parse_checksum(cache2, fn_efi);
+	g_assert_cmpint(fu_pefile_cache_get_hits(cache2), ==, 1);
+	g_assert_cmpstr(checksum4, !=, checksum5);
+
+	/* does not exist */
+	firmware = fu_pefile_cache_parse_file(cache2, "/dev/null/not-going-to-exist", &error);
+	g_assert_nonnull(error);
+	g_assert_null(firmware);
+}
+
+int
+main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+	g_test_add_func("/fwupd/pefile-cache", fu_pefile_cache_func);
+	return g_test_run();
+}
@@ -0,0 +1,386 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuPefileCache"
+
+#include "config.h"
+
+#include "fu-bytes.h"
+#include "fu-input-stream.h"
+#include "fu-pefile-cache-private.h"
+#include "fu-pefile-firmware-private.h"
+
+/**
+ * FuPefileCache:
+ *
+ * A persistent cache of the Authenticode checksums of PE files, typically found on the ESP.
+ *
+ * Each entry is keyed by the filename, and is only used if the size, modification and change
+ * times, inode and a checksum of the first page of the file have not changed since the
+ * Authenticode checksum was calculated.
+ *
+ * See also: [class@FuPefileFirmware]
+ */
+
+struct _FuPefileCache {
+	GObject parent_instance;
+	GHashTable *items; /* utf8:FuPefileCacheItem */
+	gboolean changed;
+	guint hits;
+};
+
+typedef struct {
+	guint64 size;
+	guint64 mtime_usec;
+	guint64 ctime_usec;
+	guint64 inode;
+	gchar *header_hash; /* of the first page */
+	gchar *authenticode_hash;
+} FuPefileCacheItem;
+
+G_DEFINE_TYPE(FuPefileCache, fu_pefile_cache, G_TYPE_OBJECT)
+
+#define FU_PEFILE_CACHE_ITEMS_MAX   1024
+#define FU_PEFILE_CACHE_HEADER_SIZE 0x1000
+
+static void
+fu_pefile_cache_item_free(FuPefileCacheItem *item)
+{
+	g_free(item->header_hash);
+	g_free(item->authenticode_hash);
+	g_free(item);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuPefileCacheItem, fu_pefile_cache_item_free)
+
+static guint64
+fu_pefile_cache_get_time_usec(GFileInfo *info, const gchar *attr_sec, const gchar *attr_usec)
+{
+	return g_file_info_get_attribute_uint64(info, attr_sec) * G_USEC_PER_SEC +
+	       g_file_info_get_attribute_uint32(info, attr_usec);
+}
+
+/* a same-size rewrite within the same second, or with the mtime restored, must not match */
+static FuPefileCacheItem *
+fu_pefile_cache_item_new_for_filename(const gchar *filename, GError **error)
+{
+	g_autoptr(FuInputStream) stream = NULL;
+	g_autoptr(FuPefileCacheItem) item = g_new0(FuPefileCacheItem, 1);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GFile) file = g_file_new_for_path(filename);
+	g_autoptr(GFileInfo) info = NULL;
+
+	info = g_file_query_info(file,
+				 G_FILE_ATTRIBUTE_STANDARD_SIZE
+				 "," G_FILE_ATTRIBUTE_TIME_MODIFIED
+				 "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC
+				 "," G_FILE_ATTRIBUTE_TIME_CHANGED
+				 "," G_FILE_ATTRIBUTE_TIME_CHANGED_USEC
+				 "," G_FILE_ATTRIBUTE_UNIX_INODE,
+				 G_FILE_QUERY_INFO_NONE,
+				 NULL,
+				 error);
+	if (info == NULL)
+		return NULL;
+	item->size = g_file_info_get_size(info);
+	item->mtime_usec = fu_pefile_cache_get_time_usec(info,
+							 G_FILE_ATTRIBUTE_TIME_MODIFIED,
+							 G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+	item->ctime_usec = fu_pefile_cache_get_time_usec(info,
+							 G_FILE_ATTRIBUTE_TIME_CHANGED,
+							 G_FILE_ATTRIBUTE_TIME_CHANGED_USEC);
+	item->inode = g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_UNIX_INODE);
+
+	/* cheap check of the contents, which includes the PE header */
+	stream = fu_input_stream_from_path(filename, error);
+	if (stream == NULL)
+		return NULL;
+	if (item->size > 0) {
+		blob = fu_input_stream_read_bytes(stream,
+						  0x0,
+						  MIN(item->size, FU_PEFILE_CACHE_HEADER_SIZE),
+						  NULL,
+						  error);
+		if (blob == NULL)
+			return NULL;
+		item->header_hash = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob);
+	} else {
+		item->header_hash = g_compute_checksum_for_data(G_CHECKSUM_SHA256, NULL, 0);
+	}
+	return g_steal_pointer(&item);
+}
+
+static gboolean
+fu_pefile_cache_item_equal(FuPefileCacheItem *item1, FuPefileCacheItem *item2)
+{
+	return item1->size == item2->size && item1->mtime_usec == item2->mtime_usec &&
+	       item1->ctime_usec == item2->ctime_usec && item1->inode == item2->inode &&
+	       g_strcmp0(item1->header_hash, item2->header_hash) == 0;
+}
+
+static void
+fu_pefile_cache_add_item(FuPefileCache *self, const gchar *filename, FuPefileCacheItem *item)
+{
+	/* the ESP contents have changed a lot, so just start again */
+	if (g_hash_table_size(self->items) >= FU_PEFILE_CACHE_ITEMS_MAX)
+		g_hash_table_remove_all(self->items);
+	g_hash_table_insert(self->items, g_strdup(filename), item);
+}
+
+/**
+ * fu_pefile_cache_load:
+ * @self: a #FuPefileCache
+ * @filename: a JSON filename
+ * @error: (nullable): optional return location for an error
+ *
+ * Loads the cache from a file. It is not an error if the file does not exist.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.2.1
+ **/
+gboolean
+fu_pefile_cache_load(FuPefileCache *self, const gchar *filename, GError **error)
+{
+	g_autoptr(FwupdJsonArray) json_arr = NULL;
+	g_autoptr(FwupdJsonNode) json_node = NULL;
+	g_autoptr(FwupdJsonObject) json_obj = NULL;
+	g_autoptr(FwupdJsonParser) json_parser = fwupd_json_parser_new();
+	g_autoptr(GBytes) blob = NULL;
+
+	g_return_val_if_fail(FU_IS_PEFILE_CACHE(self), FALSE);
+	g_return_val_if_fail(filename != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* nothing saved yet */
+	if (!g_file_test(filename, G_FILE_TEST_EXISTS))
+		return TRUE;
+
+	/* set appropriate limits */
+	fwupd_json_parser_set_max_depth(json_parser, 5);
+	fwupd_json_parser_set_max_items(json_parser, FU_PEFILE_CACHE_ITEMS_MAX * 5);
+
+	blob = fu_bytes_get_contents(filename, error);
+	if (blob == NULL)
+		return FALSE;
+	json_node =
+	    fwupd_json_parser_load_from_bytes(json_parser, blob, FWUPD_JSON_LOAD_FLAG_NONE, error);
+	if (json_node == NULL)
+		return FALSE;
+	json_obj = fwupd_json_node_get_object(json_node, error);
+	if (json_obj == NULL)
+		return FALSE;
+	json_arr = fwupd_json_object_get_array(json_obj, "Files", error);
+	if (json_arr == NULL)
+		return FALSE;
+	for (guint i = 0; i < fwupd_json_array_get_size(json_arr); i++) {
+		gint64 tmp = 0;
+		g_autoptr(FwupdJsonObject) json_item = NULL;
+		g_autoptr(FuPefileCacheItem) item = g_new0(FuPefileCacheItem, 1);
+		g_autoptr(GRefString) fn = NULL;
+		g_autoptr(GRefString) header_hash = NULL;
+		g_autoptr(GRefString) authenticode_hash = NULL;
+
+		json_item = fwupd_json_array_get_object(json_arr, i, error);
+		if (json_item == NULL)
+			return FALSE;
+		fn = fwupd_json_object_get_string(json_item, "Filename", error);
+		if (fn == NULL)
+			return FALSE;
+		if (!fwupd_json_object_get_integer(json_item, "Size", &tmp, error))
+			return FALSE;
+		item->size = (guint64)tmp;
+		if (!fwupd_json_object_get_integer(json_item, "MtimeUsec", &tmp, error))
+			return FALSE;
+		item->mtime_usec = (guint64)tmp;
+		if (!fwupd_json_object_get_integer(json_item, "CtimeUsec", &tmp, error))
+			return FALSE;
+		item->ctime_usec = (guint64)tmp;
+		if (!fwupd_json_object_get_integer(json_item, "Inode", &tmp, error))
+			return FALSE;
+		item->inode = (guint64)tmp;
+		header_hash = fwupd_json_object_get_string(json_item, "HeaderHash", error);
+		if (header_hash == NULL)
+			return FALSE;
+		item->header_hash = g_strdup(header_hash);
+		authenticode_hash =
+		    fwupd_json_object_get_string(json_item, "AuthenticodeHash", error);
+		if (authenticode_hash == NULL)
+			return FALSE;
+		item->authenticode_hash = g_strdup(authenticode_hash);
+
+		/* only add fully parsed items */
+		fu_pefile_cache_add_item(self, fn, g_steal_pointer(&item));
+	}
+
+	/* success */
+	self->changed = FALSE;
+	return TRUE;
+}
+
+/**
+ * fu_pefile_cache_save:
+ * @self: a #FuPefileCache
+ * @filename: a JSON filename
+ * @error: (nullable): optional return location for an error
+ *
+ * Saves the cache to a file, if it has been modified since it was loaded.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.2.1
+ **/
+gboolean
+fu_pefile_cache_save(FuPefileCache *self, const gchar *filename, GError **error)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	g_autoptr(FwupdJsonArray) json_arr = fwupd_json_array_new();
+	g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+	g_autoptr(GBytes) blob = NULL;
+
+	g_return_val_if_fail(FU_IS_PEFILE_CACHE(self), FALSE);
+	g_return_val_if_fail(filename != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* nothing to do */
+	if (!self->changed)
+		return TRUE;
+
+	g_hash_table_iter_init(&iter, self->items);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		FuPefileCacheItem *item = (FuPefileCacheItem *)value;
+		g_autoptr(FwupdJsonObject) json_item = fwupd_json_object_new();
+		fwupd_json_object_add_string(json_item, "Filename", (const gchar *)key);
+		fwupd_json_object_add_integer(json_item, "Size", (gint64)item->size);
+		fwupd_json_object_add_integer(json_item, "MtimeUsec", (gint64)item->mtime_usec);
+		fwupd_json_object_add_integer(json_item, "CtimeUsec", (gint64)item->ctime_usec);
+		fwupd_json_object_add_integer(json_item, "Inode", (gint64)item->inode);
+		fwupd_json_object_add_string(json_item, "HeaderHash", item->header_hash);
+		fwupd_json_object_add_string(json_item,
+					     "AuthenticodeHash",
+					     item->authenticode_hash);
+		fwupd_json_array_add_object(json_arr, json_item);
+	}
+	fwupd_json_object_add_array(json_obj, "Files", json_arr);
+	blob = fwupd_json_object_to_bytes(json_obj, FWUPD_JSON_EXPORT_FLAG_TRAILING_NEWLINE);
+	if (!fu_bytes_set_contents(filename, blob, error))
+		return FALSE;
+
+	/* success */
+	self->changed = FALSE;
+	return TRUE;
+}
+
+/**
+ * fu_pefile_cache_parse_file:
+ * @self: a #FuPefileCache
+ * @filename: a PE filename, typically on the ESP
+ * @error: (nullable): optional return location for an error
+ *
+ * Parses a PE file, using the cached Authenticode checksum if the file has not been modified.
+ *
+ * Returns: (transfer full): a #FuPefileFirmware, or %NULL on error
+ *
+ * Since: 2.2.1
+ **/
+FuFirmware *
+fu_pefile_cache_parse_file(FuPefileCache *self, const gchar *filename, GError **error)
+{
+	FuPefileCacheItem *item;
+	g_autoptr(FuFirmware) firmware = fu_pefile_firmware_new();
+	g_autoptr(FuPefileCacheItem) item_new = NULL;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GFile) file = g_file_new_for_path(filename);
+
+	g_return_val_if_fail(FU_IS_PEFILE_CACHE(self), NULL);
+	g_return_val_if_fail(filename != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* only use the checksum if the file has not been modified */
+	item_new = fu_pefile_cache_item_new_for_filename(filename, &error_local);
+	if (item_new == NULL)
+		g_debug("not using cache for %s: %s", filename, error_local->message);
+	item = g_hash_table_lookup(self->items, filename);
+	if (item_new != NULL && item != NULL && fu_pefile_cache_item_equal(item, item_new)) {
+		g_debug("using cached Authenticode checksum for %s", filename);
+		fu_pefile_firmware_set_authenticode_hash(FU_PEFILE_FIRMWARE(firmware),
+							 item->authenticode_hash);
+		g_clear_pointer(&item_new, fu_pefile_cache_item_free);
+		self->hits++;
+	}
+	fu_firmware_set_filename(firmware, filename);
+	if (!fu_firmware_parse_file(firmware, file, FU_FIRMWARE_PARSE_FLAG_NONE, error))
+		return NULL;
+
+	/* save for next time */
+	if (item_new != NULL) {
+		item_new->authenticode_hash =
+		    fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA256, error);
+		if (item_new->authenticode_hash == NULL)
+			return NULL;
+		fu_pefile_cache_add_item(self, filename, g_steal_pointer(&item_new));
+		self->changed = TRUE;
+	}
+
+	/* success */
+	return g_steal_pointer(&firmware);
+}
+
+/**
+ * fu_pefile_cache_get_hits:
+ * @self: a #FuPefileCache
+ *
+ * Gets the number of times a cached checksum has been used.
+ *
+ * Returns: integer
+ *
+ * Since: 2.2.1
+ **/
+guint
+fu_pefile_cache_get_hits(FuPefileCache *self)
+{
+	g_return_val_if_fail(FU_IS_PEFILE_CACHE(self), G_MAXUINT);
+	return self->hits;
+}
+
+static void
+fu_pefile_cache_finalize(GObject *object)
+{
+	FuPefileCache *self = FU_PEFILE_CACHE(object);
+	g_hash_table_unref(self->items);
+	G_OBJECT_CLASS(fu_pefile_cache_parent_class)->finalize(object);
+}
+
+static void
+fu_pefile_cache_class_init(FuPefileCacheClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_pefile_cache_finalize;
+}
+
+static void
+fu_pefile_cache_init(FuPefileCache *self)
+{
+	self->items = g_hash_table_new_full(g_str_hash,
+					    g_str_equal,
+					    g_free,
+					    (GDestroyNotify)fu_pefile_cache_item_free);
+}
+
+/**
+ * fu_pefile_cache_new:
+ *
+ * Returns: (transfer full): a #FuPefileCache
+ *
+ * Since: 2.2.1
+ **/
+FuPefileCache *
+fu_pefile_cache_new(void)
+{
+	return g_object_new(FU_TYPE_PEFILE_CACHE, NULL);
+}
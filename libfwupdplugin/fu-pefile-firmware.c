@@ -17,7 +17,7 @@
 #include "fu-input-stream.h"
 #include "fu-linear-firmware.h"
 #include "fu-partial-input-stream.h"
-#include "fu-pefile-firmware.h"
+#include "fu-pefile-firmware-private.h"
 #include "fu-pefile-struct.h"
 #include "fu-sbatlevel-section.h"
 #include "fu-string.h"
@@ -433,6 +433,10 @@ fu_pefile_firmware_parse(FuFirmware *firmware,
 					      streamsz - end_with_cert);
 	}
 
+	/* already set from a cache */
+	if (priv->authenticode_hash != NULL)
+		return TRUE;
+
 	/* calculate the checksum we would find in the dbx */
 	for (guint i = 0; i < regions->len; i++) {
 		FuPefileFirmwareRegion *r = g_ptr_array_index(regions, i);
@@ -619,6 +623,27 @@ fu_pefile_firmware_get_checksum(FuFirmware *firmware, GChecksumType csum_kind, G
 	return g_strdup(priv->authenticode_hash);
 }
 
+/**
+ * fu_pefile_firmware_set_authenticode_hash:
+ * @self: a #FuPefileFirmware
+ * @authenticode_hash: (nullable): a SHA256 checksum
+ *
+ * Sets the Authenticode checksum. If this is set before the firmware is parsed then the
+ * checksum is not recalculated, which is useful when the value is known from a cache.
+ *
+ * Since: 2.2.1
+ **/
+void
+fu_pefile_firmware_set_authenticode_hash(FuPefileFirmware *self, const gchar *authenticode_hash)
+{
+	FuPefileFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_return_if_fail(FU_IS_PEFILE_FIRMWARE(self));
+	if (g_strcmp0(priv->authenticode_hash, authenticode_hash) == 0)
+		return;
+	g_free(priv->authenticode_hash);
+	priv->authenticode_hash = g_strdup(authenticode_hash);
+}
+
 static void
 fu_pefile_firmware_init(FuPefileFirmware *self)
 {
@@ -13,6 +13,11 @@ G_BEGIN_DECLS
 gdouble
 fu_progress_get_global_fraction(FuProgress *self) G_GNUC_NON_NULL(1);
 void
+fu_progress_add_trace_events(FuProgress *self, FwupdJsonArray *json_arr) G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_progress_export_trace(FuProgress *self, const gchar *filename, GError **error)
+    G_GNUC_NON_NULL(1, 2);
+void
 fu_progress_sleep_idle(FuProgress *self, GMainContext *main_ctx, guint delay_ms) G_GNUC_NON_NULL(1);
 
 G_END_DECLS
@@ -333,6 +333,46 @@ fu_progress_child_finished(void)
 	fu_progress_step_done(progress);
 }
 
+static void
+fu_progress_trace_func(void)
+{
+	FuProgress *child;
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(FwupdJsonArray) json_arr = fwupd_json_array_new();
+	g_autoptr(FwupdJsonObject) json_obj = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GRefString) ph = NULL;
+	gint64 dur = 0;
+
+	fu_progress_set_profile(progress, TRUE);
+	fu_progress_add_step(progress, FWUPD_STATUS_LOADING, 50, "load");
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_WRITE, 50, "write");
+
+	child = fu_progress_get_child(progress);
+	fu_progress_set_id(child, G_STRLOC);
+	fu_progress_set_steps(child, 2);
+	g_usleep(1000);
+	fu_progress_step_done(child);
+	g_usleep(1000);
+	fu_progress_step_done(child);
+	fu_progress_step_done(progress);
+	g_usleep(1000);
+	fu_progress_step_done(progress);
+
+	/* root, two steps and two sub-steps */
+	fu_progress_add_trace_events(progress, json_arr);
+	g_assert_cmpint(fwupd_json_array_get_size(json_arr), ==, 5);
+	json_obj = fwupd_json_array_get_object(json_arr, 1, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(json_obj);
+	ph = fwupd_json_object_get_string(json_obj, "ph", &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(ph, ==, "X");
+	g_assert_true(fwupd_json_object_get_integer(json_obj, "dur", &dur, &error));
+	g_assert_no_error(error);
+	g_assert_cmpint(dur, >=, 2000);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -348,5 +388,6 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/progress/no-equal", fu_progress_non_equal_steps_func);
 	g_test_add_func("/fwupd/progress/finish", fu_progress_finish_func);
 	g_test_add_func("/fwupd/progress/global-fraction", fu_progress_global_fraction_func);
+	g_test_add_func("/fwupd/progress/trace", fu_progress_trace_func);
 	return g_test_run();
 }
@@ -10,6 +10,7 @@
 
 #include <math.h>
 
+#include "fu-bytes.h"
 #include "fu-progress-private.h"
 #include "fu-string.h"
 
@@ -72,6 +73,9 @@ struct _FuProgress {
 	guint step_weighting;
 	GTimer *timer;
 	GTimer *timer_child;
+	gint64 time_start;	 /* monotonic us */
+	gint64 time_child_start; /* monotonic us */
+	guint thread_id;
 	guint step_now;
 	guint step_done;
 	guint step_scaling;
@@ -379,6 +383,8 @@ fu_progress_set_percentage(FuProgress *self, gdouble percentage)
 	/* done */
 	if (percentage >= 100.0) {
 		fu_progress_set_duration(self, g_timer_elapsed(self->timer, NULL));
+		if (self->thread_id == 0)
+			self->thread_id = g_direct_hash(g_thread_self());
 		for (guint i = 0; i < self->children->len; i++) {
 			FuProgress *child = g_ptr_array_index(self->children, i);
 			g_signal_handlers_disconnect_by_data(child, self);
@@ -471,6 +477,8 @@ fu_progress_reset(FuProgress *self)
 	if (self->profile) {
 		g_timer_start(self->timer);
 		g_timer_start(self->timer_child);
+		self->time_start = g_get_monotonic_time();
+		self->time_child_start = self->time_start;
 	}
 
 	/* no more step data */
@@ -524,6 +532,8 @@ fu_progress_set_steps(FuProgress *self, guint step_max)
 
 	/* reset child timer */
 	g_timer_start(self->timer_child);
+	if (self->profile)
+		self->time_child_start = g_get_monotonic_time();
 }
 
 /**
@@ -723,6 +733,8 @@ fu_progress_add_step(FuProgress *self, FwupdStatus status, guint value, const gc
 
 	/* reset child timer */
 	g_timer_start(self->timer_child);
+	if (self->profile)
+		self->time_child_start = g_get_monotonic_time();
 
 	/* now ready */
 	self->percentage = 0.0;
@@ -903,9 +915,13 @@ fu_progress_step_done(FuProgress *self)
 
 	/* save the duration in the array */
 	if (self->profile) {
-		if (child != NULL)
+		if (child != NULL) {
 			fu_progress_set_duration(child, g_timer_elapsed(self->timer_child, NULL));
+			child->time_start = self->time_child_start;
+			child->thread_id = g_direct_hash(g_thread_self());
+		}
 		g_timer_start(self->timer_child);
+		self->time_child_start = g_get_monotonic_time();
 	}
 
 	/* is already at 100%? */
@@ -1098,6 +1114,111 @@ fu_progress_traceback(FuProgress *self)
 	return g_string_free(g_steal_pointer(&str), FALSE);
 }
 
+static void
+fu_progress_add_trace_events_cb(FuProgress *self,
+				guint child_idx,
+				guint thread_id,
+				FwupdJsonArray *json_arr)
+{
+	if (self->flags & FU_PROGRESS_FLAG_NO_TRACEBACK)
+		return;
+
+	/* children without a recorded thread ran on the parent thread */
+	if (self->thread_id != 0)
+		thread_id = self->thread_id;
+
+	/* only steps with timing data are useful */
+	if (self->time_start > 0 && fu_progress_get_duration(self) > 0.f) {
+		gint64 dur = fu_progress_get_duration(self) * G_USEC_PER_SEC;
+		g_autofree gchar *name = NULL;
+		g_autoptr(FwupdJsonObject) json_args = fwupd_json_object_new();
+		g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+
+		if (self->name != NULL) {
+			name = g_strdup(self->name);
+		} else if (self->id != NULL) {
+			name = g_strdup(self->id);
+		} else {
+			name = g_strdup_printf("%s@%u",
+					       fwupd_status_to_string(self->status),
+					       child_idx);
+		}
+		fwupd_json_object_add_string(json_obj, "name", name);
+		fwupd_json_object_add_string(json_obj, "cat", "fwupd");
+		fwupd_json_object_add_string(json_obj, "ph", "X");
+		fwupd_json_object_add_integer(json_obj, "ts", self->time_start);
+		fwupd_json_object_add_integer(json_obj, "dur", dur);
+		fwupd_json_object_add_integer(json_obj, "pid", 1);
+		fwupd_json_object_add_integer(json_obj, "tid", thread_id);
+		if (self->id != NULL)
+			fwupd_json_object_add_string(json_args, "id", self->id);
+		if (self->status != FWUPD_STATUS_UNKNOWN) {
+			fwupd_json_object_add_string(json_args,
+						     "status",
+						     fwupd_status_to_string(self->status));
+		}
+		fwupd_json_object_add_object(json_obj, "args", json_args);
+		fwupd_json_array_add_object(json_arr, json_obj);
+	}
+	for (guint i = 0; i < self->children->len; i++) {
+		FuProgress *child = g_ptr_array_index(self->children, i);
+		fu_progress_add_trace_events_cb(child, i, thread_id, json_arr);
+	}
+}
+
+/**
+ * fu_progress_add_trace_events:
+ * @self: A #FuProgress
+ * @json_arr: a #FwupdJsonArray
+ *
+ * Adds each profiled step as a Chrome trace-event "complete" event, suitable for loading into
+ * `chrome://tracing` or the Perfetto UI.
+ *
+ * NOTE: Timing data is only recorded when profiling is enabled using fu_progress_set_profile().
+ *
+ * Since: 2.2.1
+ **/
+void
+fu_progress_add_trace_events(FuProgress *self, FwupdJsonArray *json_arr)
+{
+	g_return_if_fail(FU_IS_PROGRESS(self));
+	g_return_if_fail(json_arr != NULL);
+	fu_progress_add_trace_events_cb(self,
+					G_MAXUINT,
+					g_direct_hash(g_thread_self()),
+					json_arr);
+}
+
+/**
+ * fu_progress_export_trace:
+ * @self: A #FuProgress
+ * @filename: a filename, e.g. `/tmp/fwupd-trace.json`
+ * @error: (nullable): optional return location for an error
+ *
+ * Saves the profiled steps as a Chrome trace-event JSON file.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.2.1
+ **/
+gboolean
+fu_progress_export_trace(FuProgress *self, const gchar *filename, GError **error)
+{
+	g_autoptr(FwupdJsonArray) json_arr = fwupd_json_array_new();
+	g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+	g_autoptr(GBytes) blob = NULL;
+
+	g_return_val_if_fail(FU_IS_PROGRESS(self), FALSE);
+	g_return_val_if_fail(filename != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	fu_progress_add_trace_events(self, json_arr);
+	fwupd_json_object_add_array(json_obj, "traceEvents", json_arr);
+	fwupd_json_object_add_string(json_obj, "displayTimeUnit", "ms");
+	blob = fwupd_json_object_to_bytes(json_obj, FWUPD_JSON_EXPORT_FLAG_TRAILING_NEWLINE);
+	return fu_bytes_set_contents(filename, blob, error);
+}
+
 static void
 fu_progress_add_string(FwupdCodec *codec, guint idt, GString *str)
 {
@@ -1140,6 +1261,8 @@ fu_progress_init(FuProgress *self)
 	self->children = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	self->duration = 0.f;
 	self->global_fraction = 1.f;
+	self->time_start = g_get_monotonic_time();
+	self->time_child_start = self->time_start;
 }
 
 static void
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <fwupdplugin.h>
+
+#include "fu-quirks-private.h"
+
+/* the build directory contains other files, so only compile the quirk files we were given */
+static gboolean
+fu_quirks_compiler_stage_file(FuTemporaryDirectory *tmpdir, const gchar *filename, GError **error)
+{
+	g_autofree gchar *basename = g_path_get_basename(filename);
+	g_autofree gchar *fn_dst = fu_temporary_directory_build(tmpdir, basename, NULL);
+	g_autoptr(GFile) file_src = g_file_new_for_path(filename);
+	g_autoptr(GFile) file_dst = g_file_new_for_path(fn_dst);
+
+	if (!g_file_copy(file_src, file_dst, G_FILE_COPY_NONE, NULL, NULL, NULL, error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+int
+main(int argc, char **argv)
+{
+	g_autofree gchar *vendor_ids_dir = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuQuirks) quirks = fu_quirks_new(ctx);
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GOptionContext) context = g_option_context_new("OUTDIR QUIRK-FILE...");
+	g_autoptr(GError) error = NULL;
+
+	const GOptionEntry options[] = {
+	    {"vendor-ids-dir",
+	     '\0',
+	     0,
+	     G_OPTION_ARG_FILENAME,
+	     &vendor_ids_dir,
+	     "Directory of vendor ID databases",
+	     NULL},
+	    {NULL}};
+
+	g_option_context_add_main_entries(context, options, NULL);
+	if (!g_option_context_parse(context, &argc, &argv, &error)) {
+		g_printerr("Failed to parse arguments: %s\n", error->message);
+		return EXIT_FAILURE;
+	}
+	if (argc < 3) {
+		g_printerr("Please specify an output directory and at least one quirk file\n");
+		return EXIT_FAILURE;
+	}
+	tmpdir = fu_temporary_directory_new("quirks-compiler", &error);
+	if (tmpdir == NULL) {
+		g_printerr("Failed to create directory: %s\n", error->message);
+		return EXIT_FAILURE;
+	}
+	for (gint i = 2; i < argc; i++) {
+		if (!fu_quirks_compiler_stage_file(tmpdir, argv[i], &error)) {
+			g_printerr("Failed to copy %s: %s\n", argv[i], error->message);
+			return EXIT_FAILURE;
+		}
+	}
+
+	/* only use the paths we were given */
+	fu_context_add_flag(ctx, FU_CONTEXT_FLAG_NO_CACHE);
+	fu_context_set_path(ctx,
+			    FU_PATH_KIND_DATADIR_QUIRKS,
+			    fu_temporary_directory_get_path(tmpdir));
+	if (vendor_ids_dir != NULL)
+		fu_context_set_path(ctx, FU_PATH_KIND_DATADIR_VENDOR_IDS, vendor_ids_dir);
+	if (!fu_quirks_compile(quirks, argv[1], &error)) {
+		g_printerr("Failed to compile quirks: %s\n", error->message);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-quirks.h"
+
+G_BEGIN_DECLS
+
+guint64
+fu_quirks_get_results_hits(FuQuirks *self) G_GNUC_NON_NULL(1);
+guint64
+fu_quirks_get_results_misses(FuQuirks *self) G_GNUC_NON_NULL(1);
+gboolean
+fu_quirks_get_precompiled(FuQuirks *self) G_GNUC_NON_NULL(1);
+gboolean
+fu_quirks_compile(FuQuirks *self, const gchar *dirname, GError **error) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_NON_NULL(1, 2);
+
+G_END_DECLS
@@ -11,6 +11,8 @@
 #include "fwupd-enums-private.h"
 
 #include "fu-context-private.h"
+#include "fu-quirks-private.h"
+#include "fu-test.h"
 
 typedef struct {
 	gboolean seen_one;
@@ -66,6 +68,59 @@ fu_quirks_append_func(void)
 	g_assert_true(helper.seen_two);
 }
 
+static void
+fu_quirks_results_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *guid = NULL;
+	g_autofree gchar *guid_again = NULL;
+	g_autofree gchar *testdatadir = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuQuirks) quirks = fu_quirks_new(ctx);
+	g_autoptr(GError) error = NULL;
+
+	/* the instance ID is only hashed once */
+	guid = fu_context_get_instance_id_guid(ctx, "USB\\VID_273F&PID_1004");
+	guid_again = fu_context_get_instance_id_guid(ctx, "USB\\VID_273F&PID_1004");
+	g_assert_cmpstr(guid, ==, "2fa8891f-3ece-53a4-adc4-0dd875685f30");
+	g_assert_cmpstr(guid_again, ==, guid);
+
+	/* set up test harness */
+	testdatadir = g_test_build_filename(G_TEST_DIST, "tests", "quirks.d", NULL);
+	fu_context_set_path(ctx, FU_PATH_KIND_DATADIR_QUIRKS, testdatadir);
+	fu_context_add_flag(ctx, FU_CONTEXT_FLAG_NO_CACHE);
+	ret = fu_quirks_load(quirks, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* the second lookup returns the same results without querying the silo */
+	for (guint i = 0; i < 2; i++) {
+		FuQuirksAppendHelper helper = {0};
+		ret = fu_quirks_lookup_by_id_iter(quirks,
+						  "b19d1c67-a29a-51ce-9cae-f7b40fe5505b",
+						  NULL,
+						  fu_quirks_append_cb,
+						  &helper);
+		g_assert_true(ret);
+		g_assert_true(helper.seen_one);
+		g_assert_true(helper.seen_two);
+	}
+	g_assert_cmpint(fu_quirks_get_results_misses(quirks), ==, 1);
+	g_assert_cmpint(fu_quirks_get_results_hits(quirks), ==, 1);
+
+	/* a GUID with no quirks is also cached */
+	for (guint i = 0; i < 2; i++) {
+		ret = fu_quirks_lookup_by_id_iter(quirks,
+						  "00000000-0000-0000-0000-000000000000",
+						  NULL,
+						  fu_quirks_append_cb,
+						  NULL);
+		g_assert_false(ret);
+	}
+	g_assert_cmpint(fu_quirks_get_results_misses(quirks), ==, 2);
+	g_assert_cmpint(fu_quirks_get_results_hits(quirks), ==, 2);
+}
+
 static void
 fu_quirks_vendor_ids_func(void)
 {
@@ -112,6 +167,100 @@ fu_quirks_vendor_ids_func(void)
 	g_assert_cmpstr(tmp, ==, "AnyPoint (TM) Home Network 1.6 Mbps Wireless Adapter");
 }
 
+static void
+fu_quirks_precompiled_func(void)
+{
+	gboolean ret;
+	const gchar *tmp;
+	g_autofree gchar *fn_src = NULL;
+	g_autofree gchar *fn_dst = NULL;
+	g_autofree gchar *quirksdir = NULL;
+	g_autofree gchar *testdatadir = NULL;
+	g_autoptr(FuContext) ctx1 = fu_context_new();
+	g_autoptr(FuContext) ctx2 = fu_context_new();
+	g_autoptr(FuContext) ctx3 = fu_context_new();
+	g_autoptr(FuQuirks) quirks1 = fu_quirks_new(ctx1);
+	g_autoptr(FuQuirks) quirks2 = fu_quirks_new(ctx2);
+	g_autoptr(FuQuirks) quirks3 = fu_quirks_new(ctx3);
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GString) str = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+	g_autoptr(GError) error = NULL;
+
+	tmpdir = fu_temporary_directory_new("quirks-precompiled", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+
+	/* copy the quirk file so the precompiled files can be written alongside */
+	testdatadir = g_test_build_filename(G_TEST_DIST, "tests", NULL);
+	fn_src = g_test_build_filename(G_TEST_DIST, "tests", "quirks.d", "tests.quirk", NULL);
+	fn_dst = fu_temporary_directory_build(tmpdir, "quirks.d", "tests.quirk", NULL);
+	quirksdir = fu_temporary_directory_build(tmpdir, "quirks.d", NULL);
+	blob = fu_bytes_get_contents(fn_src, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	ret = fu_bytes_set_contents(fn_dst, blob, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* like the build system */
+	fu_context_add_flag(ctx1, FU_CONTEXT_FLAG_NO_CACHE);
+	fu_context_set_path(ctx1, FU_PATH_KIND_DATADIR_QUIRKS, quirksdir);
+	fu_context_set_path(ctx1, FU_PATH_KIND_DATADIR_VENDOR_IDS, testdatadir);
+	ret = fu_quirks_compile(quirks1, quirksdir, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* load without a cache */
+	fu_context_add_flag(ctx2, FU_CONTEXT_FLAG_NO_CACHE);
+	fu_context_set_path(ctx2, FU_PATH_KIND_DATADIR_QUIRKS, quirksdir);
+	fu_context_set_path(ctx2, FU_PATH_KIND_DATADIR_VENDOR_IDS, testdatadir);
+	g_timer_reset(timer);
+	ret = fu_quirks_load(quirks2, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_debug("load=%.3fms", g_timer_elapsed(timer, NULL) * 1000.f);
+	g_assert_true(fu_quirks_get_precompiled(quirks2));
+	tmp = fu_quirks_lookup_by_id(quirks2, "bb9ec3e2-77b3-53bc-a1f1-b05916715627", "Name");
+	g_assert_cmpstr(tmp, ==, "Hub");
+#ifdef HAVE_SQLITE
+	{
+		g_autofree gchar *guid = fwupd_guid_hash_string("USB\\VID_8086");
+		tmp = fu_quirks_lookup_by_id(quirks2, guid, FWUPD_RESULT_KEY_VENDOR);
+		g_assert_cmpstr(tmp, ==, "Intel Corp.");
+	}
+#endif
+
+	/* modified without changing the size, so the precompiled silo cannot be used */
+	str = g_string_new_len(g_bytes_get_data(blob, NULL), g_bytes_get_size(blob));
+	g_assert_cmpint(g_string_replace(str, "Name = Hub", "Name = Bus", 1), ==, 1);
+	ret = g_file_set_contents(fn_dst, str->str, str->len, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_context_add_flag(ctx3, FU_CONTEXT_FLAG_NO_CACHE);
+	fu_context_set_path(ctx3, FU_PATH_KIND_DATADIR_QUIRKS, quirksdir);
+	fu_context_set_path(ctx3, FU_PATH_KIND_DATADIR_VENDOR_IDS, testdatadir);
+	ret = fu_quirks_load(quirks3, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_false(fu_quirks_get_precompiled(quirks3));
+	tmp = fu_quirks_lookup_by_id(quirks3, "bb9ec3e2-77b3-53bc-a1f1-b05916715627", "Name");
+	g_assert_cmpstr(tmp, ==, "Bus");
+
+	/* the quirks loaded from the precompiled silo also notice the change */
+	for (guint i = 0; i < 100; i++) {
+		tmp = fu_quirks_lookup_by_id(quirks2,
+					     "bb9ec3e2-77b3-53bc-a1f1-b05916715627",
+					     "Name");
+		if (g_strcmp0(tmp, "Bus") == 0)
+			break;
+		fu_test_loop_run_with_timeout(20);
+	}
+	g_assert_cmpstr(tmp, ==, "Bus");
+	g_assert_false(fu_quirks_get_precompiled(quirks2));
+}
+
 static void
 fu_quirks_performance_func(void)
 {
@@ -149,7 +298,9 @@ main(int argc, char **argv)
 	(void)g_setenv("G_TEST_SRCDIR", SRCDIR, FALSE);
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/quirks/append", fu_quirks_append_func);
+	g_test_add_func("/fwupd/quirks/results", fu_quirks_results_func);
 	g_test_add_func("/fwupd/quirks/vendor-ids", fu_quirks_vendor_ids_func);
+	g_test_add_func("/fwupd/quirks/precompiled", fu_quirks_precompiled_func);
 	g_test_add_func("/fwupd/quirks/performance", fu_quirks_performance_func);
 	return g_test_run();
 }
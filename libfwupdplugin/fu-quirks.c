@@ -9,6 +9,7 @@
 #include "config.h"
 
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #include <string.h>
 
 #ifdef HAVE_SQLITE
@@ -24,7 +25,7 @@
 #include "fu-memory-input-stream.h"
 #include "fu-path-store.h"
 #include "fu-path.h"
-#include "fu-quirks.h"
+#include "fu-quirks-private.h"
 #include "fu-string.h"
 
 /**
@@ -53,6 +54,11 @@
  *
  * You can add quirk files in `/usr/share/fwupd/quirks.d` or `/var/lib/fwupd/quirks.d/`.
  *
+ * The quirk files in `/usr/share/fwupd/quirks.d` and the vendor ID databases can also be
+ * precompiled when building the package, and if the installed files have not been modified
+ * since then the precompiled silo and database are used directly, rather than being rebuilt
+ * at startup. Any later changes to the quirk files cause the silo to be rebuilt as normal.
+ *
  * Here is an example as seen in the CSR plugin:
  *
  * |[
@@ -80,15 +86,91 @@ struct _FuQuirks {
 	XbSilo *silo;
 	XbQuery *query_kv;
 	XbQuery *query_vs;
+	XbSilo *silo_builtin; /* precompiled, nullable */
+	XbQuery *query_builtin_kv;
+	XbQuery *query_builtin_vs;
+	GFileMonitor *monitor_builtin; /* nullable */
 	gboolean verbose;
 	gboolean loaded;
 #ifdef HAVE_SQLITE
 	sqlite3 *db;
 #endif
+	GHashTable *results; /* guid:FuQuirksResults */
+	GMutex results_mutex;
+	guint64 results_hits;
+	guint64 results_misses;
 };
 
+typedef struct {
+	gchar *key;
+	gchar *value;
+	FuContextQuirkSource source;
+} FuQuirksResult;
+
+typedef struct {
+	gboolean found;
+	GPtrArray *results; /* element-type FuQuirksResult */
+} FuQuirksResults;
+
 G_DEFINE_TYPE(FuQuirks, fu_quirks, G_TYPE_OBJECT)
 
+#define FU_QUIRKS_PRECOMPILED_SILO "quirks.xmlb"
+#define FU_QUIRKS_PRECOMPILED_DB   "quirks.db"
+
+/* each device adds a dozen or so instance IDs, so this is plenty */
+#define FU_QUIRKS_RESULTS_MAX 4096
+
+static void
+fu_quirks_result_free(FuQuirksResult *result)
+{
+	g_free(result->key);
+	g_free(result->value);
+	g_free(result);
+}
+
+static void
+fu_quirks_results_free(FuQuirksResults *results)
+{
+	g_ptr_array_unref(results->results);
+	g_free(results);
+}
+
+static void
+fu_quirks_results_invalidate(FuQuirks *self)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->results_mutex);
+	g_hash_table_remove_all(self->results);
+}
+
+static GPtrArray *
+fu_quirks_results_lookup(FuQuirks *self, const gchar *guid, gboolean *found)
+{
+	FuQuirksResults *cached;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->results_mutex);
+
+	cached = g_hash_table_lookup(self->results, guid);
+	if (cached == NULL) {
+		self->results_misses++;
+		return NULL;
+	}
+	self->results_hits++;
+	*found = cached->found;
+	return g_ptr_array_ref(cached->results);
+}
+
+static void
+fu_quirks_results_insert(FuQuirks *self, const gchar *guid, gboolean found, GPtrArray *results)
+{
+	FuQuirksResults *cached = g_new0(FuQuirksResults, 1);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->results_mutex);
+
+	cached->found = found;
+	cached->results = g_ptr_array_ref(results);
+	if (g_hash_table_size(self->results) >= FU_QUIRKS_RESULTS_MAX)
+		g_hash_table_remove_all(self->results);
+	g_hash_table_replace(self->results, g_strdup(guid), cached);
+}
+
 #ifdef HAVE_SQLITE
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(sqlite3_stmt, sqlite3_finalize);
 #endif
@@ -291,22 +373,23 @@ fu_quirks_filename_sort_cb(gconstpointer a, gconstpointer b)
 	return g_strcmp0(stra, strb);
 }
 
-static gboolean
-fu_quirks_add_quirks_for_path(FuQuirks *self, XbBuilder *builder, const gchar *path, GError **error)
+static GPtrArray *
+fu_quirks_get_filenames_for_path(const gchar *path, GError **error)
 {
 	const gchar *tmp;
 	g_autoptr(GDir) dir = NULL;
 	g_autoptr(GPtrArray) filenames = g_ptr_array_new_with_free_func(g_free);
 
-	g_info("loading quirks from %s", path);
-
 	/* add valid files to the array */
 	if (!g_file_test(path, G_FILE_TEST_EXISTS))
-		return TRUE;
+		return g_steal_pointer(&filenames);
 	dir = g_dir_open(path, 0, error);
 	if (dir == NULL)
-		return FALSE;
+		return NULL;
 	while ((tmp = g_dir_read_name(dir)) != NULL) {
+		if (g_strcmp0(tmp, FU_QUIRKS_PRECOMPILED_SILO) == 0 ||
+		    g_strcmp0(tmp, FU_QUIRKS_PRECOMPILED_DB) == 0)
+			continue;
 		if (!g_str_has_suffix(tmp, ".quirk") && !g_str_has_suffix(tmp, ".quirk.gz")) {
 			g_debug("skipping invalid file %s", tmp);
 			continue;
@@ -316,6 +399,18 @@ fu_quirks_add_quirks_for_path(FuQuirks *self, XbBuilder *builder, const gchar *p
 
 	/* sort */
 	g_ptr_array_sort(filenames, fu_quirks_filename_sort_cb);
+	return g_steal_pointer(&filenames);
+}
+
+static gboolean
+fu_quirks_add_quirks_for_path(FuQuirks *self, XbBuilder *builder, const gchar *path, GError **error)
+{
+	g_autoptr(GPtrArray) filenames = NULL;
+
+	g_info("loading quirks from %s", path);
+	filenames = fu_quirks_get_filenames_for_path(path, error);
+	if (filenames == NULL)
+		return FALSE;
 
 	/* process files */
 	for (guint i = 0; i < filenames->len; i++) {
@@ -356,6 +451,188 @@ fu_quirks_strcasecmp_cb(gconstpointer a, gconstpointer b)
 	return g_ascii_strcasecmp(entry1, entry2);
 }
 
+/* only used to detect modified files, so this does not need to be cryptographically strong */
+static gchar *
+fu_quirks_compute_checksum_for_filename(const gchar *filename, GError **error)
+{
+	g_autoptr(GMappedFile) mapped_file = NULL;
+
+	mapped_file = g_mapped_file_new(filename, FALSE, error);
+	if (mapped_file == NULL) {
+		fwupd_error_convert(error);
+		return NULL;
+	}
+	return g_compute_checksum_for_data(G_CHECKSUM_SHA1,
+					   (const guchar *)g_mapped_file_get_contents(mapped_file),
+					   g_mapped_file_get_length(mapped_file));
+}
+
+/* the basename, size and hash of each quirk file, used to check the precompiled silo is valid */
+static gchar *
+fu_quirks_build_manifest(const gchar *path, GError **error)
+{
+	g_autoptr(GPtrArray) filenames = NULL;
+	g_autoptr(GString) str = g_string_new("quirks");
+
+	filenames = fu_quirks_get_filenames_for_path(path, error);
+	if (filenames == NULL)
+		return NULL;
+	for (guint i = 0; i < filenames->len; i++) {
+		const gchar *filename = g_ptr_array_index(filenames, i);
+		GStatBuf statbuf = {0};
+		g_autofree gchar *basename = g_path_get_basename(filename);
+		g_autofree gchar *checksum = NULL;
+
+		if (g_stat(filename, &statbuf) != 0) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_READ,
+				    "failed to stat %s",
+				    filename);
+			return NULL;
+		}
+		checksum = fu_quirks_compute_checksum_for_filename(filename, error);
+		if (checksum == NULL)
+			return NULL;
+		g_string_append_printf(str,
+				       ",%s:%" G_GUINT64_FORMAT ":%s",
+				       basename,
+				       (guint64)statbuf.st_size,
+				       checksum);
+	}
+	return g_string_free(g_steal_pointer(&str), FALSE);
+}
+
+static gboolean
+fu_quirks_prepare_queries(XbSilo *silo, XbQuery **query_kv, XbQuery **query_vs, GError **error)
+{
+	g_autoptr(XbNode) n_any = NULL;
+	g_autoptr(XbQuery) query_kv_tmp = NULL;
+	g_autoptr(XbQuery) query_vs_tmp = NULL;
+
+	/* check if there is any quirk data to load, as older libxmlb versions will not be able to
+	 * create the prepared query with an unknown text ID */
+	n_any = xb_silo_query_first(silo, "quirk", NULL);
+	if (n_any == NULL) {
+		g_debug("no quirk data, not creating prepared queries");
+		return TRUE;
+	}
+
+	/* create prepared queries to save time later */
+	query_kv_tmp = xb_query_new_full(silo,
+					 "quirk/device[@id=?]/value[@key=?]",
+					 XB_QUERY_FLAG_OPTIMIZE,
+					 error);
+	if (query_kv_tmp == NULL) {
+		g_prefix_error_literal(error, "failed to prepare query: ");
+		return FALSE;
+	}
+	query_vs_tmp = xb_query_new_full(silo,
+					 "quirk/device[@id=?]/value",
+					 XB_QUERY_FLAG_OPTIMIZE,
+					 error);
+	if (query_vs_tmp == NULL) {
+		g_prefix_error_literal(error, "failed to prepare query: ");
+		return FALSE;
+	}
+	if (!xb_silo_query_build_index(silo, "quirk/device", "id", error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	if (!xb_silo_query_build_index(silo, "quirk/device/value", "key", error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+
+	/* success */
+	g_set_object(query_kv, query_kv_tmp);
+	g_set_object(query_vs, query_vs_tmp);
+	return TRUE;
+}
+
+static gboolean
+fu_quirks_load_precompiled_silo(FuQuirks *self, const gchar *datadir, GError **error)
+{
+	g_autofree gchar *filename = NULL;
+	g_autofree gchar *manifest = NULL;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(XbNode) n_manifest = NULL;
+	g_autoptr(XbSilo) silo = xb_silo_new();
+
+	g_clear_object(&self->query_builtin_kv);
+	g_clear_object(&self->query_builtin_vs);
+	g_clear_object(&self->silo_builtin);
+
+	/* not shipped */
+	filename = g_build_filename(datadir, FU_QUIRKS_PRECOMPILED_SILO, NULL);
+	if (!g_file_test(filename, G_FILE_TEST_EXISTS))
+		return TRUE;
+
+	/* this is mmap'ed rather than read into memory */
+	file = g_file_new_for_path(filename);
+	if (!xb_silo_load_from_file(silo, file, XB_SILO_LOAD_FLAG_NONE, NULL, &error_local)) {
+		g_debug("ignoring %s: %s", filename, error_local->message);
+		return TRUE;
+	}
+
+	/* the quirk files have been modified since the package was built */
+	manifest = fu_quirks_build_manifest(datadir, error);
+	if (manifest == NULL)
+		return FALSE;
+	n_manifest = xb_silo_query_first(silo, "manifest", NULL);
+	if (n_manifest == NULL || g_strcmp0(xb_node_get_text(n_manifest), manifest) != 0) {
+		g_debug("ignoring %s as quirks have changed", filename);
+		return TRUE;
+	}
+	if (!fu_quirks_prepare_queries(silo,
+				       &self->query_builtin_kv,
+				       &self->query_builtin_vs,
+				       error))
+		return FALSE;
+
+	/* success */
+	g_info("using precompiled quirks from %s", filename);
+	self->silo_builtin = g_steal_pointer(&silo);
+	return TRUE;
+}
+
+static void
+fu_quirks_builtin_changed_cb(GFileMonitor *monitor,
+			     GFile *file,
+			     GFile *other_file,
+			     GFileMonitorEvent event_type,
+			     gpointer user_data)
+{
+	FuQuirks *self = FU_QUIRKS(user_data);
+	g_autofree gchar *fn = g_file_get_path(file);
+
+	/* the precompiled silo does not watch the source files, so rebuild on next use */
+	g_debug("%s changed, checking precompiled quirks", fn);
+	if (self->silo != NULL)
+		xb_silo_invalidate(self->silo);
+}
+
+static gboolean
+fu_quirks_watch_builtin(FuQuirks *self, const gchar *datadir, GError **error)
+{
+	g_autoptr(GFile) file = NULL;
+
+	if (self->monitor_builtin != NULL)
+		return TRUE;
+	file = g_file_new_for_path(datadir);
+	self->monitor_builtin = g_file_monitor_directory(file, G_FILE_MONITOR_NONE, NULL, error);
+	if (self->monitor_builtin == NULL) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	g_signal_connect(self->monitor_builtin,
+			 "changed",
+			 G_CALLBACK(fu_quirks_builtin_changed_cb),
+			 self);
+	return TRUE;
+}
+
 static gboolean
 fu_quirks_check_silo(FuQuirks *self, GError **error)
 {
@@ -364,18 +641,27 @@ fu_quirks_check_silo(FuQuirks *self, GError **error)
 	const gchar *localstatedir = NULL;
 	g_autoptr(GFile) file = NULL;
 	g_autoptr(XbBuilder) builder = NULL;
-	g_autoptr(XbNode) n_any = NULL;
 
 	/* everything is okay */
 	if (self->silo != NULL && xb_silo_is_valid(self->silo))
 		return TRUE;
 
-	/* system datadir */
+	/* any cached results may now be wrong */
+	fu_quirks_results_invalidate(self);
+
+	/* system datadir, using the precompiled silo if it is still valid */
 	builder = xb_builder_new();
 	datadir = fu_context_get_path(self->ctx, FU_PATH_KIND_DATADIR_QUIRKS, NULL);
 	if (datadir != NULL) {
-		if (!fu_quirks_add_quirks_for_path(self, builder, datadir, error))
+		if (!fu_quirks_load_precompiled_silo(self, datadir, error))
 			return FALSE;
+		if (self->silo_builtin == NULL) {
+			if (!fu_quirks_add_quirks_for_path(self, builder, datadir, error))
+				return FALSE;
+		} else {
+			if (!fu_quirks_watch_builtin(self, datadir, error))
+				return FALSE;
+		}
 	}
 
 	/* something we can write when using Ostree */
@@ -409,6 +695,9 @@ fu_quirks_check_silo(FuQuirks *self, GError **error)
 	}
 	if (fu_context_has_flag(self->ctx, FU_CONTEXT_FLAG_READONLY_FS))
 		compile_flags |= XB_BUILDER_COMPILE_FLAG_IGNORE_GUID;
+	g_clear_object(&self->query_kv);
+	g_clear_object(&self->query_vs);
+	g_clear_object(&self->silo);
 	self->silo = xb_builder_ensure(builder, file, compile_flags, NULL, error);
 	if (self->silo == NULL)
 		return FALSE;
@@ -421,42 +710,41 @@ fu_quirks_check_silo(FuQuirks *self, GError **error)
 		g_info("invalid key names: %s", str);
 	}
 
-	/* check if there is any quirk data to load, as older libxmlb versions will not be able to
-	 * create the prepared query with an unknown text ID */
-	n_any = xb_silo_query_first(self->silo, "quirk", NULL);
-	if (n_any == NULL) {
-		g_debug("no quirk data, not creating prepared queries");
-		return TRUE;
-	}
+	/* success */
+	return fu_quirks_prepare_queries(self->silo, &self->query_kv, &self->query_vs, error);
+}
 
-	/* create prepared queries to save time later */
-	self->query_kv = xb_query_new_full(self->silo,
-					   "quirk/device[@id=?]/value[@key=?]",
-					   XB_QUERY_FLAG_OPTIMIZE,
-					   error);
-	if (self->query_kv == NULL) {
-		g_prefix_error_literal(error, "failed to prepare query: ");
-		return FALSE;
-	}
-	self->query_vs = xb_query_new_full(self->silo,
-					   "quirk/device[@id=?]/value",
-					   XB_QUERY_FLAG_OPTIMIZE,
-					   error);
-	if (self->query_vs == NULL) {
-		g_prefix_error_literal(error, "failed to prepare query: ");
-		return FALSE;
-	}
-	if (!xb_silo_query_build_index(self->silo, "quirk/device", "id", error)) {
-		fwupd_error_convert(error);
-		return FALSE;
-	}
-	if (!xb_silo_query_build_index(self->silo, "quirk/device/value", "key", error)) {
-		fwupd_error_convert(error);
-		return FALSE;
-	}
+static const gchar *
+fu_quirks_lookup_by_id_for_silo(FuQuirks *self,
+				XbSilo *silo,
+				XbQuery *query_kv,
+				const gchar *guid,
+				const gchar *key)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbNode) n = NULL;
+	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
 
-	/* success */
-	return TRUE;
+	/* no quirk data */
+	if (query_kv == NULL)
+		return NULL;
+
+	/* query */
+	xb_query_context_set_flags(&context, XB_QUERY_FLAG_USE_INDEXES);
+	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
+	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 1, key, NULL);
+	n = xb_silo_query_first_with_context(silo, query_kv, &context, &error);
+	if (n == NULL) {
+		if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+			return NULL;
+		if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
+			return NULL;
+		g_warning("failed to query: %s", error->message);
+		return NULL;
+	}
+	if (self->verbose)
+		g_debug("%s:%s → %s", guid, key, xb_node_get_text(n));
+	return xb_node_get_text(n);
 }
 
 /**
@@ -474,9 +762,8 @@ fu_quirks_check_silo(FuQuirks *self, GError **error)
 const gchar *
 fu_quirks_lookup_by_id(FuQuirks *self, const gchar *guid, const gchar *key)
 {
+	const gchar *value;
 	g_autoptr(GError) error = NULL;
-	g_autoptr(XbNode) n = NULL;
-	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
 
 	g_return_val_if_fail(FU_IS_QUIRKS(self), NULL);
 	g_return_val_if_fail(self->loaded, NULL);
@@ -485,7 +772,7 @@ fu_quirks_lookup_by_id(FuQuirks *self, const gchar *guid, const gchar *key)
 
 #ifdef HAVE_SQLITE
 	/* this is generated from usb.ids and other static sources */
-	if (self->db != NULL && !fu_context_has_flag(self->ctx, FU_CONTEXT_FLAG_NO_CACHE)) {
+	if (self->db != NULL) {
 		g_autoptr(sqlite3_stmt) stmt = NULL;
 		if (sqlite3_prepare_v2(self->db,
 				       "SELECT key, value FROM quirks WHERE guid = ?1 "
@@ -512,61 +799,94 @@ fu_quirks_lookup_by_id(FuQuirks *self, const gchar *guid, const gchar *key)
 		return NULL;
 	}
 
+	/* the datadir quirks are loaded before the localstatedir quirks */
+	value = fu_quirks_lookup_by_id_for_silo(self,
+						self->silo_builtin,
+						self->query_builtin_kv,
+						guid,
+						key);
+	if (value != NULL)
+		return value;
+	return fu_quirks_lookup_by_id_for_silo(self, self->silo, self->query_kv, guid, key);
+}
+
+static gboolean
+fu_quirks_lookup_by_id_iter_for_silo(FuQuirks *self,
+				     XbSilo *silo,
+				     XbQuery *query_kv,
+				     XbQuery *query_vs,
+				     const gchar *guid,
+				     const gchar *key,
+				     FuQuirksIter iter_cb,
+				     gpointer user_data)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) results = NULL;
+	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
+
 	/* no quirk data */
-	if (self->query_kv == NULL)
-		return NULL;
+	if (query_vs == NULL)
+		return FALSE;
 
 	/* query */
 	xb_query_context_set_flags(&context, XB_QUERY_FLAG_USE_INDEXES);
 	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
-	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 1, key, NULL);
-	n = xb_silo_query_first_with_context(self->silo, self->query_kv, &context, &error);
-	if (n == NULL) {
+	if (key != NULL) {
+		xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 1, key, NULL);
+		results = xb_silo_query_with_context(silo, query_kv, &context, &error);
+	} else {
+		results = xb_silo_query_with_context(silo, query_vs, &context, &error);
+	}
+	if (results == NULL) {
 		if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
-			return NULL;
+			return FALSE;
 		if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
-			return NULL;
+			return FALSE;
 		g_warning("failed to query: %s", error->message);
-		return NULL;
+		return FALSE;
 	}
-	if (self->verbose)
-		g_debug("%s:%s → %s", guid, key, xb_node_get_text(n));
-	return xb_node_get_text(n);
+	for (guint i = 0; i < results->len; i++) {
+		XbNode *n = g_ptr_array_index(results, i);
+		if (self->verbose)
+			g_debug("%s → %s", guid, xb_node_get_text(n));
+		iter_cb(self,
+			xb_node_get_attr(n, "key"),
+			xb_node_get_text(n),
+			FU_CONTEXT_QUIRK_SOURCE_FILE,
+			user_data);
+	}
+
+	return TRUE;
 }
 
-/**
- * fu_quirks_lookup_by_id_iter:
- * @self: a #FuQuirks
- * @guid: GUID to lookup
- * @key: (nullable): an ID to match the entry, e.g. `Name`, or %NULL for all keys
- * @iter_cb: (scope call) (closure user_data): a function to call for each result
- * @user_data: user data passed to @iter_cb
- *
- * Looks up all entries in the hardware database using a GUID value.
- *
- * Returns: %TRUE if the ID was found, and @iter was called
- *
- * Since: 1.3.3
- **/
-gboolean
-fu_quirks_lookup_by_id_iter(FuQuirks *self,
-			    const gchar *guid,
-			    const gchar *key,
-			    FuQuirksIter iter_cb,
-			    gpointer user_data)
+static void
+fu_quirks_results_collect_cb(FuQuirks *self,
+			     const gchar *key,
+			     const gchar *value,
+			     FuContextQuirkSource source,
+			     gpointer user_data)
 {
-	g_autoptr(GError) error = NULL;
-	g_autoptr(GPtrArray) results = NULL;
-	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
+	GPtrArray *results = (GPtrArray *)user_data;
+	FuQuirksResult *result = g_new0(FuQuirksResult, 1);
+	result->key = g_strdup(key);
+	result->value = g_strdup(value);
+	result->source = source;
+	g_ptr_array_add(results, result);
+}
 
-	g_return_val_if_fail(FU_IS_QUIRKS(self), FALSE);
-	g_return_val_if_fail(self->loaded, FALSE);
-	g_return_val_if_fail(guid != NULL, FALSE);
-	g_return_val_if_fail(iter_cb != NULL, FALSE);
+static gboolean
+fu_quirks_lookup_by_id_iter_uncached(FuQuirks *self,
+				     const gchar *guid,
+				     const gchar *key,
+				     FuQuirksIter iter_cb,
+				     gpointer user_data)
+{
+	gboolean ret;
+	g_autoptr(GError) error = NULL;
 
 #ifdef HAVE_SQLITE
 	/* this is generated from usb.ids and other static sources */
-	if (self->db != NULL && !fu_context_has_flag(self->ctx, FU_CONTEXT_FLAG_NO_CACHE)) {
+	if (self->db != NULL) {
 		g_autoptr(sqlite3_stmt) stmt = NULL;
 		if (key == NULL) {
 			if (sqlite3_prepare_v2(self->db,
@@ -605,39 +925,136 @@ fu_quirks_lookup_by_id_iter(FuQuirks *self,
 		return FALSE;
 	}
 
-	/* no quirk data */
-	if (self->query_vs == NULL)
-		return FALSE;
+	/* the datadir quirks are loaded before the localstatedir quirks */
+	ret = fu_quirks_lookup_by_id_iter_for_silo(self,
+						   self->silo_builtin,
+						   self->query_builtin_kv,
+						   self->query_builtin_vs,
+						   guid,
+						   key,
+						   iter_cb,
+						   user_data);
+	if (fu_quirks_lookup_by_id_iter_for_silo(self,
+						 self->silo,
+						 self->query_kv,
+						 self->query_vs,
+						 guid,
+						 key,
+						 iter_cb,
+						 user_data))
+		ret = TRUE;
+	return ret;
+}
 
-	/* query */
-	xb_query_context_set_flags(&context, XB_QUERY_FLAG_USE_INDEXES);
-	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
-	if (key != NULL) {
-		xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 1, key, NULL);
-		results = xb_silo_query_with_context(self->silo, self->query_kv, &context, &error);
-	} else {
-		results = xb_silo_query_with_context(self->silo, self->query_vs, &context, &error);
+/**
+ * fu_quirks_lookup_by_id_iter:
+ * @self: a #FuQuirks
+ * @guid: GUID to lookup
+ * @key: (nullable): an ID to match the entry, e.g. `Name`, or %NULL for all keys
+ * @iter_cb: (scope call) (closure user_data): a function to call for each result
+ * @user_data: user data passed to @iter_cb
+ *
+ * Looks up all entries in the hardware database using a GUID value.
+ *
+ * Returns: %TRUE if the ID was found, and @iter was called
+ *
+ * Since: 1.3.3
+ **/
+gboolean
+fu_quirks_lookup_by_id_iter(FuQuirks *self,
+			    const gchar *guid,
+			    const gchar *key,
+			    FuQuirksIter iter_cb,
+			    gpointer user_data)
+{
+	gboolean found = FALSE;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) results = NULL;
+
+	g_return_val_if_fail(FU_IS_QUIRKS(self), FALSE);
+	g_return_val_if_fail(self->loaded, FALSE);
+	g_return_val_if_fail(guid != NULL, FALSE);
+	g_return_val_if_fail(iter_cb != NULL, FALSE);
+
+	/* only the complete set of quirks for a GUID is cached */
+	if (key != NULL)
+		return fu_quirks_lookup_by_id_iter_uncached(self, guid, key, iter_cb, user_data);
+
+	/* ensure up to date, which also invalidates the cache if required */
+	if (!fu_quirks_check_silo(self, &error)) {
+		g_warning("failed to build silo: %s", error->message);
+		return FALSE;
 	}
+
+	/* use the results from last time, or run the query and save for next time */
+	results = fu_quirks_results_lookup(self, guid, &found);
 	if (results == NULL) {
-		if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
-			return FALSE;
-		if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
-			return FALSE;
-		g_warning("failed to query: %s", error->message);
-		return FALSE;
+		results = g_ptr_array_new_with_free_func((GDestroyNotify)fu_quirks_result_free);
+		found = fu_quirks_lookup_by_id_iter_uncached(self,
+							     guid,
+							     NULL,
+							     fu_quirks_results_collect_cb,
+							     results);
+		fu_quirks_results_insert(self, guid, found, results);
 	}
+
+	/* the callback is allowed to look up other quirks */
 	for (guint i = 0; i < results->len; i++) {
-		XbNode *n = g_ptr_array_index(results, i);
-		if (self->verbose)
-			g_debug("%s → %s", guid, xb_node_get_text(n));
-		iter_cb(self,
-			xb_node_get_attr(n, "key"),
-			xb_node_get_text(n),
-			FU_CONTEXT_QUIRK_SOURCE_FILE,
-			user_data);
+		FuQuirksResult *result = g_ptr_array_index(results, i);
+		iter_cb(self, result->key, result->value, result->source, user_data);
 	}
+	return found;
+}
 
-	return TRUE;
+/**
+ * fu_quirks_get_results_hits: (skip)
+ * @self: a #FuQuirks
+ *
+ * Gets the number of GUID lookups that were satisfied by the cache.
+ *
+ * Returns: integer
+ *
+ * Since: 2.2.1
+ **/
+guint64
+fu_quirks_get_results_hits(FuQuirks *self)
+{
+	g_return_val_if_fail(FU_IS_QUIRKS(self), 0);
+	return self->results_hits;
+}
+
+/**
+ * fu_quirks_get_results_misses: (skip)
+ * @self: a #FuQuirks
+ *
+ * Gets the number of GUID lookups that had to query the quirk database.
+ *
+ * Returns: integer
+ *
+ * Since: 2.2.1
+ **/
+guint64
+fu_quirks_get_results_misses(FuQuirks *self)
+{
+	g_return_val_if_fail(FU_IS_QUIRKS(self), 0);
+	return self->results_misses;
+}
+
+/**
+ * fu_quirks_get_precompiled: (skip)
+ * @self: a #FuQuirks
+ *
+ * Gets if the precompiled silo of the system quirk files is being used.
+ *
+ * Returns: %TRUE if precompiled
+ *
+ * Since: 2.2.1
+ **/
+gboolean
+fu_quirks_get_precompiled(FuQuirks *self)
+{
+	g_return_val_if_fail(FU_IS_QUIRKS(self), FALSE);
+	return self->silo_builtin != NULL;
 }
 
 #ifdef HAVE_SQLITE
@@ -847,40 +1264,38 @@ fu_quirks_db_sqlite3_exec(FuQuirks *self, const gchar *sql, GError **error)
 	return TRUE;
 }
 
+static const FuQuirksDbItem fu_quirks_db_items[] = {
+    {"pci.ids", "PCI", "VEN", "DEV", fu_quirks_db_add_usbids_cb},
+    {"usb.ids", "USB", "VID", "PID", fu_quirks_db_add_usbids_cb},
+    {"pnp.ids", "PNP", "VID", "PID", fu_quirks_db_add_pnpids_cb},
+    {"oui.txt", "OUI", "VID", "PID", fu_quirks_db_add_ouitxt_cb},
+};
+
 static gboolean
-fu_quirks_db_load(FuQuirks *self, GError **error)
+fu_quirks_db_create_tables(FuQuirks *self, GError **error)
 {
-	g_autoptr(sqlite3_stmt) stmt_insert = NULL;
-	g_autoptr(sqlite3_stmt) stmt_query = NULL;
-	g_autoptr(GString) fn_mtimes = g_string_new("quirks");
-	g_autofree gchar *guid_fwupd = fwupd_guid_hash_string("fwupd");
-	const FuQuirksDbItem map[] = {
-	    {"pci.ids", "PCI", "VEN", "DEV", fu_quirks_db_add_usbids_cb},
-	    {"usb.ids", "USB", "VID", "PID", fu_quirks_db_add_usbids_cb},
-	    {"pnp.ids", "PNP", "VID", "PID", fu_quirks_db_add_pnpids_cb},
-	    {"oui.txt", "OUI", "VID", "PID", fu_quirks_db_add_ouitxt_cb},
-	};
-
-	/* nothing to do */
-	if (fu_context_has_flag(self->ctx, FU_CONTEXT_FLAG_NO_CACHE))
-		return TRUE;
+	return fu_quirks_db_sqlite3_exec(
+	    self,
+	    "BEGIN TRANSACTION;"
+	    "CREATE TABLE IF NOT EXISTS quirks(guid, key, value);"
+	    "CREATE INDEX IF NOT EXISTS idx_quirks_guid ON quirks(guid);"
+	    "CREATE INDEX IF NOT EXISTS idx_quirks_guid_key ON quirks(guid, key);"
+	    "COMMIT;",
+	    error);
+}
 
-	/* create tables and indexes */
-	if (!fu_quirks_db_sqlite3_exec(
-		self,
-		"BEGIN TRANSACTION;"
-		"CREATE TABLE IF NOT EXISTS quirks(guid, key, value);"
-		"CREATE INDEX IF NOT EXISTS idx_quirks_guid ON quirks(guid);"
-		"CREATE INDEX IF NOT EXISTS idx_quirks_guid_key ON quirks(guid, key);"
-		"COMMIT;",
-		error)) {
-		return FALSE;
-	}
+/* the precompiled database cannot use the mtime as it is built on a different system, so
+ * the size and hash of each file is used instead */
+static gchar *
+fu_quirks_db_build_version(FuQuirks *self, gboolean use_mtime, GError **error)
+{
+	g_autoptr(GString) str = g_string_new("quirks");
 
 	/* find out the mtimes of each of the files we want to load into the db */
-	for (guint i = 0; i < G_N_ELEMENTS(map); i++) {
-		const FuQuirksDbItem *item = &map[i];
-		guint64 mtime;
+	for (guint i = 0; i < G_N_ELEMENTS(fu_quirks_db_items); i++) {
+		const FuQuirksDbItem *item = &fu_quirks_db_items[i];
+		const gchar *attr =
+		    use_mtime ? G_FILE_ATTRIBUTE_TIME_MODIFIED : G_FILE_ATTRIBUTE_STANDARD_SIZE;
 		g_autofree gchar *fn = NULL;
 		g_autoptr(GFile) file = NULL;
 		g_autoptr(GFileInfo) info = NULL;
@@ -895,40 +1310,50 @@ fu_quirks_db_load(FuQuirks *self, GError **error)
 		file = g_file_new_for_path(fn);
 		if (!g_file_query_exists(file, NULL))
 			continue;
-		info = g_file_query_info(file,
-					 G_FILE_ATTRIBUTE_TIME_MODIFIED,
-					 G_FILE_QUERY_INFO_NONE,
-					 NULL,
-					 error);
+		info = g_file_query_info(file, attr, G_FILE_QUERY_INFO_NONE, NULL, error);
 		if (info == NULL)
-			return FALSE;
-		mtime = g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
-		g_string_append_printf(fn_mtimes, ",%s:%" G_GUINT64_FORMAT, item->fn, mtime);
+			return NULL;
+		g_string_append_printf(str,
+				       ",%s:%" G_GUINT64_FORMAT,
+				       item->fn,
+				       g_file_info_get_attribute_uint64(info, attr));
+		if (!use_mtime) {
+			g_autofree gchar *checksum = NULL;
+			checksum = fu_quirks_compute_checksum_for_filename(fn, error);
+			if (checksum == NULL)
+				return NULL;
+			g_string_append_printf(str, ":%s", checksum);
+		}
 	}
+	return g_string_free(g_steal_pointer(&str), FALSE);
+}
+
+static gchar *
+fu_quirks_db_get_version(FuQuirks *self)
+{
+	g_autofree gchar *guid_fwupd = fwupd_guid_hash_string("fwupd");
+	g_autoptr(sqlite3_stmt) stmt_query = NULL;
 
-	/* check if the mtimes match */
 	if (sqlite3_prepare_v2(self->db,
 			       "SELECT value FROM quirks WHERE guid = ?1 and key = ?2",
 			       -1,
 			       &stmt_query,
 			       NULL) != SQLITE_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "failed to prepare SQL: %s",
-			    sqlite3_errmsg(self->db));
-		return FALSE;
+		g_debug("failed to prepare SQL: %s", sqlite3_errmsg(self->db));
+		return NULL;
 	}
 	sqlite3_bind_text(stmt_query, 1, guid_fwupd, -1, SQLITE_STATIC);
 	sqlite3_bind_text(stmt_query, 2, FWUPD_RESULT_KEY_VERSION, -1, SQLITE_STATIC);
-	while (sqlite3_step(stmt_query) == SQLITE_ROW) {
-		const gchar *fn_mtimes_old = (const gchar *)sqlite3_column_text(stmt_query, 0);
-		if (g_strcmp0(fn_mtimes->str, fn_mtimes_old) == 0) {
-			g_debug("mtimes unchanged: %s, doing nothing", fn_mtimes->str);
-			return TRUE;
-		}
-		g_debug("mtimes changed %s vs %s -- regenerating", fn_mtimes_old, fn_mtimes->str);
-	}
+	if (sqlite3_step(stmt_query) != SQLITE_ROW)
+		return NULL;
+	return g_strdup((const gchar *)sqlite3_column_text(stmt_query, 0));
+}
+
+static gboolean
+fu_quirks_db_import(FuQuirks *self, const gchar *version, GError **error)
+{
+	g_autoptr(sqlite3_stmt) stmt_insert = NULL;
+	g_autofree gchar *guid_fwupd = fwupd_guid_hash_string("fwupd");
 
 	/* delete any existing data */
 	if (!fu_quirks_db_sqlite3_exec(self, "BEGIN TRANSACTION;", error))
@@ -952,8 +1377,8 @@ fu_quirks_db_load(FuQuirks *self, GError **error)
 	}
 
 	/* populate database */
-	for (guint i = 0; i < G_N_ELEMENTS(map); i++) {
-		const FuQuirksDbItem *item = &map[i];
+	for (guint i = 0; i < G_N_ELEMENTS(fu_quirks_db_items); i++) {
+		const FuQuirksDbItem *item = &fu_quirks_db_items[i];
 		g_autofree gchar *fn = NULL;
 		g_autoptr(FuQuirksDbHelper) helper = g_new0(FuQuirksDbHelper, 1);
 		g_autoptr(GFile) file = NULL;
@@ -991,7 +1416,7 @@ fu_quirks_db_load(FuQuirks *self, GError **error)
 	sqlite3_reset(stmt_insert);
 	sqlite3_bind_text(stmt_insert, 1, guid_fwupd, -1, SQLITE_STATIC);
 	sqlite3_bind_text(stmt_insert, 2, FWUPD_RESULT_KEY_VERSION, -1, SQLITE_STATIC);
-	sqlite3_bind_text(stmt_insert, 3, fn_mtimes->str, -1, SQLITE_STATIC);
+	sqlite3_bind_text(stmt_insert, 3, version, -1, SQLITE_STATIC);
 	if (sqlite3_step(stmt_insert) != SQLITE_DONE) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -1006,6 +1431,75 @@ fu_quirks_db_load(FuQuirks *self, GError **error)
 	/* success */
 	return TRUE;
 }
+
+static gboolean
+fu_quirks_db_load(FuQuirks *self, GError **error)
+{
+	g_autofree gchar *version = NULL;
+	g_autofree gchar *version_old = NULL;
+
+	/* nothing to do */
+	if (fu_context_has_flag(self->ctx, FU_CONTEXT_FLAG_NO_CACHE))
+		return TRUE;
+
+	/* create tables and indexes */
+	if (!fu_quirks_db_create_tables(self, error))
+		return FALSE;
+
+	/* check if the mtimes match */
+	version = fu_quirks_db_build_version(self, TRUE, error);
+	if (version == NULL)
+		return FALSE;
+	version_old = fu_quirks_db_get_version(self);
+	if (g_strcmp0(version, version_old) == 0) {
+		g_debug("mtimes unchanged: %s, doing nothing", version);
+		return TRUE;
+	}
+	if (version_old != NULL)
+		g_debug("mtimes changed %s vs %s -- regenerating", version_old, version);
+	return fu_quirks_db_import(self, version, error);
+}
+
+static gboolean
+fu_quirks_db_load_precompiled(FuQuirks *self, GError **error)
+{
+	g_autofree gchar *filename = NULL;
+	g_autofree gchar *version = NULL;
+	g_autofree gchar *version_old = NULL;
+
+	/* not shipped */
+	filename = fu_context_build_filename(self->ctx,
+					     NULL,
+					     FU_PATH_KIND_DATADIR_QUIRKS,
+					     FU_QUIRKS_PRECOMPILED_DB,
+					     NULL);
+	if (filename == NULL || !g_file_test(filename, G_FILE_TEST_EXISTS))
+		return TRUE;
+	if (sqlite3_open_v2(filename, &self->db, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK) {
+		g_debug("ignoring %s: %s", filename, sqlite3_errmsg(self->db));
+		g_clear_pointer(&self->db, sqlite3_close);
+		return TRUE;
+	}
+
+	/* the vendor IDs have been updated since the package was built */
+	version = fu_quirks_db_build_version(self, FALSE, error);
+	if (version == NULL)
+		return FALSE;
+	version_old = fu_quirks_db_get_version(self);
+	if (g_strcmp0(version, version_old) != 0) {
+		g_debug("ignoring %s as %s does not match %s", filename, version_old, version);
+		g_clear_pointer(&self->db, sqlite3_close);
+		return TRUE;
+	}
+
+	/* use the page cache rather than copying pages into the heap */
+	if (!fu_quirks_db_sqlite3_exec(self, "PRAGMA mmap_size=268435456;", error))
+		return FALSE;
+
+	/* success */
+	g_info("using precompiled vendor IDs from %s", filename);
+	return TRUE;
+}
 #endif
 
 /**
@@ -1027,8 +1521,13 @@ fu_quirks_load(FuQuirks *self, GError **error)
 
 	self->loaded = TRUE;
 	self->verbose = g_getenv("FWUPD_XMLB_VERBOSE") != NULL;
+	fu_quirks_results_invalidate(self);
 
 #ifdef HAVE_SQLITE
+	if (self->db == NULL) {
+		if (!fu_quirks_db_load_precompiled(self, error))
+			return FALSE;
+	}
 	if (self->db == NULL && !fu_context_has_flag(self->ctx, FU_CONTEXT_FLAG_NO_CACHE)) {
 		g_autofree gchar *quirksdb = NULL;
 
@@ -1060,6 +1559,98 @@ fu_quirks_load(FuQuirks *self, GError **error)
 	return fu_quirks_check_silo(self, error);
 }
 
+/**
+ * fu_quirks_compile: (skip)
+ * @self: a #FuQuirks
+ * @dirname: a directory to write to, typically the build directory
+ * @error: (nullable): optional return location for an error
+ *
+ * Precompiles the quirk files in %FU_PATH_KIND_DATADIR_QUIRKS and the vendor ID databases in
+ * %FU_PATH_KIND_DATADIR_VENDOR_IDS so that they can be installed alongside the quirk files.
+ *
+ * The localstatedir quirks are not included, and are always compiled at runtime.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.2.1
+ **/
+gboolean
+fu_quirks_compile(FuQuirks *self, const gchar *dirname, GError **error)
+{
+	const gchar *datadir;
+	g_autofree gchar *fn_silo = NULL;
+	g_autofree gchar *manifest = NULL;
+	g_autoptr(GFile) file_silo = NULL;
+	g_autoptr(XbBuilder) builder = xb_builder_new();
+	g_autoptr(XbBuilderNode) bn_manifest = xb_builder_node_new("manifest");
+	g_autoptr(XbSilo) silo = NULL;
+
+	g_return_val_if_fail(FU_IS_QUIRKS(self), FALSE);
+	g_return_val_if_fail(dirname != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* the quirk files, and what they were when compiled */
+	datadir = fu_context_get_path(self->ctx, FU_PATH_KIND_DATADIR_QUIRKS, error);
+	if (datadir == NULL)
+		return FALSE;
+	if (!fu_quirks_add_quirks_for_path(self, builder, datadir, error))
+		return FALSE;
+	manifest = fu_quirks_build_manifest(datadir, error);
+	if (manifest == NULL)
+		return FALSE;
+	xb_builder_node_set_text(bn_manifest, manifest, -1);
+	xb_builder_import_node(builder, bn_manifest);
+	silo = xb_builder_compile(builder, XB_BUILDER_COMPILE_FLAG_NONE, NULL, error);
+	if (silo == NULL) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	fn_silo = g_build_filename(dirname, FU_QUIRKS_PRECOMPILED_SILO, NULL);
+	file_silo = g_file_new_for_path(fn_silo);
+	if (!xb_silo_save_to_file(silo, file_silo, NULL, error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+
+#ifdef HAVE_SQLITE
+	{
+		g_autofree gchar *fn_db = g_build_filename(dirname, FU_QUIRKS_PRECOMPILED_DB, NULL);
+		g_autofree gchar *version = NULL;
+
+		/* start from scratch */
+		g_clear_pointer(&self->db, sqlite3_close);
+		if (g_file_test(fn_db, G_FILE_TEST_EXISTS) && g_unlink(fn_db) != 0) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_WRITE,
+				    "failed to delete %s",
+				    fn_db);
+			return FALSE;
+		}
+		if (sqlite3_open(fn_db, &self->db) != SQLITE_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_READ,
+				    "cannot open %s: %s",
+				    fn_db,
+				    sqlite3_errmsg(self->db));
+			return FALSE;
+		}
+		if (!fu_quirks_db_create_tables(self, error))
+			return FALSE;
+		version = fu_quirks_db_build_version(self, FALSE, error);
+		if (version == NULL)
+			return FALSE;
+		if (!fu_quirks_db_import(self, version, error))
+			return FALSE;
+		g_clear_pointer(&self->db, sqlite3_close);
+	}
+#endif
+
+	/* success */
+	return TRUE;
+}
+
 /**
  * fu_quirks_add_possible_key:
  * @self: a #FuQuirks
@@ -1111,6 +1702,11 @@ fu_quirks_init(FuQuirks *self)
 {
 	self->possible_keys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 	self->invalid_keys = g_ptr_array_new_with_free_func(g_free);
+	self->results = g_hash_table_new_full(g_str_hash,
+					      g_str_equal,
+					      g_free,
+					      (GDestroyNotify)fu_quirks_results_free);
+	g_mutex_init(&self->results_mutex);
 
 	/* built in */
 	fu_quirks_add_possible_key(self, FU_QUIRKS_BRANCH);
@@ -1135,6 +1731,8 @@ fu_quirks_init(FuQuirks *self)
 	fu_quirks_add_possible_key(self, FU_QUIRKS_PROXY_GUID);
 	fu_quirks_add_possible_key(self, FU_QUIRKS_APPSTREAM_ID);
 	fu_quirks_add_possible_key(self, FU_QUIRKS_BATTERY_THRESHOLD);
+	fu_quirks_add_possible_key(self, FU_QUIRKS_READY_TIMEOUT);
+	fu_quirks_add_possible_key(self, FU_QUIRKS_RETRY_POLICY);
 	fu_quirks_add_possible_key(self, FU_QUIRKS_REMOVE_DELAY);
 	fu_quirks_add_possible_key(self, FU_QUIRKS_SUMMARY);
 	fu_quirks_add_possible_key(self, FU_QUIRKS_UPDATE_IMAGE);
@@ -1168,12 +1766,24 @@ fu_quirks_finalize(GObject *obj)
 		g_object_unref(self->query_vs);
 	if (self->silo != NULL)
 		g_object_unref(self->silo);
+	if (self->query_builtin_kv != NULL)
+		g_object_unref(self->query_builtin_kv);
+	if (self->query_builtin_vs != NULL)
+		g_object_unref(self->query_builtin_vs);
+	if (self->silo_builtin != NULL)
+		g_object_unref(self->silo_builtin);
+	if (self->monitor_builtin != NULL) {
+		g_file_monitor_cancel(self->monitor_builtin);
+		g_object_unref(self->monitor_builtin);
+	}
 #ifdef HAVE_SQLITE
 	if (self->db != NULL)
 		sqlite3_close(self->db);
 #endif
 	g_hash_table_unref(self->possible_keys);
 	g_ptr_array_unref(self->invalid_keys);
+	g_hash_table_unref(self->results);
+	g_mutex_clear(&self->results_mutex);
 	G_OBJECT_CLASS(fu_quirks_parent_class)->finalize(obj);
 }
 
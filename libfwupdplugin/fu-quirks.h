@@ -325,6 +325,23 @@ fu_quirks_add_possible_key(FuQuirks *self, const gchar *possible_key) G_GNUC_NON
  * Since: 1.8.3
  **/
 #define FU_QUIRKS_ACQUIESCE_DELAY "AcquiesceDelay"
+/**
+ * FU_QUIRKS_READY_TIMEOUT:
+ *
+ * The quirk key for the maximum time to wait for the device to become ready in milliseconds,
+ * e.g. `5000`.
+ *
+ * Since: 2.2.1
+ **/
+#define FU_QUIRKS_READY_TIMEOUT "ReadyTimeout"
+/**
+ * FU_QUIRKS_RETRY_POLICY:
+ *
+ * The quirk key for the policy used to delay between each retry, e.g. `exponential`.
+ *
+ * Since: 2.2.1
+ **/
+#define FU_QUIRKS_RETRY_POLICY "RetryPolicy"
 /**
  * FU_QUIRKS_INHIBIT:
  *
@@ -1675,6 +1675,124 @@ fu_usb_device_bulk_transfer(FuUsbDevice *self,
 	return TRUE;
 }
 
+/**
+ * fu_usb_device_bulk_write:
+ * @self: a #FuUsbDevice
+ * @endpoint: the address of a valid OUT endpoint to communicate with
+ * @data: (array length=length): data to send
+ * @length: the size of @data
+ * @actual_length: (out) (optional): the actual number of bytes sent, or %NULL
+ * @timeout: timeout timeout (in milliseconds) that this function should wait
+ * before giving up due to no response being received. For an unlimited
+ * timeout, use 0.
+ * @cancellable: a #GCancellable, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Perform a USB bulk transfer to the device without copying the const data first.
+ *
+ * This uses the same emulation events as fu_usb_device_bulk_transfer().
+ *
+ * Warning: this function is synchronous, and cannot be cancelled.
+ *
+ * Return value: %TRUE on success
+ *
+ * Since: 2.2.1
+ **/
+gboolean
+fu_usb_device_bulk_write(FuUsbDevice *self,
+			 guint8 endpoint,
+			 const guint8 *data,
+			 gsize length,
+			 gsize *actual_length,
+			 guint timeout,
+			 GCancellable *cancellable,
+			 GError **error)
+{
+	FuUsbDevicePrivate *priv = GET_PRIVATE(self);
+	gint rc;
+	gint transferred = 0;
+	FuDeviceEvent *event = NULL;
+	g_autofree gchar *event_id = NULL;
+
+	g_return_val_if_fail(FU_IS_USB_DEVICE(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* build event key either for load or save */
+	if (fu_device_has_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_EMULATED) ||
+	    fu_context_has_flag(fu_device_get_context(FU_DEVICE(self)),
+				FU_CONTEXT_FLAG_SAVE_EVENTS)) {
+		g_autofree gchar *data_base64 = fu_base64_encode(data, length);
+		event_id = g_strdup_printf("BulkTransfer:"
+					   "Endpoint=0x%02x,"
+					   "Data=%s,"
+					   "Length=0x%x",
+					   endpoint,
+					   data_base64,
+					   (guint)length);
+	}
+
+	/* emulated, where only the size of the recorded data matters */
+	if (fu_device_has_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_EMULATED)) {
+		gint64 rc_tmp;
+		g_autoptr(GBytes) blob = NULL;
+
+		event = fu_device_load_event(FU_DEVICE(self), event_id, error);
+		if (event == NULL)
+			return FALSE;
+		rc_tmp = fu_device_event_get_i64(event, "Error", NULL);
+		if (rc_tmp != G_MAXINT64)
+			return fu_usb_device_libusb_error_to_gerror(rc_tmp, error);
+		rc_tmp = fu_device_event_get_i64(event, "Status", NULL);
+		if (rc_tmp != G_MAXINT64)
+			return fu_usb_device_libusb_status_to_gerror(rc_tmp, error);
+		blob = fu_device_event_get_bytes(event, "Data", error);
+		if (blob == NULL)
+			return FALSE;
+		if (actual_length != NULL)
+			*actual_length = g_bytes_get_size(blob);
+		return TRUE;
+	}
+
+	/* for fuzzing */
+	if (fu_device_has_private_flag(FU_DEVICE(self), FU_DEVICE_PRIVATE_FLAG_IS_FAKE)) {
+		if (actual_length != NULL)
+			*actual_length = length;
+		return TRUE;
+	}
+
+	/* sanity check */
+	if (priv->handle == NULL)
+		return fu_usb_device_not_open_error(self, error);
+
+	/* save */
+	if (fu_context_has_flag(fu_device_get_context(FU_DEVICE(self)),
+				FU_CONTEXT_FLAG_SAVE_EVENTS)) {
+		event = fu_device_save_event(FU_DEVICE(self), event_id);
+	}
+
+	/* sync request, where libusb does not modify the data of an OUT transfer */
+	rc = libusb_bulk_transfer(priv->handle,
+				  endpoint,
+				  (guint8 *)data,
+				  length,
+				  &transferred,
+				  timeout);
+	if (!fu_usb_device_libusb_error_to_gerror(rc, error)) {
+		if (event != NULL)
+			fu_device_event_set_i64(event, "Error", rc);
+		return FALSE;
+	}
+	if (actual_length != NULL)
+		*actual_length = transferred;
+
+	/* save */
+	if (event != NULL)
+		fu_device_event_set_data(event, "Data", data, transferred);
+
+	/* success */
+	return TRUE;
+}
+
 /**
  * fu_usb_device_interrupt_transfer:
  * @self: a #FuUsbDevice
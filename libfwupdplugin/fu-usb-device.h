@@ -89,6 +89,15 @@ fu_usb_device_bulk_transfer(FuUsbDevice *self,
 			    GCancellable *cancellable,
 			    GError **error) G_GNUC_NON_NULL(1);
 gboolean
+fu_usb_device_bulk_write(FuUsbDevice *self,
+			 guint8 endpoint,
+			 const guint8 *data,
+			 gsize length,
+			 gsize *actual_length,
+			 guint timeout,
+			 GCancellable *cancellable,
+			 GError **error) G_GNUC_NON_NULL(1);
+gboolean
 fu_usb_device_interrupt_transfer(FuUsbDevice *self,
 				 guint8 endpoint,
 				 guint8 *data,
@@ -794,3 +794,192 @@ fu_version_compare(const gchar *version_a, const gchar *version_b, FwupdVersionF
 	}
 	return fu_version_compare_safe(version_a, version_b);
 }
+
+struct FuVersionKey {
+	grefcount refcount;
+	FwupdVersionFormat fmt;
+	gchar *version;	   /* nullable */
+	gchar *normalized; /* nullable */
+	gchar **sections;  /* nullable */
+	guint sections_len;
+	gint64 *values;	      /* array of @sections_len */
+	const gchar **suffixes; /* array of @sections_len, pointing into @sections */
+};
+
+/**
+ * fu_version_key_new: (skip):
+ * @version: (nullable): a version number, e.g. `1.2.3`
+ * @fmt: a version format, e.g. %FWUPD_VERSION_FORMAT_TRIPLET
+ *
+ * Splits and normalizes a version number once so that it can be compared many times, for
+ * instance when sorting a large number of releases.
+ *
+ * Returns: (transfer full): a #FuVersionKey
+ *
+ * Since: 2.2.1
+ **/
+FuVersionKey *
+fu_version_key_new(const gchar *version, FwupdVersionFormat fmt)
+{
+	FuVersionKey *self = g_new0(FuVersionKey, 1);
+	g_ref_count_init(&self->refcount);
+	self->fmt = fmt;
+	self->version = g_strdup(version);
+	if (fmt == FWUPD_VERSION_FORMAT_PLAIN)
+		return self;
+	if (fmt == FWUPD_VERSION_FORMAT_HEX)
+		self->normalized = fu_version_parse_from_format(version, fmt);
+	else
+		self->normalized = g_strdup(version);
+	if (self->normalized == NULL)
+		return self;
+
+	/* this has to match fu_version_compare_safe() */
+	self->sections = g_strsplit(self->normalized, ".", -1);
+	self->sections_len = g_strv_length(self->sections);
+	self->values = g_new0(gint64, self->sections_len);
+	self->suffixes = g_new0(const gchar *, self->sections_len);
+	for (guint i = 0; i < self->sections_len; i++) {
+		gchar *endptr = NULL;
+		self->values[i] =
+		    g_ascii_strtoll(self->sections[i], &endptr, 10); /* nocheck:blocked */
+		self->suffixes[i] = endptr != NULL ? endptr : "";
+	}
+	return self;
+}
+
+/**
+ * fu_version_key_ref: (skip):
+ * @self: a #FuVersionKey
+ *
+ * Increases the reference count of a version key.
+ *
+ * Returns: (transfer full): a #FuVersionKey
+ *
+ * Since: 2.2.1
+ **/
+FuVersionKey *
+fu_version_key_ref(FuVersionKey *self)
+{
+	g_return_val_if_fail(self != NULL, NULL);
+	g_ref_count_inc(&self->refcount);
+	return self;
+}
+
+/**
+ * fu_version_key_unref: (skip):
+ * @self: a #FuVersionKey
+ *
+ * Decreases the reference count of a version key.
+ *
+ * Returns: (transfer none): a #FuVersionKey, or %NULL
+ *
+ * Since: 2.2.1
+ **/
+FuVersionKey *
+fu_version_key_unref(FuVersionKey *self)
+{
+	g_return_val_if_fail(self != NULL, NULL);
+	if (!g_ref_count_dec(&self->refcount))
+		return self;
+	g_free(self->version);
+	g_free(self->normalized);
+	g_strfreev(self->sections);
+	g_free(self->values);
+	g_free(self->suffixes);
+	g_free(self);
+	return NULL;
+}
+
+/**
+ * fu_version_key_get_version: (skip):
+ * @self: a #FuVersionKey
+ *
+ * Gets the version number the key was created from.
+ *
+ * Returns: a version number, or %NULL
+ *
+ * Since: 2.2.1
+ **/
+const gchar *
+fu_version_key_get_version(FuVersionKey *self)
+{
+	g_return_val_if_fail(self != NULL, NULL);
+	return self->version;
+}
+
+/**
+ * fu_version_key_get_format: (skip):
+ * @self: a #FuVersionKey
+ *
+ * Gets the version format the key was created with.
+ *
+ * Returns: a version format, e.g. %FWUPD_VERSION_FORMAT_TRIPLET
+ *
+ * Since: 2.2.1
+ **/
+FwupdVersionFormat
+fu_version_key_get_format(FuVersionKey *self)
+{
+	g_return_val_if_fail(self != NULL, FWUPD_VERSION_FORMAT_UNKNOWN);
+	return self->fmt;
+}
+
+/**
+ * fu_version_key_compare: (skip):
+ * @key_a: a #FuVersionKey
+ * @key_b: a #FuVersionKey created with the same format as @key_a
+ *
+ * Compares version keys for sorting, returning the same result as fu_version_compare() would
+ * for the original version numbers.
+ *
+ * Returns: -1 if a < b, +1 if a > b, 0 if they are equal, and %G_MAXINT on error
+ *
+ * Since: 2.2.1
+ **/
+gint
+fu_version_key_compare(FuVersionKey *key_a, FuVersionKey *key_b)
+{
+	guint longest_split;
+
+	g_return_val_if_fail(key_a != NULL, G_MAXINT);
+	g_return_val_if_fail(key_b != NULL, G_MAXINT);
+
+	if (key_a->fmt == FWUPD_VERSION_FORMAT_PLAIN)
+		return g_strcmp0(key_a->version, key_b->version);
+
+	/* sanity check */
+	if (key_a->normalized == NULL || key_b->normalized == NULL)
+		return G_MAXINT;
+
+	/* optimization */
+	if (g_strcmp0(key_a->normalized, key_b->normalized) == 0)
+		return 0;
+
+	longest_split = MAX(key_a->sections_len, key_b->sections_len);
+	for (guint i = 0; i < longest_split; i++) {
+		/* we lost or gained a dot */
+		if (i >= key_a->sections_len)
+			return -1;
+		if (i >= key_b->sections_len)
+			return 1;
+
+		/* compare integers */
+		if (key_a->values[i] < key_b->values[i])
+			return -1;
+		if (key_a->values[i] > key_b->values[i])
+			return 1;
+
+		/* compare strings */
+		if (key_a->suffixes[i][0] != '\0' || key_b->suffixes[i][0] != '\0') {
+			gint rc = fu_version_compare_chunk(key_a->suffixes[i], key_b->suffixes[i]);
+			if (rc < 0)
+				return -1;
+			if (rc > 0)
+				return 1;
+		}
+	}
+
+	/* we really shouldn't get here */
+	return 0;
+}
@@ -36,4 +36,21 @@ fu_version_verify_format(const gchar *version,
 			 FwupdVersionFormat fmt,
 			 GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
 
+typedef struct FuVersionKey FuVersionKey;
+
+FuVersionKey *
+fu_version_key_new(const gchar *version, FwupdVersionFormat fmt) G_GNUC_WARN_UNUSED_RESULT;
+FuVersionKey *
+fu_version_key_ref(FuVersionKey *self) G_GNUC_NON_NULL(1);
+FuVersionKey *
+fu_version_key_unref(FuVersionKey *self) G_GNUC_NON_NULL(1);
+const gchar *
+fu_version_key_get_version(FuVersionKey *self) G_GNUC_NON_NULL(1);
+FwupdVersionFormat
+fu_version_key_get_format(FuVersionKey *self) G_GNUC_NON_NULL(1);
+gint
+fu_version_key_compare(FuVersionKey *key_a, FuVersionKey *key_b) G_GNUC_NON_NULL(1, 2);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuVersionKey, fu_version_key_unref)
+
 G_END_DECLS
@@ -267,6 +267,47 @@ fu_version_vercmp_func(void)
 	g_assert_cmpint(fu_version_compare(NULL, NULL, FWUPD_VERSION_FORMAT_UNKNOWN), ==, G_MAXINT);
 }
 
+static void
+fu_version_key_func(void)
+{
+	struct {
+		const gchar *version_a;
+		const gchar *version_b;
+		FwupdVersionFormat fmt;
+	} map[] = {
+	    {"1.2.3", "1.2.3", FWUPD_VERSION_FORMAT_UNKNOWN},
+	    {"001.002.003", "1.2.3", FWUPD_VERSION_FORMAT_UNKNOWN},
+	    {"1.2.3", "1.2.4", FWUPD_VERSION_FORMAT_UNKNOWN},
+	    {"1.2.3", "1.2.3.1", FWUPD_VERSION_FORMAT_UNKNOWN},
+	    {"1.2.3.1", "1.2.4", FWUPD_VERSION_FORMAT_UNKNOWN},
+	    {"1.2.3a", "1.2.3b", FWUPD_VERSION_FORMAT_UNKNOWN},
+	    {"1.2.3", "1.2.3a", FWUPD_VERSION_FORMAT_UNKNOWN},
+	    {"alpha", "beta", FWUPD_VERSION_FORMAT_UNKNOWN},
+	    {"1.2a.3", "1.2b.3", FWUPD_VERSION_FORMAT_UNKNOWN},
+	    {"1.2.3~rc1", "1.2.3", FWUPD_VERSION_FORMAT_UNKNOWN},
+	    {"1.2.3~rc2", "1.2.3~rc1", FWUPD_VERSION_FORMAT_UNKNOWN},
+	    {"0x00000002", "0x2", FWUPD_VERSION_FORMAT_HEX},
+	    {"0x00000002", "0x10", FWUPD_VERSION_FORMAT_HEX},
+	    {"abc", "abd", FWUPD_VERSION_FORMAT_PLAIN},
+	    {"1", NULL, FWUPD_VERSION_FORMAT_UNKNOWN},
+	    {NULL, NULL, FWUPD_VERSION_FORMAT_UNKNOWN},
+	};
+
+	/* the key must always agree with the string comparison, in both directions */
+	for (guint i = 0; i < G_N_ELEMENTS(map); i++) {
+		g_autoptr(FuVersionKey) key_a = fu_version_key_new(map[i].version_a, map[i].fmt);
+		g_autoptr(FuVersionKey) key_b = fu_version_key_new(map[i].version_b, map[i].fmt);
+		g_assert_cmpint(fu_version_key_compare(key_a, key_b),
+				==,
+				fu_version_compare(map[i].version_a, map[i].version_b, map[i].fmt));
+		g_assert_cmpint(fu_version_key_compare(key_b, key_a),
+				==,
+				fu_version_compare(map[i].version_b, map[i].version_a, map[i].fmt));
+		g_assert_cmpstr(fu_version_key_get_version(key_a), ==, map[i].version_a);
+		g_assert_cmpint(fu_version_key_get_format(key_a), ==, map[i].fmt);
+	}
+}
+
 int
 main(int argc, char **argv)
 {
@@ -276,5 +317,6 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/version/verify-format", fu_version_verify_format_func);
 	g_test_add_func("/fwupd/version/semver", fu_version_semver_func);
 	g_test_add_func("/fwupd/version/vercmp", fu_version_vercmp_func);
+	g_test_add_func("/fwupd/version/key", fu_version_key_func);
 	return g_test_run();
 }
@@ -9,6 +9,7 @@
 #include "config.h"
 
 #include "fu-volume-locker.h"
+#include "fu-volume-private.h"
 
 /**
  * FuVolumeLocker:
@@ -22,10 +23,28 @@ struct _FuVolumeLocker {
 	GObject parent_instance;
 	FuVolume *volume;
 	gboolean is_open;
+	gboolean index_held;
 };
 
 G_DEFINE_TYPE(FuVolumeLocker, fu_volume_locker, G_TYPE_OBJECT)
 
+/* the directory index of the volume is only valid while it cannot be unmounted */
+static void
+fu_volume_locker_index_hold(FuVolumeLocker *self)
+{
+	fu_volume_index_hold(self->volume);
+	self->index_held = TRUE;
+}
+
+static void
+fu_volume_locker_index_release(FuVolumeLocker *self)
+{
+	if (!self->index_held)
+		return;
+	fu_volume_index_release(self->volume);
+	self->index_held = FALSE;
+}
+
 /**
  * fu_volume_locker_close:
  * @self: a #FuVolumeLocker
@@ -48,6 +67,7 @@ fu_volume_locker_close(FuVolumeLocker *self, GError **error)
 	g_return_val_if_fail(FU_IS_VOLUME_LOCKER(self), FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
+	fu_volume_locker_index_release(self);
 	if (!self->is_open)
 		return TRUE;
 	if (!fu_volume_unmount(self->volume, &error_local)) {
@@ -69,6 +89,7 @@ fu_volume_locker_finalize(GObject *obj)
 {
 	FuVolumeLocker *self = FU_VOLUME_LOCKER(obj);
 
+	fu_volume_locker_index_release(self);
 	if (self->is_open) {
 		g_autoptr(GError) error_local = NULL;
 		if (!fu_volume_unmount(self->volume, &error_local))
@@ -112,8 +133,11 @@ fu_volume_locker_new(FuVolume *volume, GError **error)
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
 	/* already open, so NOP */
-	if (fu_volume_is_mounted(volume))
+	if (fu_volume_is_mounted(volume)) {
+		self->volume = g_object_ref(volume);
+		fu_volume_locker_index_hold(self);
 		return g_steal_pointer(&self);
+	}
 
 	/* open volume */
 	if (!fu_volume_mount(volume, error)) {
@@ -130,5 +154,6 @@ fu_volume_locker_new(FuVolume *volume, GError **error)
 	/* success */
 	self->is_open = TRUE;
 	self->volume = g_object_ref(volume);
+	fu_volume_locker_index_hold(self);
 	return g_steal_pointer(&self);
 }
@@ -20,6 +20,10 @@ void
 fu_volume_set_partition_kind(FuVolume *self, const gchar *partition_kind) G_GNUC_NON_NULL(1, 2);
 void
 fu_volume_set_partition_uuid(FuVolume *self, const gchar *partition_uuid) G_GNUC_NON_NULL(1, 2);
+void
+fu_volume_index_hold(FuVolume *self) G_GNUC_NON_NULL(1);
+void
+fu_volume_index_release(FuVolume *self) G_GNUC_NON_NULL(1);
 
 /* for tests */
 void
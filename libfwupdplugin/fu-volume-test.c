@@ -8,6 +8,7 @@
 
 #include <fwupdplugin.h>
 
+#include "fu-common-private.h"
 #include "fu-test.h"
 #include "fu-volume-private.h"
 
@@ -75,6 +76,298 @@ fu_volume_write_file_func(void)
 	g_assert_cmpstr(contents, ==, "hello");
 }
 
+static void
+fu_volume_glob_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *fn1 = NULL;
+	g_autofree gchar *fn2 = NULL;
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(FuVolume) volume = NULL;
+	g_autoptr(FuVolumeLocker) locker = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) files1 = NULL;
+	g_autoptr(GPtrArray) files2 = NULL;
+	g_autoptr(GPtrArray) files3 = NULL;
+
+	/* set up test harness */
+	tmpdir = fu_temporary_directory_new("volume-glob", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	volume = fu_volume_new_from_mount_path(fu_temporary_directory_get_path(tmpdir));
+	fn1 = fu_temporary_directory_build(tmpdir, "EFI", "fedora", "fw", "fwupd-1.cap", NULL);
+	fn2 = fu_temporary_directory_build(tmpdir, "EFI", "fedora", "fw", "fwupd-2.cap", NULL);
+	ret = fu_path_mkdir_parent(fn1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = g_file_set_contents(fn1, "", 0, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* the directory listings are cached while locked */
+	locker = fu_volume_locker_new(volume, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(locker);
+	files1 = fu_volume_glob(volume, "EFI/*/fw/*.cap", FU_PATH_GLOB_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(files1);
+	g_assert_cmpint(files1->len, ==, 1);
+	ret = g_file_set_contents(fn2, "", 0, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	files2 = fu_volume_glob(volume, "EFI/*/fw/*.cap", FU_PATH_GLOB_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(files2);
+	g_assert_cmpint(files2->len, ==, 1);
+
+	/* and read again when unlocked */
+	g_clear_object(&locker);
+	files3 = fu_volume_glob(volume, "EFI/*/fw/*.cap", FU_PATH_GLOB_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(files3);
+	g_assert_cmpint(files3->len, ==, 2);
+}
+
+#ifdef __linux__
+typedef struct {
+	GDBusConnection *conn;
+	GMainContext *mock_ctx;
+	GMainLoop *mock_loop;
+	GThread *mock_thread;
+	gint get_managed_objects_cnt;
+} FuVolumeUdisksHelper;
+
+static const gchar introspection_udisks_xml[] =
+    "<node>"
+    "  <interface name='org.freedesktop.DBus.ObjectManager'>"
+    "    <method name='GetManagedObjects'>"
+    "      <arg name='objects' type='a{oa{sa{sv}}}' direction='out'/>"
+    "    </method>"
+    "  </interface>"
+    "</node>";
+
+static GVariant *
+fu_volume_udisks_build_interfaces(const gchar *device, const gchar *partition_kind)
+{
+	GVariantBuilder builder;
+	GVariantBuilder builder_blk;
+	GVariantBuilder builder_fs;
+	GVariantBuilder builder_part;
+
+	g_variant_builder_init(&builder_blk, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add(&builder_blk, "{sv}", "Device", g_variant_new_bytestring(device));
+	g_variant_builder_add(&builder_blk, "{sv}", "IdType", g_variant_new_string("vfat"));
+	g_variant_builder_add(&builder_blk, "{sv}", "HintSystem", g_variant_new_boolean(TRUE));
+	g_variant_builder_init(&builder_part, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add(&builder_part, "{sv}", "Type", g_variant_new_string(partition_kind));
+	g_variant_builder_init(&builder_fs, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add(&builder_fs, "{sv}", "Size", g_variant_new_uint64(0x1000));
+
+	g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sa{sv}}"));
+	g_variant_builder_add(&builder, "{sa{sv}}", "org.freedesktop.UDisks2.Block", &builder_blk);
+	g_variant_builder_add(&builder,
+			      "{sa{sv}}",
+			      "org.freedesktop.UDisks2.Partition",
+			      &builder_part);
+	g_variant_builder_add(&builder,
+			      "{sa{sv}}",
+			      "org.freedesktop.UDisks2.Filesystem",
+			      &builder_fs);
+	return g_variant_builder_end(&builder);
+}
+
+static void
+fu_volume_udisks_method_call_cb(GDBusConnection *connection,
+				const gchar *sender,
+				const gchar *object_path,
+				const gchar *interface_name,
+				const gchar *method_name,
+				GVariant *parameters,
+				GDBusMethodInvocation *invocation,
+				gpointer user_data)
+{
+	FuVolumeUdisksHelper *helper = (FuVolumeUdisksHelper *)user_data;
+	GVariantBuilder builder;
+
+	g_atomic_int_inc(&helper->get_managed_objects_cnt);
+	g_variant_builder_init(&builder, G_VARIANT_TYPE("a{oa{sa{sv}}}"));
+	g_variant_builder_add(&builder,
+			      "{o@a{sa{sv}}}",
+			      "/org/freedesktop/UDisks2/block_devices/sda1",
+			      fu_volume_udisks_build_interfaces("/dev/sda1", FU_VOLUME_KIND_ESP));
+	g_variant_builder_add(&builder,
+			      "{o@a{sa{sv}}}",
+			      "/org/freedesktop/UDisks2/block_devices/sda2",
+			      fu_volume_udisks_build_interfaces("/dev/sda2", "0x83"));
+	g_dbus_method_invocation_return_value(invocation,
+					      g_variant_new("(a{oa{sa{sv}}})", &builder));
+}
+
+static const GDBusInterfaceVTable udisks_vtable = {
+    fu_volume_udisks_method_call_cb,
+    NULL,
+    NULL,
+};
+
+static gpointer
+fu_volume_udisks_mock_thread_cb(gpointer data)
+{
+	FuVolumeUdisksHelper *helper = (FuVolumeUdisksHelper *)data;
+	g_main_loop_run(helper->mock_loop);
+	return NULL;
+}
+
+static void
+fu_volume_udisks_func(void)
+{
+	guint reg_id;
+	const gchar *mount_points[] = {"/boot/efi", NULL};
+	g_autofree gchar *mount_point = NULL;
+	g_autoptr(FuVolume) esp = NULL;
+	g_autoptr(FuVolume) volume = NULL;
+	g_autoptr(GDBusConnection) conn_system = NULL;
+	g_autoptr(GDBusNodeInfo) node_info = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) volumes = NULL;
+	g_autoptr(GTestDBus) dbus = g_test_dbus_new(G_TEST_DBUS_NONE);
+	g_autoptr(GVariant) result = NULL;
+	FuVolumeUdisksHelper helper = {0};
+
+	/* run a fake udisks on a private bus */
+	g_test_dbus_up(dbus);
+	(void)g_setenv("DBUS_SYSTEM_BUS_ADDRESS", g_test_dbus_get_bus_address(dbus), TRUE);
+	helper.mock_ctx = g_main_context_new();
+	helper.mock_loop = g_main_loop_new(helper.mock_ctx, FALSE);
+	g_main_context_push_thread_default(helper.mock_ctx);
+	helper.conn = g_dbus_connection_new_for_address_sync(
+	    g_test_dbus_get_bus_address(dbus),
+	    G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+		G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+	    NULL,
+	    NULL,
+	    &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(helper.conn);
+	node_info = g_dbus_node_info_new_for_xml(introspection_udisks_xml, &error);
+	g_assert_no_error(error);
+	reg_id = g_dbus_connection_register_object(helper.conn,
+						   "/org/freedesktop/UDisks2",
+						   node_info->interfaces[0],
+						   &udisks_vtable,
+						   &helper,
+						   NULL,
+						   &error);
+	g_assert_no_error(error);
+	g_main_context_pop_thread_default(helper.mock_ctx);
+	result = g_dbus_connection_call_sync(helper.conn,
+					     "org.freedesktop.DBus",
+					     "/org/freedesktop/DBus",
+					     "org.freedesktop.DBus",
+					     "RequestName",
+					     g_variant_new("(su)", "org.freedesktop.UDisks2", 0u),
+					     G_VARIANT_TYPE("(u)"),
+					     G_DBUS_CALL_FLAGS_NONE,
+					     -1,
+					     NULL,
+					     &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(result);
+	helper.mock_thread = g_thread_new("mock-udisks", fu_volume_udisks_mock_thread_cb, &helper);
+
+	/* only the ESP matches */
+	volumes = fu_volume_new_by_kind(FU_VOLUME_KIND_ESP, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(volumes);
+	g_assert_cmpint(volumes->len, ==, 1);
+	g_assert_cmpstr(fu_volume_get_id(g_ptr_array_index(volumes, 0)),
+			==,
+			"/org/freedesktop/UDisks2/block_devices/sda1");
+	esp = g_object_ref(g_ptr_array_index(volumes, 0));
+	g_assert_false(fu_volume_is_mounted(esp));
+
+	/* uses the cache */
+	volume = fu_volume_new_by_device("/dev/sda2", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(volume);
+	g_assert_cmpint(g_atomic_int_get(&helper.get_managed_objects_cnt), ==, 1);
+
+	/* new partition appears */
+	g_dbus_connection_emit_signal(
+	    helper.conn,
+	    NULL,
+	    "/org/freedesktop/UDisks2",
+	    "org.freedesktop.DBus.ObjectManager",
+	    "InterfacesAdded",
+	    g_variant_new("(o@a{sa{sv}})",
+			  "/org/freedesktop/UDisks2/block_devices/sdb1",
+			  fu_volume_udisks_build_interfaces("/dev/sdb1", FU_VOLUME_KIND_ESP)),
+	    &error);
+	g_assert_no_error(error);
+
+	/* the reply is ordered after the signal */
+	conn_system = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &error);
+	g_assert_no_error(error);
+	g_clear_pointer(&result, g_variant_unref);
+	result = g_dbus_connection_call_sync(conn_system,
+					     "org.freedesktop.UDisks2",
+					     "/org/freedesktop/UDisks2",
+					     "org.freedesktop.DBus.Peer",
+					     "Ping",
+					     NULL,
+					     NULL,
+					     G_DBUS_CALL_FLAGS_NONE,
+					     -1,
+					     NULL,
+					     &error);
+	g_assert_no_error(error);
+	g_clear_pointer(&volumes, g_ptr_array_unref);
+	volumes = fu_volume_new_by_kind(FU_VOLUME_KIND_ESP, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(volumes);
+	g_assert_cmpint(volumes->len, ==, 2);
+	g_assert_cmpint(g_atomic_int_get(&helper.get_managed_objects_cnt), ==, 1);
+
+	/* mounted by something else after the volume was created */
+	g_dbus_connection_emit_signal(
+	    helper.conn,
+	    NULL,
+	    "/org/freedesktop/UDisks2/block_devices/sda1",
+	    "org.freedesktop.DBus.Properties",
+	    "PropertiesChanged",
+	    g_variant_new_parsed("(%s, {'MountPoints': <%@aay>}, @as [])",
+				 UDISKS_DBUS_INTERFACE_FILESYSTEM,
+				 g_variant_new_bytestring_array(mount_points, -1)),
+	    &error);
+	g_assert_no_error(error);
+	g_clear_pointer(&result, g_variant_unref);
+	result = g_dbus_connection_call_sync(conn_system,
+					     "org.freedesktop.UDisks2",
+					     "/org/freedesktop/UDisks2",
+					     "org.freedesktop.DBus.Peer",
+					     "Ping",
+					     NULL,
+					     NULL,
+					     G_DBUS_CALL_FLAGS_NONE,
+					     -1,
+					     NULL,
+					     &error);
+	g_assert_no_error(error);
+	mount_point = fu_volume_get_mount_point(esp);
+	g_assert_cmpstr(mount_point, ==, "/boot/efi");
+	g_assert_cmpint(g_atomic_int_get(&helper.get_managed_objects_cnt), ==, 1);
+
+	/* tear down the fake udisks */
+	g_main_loop_quit(helper.mock_loop);
+	g_thread_join(helper.mock_thread);
+	g_dbus_connection_unregister_object(helper.conn, reg_id);
+	g_object_unref(helper.conn);
+	g_main_loop_unref(helper.mock_loop);
+	g_main_context_unref(helper.mock_ctx);
+	fu_common_free_block_devices();
+	g_test_dbus_down(dbus);
+}
+#endif
+
 static void
 fu_volume_gpt_type_func(void)
 {
@@ -96,5 +389,14 @@ main(int argc, char **argv)
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/volume/gpt-type", fu_volume_gpt_type_func);
 	g_test_add_func("/fwupd/volume/write-file", fu_volume_write_file_func);
+	g_test_add_func("/fwupd/volume/glob", fu_volume_glob_func);
+#ifdef __linux__
+	{
+		/* nocheck:blocked -- while building packages this may not be available */
+		g_autofree gchar *argv0 = g_find_program_in_path("dbus-daemon");
+		if (argv0 != NULL)
+			g_test_add_func("/fwupd/volume/udisks", fu_volume_udisks_func);
+	}
+#endif
 	return g_test_run();
 }
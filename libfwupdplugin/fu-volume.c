@@ -22,6 +22,7 @@
 
 #include "fu-bytes.h"
 #include "fu-common-private.h"
+#include "fu-path-private.h"
 #include "fu-volume-private.h"
 
 /**
@@ -39,6 +40,8 @@ struct _FuVolume {
 	gchar *partition_kind; /* only for tests */
 	gchar *partition_uuid; /* only for tests */
 	guint64 fs_free;       /* only for tests */
+	guint index_holds;     /* number of lockers */
+	GHashTable *index;     /* (element-type utf8 GPtrArray): directory listings */
 };
 
 enum {
@@ -102,6 +105,7 @@ fu_volume_finalize(GObject *obj)
 	g_free(self->mount_path);
 	g_free(self->partition_kind);
 	g_free(self->partition_uuid);
+	g_hash_table_unref(self->index);
 	if (self->proxy_blk != NULL)
 		g_object_unref(self->proxy_blk);
 	if (self->proxy_fs != NULL)
@@ -251,6 +255,21 @@ fu_volume_class_init(FuVolumeClass *klass)
 static void
 fu_volume_init(FuVolume *self)
 {
+	self->index = g_hash_table_new_full(g_str_hash,
+					    g_str_equal,
+					    g_free,
+					    (GDestroyNotify)g_ptr_array_unref);
+}
+
+/* the shared object manager only updates the cached properties when its context is iterated */
+static void
+fu_volume_refresh(FuVolume *self)
+{
+	if (self->proxy_blk == NULL)
+		return;
+	if (g_dbus_interface_get_object(G_DBUS_INTERFACE(self->proxy_blk)) == NULL)
+		return;
+	fu_common_refresh_block_devices();
 }
 
 /**
@@ -295,6 +314,7 @@ fu_volume_get_size(FuVolume *self)
 
 	if (self->proxy_blk == NULL)
 		return 0;
+	fu_volume_refresh(self);
 	val = g_dbus_proxy_get_cached_property(self->proxy_blk, "Size");
 	if (val == NULL)
 		return 0;
@@ -662,6 +682,7 @@ fu_volume_get_mount_point(FuVolume *self)
 	/* something else mounted it */
 	if (self->proxy_fs == NULL)
 		return NULL;
+	fu_volume_refresh(self);
 	val = g_dbus_proxy_get_cached_property(self->proxy_fs, "MountPoints");
 	if (val == NULL)
 		return NULL;
@@ -700,6 +721,7 @@ fu_volume_write_file(FuVolume *self, const gchar *filename, GBytes *bytes, GErro
 
 	if (!fu_bytes_set_contents(filename, bytes, error))
 		return FALSE;
+	g_hash_table_remove_all(self->index);
 
 	/* success */
 	g_signal_emit(self, signals[SIGNAL_WRITE_FILE], 0, filename);
@@ -895,6 +917,7 @@ fu_volume_get_id_type(FuVolume *self)
 	g_autoptr(GVariant) val = NULL;
 	g_return_val_if_fail(FU_IS_VOLUME(self), NULL);
 
+	fu_volume_refresh(self);
 	val = g_dbus_proxy_get_cached_property(self->proxy_blk, "IdType");
 	if (val == NULL)
 		return NULL;
@@ -938,9 +961,92 @@ fu_volume_unmount(FuVolume *self, GError **error)
 	if (val == NULL)
 		return FALSE;
 	g_clear_pointer(&self->mount_path, g_free);
+	g_hash_table_remove_all(self->index);
 	return TRUE;
 }
 
+/* private: called by FuVolumeLocker so that the index is only used while the volume is locked */
+void
+fu_volume_index_hold(FuVolume *self)
+{
+	g_return_if_fail(FU_IS_VOLUME(self));
+	self->index_holds++;
+}
+
+/* private */
+void
+fu_volume_index_release(FuVolume *self)
+{
+	g_return_if_fail(FU_IS_VOLUME(self));
+	g_return_if_fail(self->index_holds > 0);
+	if (--self->index_holds == 0)
+		g_hash_table_remove_all(self->index);
+}
+
+static GPtrArray *
+fu_volume_list_dir_cb(const gchar *directory, gpointer user_data, GError **error)
+{
+	FuVolume *self = FU_VOLUME(user_data);
+	GPtrArray *basenames;
+	g_autoptr(GPtrArray) basenames_new = NULL;
+
+	/* not locked, so the contents can change at any time */
+	if (self->index_holds == 0)
+		return fu_path_list_dir(directory, error);
+
+	/* already read */
+	basenames = g_hash_table_lookup(self->index, directory);
+	if (basenames != NULL)
+		return g_ptr_array_ref(basenames);
+	basenames_new = fu_path_list_dir(directory, error);
+	if (basenames_new == NULL)
+		return NULL;
+	g_hash_table_insert(self->index, g_strdup(directory), g_ptr_array_ref(basenames_new));
+	return g_steal_pointer(&basenames_new);
+}
+
+/**
+ * fu_volume_glob:
+ * @self: a @FuVolume
+ * @pattern: a glob pattern relative to the mount point, e.g. `EFI/BOOT/boot*.efi`
+ * @flags: some #FuPathGlobFlags, e.g. %FU_PATH_GLOB_FLAG_CASE_INSENSITIVE
+ * @error: (nullable): optional return location for an error
+ *
+ * Returns all the files on the volume that match a glob pattern, as with fu_path_glob_full().
+ *
+ * The directory listings are cached for as long as a #FuVolumeLocker is held on the volume, so
+ * that repeated queries do not need to read the filesystem again. The cache is invalidated when
+ * a file is written using fu_volume_write_file().
+ *
+ * Returns:  (element-type utf8) (transfer container): matching files, or %NULL
+ *
+ * Since: 2.2.1
+ **/
+GPtrArray *
+fu_volume_glob(FuVolume *self, const gchar *pattern, FuPathGlobFlags flags, GError **error)
+{
+	g_autofree gchar *mount_point = NULL;
+
+	g_return_val_if_fail(FU_IS_VOLUME(self), NULL);
+	g_return_val_if_fail(pattern != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	mount_point = fu_volume_get_mount_point(self);
+	if (mount_point == NULL) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "no mountpoint for volume");
+		return NULL;
+	}
+	return fu_path_glob_with_func(mount_point,
+				      pattern,
+				      flags,
+				      fu_volume_list_dir_cb,
+				      self,
+				      error);
+}
+
 /* private */
 FuVolume *
 fu_volume_new_from_mount_path(const gchar *mount_path)
@@ -1044,6 +1150,38 @@ fu_volume_codec_iface_init(FwupdCodecInterface *iface)
 	iface->add_json = fu_volume_add_json;
 }
 
+static GDBusProxy *
+fu_volume_get_sibling_proxy(GDBusProxy *proxy_blk, const gchar *iface_name, GError **error)
+{
+	GDBusObject *dbus_object = g_dbus_interface_get_object(G_DBUS_INTERFACE(proxy_blk));
+	GDBusInterface *dbus_iface;
+
+	/* not from the shared object manager */
+	if (dbus_object == NULL) {
+		return g_dbus_proxy_new_sync(g_dbus_proxy_get_connection(proxy_blk),
+					     G_DBUS_PROXY_FLAGS_NONE,
+					     NULL,
+					     UDISKS_DBUS_SERVICE,
+					     g_dbus_proxy_get_object_path(proxy_blk),
+					     iface_name,
+					     NULL,
+					     error);
+	}
+
+	/* the object manager already has the interface and all the properties */
+	dbus_iface = g_dbus_object_get_interface(dbus_object, iface_name);
+	if (dbus_iface == NULL) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "no %s interface on %s",
+			    iface_name,
+			    g_dbus_proxy_get_object_path(proxy_blk));
+		return NULL;
+	}
+	return G_DBUS_PROXY(dbus_iface);
+}
+
 /**
  * fu_volume_new_by_kind:
  * @kind: a volume kind, typically a GUID
@@ -1094,28 +1232,18 @@ fu_volume_new_by_kind(const gchar *kind, GError **error)
 			}
 		}
 
-		proxy_part = g_dbus_proxy_new_sync(g_dbus_proxy_get_connection(proxy_blk),
-						   G_DBUS_PROXY_FLAGS_NONE,
-						   NULL,
-						   UDISKS_DBUS_SERVICE,
-						   g_dbus_proxy_get_object_path(proxy_blk),
-						   UDISKS_DBUS_INTERFACE_PARTITION,
-						   NULL,
-						   error);
+		proxy_part = fu_volume_get_sibling_proxy(proxy_blk,
+							 UDISKS_DBUS_INTERFACE_PARTITION,
+							 &error_local);
 		if (proxy_part == NULL) {
-			g_prefix_error(error,
-				       "failed to initialize d-bus proxy %s: ",
-				       g_dbus_proxy_get_object_path(proxy_blk));
-			return NULL;
+			g_debug("no partition for %s: %s",
+				g_dbus_proxy_get_object_path(proxy_blk),
+				error_local->message);
+			g_clear_error(&error_local);
 		}
-		proxy_fs = g_dbus_proxy_new_sync(g_dbus_proxy_get_connection(proxy_blk),
-						 G_DBUS_PROXY_FLAGS_NONE,
-						 NULL,
-						 UDISKS_DBUS_SERVICE,
-						 g_dbus_proxy_get_object_path(proxy_blk),
-						 UDISKS_DBUS_INTERFACE_FILESYSTEM,
-						 NULL,
-						 &error_local);
+		proxy_fs = fu_volume_get_sibling_proxy(proxy_blk,
+						       UDISKS_DBUS_INTERFACE_FILESYSTEM,
+						       &error_local);
 		if (proxy_fs == NULL) {
 			g_debug("failed to get filesystem for %s: %s",
 				g_dbus_proxy_get_object_path(proxy_blk),
@@ -1217,24 +1345,16 @@ fu_volume_new_by_device(const gchar *device, GError **error)
 			g_autoptr(GDBusProxy) proxy_fs = NULL;
 			g_autoptr(GDBusProxy) proxy_part = NULL;
 			g_autoptr(GError) error_local = NULL;
-			proxy_fs = g_dbus_proxy_new_sync(g_dbus_proxy_get_connection(proxy_blk),
-							 G_DBUS_PROXY_FLAGS_NONE,
-							 NULL,
-							 UDISKS_DBUS_SERVICE,
-							 g_dbus_proxy_get_object_path(proxy_blk),
-							 UDISKS_DBUS_INTERFACE_FILESYSTEM,
-							 NULL,
-							 &error_local);
-			if (proxy_fs == NULL)
+			proxy_fs = fu_volume_get_sibling_proxy(proxy_blk,
+							       UDISKS_DBUS_INTERFACE_FILESYSTEM,
+							       &error_local);
+			if (proxy_fs == NULL) {
 				g_debug("ignoring: %s", error_local->message);
-			proxy_part = g_dbus_proxy_new_sync(g_dbus_proxy_get_connection(proxy_blk),
-							   G_DBUS_PROXY_FLAGS_NONE,
-							   NULL,
-							   UDISKS_DBUS_SERVICE,
-							   g_dbus_proxy_get_object_path(proxy_blk),
-							   UDISKS_DBUS_INTERFACE_PARTITION,
-							   NULL,
-							   &error_local);
+				g_clear_error(&error_local);
+			}
+			proxy_part = fu_volume_get_sibling_proxy(proxy_blk,
+								 UDISKS_DBUS_INTERFACE_PARTITION,
+								 &error_local);
 			if (proxy_part == NULL)
 				g_debug("ignoring: %s", error_local->message);
 			return g_object_new(FU_TYPE_VOLUME,
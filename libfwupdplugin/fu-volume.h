@@ -9,6 +9,8 @@
 
 #include <fwupd.h>
 
+#include "fu-path.h"
+
 G_BEGIN_DECLS
 
 #define FU_TYPE_VOLUME (fu_volume_get_type())
@@ -38,6 +40,9 @@ gboolean
 fu_volume_check_free_space(FuVolume *self,
 			   guint64 required,
 			   GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
+GPtrArray *
+fu_volume_glob(FuVolume *self, const gchar *pattern, FuPathGlobFlags flags, GError **error)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
 gboolean
 fu_volume_write_file(FuVolume *self, const gchar *filename, GBytes *bytes, GError **error)
     G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2, 3);
@@ -107,7 +107,7 @@ fu_lxs_touch_device_read_data(FuLxsTouchDevice *self,
 }
 
 static gboolean
-fu_lxs_touch_device_wait_ready_cb(FuDevice *device, gpointer user_data, GError **error)
+fu_lxs_touch_device_check_ready(FuDevice *device, GError **error)
 {
 	FuLxsTouchDevice *self = FU_LXS_TOUCH_DEVICE(device);
 	guint8 buf[8] = {0};
@@ -131,6 +131,12 @@ fu_lxs_touch_device_wait_ready_cb(FuDevice *device, gpointer user_data, GError *
 	return TRUE;
 }
 
+static gboolean
+fu_lxs_touch_device_wait_ready_cb(FuDevice *device, gpointer user_data, GError **error)
+{
+	return fu_lxs_touch_device_check_ready(device, error);
+}
+
 static gboolean
 fu_lxs_touch_device_wait_ready(FuLxsTouchDevice *self, GError **error)
 {
@@ -551,6 +557,11 @@ fu_lxs_touch_device_write_firmware(FuDevice *device,
 		return FALSE;
 	}
 
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_WRITE, 95, NULL);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_RESTART, 5, NULL);
+
 	/* send chunks */
 	stream = fu_firmware_get_stream(firmware, error);
 	if (stream == NULL)
@@ -564,7 +575,10 @@ fu_lxs_touch_device_write_firmware(FuDevice *device,
 							error);
 		if (chunks == NULL)
 			return FALSE;
-		if (!fu_lxs_touch_device_write_4k_chunks(self, chunks, progress, error))
+		if (!fu_lxs_touch_device_write_4k_chunks(self,
+							 chunks,
+							 fu_progress_get_child(progress),
+							 error))
 			return FALSE;
 	} else {
 		g_autoptr(FuChunkArray) chunks = NULL;
@@ -575,15 +589,29 @@ fu_lxs_touch_device_write_firmware(FuDevice *device,
 							error);
 		if (chunks == NULL)
 			return FALSE;
-		if (!fu_lxs_touch_device_write_normal_chunks(self, chunks, progress, error))
+		if (!fu_lxs_touch_device_write_normal_chunks(self,
+							     chunks,
+							     fu_progress_get_child(progress),
+							     error))
 			return FALSE;
 	}
+	fu_progress_step_done(progress);
 	if (!fu_lxs_touch_device_reset_wdt(self, error))
 		return FALSE;
 
 	/* I2C HID devices do not disconnect/reconnect after watchdog reset;
 	 * the same /dev/hidrawN node remains. Wait for the device to settle. */
-	fu_device_sleep(device, 3000);
+	if (fu_device_has_flag(device, FWUPD_DEVICE_FLAG_EMULATED) &&
+	    !fu_device_check_fwupd_version(device, "2.2.1")) {
+		fu_device_sleep(device, 3000);
+	} else {
+		if (!fu_device_poll_until_ready(device,
+						3000,
+						fu_progress_get_child(progress),
+						error))
+			return FALSE;
+	}
+	fu_progress_step_done(progress);
 	return TRUE;
 }
 
@@ -622,6 +650,7 @@ fu_lxs_touch_device_class_init(FuLxsTouchDeviceClass *klass)
 	device_class->reload = fu_lxs_touch_device_setup;
 	device_class->detach = fu_lxs_touch_device_detach;
 	device_class->write_firmware = fu_lxs_touch_device_write_firmware;
+	device_class->check_ready = fu_lxs_touch_device_check_ready;
 	device_class->to_string = fu_lxs_touch_device_to_string;
 	device_class->set_progress = fu_lxs_touch_device_set_progress;
 }
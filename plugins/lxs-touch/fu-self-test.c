@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "fu-device-private.h"
+#include "fu-lxs-touch-device.h"
+#include "fu-lxs-touch-struct.h"
+
+#define FU_LXS_TOUCH_TEST_BUFFER_SIZE 64
+
+static void
+fu_lxs_touch_test_add_write_event(FuLxsTouchDevice *self,
+				  FuLxsTouchFlag flag,
+				  guint16 length,
+				  guint16 command)
+{
+	g_autofree gchar *data_base64 = NULL;
+	g_autofree gchar *event_id = NULL;
+	g_autoptr(FuDeviceEvent) event = NULL;
+	g_autoptr(FuStructLxsTouchPacket) st = fu_struct_lxs_touch_packet_new();
+
+	fu_struct_lxs_touch_packet_set_flag(st, flag);
+	fu_struct_lxs_touch_packet_set_length(st, length);
+	fu_struct_lxs_touch_packet_set_command(st, command);
+	fu_byte_array_set_size(st->buf, FU_LXS_TOUCH_TEST_BUFFER_SIZE, 0x0);
+	data_base64 = fu_base64_encode(st->buf->data, st->buf->len);
+	event_id = g_strdup_printf("Write:Data=%s,Length=0x%x", data_base64, st->buf->len);
+	event = fu_device_event_new(event_id);
+	fu_device_add_event(FU_DEVICE(self), event);
+}
+
+/* the events for a single read of the CtrlGetter register */
+static void
+fu_lxs_touch_test_add_getter_events(FuLxsTouchDevice *self, FuLxsTouchReadyStatus ready_status)
+{
+	guint8 buf[FU_LXS_TOUCH_TEST_BUFFER_SIZE] = {0};
+	g_autoptr(FuDeviceEvent) event = fu_device_event_new("Read:Length=0x40,Offset=0x0");
+
+	fu_lxs_touch_test_add_write_event(self,
+					  FU_LXS_TOUCH_FLAG_WRITE,
+					  2,
+					  FU_LXS_TOUCH_REG_CTRL_GETTER);
+	fu_lxs_touch_test_add_write_event(self,
+					  FU_LXS_TOUCH_FLAG_READ,
+					  8,
+					  FU_LXS_TOUCH_REG_CTRL_GETTER);
+	buf[4] = ready_status;
+	fu_device_event_set_data(event, "Data", buf, sizeof(buf));
+	fu_device_add_event(FU_DEVICE(self), event);
+}
+
+static void
+fu_lxs_touch_device_ready_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuLxsTouchDevice) device = NULL;
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	device = g_object_new(FU_TYPE_LXS_TOUCH_DEVICE, "context", ctx, NULL);
+	fu_device_add_flag(FU_DEVICE(device), FWUPD_DEVICE_FLAG_EMULATED);
+	fu_device_set_fwupd_version(FU_DEVICE(device), PACKAGE_VERSION);
+
+	/* still resetting after the watchdog reset, and then ready */
+	fu_lxs_touch_test_add_getter_events(device, FU_LXS_TOUCH_READY_STATUS_NONE);
+	fu_lxs_touch_test_add_getter_events(device, FU_LXS_TOUCH_READY_STATUS_NONE);
+	fu_lxs_touch_test_add_getter_events(device, FU_LXS_TOUCH_READY_STATUS_READY);
+
+	/* this used to be a fixed 3s sleep */
+	ret = fu_device_poll_until_ready(FU_DEVICE(device), 3000, progress, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpfloat(g_timer_elapsed(timer, NULL), <, 1.f);
+}
+
+int
+main(int argc, char **argv)
+{
+	(void)g_setenv("G_TEST_SRCDIR", SRCDIR, FALSE);
+	g_test_init(&argc, &argv, NULL);
+
+	/* log everything */
+	(void)g_setenv("G_MESSAGES_DEBUG", "all", FALSE);
+	g_test_add_func("/lxs-touch/device/ready", fu_lxs_touch_device_ready_func);
+	return g_test_run();
+}
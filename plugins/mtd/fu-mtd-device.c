@@ -774,6 +774,50 @@ fu_mtd_device_probe(FuDevice *device, GError **error)
 	return TRUE;
 }
 
+static gboolean
+fu_mtd_device_erase_chunk(FuMtdDevice *self, FuChunk *chk, GError **error)
+{
+#ifdef HAVE_MTD_USER_H
+	FuMtdDevicePrivate *priv = GET_PRIVATE(self);
+	struct erase_info_user erase = {0x0};
+	g_autoptr(FuIoctl) ioctl = fu_udev_device_ioctl_new(FU_UDEV_DEVICE(self));
+
+	erase.start = fu_chunk_get_address(chk);
+	erase.length = fu_chunk_get_data_sz(chk);
+
+	/* the last chunk may be smaller than the erasesize. if it is, extend the last erase
+	 * up to the erasesize */
+	if (erase.length < priv->erasesize) {
+		g_debug("extending last erase from %" G_GUINT32_FORMAT
+			" bytes to %" G_GUINT64_FORMAT " bytes",
+			erase.length,
+			priv->erasesize);
+		erase.length = priv->erasesize;
+	}
+
+	if (!fu_ioctl_execute(ioctl,
+			      MEMERASE,
+			      (guint8 *)&erase,
+			      sizeof(erase),
+			      NULL,
+			      FU_MTD_DEVICE_IOCTL_TIMEOUT,
+			      FU_IOCTL_FLAG_NONE,
+			      error)) {
+		g_prefix_error(error, "failed to erase @0x%x: ", (guint)erase.start);
+		return FALSE;
+	}
+
+	/* success */
+	return TRUE;
+#else
+	g_set_error_literal(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "Not supported as mtd-user.h is unavailable");
+	return FALSE;
+#endif
+}
+
 static gboolean
 fu_mtd_device_erase(FuMtdDevice *self,
 		    FuInputStream *stream,
@@ -781,7 +825,6 @@ fu_mtd_device_erase(FuMtdDevice *self,
 		    FuProgress *progress,
 		    GError **error)
 {
-#ifdef HAVE_MTD_USER_H
 	FuMtdDevicePrivate *priv = GET_PRIVATE(self);
 	g_autoptr(FuChunkArray) chunks = NULL;
 
@@ -799,50 +842,19 @@ fu_mtd_device_erase(FuMtdDevice *self,
 
 	/* erase each chunk */
 	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
-		struct erase_info_user erase = {0x0};
 		g_autoptr(FuChunk) chk = NULL;
-		g_autoptr(FuIoctl) ioctl = fu_udev_device_ioctl_new(FU_UDEV_DEVICE(self));
 
 		/* prepare chunk */
 		chk = fu_chunk_array_index(chunks, i, error);
 		if (chk == NULL)
 			return FALSE;
-		erase.start = fu_chunk_get_address(chk);
-		erase.length = fu_chunk_get_data_sz(chk);
-
-		/* the last chunk may be smaller than the erasesize. if it is, extend the last erase
-		 * up to the erasesize */
-		if (erase.length < priv->erasesize) {
-			g_debug("extending last erase from %" G_GUINT32_FORMAT
-				" bytes to %" G_GUINT64_FORMAT " bytes",
-				erase.length,
-				priv->erasesize);
-			erase.length = priv->erasesize;
-		}
-
-		if (!fu_ioctl_execute(ioctl,
-				      MEMERASE,
-				      (guint8 *)&erase,
-				      sizeof(erase),
-				      NULL,
-				      FU_MTD_DEVICE_IOCTL_TIMEOUT,
-				      FU_IOCTL_FLAG_NONE,
-				      error)) {
-			g_prefix_error(error, "failed to erase @0x%x: ", (guint)erase.start);
+		if (!fu_mtd_device_erase_chunk(self, chk, error))
 			return FALSE;
-		}
 		fu_progress_step_done(progress);
 	}
 
 	/* success */
 	return TRUE;
-#else
-	g_set_error_literal(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_NOT_SUPPORTED,
-			    "Not supported as mtd-user.h is unavailable");
-	return FALSE;
-#endif
 }
 
 static gboolean
@@ -886,13 +898,14 @@ fu_mtd_device_write(FuMtdDevice *self, FuChunkArray *chunks, FuProgress *progres
 static gboolean
 fu_mtd_device_verify(FuMtdDevice *self, FuChunkArray *chunks, FuProgress *progress, GError **error)
 {
+	g_autofree guint8 *buf = NULL;
+
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_set_steps(progress, fu_chunk_array_length(chunks));
 
-	/* verify each chunk */
+	/* verify each chunk, reusing the buffer as only the last chunk can be smaller */
 	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
-		g_autofree guint8 *buf = NULL;
 		g_autoptr(FuChunk) chk = NULL;
 		g_autoptr(GBytes) blob1 = NULL;
 		g_autoptr(GBytes) blob2 = NULL;
@@ -901,7 +914,8 @@ fu_mtd_device_verify(FuMtdDevice *self, FuChunkArray *chunks, FuProgress *progre
 		chk = fu_chunk_array_index(chunks, i, error);
 		if (chk == NULL)
 			return FALSE;
-		buf = g_malloc0(fu_chunk_get_data_sz(chk));
+		if (buf == NULL)
+			buf = g_malloc0(fu_chunk_get_data_sz(chk));
 		if (!fu_udev_device_pread(FU_UDEV_DEVICE(self),
 					  fu_chunk_get_address(chk),
 					  buf,
@@ -961,6 +975,128 @@ fu_mtd_device_write_verify(FuMtdDevice *self,
 	return TRUE;
 }
 
+static gboolean
+fu_mtd_device_write_stream_differential(FuMtdDevice *self,
+					FuInputStream *stream,
+					gsize offset,
+					FuProgress *progress,
+					GError **error)
+{
+	FuMtdDevicePrivate *priv = GET_PRIVATE(self);
+	g_autofree guint8 *buf = g_malloc0(priv->erasesize);
+	g_autoptr(FuChunkArray) chunks = NULL;
+	g_autoptr(GPtrArray) chunks_changed = g_ptr_array_new_with_free_func(g_object_unref);
+
+	chunks = fu_chunk_array_new_from_stream(stream,
+						offset,
+						FU_CHUNK_PAGESZ_NONE,
+						priv->erasesize,
+						error);
+	if (chunks == NULL)
+		return FALSE;
+
+	/* progress */
+	fu_progress_set_id(progress, G_STRLOC);
+	fu_progress_add_flag(progress, FU_PROGRESS_FLAG_GUESSED);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_READ, 25, NULL);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_ERASE, 25, NULL);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_WRITE, 25, NULL);
+	fu_progress_add_step(progress, FWUPD_STATUS_DEVICE_VERIFY, 25, NULL);
+
+	/* find the erase blocks that are different to the new image */
+	fu_progress_set_steps(fu_progress_get_child(progress), fu_chunk_array_length(chunks));
+	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
+		g_autoptr(FuChunk) chk = NULL;
+
+		chk = fu_chunk_array_index(chunks, i, error);
+		if (chk == NULL)
+			return FALSE;
+		if (!fu_udev_device_pread(FU_UDEV_DEVICE(self),
+					  fu_chunk_get_address(chk),
+					  buf,
+					  fu_chunk_get_data_sz(chk),
+					  error)) {
+			g_prefix_error(error,
+				       "failed to read @0x%x: ",
+				       (guint)fu_chunk_get_address(chk));
+			return FALSE;
+		}
+		if (memcmp(buf, fu_chunk_get_data(chk), fu_chunk_get_data_sz(chk)) != 0)
+			g_ptr_array_add(chunks_changed, g_steal_pointer(&chk));
+		fu_progress_step_done(fu_progress_get_child(progress));
+	}
+	fu_progress_step_done(progress);
+	g_debug("%u of %u erase blocks changed",
+		chunks_changed->len,
+		fu_chunk_array_length(chunks));
+	if (chunks_changed->len == 0) {
+		fu_progress_finished(progress);
+		return TRUE;
+	}
+
+	/* erase */
+	fu_progress_set_steps(fu_progress_get_child(progress), chunks_changed->len);
+	for (guint i = 0; i < chunks_changed->len; i++) {
+		FuChunk *chk = g_ptr_array_index(chunks_changed, i);
+		if (!fu_mtd_device_erase_chunk(self, chk, error))
+			return FALSE;
+		fu_progress_step_done(fu_progress_get_child(progress));
+	}
+	fu_progress_step_done(progress);
+
+	/* write */
+	fu_progress_set_steps(fu_progress_get_child(progress), chunks_changed->len);
+	for (guint i = 0; i < chunks_changed->len; i++) {
+		FuChunk *chk = g_ptr_array_index(chunks_changed, i);
+		if (!fu_udev_device_pwrite(FU_UDEV_DEVICE(self),
+					   fu_chunk_get_address(chk),
+					   fu_chunk_get_data(chk),
+					   fu_chunk_get_data_sz(chk),
+					   error)) {
+			g_prefix_error(error,
+				       "failed to write @0x%x: ",
+				       (guint)fu_chunk_get_address(chk));
+			return FALSE;
+		}
+		fu_progress_step_done(fu_progress_get_child(progress));
+	}
+	fu_progress_step_done(progress);
+
+	/* verify only what was written */
+	fu_progress_set_steps(fu_progress_get_child(progress), chunks_changed->len);
+	for (guint i = 0; i < chunks_changed->len; i++) {
+		FuChunk *chk = g_ptr_array_index(chunks_changed, i);
+		if (!fu_udev_device_pread(FU_UDEV_DEVICE(self),
+					  fu_chunk_get_address(chk),
+					  buf,
+					  fu_chunk_get_data_sz(chk),
+					  error)) {
+			g_prefix_error(error,
+				       "failed to read @0x%x: ",
+				       (guint)fu_chunk_get_address(chk));
+			return FALSE;
+		}
+		if (!fu_memcmp_safe(buf,
+				    priv->erasesize,
+				    0x0,
+				    fu_chunk_get_data(chk),
+				    fu_chunk_get_data_sz(chk),
+				    0x0,
+				    fu_chunk_get_data_sz(chk),
+				    error)) {
+			g_prefix_error(error,
+				       "failed to verify @0x%x: ",
+				       (guint)fu_chunk_get_address(chk));
+			return FALSE;
+		}
+		fu_progress_step_done(fu_progress_get_child(progress));
+	}
+	fu_progress_step_done(progress);
+
+	/* success */
+	return TRUE;
+}
+
 static GBytes *
 fu_mtd_device_dump_firmware(FuDevice *device, FuProgress *progress, GError **error)
 {
@@ -1010,6 +1146,14 @@ fu_mtd_device_write_stream(FuMtdDevice *self,
 	if (priv->erasesize == 0)
 		return fu_mtd_device_write_verify(self, stream, offset, progress, error);
 
+	/* only erase and write the blocks that changed */
+	if (fu_device_has_private_flag(FU_DEVICE(self), FU_MTD_DEVICE_FLAG_DIFFERENTIAL_WRITE))
+		return fu_mtd_device_write_stream_differential(self,
+							       stream,
+							       offset,
+							       progress,
+							       error);
+
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_add_flag(progress, FU_PROGRESS_FLAG_GUESSED);
@@ -1297,5 +1441,6 @@ fu_mtd_device_class_init(FuMtdDeviceClass *klass)
 	device_class->write_firmware = fu_mtd_device_write_firmware;
 	device_class->set_quirk_kv = fu_mtd_device_set_quirk_kv;
 	fu_device_register_private_flag(device_class, FU_MTD_DEVICE_FLAG_SMBIOS_VERSION_FALLBACK);
+	fu_device_register_private_flag(device_class, FU_MTD_DEVICE_FLAG_DIFFERENTIAL_WRITE);
 	device_class->add_security_attrs = fu_mtd_device_add_security_attrs;
 }
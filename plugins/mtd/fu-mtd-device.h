@@ -16,6 +16,7 @@ struct _FuMtdDeviceClass {
 };
 
 #define FU_MTD_DEVICE_FLAG_SMBIOS_VERSION_FALLBACK "smbios-version-fallback"
+#define FU_MTD_DEVICE_FLAG_DIFFERENTIAL_WRITE	   "differential-write"
 
 gboolean
 fu_mtd_device_write_image(FuMtdDevice *self, FuFirmware *img, FuProgress *progress, GError **error)
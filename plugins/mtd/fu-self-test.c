@@ -138,6 +138,43 @@ fu_test_mtd_device_new_for_security_attrs(FuTest *self, gboolean add_event, gboo
 		fu_test_mtd_device_add_memislocked_event(FU_MTD_DEVICE(device), locked);
 	return FU_MTD_DEVICE(g_steal_pointer(&device));
 }
+
+/* count the erase ioctls and the bytes written from the saved events */
+static void
+fu_test_mtd_device_count_events(FuMtdDevice *device, guint *erase_cnt, gsize *write_bytes)
+{
+	GPtrArray *events = fu_device_get_events(FU_DEVICE(device));
+	g_autofree gchar *erase_prefix = g_strdup_printf("Ioctl:Request=0x%04x,", (guint)MEMERASE);
+
+	*erase_cnt = 0;
+	*write_bytes = 0;
+	for (guint i = 0; i < events->len; i++) {
+		FuDeviceEvent *event = g_ptr_array_index(events, i);
+		const gchar *id;
+		g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+
+		fwupd_codec_to_json(FWUPD_CODEC(event), json_obj, FWUPD_CODEC_FLAG_NONE);
+		id = fwupd_json_object_get_string(json_obj, "Id", NULL);
+		g_assert_nonnull(id);
+		if (g_str_has_prefix(id, erase_prefix)) {
+			(*erase_cnt)++;
+		} else if (g_str_has_prefix(id, "Pwrite:")) {
+			gboolean ret;
+			guint64 length = 0;
+			g_autoptr(GError) error = NULL;
+
+			ret = fu_strtoull(g_strrstr(id, "Length=") + strlen("Length="),
+					  &length,
+					  0,
+					  G_MAXSIZE,
+					  FU_INTEGER_BASE_16,
+					  &error);
+			g_assert_no_error(error);
+			g_assert_true(ret);
+			*write_bytes += length;
+		}
+	}
+}
 #endif
 
 static FuFirmware *
@@ -717,6 +754,96 @@ fu_test_mtd_device_smbios_func(gconstpointer user_data)
 			FWUPD_VERSION_FORMAT_PAIR);
 }
 
+static void
+fu_test_mtd_device_differential_func(gconstpointer user_data)
+{
+#ifndef HAVE_MTD_USER_H
+	g_test_skip("no mtd-user.h support");
+#else
+	FuTest *self = (FuTest *)user_data;
+	gboolean ret;
+	gsize bufsz;
+	gsize write_bytes = 0;
+	guint64 erasesize = 0;
+	guint erase_cnt = 0;
+	g_autofree gchar *attr_erasesize = NULL;
+	g_autoptr(FuFirmware) firmware = NULL;
+	g_autoptr(FuMtdDevice) device = NULL;
+	g_autoptr(FuProgress) progress = fu_progress_new(NULL);
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob_dump = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* find correct device */
+	device = fu_test_mtd_find_mtdram(self->ctx, &error);
+	if (device == NULL) {
+		g_test_skip(error->message);
+		return;
+	}
+	attr_erasesize = fu_udev_device_read_sysfs(FU_UDEV_DEVICE(device),
+						   "erasesize",
+						   FU_UDEV_DEVICE_ATTR_READ_TIMEOUT_DEFAULT,
+						   &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(attr_erasesize);
+	ret = fu_strtoull(attr_erasesize, &erasesize, 1, G_MAXUINT32, FU_INTEGER_BASE_AUTO, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* write the empty image */
+	firmware = fu_test_mtd_prepare_mtdram_device(device, FU_TYPE_FIRMWARE, NULL);
+	g_assert_nonnull(firmware);
+
+	/* change a single erase block in the middle */
+	bufsz = fu_device_get_firmware_size_max(FU_DEVICE(device));
+	g_assert_cmpint(bufsz, >, erasesize);
+	fu_byte_array_set_size(buf, bufsz, 0xFF);
+	memset(buf->data + (bufsz / 2), 0x42, 0x10);
+	blob = g_bytes_new(buf->data, buf->len);
+	fu_firmware_set_bytes(firmware, blob);
+	fu_device_add_private_flag(FU_DEVICE(device), FU_MTD_DEVICE_FLAG_DIFFERENTIAL_WRITE);
+	fu_context_add_flag(self->ctx, FU_CONTEXT_FLAG_SAVE_EVENTS);
+	fu_device_clear_events(FU_DEVICE(device));
+	ret = fu_device_write_firmware(FU_DEVICE(device),
+				       firmware,
+				       progress,
+				       FWUPD_INSTALL_FLAG_NONE,
+				       &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* only the changed erase block was erased and written */
+	fu_test_mtd_device_count_events(device, &erase_cnt, &write_bytes);
+	g_assert_cmpint(erase_cnt, ==, 1);
+	g_assert_cmpint(write_bytes, ==, erasesize);
+
+	/* the device contents match the image */
+	fu_progress_reset(progress);
+	blob_dump = fu_device_dump_firmware(FU_DEVICE(device), progress, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_dump);
+	ret = fu_bytes_compare(blob_dump, blob, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* writing the same image again does not erase or write anything */
+	fu_progress_reset(progress);
+	fu_device_clear_events(FU_DEVICE(device));
+	ret = fu_device_write_firmware(FU_DEVICE(device),
+				       firmware,
+				       progress,
+				       FWUPD_INSTALL_FLAG_NONE,
+				       &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_test_mtd_device_count_events(device, &erase_cnt, &write_bytes);
+	g_assert_cmpint(erase_cnt, ==, 0);
+	g_assert_cmpint(write_bytes, ==, 0);
+	fu_context_remove_flag(self->ctx, FU_CONTEXT_FLAG_SAVE_EVENTS);
+#endif
+}
+
 int
 main(int argc, char **argv)
 {
@@ -789,5 +916,8 @@ main(int argc, char **argv)
 	g_test_add_data_func("/mtd/device/ifd", self, fu_test_mtd_device_ifd_func);
 	g_test_add_data_func("/mtd/device/fmap", self, fu_test_mtd_device_fmap_func);
 	g_test_add_data_func("/mtd/device/smbios", self, fu_test_mtd_device_smbios_func);
+	g_test_add_data_func("/mtd/device/differential",
+			     self,
+			     fu_test_mtd_device_differential_func);
 	return g_test_run();
 }
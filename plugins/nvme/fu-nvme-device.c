@@ -6,6 +6,7 @@
 
 #include "config.h"
 
+#include <errno.h>
 #include <linux/nvme_ioctl.h>
 #ifdef HAVE_LINUX_SED_OPAL_H
 #include <linux/sed-opal.h>
@@ -17,7 +18,9 @@
 struct _FuNvmeDevice {
 	FuPciDevice parent_instance;
 	guint pci_depth;
-	guint64 write_block_size;
+	guint64 write_block_size;  /* from quirk */
+	guint64 write_granularity; /* from FWUG */
+	guint64 write_max_size;	   /* from MDTS */
 	guint serial_suffix;
 	FuNvmeOpalFlags opal_flags;
 };
@@ -39,12 +42,21 @@ G_DEFINE_TYPE(FuNvmeDevice, fu_nvme_device, FU_TYPE_PCI_DEVICE)
 #define FU_NVME_DEVICE_IOCTL_TIMEOUT	  5000 /* ms */
 #define FU_NVME_DEVICE_OPAL_IOCTL_TIMEOUT 500  /* ms */
 
+#define FU_NVME_DEVICE_BLOCK_SIZE_MIN 0x1000 /* CAP.MPSMIN is not visible from userspace */
+#define FU_NVME_DEVICE_BLOCK_SIZE_MAX 0x100000
+
+/* GHashTable of model name:block size, shared by all devices of the same context */
+#define FU_NVME_DEVICE_BLOCK_SIZES_KEY "nvme-block-sizes"
+
 static void
 fu_nvme_device_to_string(FuDevice *device, guint idt, GString *str)
 {
 	FuNvmeDevice *self = FU_NVME_DEVICE(device);
 	g_autofree gchar *opal_flags = fu_nvme_opal_flags_to_string(self->opal_flags);
 	fwupd_codec_string_append_int(str, idt, "PciDepth", self->pci_depth);
+	fwupd_codec_string_append_hex(str, idt, "WriteBlockSize", self->write_block_size);
+	fwupd_codec_string_append_hex(str, idt, "WriteGranularity", self->write_granularity);
+	fwupd_codec_string_append_hex(str, idt, "WriteMaxSize", self->write_max_size);
 	fwupd_codec_string_append_int(str, idt, "SerialSuffix", self->serial_suffix);
 	fwupd_codec_string_append(str, idt, "OpalFlags", opal_flags);
 }
@@ -141,6 +153,13 @@ fu_nvme_device_submit_admin_passthru(FuNvmeDevice *self,
 	case FU_NVME_STATUS_FW_NEEDS_SUBSYS_RESET:
 	case FU_NVME_STATUS_FW_NEEDS_RESET:
 		return TRUE;
+	case FU_NVME_STATUS_INVALID_FIELD:
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "Invalid data: %s",
+			    fu_nvme_status_to_string(err));
+		return FALSE;
 	default:
 		break;
 	}
@@ -152,6 +171,15 @@ fu_nvme_device_submit_admin_passthru(FuNvmeDevice *self,
 	return FALSE;
 }
 
+/* the generic ioctl error does not have a specific code for EINVAL, so match the errno */
+static gboolean
+fu_nvme_device_error_is_einval(const GError *error)
+{
+	g_autofree gchar *str = g_strdup_printf("[%i]", EINVAL);
+	return g_error_matches(error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL) &&
+	       g_str_has_suffix(error->message, str);
+}
+
 static gboolean
 fu_nvme_device_identify_ctrl(FuNvmeDevice *self, guint8 *buf, gsize bufsz, GError **error)
 {
@@ -343,6 +371,7 @@ fu_nvme_device_parse_cns(FuNvmeDevice *self, const guint8 *buf, gsize bufsz, GEr
 	guint8 frmw;
 	guint8 fawr;
 	guint8 fwug;
+	guint8 mdts;
 	guint8 nfws;
 	guint8 s1ro;
 	const fwupd_guid_t *gu;
@@ -382,7 +411,12 @@ fu_nvme_device_parse_cns(FuNvmeDevice *self, const guint8 *buf, gsize bufsz, GEr
 	/* firmware update granularity */
 	fwug = fu_struct_nvme_id_ctrl_get_fwug(st);
 	if (fwug != 0x00 && fwug != 0xff)
-		self->write_block_size = ((guint64)fwug) * 0x1000;
+		self->write_granularity = ((guint64)fwug) * 0x1000;
+
+	/* maximum data transfer size, in units of the minimum memory page size */
+	mdts = fu_struct_nvme_id_ctrl_get_mdts(st);
+	if (mdts != 0x00 && mdts < 32)
+		self->write_max_size = (1ull << mdts) * FU_NVME_DEVICE_BLOCK_SIZE_MIN;
 
 	/* firmware slot information */
 	frmw = fu_struct_nvme_id_ctrl_get_frmw(st);
@@ -536,6 +570,79 @@ fu_nvme_device_setup(FuDevice *device, GError **error)
 	return TRUE;
 }
 
+static GHashTable *
+fu_nvme_device_get_block_sizes(FuNvmeDevice *self)
+{
+	FuContext *ctx = fu_device_get_context(FU_DEVICE(self));
+	GHashTable *block_sizes = g_object_get_data(G_OBJECT(ctx), FU_NVME_DEVICE_BLOCK_SIZES_KEY);
+	if (block_sizes == NULL) {
+		block_sizes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+		g_object_set_data_full(G_OBJECT(ctx),
+				       FU_NVME_DEVICE_BLOCK_SIZES_KEY,
+				       block_sizes,
+				       (GDestroyNotify)g_hash_table_unref);
+	}
+	return block_sizes;
+}
+
+/* the block size that worked for another drive of the same model */
+static guint64
+fu_nvme_device_get_block_size_learned(FuNvmeDevice *self)
+{
+	const gchar *name = fu_device_get_name(FU_DEVICE(self));
+	if (name == NULL)
+		return 0;
+	return GPOINTER_TO_SIZE(g_hash_table_lookup(fu_nvme_device_get_block_sizes(self), name));
+}
+
+static void
+fu_nvme_device_set_block_size_learned(FuNvmeDevice *self, guint64 block_size)
+{
+	const gchar *name = fu_device_get_name(FU_DEVICE(self));
+	if (name == NULL)
+		return;
+	g_hash_table_insert(fu_nvme_device_get_block_sizes(self),
+			    g_strdup(name),
+			    GSIZE_TO_POINTER(block_size));
+}
+
+/* all transfers have to be a multiple of this */
+static guint64
+fu_nvme_device_get_block_size_min(FuNvmeDevice *self)
+{
+	if (self->write_block_size > 0)
+		return self->write_block_size;
+	if (self->write_granularity > 0)
+		return self->write_granularity;
+	return FU_NVME_DEVICE_BLOCK_SIZE_MIN;
+}
+
+static guint64
+fu_nvme_device_get_block_size(FuNvmeDevice *self)
+{
+	guint64 block_size = FU_NVME_DEVICE_BLOCK_SIZE_MAX;
+	guint64 block_size_learned = fu_nvme_device_get_block_size_learned(self);
+	guint64 block_size_min = fu_nvme_device_get_block_size_min(self);
+
+	/* set explicitly by a quirk */
+	if (self->write_block_size > 0)
+		return self->write_block_size;
+
+	/* emulations recorded with older versions used the granularity */
+	if (fu_device_has_flag(FU_DEVICE(self), FWUPD_DEVICE_FLAG_EMULATED) &&
+	    !fu_device_check_fwupd_version(FU_DEVICE(self), "2.2.1"))
+		return block_size_min;
+
+	/* as large as the controller allows */
+	if (self->write_max_size > 0)
+		block_size = MIN(block_size, self->write_max_size);
+	if (block_size_learned > 0)
+		block_size = MIN(block_size, block_size_learned);
+	if (block_size < block_size_min)
+		return block_size_min;
+	return block_size - (block_size % block_size_min);
+}
+
 static gboolean
 fu_nvme_device_write_firmware(FuDevice *device,
 			      FuFirmware *firmware,
@@ -544,10 +651,13 @@ fu_nvme_device_write_firmware(FuDevice *device,
 			      GError **error)
 {
 	FuNvmeDevice *self = FU_NVME_DEVICE(device);
+	gsize bufsz = 0;
+	gsize offset = 0;
+	const guint8 *buf;
 	g_autoptr(GBytes) fw2 = NULL;
 	g_autoptr(GBytes) fw = NULL;
-	g_autoptr(FuChunkArray) chunks = NULL;
-	guint64 block_size = self->write_block_size > 0 ? self->write_block_size : 4 * FU_KB;
+	guint64 block_size = fu_nvme_device_get_block_size(self);
+	guint64 block_size_min = fu_nvme_device_get_block_size_min(self);
 	guint8 commit_action = FU_NVME_COMMIT_ACTION_CA1;
 
 	/* progress */
@@ -563,38 +673,45 @@ fu_nvme_device_write_firmware(FuDevice *device,
 	/* some vendors provide firmware files whose sizes are not multiples
 	 * of blksz *and* the device won't accept blocks of different sizes */
 	if (fu_device_has_private_flag(device, FU_NVME_DEVICE_FLAG_FORCE_ALIGN)) {
-		fw2 = fu_bytes_align(fw, block_size, 0xff);
+		fw2 = fu_bytes_align(fw, block_size_min, 0xff);
 	} else {
 		fw2 = g_bytes_ref(fw);
 	}
 
-	/* write each block */
-	chunks = fu_chunk_array_new_from_bytes(fw2,
-					       FU_CHUNK_ADDR_OFFSET_NONE,
-					       FU_CHUNK_PAGESZ_NONE,
-					       block_size,
-					       error);
-	if (chunks == NULL)
-		return FALSE;
-	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
-		g_autoptr(FuChunk) chk = NULL;
+	/* write each block, using smaller transfers if the kernel returns EINVAL or the
+	 * controller returns Invalid Field in Command for the transfer size */
+	buf = g_bytes_get_data(fw2, &bufsz);
+	g_debug("using block size 0x%x", (guint)block_size);
+	while (offset < bufsz) {
+		gsize chunksz = MIN(bufsz - offset, block_size);
+		g_autoptr(GError) error_local = NULL;
 
-		/* prepare chunk */
-		chk = fu_chunk_array_index(chunks, i, error);
-		if (chk == NULL)
-			return FALSE;
 		if (!fu_nvme_device_fw_download(self,
-						fu_chunk_get_address(chk),
-						fu_chunk_get_data(chk),
-						fu_chunk_get_data_sz(chk),
-						error)) {
-			g_prefix_error(error, "failed to write chunk %u: ", i);
-			return FALSE;
+						offset,
+						buf + offset,
+						chunksz,
+						&error_local)) {
+			if ((!g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA) &&
+			     !fu_nvme_device_error_is_einval(error_local)) ||
+			    block_size / 2 < block_size_min ||
+			    (block_size / 2) % block_size_min != 0) {
+				g_propagate_prefixed_error(error,
+							   g_steal_pointer(&error_local),
+							   "failed to write chunk @0x%x: ",
+							   (guint)offset);
+				return FALSE;
+			}
+			block_size /= 2;
+			g_debug("failed to write chunk @0x%x, retrying with block size 0x%x: %s",
+				(guint)offset,
+				(guint)block_size,
+				error_local->message);
+			continue;
 		}
-		fu_progress_set_percentage_full(fu_progress_get_child(progress),
-						(gsize)i + 1,
-						(gsize)fu_chunk_array_length(chunks));
+		offset += chunksz;
+		fu_progress_set_percentage_full(fu_progress_get_child(progress), offset, bufsz);
 	}
+	fu_nvme_device_set_block_size_learned(self, block_size);
 	fu_progress_step_done(progress);
 
 	/* wait */
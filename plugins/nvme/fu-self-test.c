@@ -10,6 +10,7 @@
 #include "fu-device-private.h"
 #include "fu-nvme-device.h"
 #include "fu-nvme-plugin.h"
+#include "fu-nvme-struct.h"
 #include "fu-plugin-private.h"
 #include "fu-security-attrs-private.h"
 
@@ -126,6 +127,158 @@ fu_nvme_cns_all_func(void)
 	}
 }
 
+static void
+fu_nvme_test_add_event(FuNvmeDevice *self,
+		       guint8 opcode,
+		       guint32 cdw10,
+		       guint32 cdw11,
+		       const guint8 *buf,
+		       gsize bufsz,
+		       FuNvmeStatus status)
+{
+	g_autofree gchar *data_base64 = fu_base64_encode(buf, bufsz);
+	g_autofree gchar *event_id = NULL;
+	g_autoptr(FuDeviceEvent) event = NULL;
+
+	event_id = g_strdup_printf("NvmeIoctl:Opcode=0x%02x,Cdw10=0x%02x,Cdw11=0x%02x,"
+				   "Data=%s,Length=0x%x",
+				   opcode,
+				   cdw10,
+				   cdw11,
+				   data_base64,
+				   (guint)bufsz);
+	event = fu_device_event_new(event_id);
+	fu_device_event_set_data(event, "DataOut", buf, bufsz);
+	if (status != FU_NVME_STATUS_SUCCESS)
+		fu_device_event_set_i64(event, "Rc", status);
+	fu_device_add_event(FU_DEVICE(self), event);
+}
+
+static void
+fu_nvme_test_add_fw_download_event(FuNvmeDevice *self,
+				   GBytes *fw,
+				   gsize offset,
+				   gsize chunksz,
+				   FuNvmeStatus status)
+{
+	const guint8 *buf = g_bytes_get_data(fw, NULL);
+	fu_nvme_test_add_event(self,
+			       0x11,
+			       (chunksz >> 2) - 1,
+			       offset >> 2,
+			       buf + offset,
+			       chunksz,
+			       status);
+}
+
+/* the firmware slot log with no activation in progress, then commit with CA1 */
+static void
+fu_nvme_test_add_commit_events(FuNvmeDevice *self)
+{
+	guint8 buf[FU_STRUCT_NVME_FW_SLOT_INFO_LOG_SIZE] = {0};
+	fu_nvme_test_add_event(self,
+			       0x02,
+			       (((guint32)sizeof(buf) >> 2) - 1) << 16 | 0x03,
+			       0x0,
+			       buf,
+			       sizeof(buf),
+			       FU_NVME_STATUS_SUCCESS);
+	fu_nvme_test_add_event(self, 0x10, 0b001 << 3, 0x0, NULL, 0, FU_NVME_STATUS_SUCCESS);
+}
+
+/* MDTS of 16kB and FWUG of 4kB */
+static FuNvmeDevice *
+fu_nvme_test_new_emulated_device(FuContext *ctx)
+{
+	gboolean ret;
+	const gchar *mn = "FWUPD TEST NVME";
+	guint8 buf[FU_STRUCT_NVME_ID_CTRL_SIZE] = {0};
+	g_autoptr(FuNvmeDevice) device = NULL;
+	g_autoptr(GError) error = NULL;
+
+	ret = fu_memcpy_safe(buf,
+			     sizeof(buf),
+			     FU_STRUCT_NVME_ID_CTRL_OFFSET_MN,
+			     (const guint8 *)mn,
+			     strlen(mn),
+			     0x0,
+			     strlen(mn),
+			     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	buf[FU_STRUCT_NVME_ID_CTRL_OFFSET_MDTS] = 2;
+	buf[FU_STRUCT_NVME_ID_CTRL_OFFSET_FWUG] = 1;
+	device = fu_nvme_device_new_from_blob(ctx, buf, sizeof(buf), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(device);
+	fu_device_add_flag(FU_DEVICE(device), FWUPD_DEVICE_FLAG_EMULATED);
+	fu_device_set_fwupd_version(FU_DEVICE(device), PACKAGE_VERSION);
+	return g_steal_pointer(&device);
+}
+
+static GBytes *
+fu_nvme_test_new_fw(gsize bufsz)
+{
+	g_autofree guint8 *buf = g_malloc0(bufsz);
+	for (gsize i = 0; i < bufsz; i++)
+		buf[i] = (guint8)i;
+	return g_bytes_new_take(g_steal_pointer(&buf), bufsz);
+}
+
+static void
+fu_nvme_write_firmware_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuFirmware) firmware = NULL;
+	g_autoptr(FuNvmeDevice) device = fu_nvme_test_new_emulated_device(ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GBytes) fw = fu_nvme_test_new_fw(0x8000);
+	g_autoptr(GError) error = NULL;
+
+	/* sized from MDTS, then halved when the controller rejects the transfer */
+	fu_nvme_test_add_fw_download_event(device, fw, 0x0, 0x4000, FU_NVME_STATUS_INVALID_FIELD);
+	for (gsize offset = 0x0; offset < 0x8000; offset += 0x2000) {
+		fu_nvme_test_add_fw_download_event(device,
+						   fw,
+						   offset,
+						   0x2000,
+						   FU_NVME_STATUS_SUCCESS);
+	}
+	fu_nvme_test_add_commit_events(device);
+	firmware = fu_firmware_new_from_bytes(fw);
+	ret = fu_device_write_firmware(FU_DEVICE(device),
+				       firmware,
+				       progress,
+				       FWUPD_INSTALL_FLAG_NONE,
+				       &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+}
+
+static void
+fu_nvme_write_firmware_no_retry_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuFirmware) firmware = NULL;
+	g_autoptr(FuNvmeDevice) device = fu_nvme_test_new_emulated_device(ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GBytes) fw = fu_nvme_test_new_fw(0x8000);
+	g_autoptr(GError) error = NULL;
+
+	/* a failure unrelated to the transfer size is not retried */
+	fu_nvme_test_add_fw_download_event(device, fw, 0x0, 0x4000, FU_NVME_STATUS_INTERNAL);
+	firmware = fu_firmware_new_from_bytes(fw);
+	ret = fu_device_write_firmware(FU_DEVICE(device),
+				       firmware,
+				       progress,
+				       FWUPD_INSTALL_FLAG_NONE,
+				       &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_false(ret);
+}
+
 static guint fu_test_nvme_device_cnt;
 
 static FuDevice *
@@ -299,6 +452,8 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/serial-suffix", fu_nvme_serial_suffix_func);
 	g_test_add_func("/fwupd/cns", fu_nvme_cns_func);
 	g_test_add_func("/fwupd/cns/all", fu_nvme_cns_all_func);
+	g_test_add_func("/fwupd/write-firmware", fu_nvme_write_firmware_func);
+	g_test_add_func("/fwupd/write-firmware/no-retry", fu_nvme_write_firmware_no_retry_func);
 
 	/* OPAL security attribute tests */
 	g_test_add_func("/fwupd/opal/no-devices", fu_nvme_plugin_opal_no_devices_func);
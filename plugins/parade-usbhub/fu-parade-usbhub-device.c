@@ -967,6 +967,7 @@ fu_parade_usbhub_device_calculate_checksum(FuParadeUsbhubDevice *self,
 
 static gboolean
 fu_parade_usbhub_device_spi_rom_checksum(FuParadeUsbhubDevice *self,
+					 guint32 address,
 					 gsize size,
 					 guint32 *checksum,
 					 GError **error)
@@ -983,7 +984,7 @@ fu_parade_usbhub_device_spi_rom_checksum(FuParadeUsbhubDevice *self,
 	/* calculate checksum internally */
 	chunks = fu_chunk_array_new(NULL,
 				    size,
-				    self->spi_address,
+				    address,
 				    0x0,
 				    FU_PARADE_USBHUB_SPI_ROM_CHECKSUM_BUFFER_SIZE,
 				    error);
@@ -1011,6 +1012,32 @@ fu_parade_usbhub_device_spi_rom_checksum(FuParadeUsbhubDevice *self,
 	return TRUE;
 }
 
+/* the hub calculates the CRC-32/MPEG-2 of the SPI ROM range itself */
+static gboolean
+fu_parade_usbhub_device_read_crc(FuDevice *device,
+				 FuCrcKind kind,
+				 guint32 address,
+				 gsize bufsz,
+				 guint32 *crc,
+				 GError **error)
+{
+	FuParadeUsbhubDevice *self = FU_PARADE_USBHUB_DEVICE(device);
+
+	if (kind != FU_CRC_KIND_B32_MPEG2) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "CRC kind %s not supported",
+			    fu_crc_kind_to_string(kind));
+		return FALSE;
+	}
+	if (!fu_parade_usbhub_device_spi_rom_checksum(self, address, bufsz, crc, error)) {
+		g_prefix_error_literal(error, "failed to get ROM checksum: ");
+		return FALSE;
+	}
+	return TRUE;
+}
+
 static gboolean
 fu_parade_usbhub_device_assert_ufp_disconnect_flag(FuParadeUsbhubDevice *self, GError **error)
 {
@@ -1164,8 +1191,7 @@ fu_parade_usbhub_device_write_firmware(FuDevice *device,
 	FuParadeUsbhubDevice *self = FU_PARADE_USBHUB_DEVICE(device);
 	g_autoptr(FuInputStream) stream = NULL;
 	g_autoptr(GByteArray) blob = NULL;
-	guint32 checksum;
-	guint32 checksum_new;
+	g_autoptr(GBytes) blob_bytes = NULL;
 
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
@@ -1202,20 +1228,14 @@ fu_parade_usbhub_device_write_firmware(FuDevice *device,
 	fu_progress_step_done(progress);
 
 	/* compare checksum */
-	if (!fu_parade_usbhub_device_spi_rom_checksum(self, blob->len, &checksum_new, error)) {
-		g_prefix_error_literal(error, "failed to get ROM checksum: ");
+	blob_bytes = g_bytes_new(blob->data, blob->len);
+	if (!fu_device_verify_crc(device,
+				  FU_CRC_KIND_B32_MPEG2,
+				  self->spi_address,
+				  blob_bytes,
+				  fu_progress_get_child(progress),
+				  error))
 		return FALSE;
-	}
-	checksum = fu_crc32(FU_CRC_KIND_B32_MPEG2, blob->data, blob->len);
-	if (checksum != checksum_new) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INVALID_DATA,
-			    "checksum was 0x%x, expected 0x%x",
-			    checksum_new,
-			    checksum);
-		return FALSE;
-	}
 	if (fu_device_has_private_flag(FU_DEVICE(self),
 				       FU_PARADE_USBHUB_DEVICE_FLAG_USE_GPIO_ENABLE)) {
 		if (!fu_parade_usbhub_device_mmio_write_u8(
@@ -1330,6 +1350,7 @@ fu_parade_usbhub_device_class_init(FuParadeUsbhubDeviceClass *klass)
 	device_class->detach = fu_parade_usbhub_device_detach;
 	device_class->set_quirk_kv = fu_parade_usbhub_device_set_quirk_kv;
 	device_class->write_firmware = fu_parade_usbhub_device_write_firmware;
+	device_class->read_crc = fu_parade_usbhub_device_read_crc;
 	device_class->set_progress = fu_parade_usbhub_device_set_progress;
 	device_class->convert_version = fu_parade_usbhub_device_convert_version;
 	fu_device_register_private_flag(device_class, FU_PARADE_USBHUB_DEVICE_FLAG_USE_GPIO_ENABLE);
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "fu-device-private.h"
+#include "fu-parade-usbhub-device.h"
+#include "fu-parade-usbhub-struct.h"
+
+static void
+fu_parade_usbhub_test_add_event(FuParadeUsbhubDevice *self,
+				FuUsbDirection direction,
+				FuParadeUsbhubDeviceRequest request,
+				guint16 address,
+				guint8 val_in,
+				guint8 val_out)
+{
+	g_autofree gchar *data_base64 = fu_base64_encode(&val_in, sizeof(val_in));
+	g_autofree gchar *event_id = NULL;
+	g_autoptr(FuDeviceEvent) event = NULL;
+
+	event_id = g_strdup_printf("ControlTransfer:"
+				   "Direction=0x%02x,"
+				   "RequestType=0x%02x,"
+				   "Recipient=0x%02x,"
+				   "Request=0x%02x,"
+				   "Value=0x%04x,"
+				   "Idx=0x%04x,"
+				   "Data=%s,"
+				   "Length=0x%x",
+				   direction,
+				   FU_USB_REQUEST_TYPE_VENDOR,
+				   FU_USB_RECIPIENT_DEVICE,
+				   request,
+				   0x0u,
+				   address,
+				   data_base64,
+				   (guint)sizeof(val_in));
+	event = fu_device_event_new(event_id);
+	fu_device_event_set_data(event, "Data", &val_out, sizeof(val_out));
+	fu_device_add_event(FU_DEVICE(self), event);
+}
+
+static void
+fu_parade_usbhub_test_add_read_event(FuParadeUsbhubDevice *self, guint16 address, guint8 val)
+{
+	fu_parade_usbhub_test_add_event(self,
+					FU_USB_DIRECTION_DEVICE_TO_HOST,
+					FU_PARADE_USBHUB_DEVICE_REQUEST_READ,
+					address,
+					0x0,
+					val);
+}
+
+static void
+fu_parade_usbhub_test_add_write_event(FuParadeUsbhubDevice *self, guint16 address, guint8 val)
+{
+	fu_parade_usbhub_test_add_event(self,
+					FU_USB_DIRECTION_HOST_TO_DEVICE,
+					FU_PARADE_USBHUB_DEVICE_REQUEST_WRITE,
+					address,
+					val,
+					val);
+}
+
+/* the hub calculates the CRC of the SPI ROM range rather than reading the data back */
+static void
+fu_parade_usbhub_test_add_crc_events(FuParadeUsbhubDevice *self,
+				     guint32 address,
+				     guint16 size,
+				     guint32 crc)
+{
+	guint8 buf[4] = {0};
+
+	/* acquire and enable SPI */
+	fu_parade_usbhub_test_add_read_event(self,
+					     FU_PARADE_USBHUB_DEVICE_ADDR_SPI_MASTER_ACQUIRE,
+					     0x00);
+	fu_parade_usbhub_test_add_write_event(self,
+					      FU_PARADE_USBHUB_DEVICE_ADDR_SPI_MASTER_ACQUIRE,
+					      0x80);
+	fu_parade_usbhub_test_add_read_event(self, FU_PARADE_USBHUB_DEVICE_ADDR_SPI_MASTER, 0x00);
+	fu_parade_usbhub_test_add_write_event(self, FU_PARADE_USBHUB_DEVICE_ADDR_SPI_MASTER, 0x10);
+
+	/* the range fits in one checksum buffer */
+	fu_memwrite_uint24(buf, address, G_LITTLE_ENDIAN);
+	for (guint i = 0; i < 3; i++) {
+		fu_parade_usbhub_test_add_write_event(self,
+						      FU_PARADE_USBHUB_DEVICE_ADDR_SPI_ADDR + i,
+						      buf[i]);
+	}
+	fu_memwrite_uint16(buf, size, G_LITTLE_ENDIAN);
+	for (guint i = 0; i < 2; i++) {
+		fu_parade_usbhub_test_add_write_event(self,
+						      FU_PARADE_USBHUB_DEVICE_ADDR_DMA_SIZE + i,
+						      buf[i]);
+	}
+	fu_parade_usbhub_test_add_write_event(self,
+					      FU_PARADE_USBHUB_DEVICE_ADDR_STATUS,
+					      FU_PARADE_USBHUB_DEVICE_STATUS_FLAG_CHECKSUM |
+						  FU_PARADE_USBHUB_DEVICE_STATUS_FLAG_TRIGGER_SPI);
+	fu_parade_usbhub_test_add_read_event(self,
+					     FU_PARADE_USBHUB_DEVICE_ADDR_STATUS,
+					     FU_PARADE_USBHUB_DEVICE_STATUS_FLAG_SPI_DONE);
+
+	/* read calculated checksum */
+	fu_memwrite_uint32(buf, crc, G_LITTLE_ENDIAN);
+	for (guint i = 0; i < 4; i++) {
+		fu_parade_usbhub_test_add_read_event(self,
+						     FU_PARADE_USBHUB_DEVICE_ADDR_DATA + i,
+						     buf[i]);
+	}
+}
+
+static void
+fu_parade_usbhub_device_verify_crc_func(void)
+{
+	gboolean ret;
+	guint32 crc;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuParadeUsbhubDevice) device = NULL;
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(GBytes) blob = g_bytes_new_static("hello parade hub", 16);
+	g_autoptr(GError) error = NULL;
+
+	device = g_object_new(FU_TYPE_PARADE_USBHUB_DEVICE, "context", ctx, NULL);
+	fu_device_add_flag(FU_DEVICE(device), FWUPD_DEVICE_FLAG_EMULATED);
+	fu_device_set_fwupd_version(FU_DEVICE(device), PACKAGE_VERSION);
+
+	/* CRC matches */
+	crc = fu_crc32_bytes(FU_CRC_KIND_B32_MPEG2, blob);
+	fu_parade_usbhub_test_add_crc_events(device, 0x40000, 16, crc);
+	ret = fu_device_verify_crc(FU_DEVICE(device),
+				   FU_CRC_KIND_B32_MPEG2,
+				   0x40000,
+				   blob,
+				   progress,
+				   &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* ROM contents differ */
+	fu_parade_usbhub_test_add_crc_events(device, 0x40000, 16, crc ^ 0x1);
+	ret = fu_device_verify_crc(FU_DEVICE(device),
+				   FU_CRC_KIND_B32_MPEG2,
+				   0x40000,
+				   blob,
+				   progress,
+				   &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* the hub only does one kind of CRC */
+	ret = fu_device_verify_crc(FU_DEVICE(device),
+				   FU_CRC_KIND_B32_STANDARD,
+				   0x40000,
+				   blob,
+				   progress,
+				   &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_false(ret);
+}
+
+int
+main(int argc, char **argv)
+{
+	(void)g_setenv("G_TEST_SRCDIR", SRCDIR, FALSE);
+	g_test_init(&argc, &argv, NULL);
+
+	/* log everything */
+	(void)g_setenv("G_MESSAGES_DEBUG", "all", FALSE);
+	g_test_add_func("/parade-usbhub/device/verify-crc",
+			fu_parade_usbhub_device_verify_crc_func);
+	return g_test_run();
+}
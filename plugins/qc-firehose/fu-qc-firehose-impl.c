@@ -11,6 +11,9 @@
 #include "fu-qc-firehose-impl-common.h"
 #include "fu-qc-firehose-impl.h"
 
+/* the target advertises what it can accept, but never buffer more than this per transfer */
+#define FU_QC_FIREHOSE_IMPL_MAX_PAYLOAD_SIZE (16 * FU_MB)
+
 G_DEFINE_INTERFACE(FuQcFirehoseImpl, fu_qc_firehose_impl, G_TYPE_OBJECT)
 
 static void
@@ -58,6 +61,24 @@ fu_qc_firehose_impl_write(FuQcFirehoseImpl *self,
 	return (*iface->write)(self, buf, bufsz, timeout_ms, error);
 }
 
+static gboolean
+fu_qc_firehose_impl_write_payload(FuQcFirehoseImpl *self,
+				  const guint8 *buf,
+				  gsize bufsz,
+				  guint timeout_ms,
+				  GError **error)
+{
+	FuQcFirehoseImplInterface *iface;
+
+	g_return_val_if_fail(FU_IS_QC_FIREHOSE_IMPL(self), FALSE);
+
+	/* optional, the default packet-sized write works fine but is slower */
+	iface = FU_QC_FIREHOSE_IMPL_GET_IFACE(self);
+	if (iface->write_payload == NULL)
+		return fu_qc_firehose_impl_write(self, buf, bufsz, timeout_ms, error);
+	return (*iface->write_payload)(self, buf, bufsz, timeout_ms, error);
+}
+
 static gboolean
 fu_qc_firehose_impl_has_function(FuQcFirehoseImpl *self, FuQcFirehoseFunctions func)
 {
@@ -186,9 +207,10 @@ fu_qc_firehose_impl_read_xml_nop_cb(FuQcFirehoseImpl *self,
 
 typedef struct {
 	FuFirmware *firmware;
-	gboolean no_zlp;
+	FuQcFirehoseImplWriteFlags flags;
 	gboolean rawmode;
 	guint64 max_payload_size;
+	guint64 max_payload_size_supported;
 	FuQcFirehoseImplReadFunc read_func;
 } FuQcFirehoseImplHelper;
 
@@ -265,6 +287,22 @@ fu_qc_firehose_impl_read_xml_cb(FuQcFirehoseImpl *self,
 		}
 	}
 
+	/* the largest value the device would accept if asked */
+	tmp = xb_node_get_attr(xn_response, "MaxPayloadSizeToTargetInBytesSupported");
+	if (tmp != NULL) {
+		if (!fu_strtoull(tmp,
+				 &helper->max_payload_size_supported,
+				 0x0,
+				 G_MAXUINT64,
+				 FU_INTEGER_BASE_AUTO,
+				 error)) {
+			g_prefix_error_literal(
+			    error,
+			    "failed to parse MaxPayloadSizeToTargetInBytesSupported: ");
+			return FALSE;
+		}
+	}
+
 	/* device is giving us a better value */
 	if (g_strcmp0(xb_node_get_attr(xn_response, "value"), "NAK") == 0) {
 		tmp = xb_node_get_attr(xn_response, "MaxPayloadSizeToTargetInBytes");
@@ -376,6 +414,8 @@ fu_qc_firehose_impl_send_configure(FuQcFirehoseImpl *self,
 				   FuQcFirehoseImplHelper *helper,
 				   GError **error)
 {
+	const gchar *zlp_aware_host =
+	    (helper->flags & FU_QC_FIREHOSE_IMPL_WRITE_FLAG_NO_ZLP) > 0 ? "0" : "1";
 	g_autofree gchar *max_payload_size_str = NULL;
 	g_autoptr(XbBuilderNode) bn = xb_builder_node_new("data");
 	g_autoptr(GError) error_local = NULL;
@@ -392,7 +432,7 @@ fu_qc_firehose_impl_send_configure(FuQcFirehoseImpl *self,
 				    "Verbose",
 				    "0",
 				    "ZlpAwareHost",
-				    helper->no_zlp ? "0" : "1",
+				    zlp_aware_host,
 				    "AlwaysValidate",
 				    "0",
 				    "MaxDigestTableSizeInBytes",
@@ -442,6 +482,40 @@ fu_qc_firehose_impl_configure(FuQcFirehoseImpl *self,
 			return FALSE;
 	}
 
+	/* ask for the largest payload the device supports to reduce the number of transfers */
+	if ((helper->flags & FU_QC_FIREHOSE_IMPL_WRITE_FLAG_LARGE_PAYLOAD) > 0) {
+		guint64 max_payload_size_accepted = helper->max_payload_size;
+		guint64 max_payload_size = MIN(helper->max_payload_size_supported,
+					       FU_QC_FIREHOSE_IMPL_MAX_PAYLOAD_SIZE);
+		g_autoptr(GError) error_local = NULL;
+
+		if (max_payload_size <= max_payload_size_accepted)
+			return TRUE;
+		g_debug("increasing max payload size to 0x%x", (guint)max_payload_size);
+		helper->max_payload_size = max_payload_size;
+		if (!fu_qc_firehose_impl_send_configure(self,
+							storage,
+							FALSE,
+							helper,
+							&error_local)) {
+			if (!g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED)) {
+				g_propagate_error(error, g_steal_pointer(&error_local));
+				return FALSE;
+			}
+
+			/* the device advertised a size it would not accept */
+			g_debug("using max payload size 0x%x: %s",
+				(guint)max_payload_size_accepted,
+				error_local->message);
+			helper->max_payload_size = max_payload_size_accepted;
+			return fu_qc_firehose_impl_send_configure(self,
+								  storage,
+								  FALSE,
+								  helper,
+								  error);
+		}
+	}
+
 	/* success */
 	return TRUE;
 }
@@ -504,9 +578,16 @@ fu_qc_firehose_impl_erase(FuQcFirehoseImpl *self,
 static gboolean
 fu_qc_firehose_impl_write_blocks(FuQcFirehoseImpl *self,
 				 FuChunkArray *chunks,
+				 FuQcFirehoseImplHelper *helper,
 				 FuProgress *progress,
 				 GError **error)
 {
+	guint timeout_ms = 500;
+
+	/* send each payload as one transfer, allowing at least 1ms per KB */
+	if ((helper->flags & FU_QC_FIREHOSE_IMPL_WRITE_FLAG_LARGE_PAYLOAD) > 0)
+		timeout_ms = (guint)MAX(timeout_ms, helper->max_payload_size / FU_KB);
+
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
 	fu_progress_set_steps(progress, fu_chunk_array_length(chunks));
@@ -517,12 +598,21 @@ fu_qc_firehose_impl_write_blocks(FuQcFirehoseImpl *self,
 		chk = fu_chunk_array_index(chunks, i, error);
 		if (chk == NULL)
 			return FALSE;
-		if (!fu_qc_firehose_impl_write(self,
-					       fu_chunk_get_data(chk),
-					       fu_chunk_get_data_sz(chk),
-					       500,
-					       error))
-			return FALSE;
+		if ((helper->flags & FU_QC_FIREHOSE_IMPL_WRITE_FLAG_LARGE_PAYLOAD) > 0) {
+			if (!fu_qc_firehose_impl_write_payload(self,
+							       fu_chunk_get_data(chk),
+							       fu_chunk_get_data_sz(chk),
+							       timeout_ms,
+							       error))
+				return FALSE;
+		} else {
+			if (!fu_qc_firehose_impl_write(self,
+						       fu_chunk_get_data(chk),
+						       fu_chunk_get_data_sz(chk),
+						       timeout_ms,
+						       error))
+				return FALSE;
+		}
 
 		/* update progress */
 		fu_progress_step_done(progress);
@@ -655,7 +745,7 @@ fu_qc_firehose_impl_program(FuQcFirehoseImpl *self,
 	    fu_chunk_array_new_from_bytes(blob_padded, 0x0, 0x0, helper->max_payload_size, error);
 	if (chunks == NULL)
 		return FALSE;
-	if (!fu_qc_firehose_impl_write_blocks(self, chunks, progress, error))
+	if (!fu_qc_firehose_impl_write_blocks(self, chunks, helper, progress, error))
 		return FALSE;
 	if (!fu_qc_firehose_impl_read_xml(self, 30000, helper, error))
 		return FALSE;
@@ -914,7 +1004,7 @@ fu_qc_firehose_impl_setup(FuQcFirehoseImpl *self, GError **error)
 gboolean
 fu_qc_firehose_impl_write_firmware(FuQcFirehoseImpl *self,
 				   FuFirmware *firmware,
-				   gboolean no_zlp,
+				   FuQcFirehoseImplWriteFlags flags,
 				   FuProgress *progress,
 				   GError **error)
 {
@@ -927,7 +1017,7 @@ fu_qc_firehose_impl_write_firmware(FuQcFirehoseImpl *self,
 	g_autoptr(XbBuilderSource) source = xb_builder_source_new();
 	g_autoptr(XbSilo) silo = NULL;
 	FuQcFirehoseImplHelper helper = {
-	    .no_zlp = no_zlp,
+	    .flags = flags,
 	    .rawmode = FALSE,
 	    .max_payload_size = 1 * FU_MB,
 	    .firmware = firmware,
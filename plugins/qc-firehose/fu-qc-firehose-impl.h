@@ -10,6 +10,12 @@
 
 #include "fu-qc-firehose-struct.h"
 
+typedef enum {
+	FU_QC_FIREHOSE_IMPL_WRITE_FLAG_NONE = 0,
+	FU_QC_FIREHOSE_IMPL_WRITE_FLAG_NO_ZLP = 1 << 0,
+	FU_QC_FIREHOSE_IMPL_WRITE_FLAG_LARGE_PAYLOAD = 1 << 1,
+} FuQcFirehoseImplWriteFlags;
+
 #define FU_TYPE_QC_FIREHOSE_IMPL (fu_qc_firehose_impl_get_type())
 G_DECLARE_INTERFACE(FuQcFirehoseImpl, fu_qc_firehose_impl, FU, QC_FIREHOSE_IMPL, GObject)
 
@@ -23,6 +29,11 @@ struct _FuQcFirehoseImplInterface {
 			  gsize bufsz,
 			  guint timeout_ms,
 			  GError **error) G_GNUC_NON_NULL(1);
+	gboolean (*write_payload)(FuQcFirehoseImpl *self,
+				  const guint8 *buf,
+				  gsize bufsz,
+				  guint timeout_ms,
+				  GError **error) G_GNUC_NON_NULL(1);
 	gboolean (*has_function)(FuQcFirehoseImpl *self, FuQcFirehoseFunctions func)
 	    G_GNUC_NON_NULL(1);
 	void (*add_function)(FuQcFirehoseImpl *self, FuQcFirehoseFunctions func) G_GNUC_NON_NULL(1);
@@ -33,7 +44,7 @@ fu_qc_firehose_impl_setup(FuQcFirehoseImpl *self, GError **error) G_GNUC_NON_NUL
 gboolean
 fu_qc_firehose_impl_write_firmware(FuQcFirehoseImpl *self,
 				   FuFirmware *firmware,
-				   gboolean no_zlp,
+				   FuQcFirehoseImplWriteFlags flags,
 				   FuProgress *progress,
 				   GError **error) G_GNUC_NON_NULL(1, 2, 4);
 gboolean
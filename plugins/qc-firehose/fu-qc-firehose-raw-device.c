@@ -81,7 +81,7 @@ fu_qc_firehose_raw_device_impl_write_firmware(FuDevice *device,
 	}
 	return fu_qc_firehose_impl_write_firmware(FU_QC_FIREHOSE_IMPL(self),
 						  firmware,
-						  FALSE,
+						  FU_QC_FIREHOSE_IMPL_WRITE_FLAG_NONE,
 						  progress,
 						  error);
 }
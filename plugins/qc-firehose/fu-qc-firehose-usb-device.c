@@ -14,7 +14,8 @@
 #include "fu-qc-firehose-struct.h"
 #include "fu-qc-firehose-usb-device.h"
 
-#define FU_QC_FIREHOSE_USB_DEVICE_NO_ZLP "no-zlp"
+#define FU_QC_FIREHOSE_USB_DEVICE_NO_ZLP	"no-zlp"
+#define FU_QC_FIREHOSE_USB_DEVICE_LARGE_PAYLOAD "large-payload"
 
 #define FU_QC_FIREHOSE_USB_DEVICE_RAW_BUFFER_SIZE (4 * FU_KB)
 
@@ -92,15 +93,15 @@ fu_qc_firehose_usb_device_read(FuQcFirehoseUsbDevice *self, guint timeout_ms, GE
 }
 
 static gboolean
-fu_qc_firehose_usb_device_write(FuQcFirehoseUsbDevice *self,
-				const guint8 *buf,
-				gsize sz,
-				guint timeout_ms,
-				GError **error)
+fu_qc_firehose_usb_device_write_full(FuQcFirehoseUsbDevice *self,
+				     const guint8 *buf,
+				     gsize sz,
+				     gsize transfer_sz,
+				     guint timeout_ms,
+				     GError **error)
 {
 	gsize actual_len = 0;
 	g_autoptr(GPtrArray) chunks = NULL;
-	g_autoptr(GByteArray) bufmut = g_byte_array_sized_new(sz);
 
 	/* sanity check */
 	if (self->maxpktsize_out == 0) {
@@ -111,14 +112,8 @@ fu_qc_firehose_usb_device_write(FuQcFirehoseUsbDevice *self,
 		return FALSE;
 	}
 
-	/* copy const data to mutable GByteArray */
-	g_byte_array_append(bufmut, buf, sz);
-	chunks = fu_chunk_array_mutable_new(bufmut->data,
-					    bufmut->len,
-					    0,
-					    0,
-					    self->maxpktsize_out,
-					    error);
+	/* the data is sent without being copied into a mutable buffer first */
+	chunks = fu_chunk_array_new(buf, sz, 0, 0, transfer_sz, error);
 	if (chunks == NULL)
 		return FALSE;
 	if (chunks->len > 1)
@@ -130,14 +125,14 @@ fu_qc_firehose_usb_device_write(FuQcFirehoseUsbDevice *self,
 			    "tx packet",
 			    fu_chunk_get_data(chk),
 			    fu_chunk_get_data_sz(chk));
-		if (!fu_usb_device_bulk_transfer(FU_USB_DEVICE(self),
-						 self->ep_out,
-						 fu_chunk_get_data_out(chk),
-						 fu_chunk_get_data_sz(chk),
-						 &actual_len,
-						 timeout_ms,
-						 NULL,
-						 error)) {
+		if (!fu_usb_device_bulk_write(FU_USB_DEVICE(self),
+					      self->ep_out,
+					      fu_chunk_get_data(chk),
+					      fu_chunk_get_data_sz(chk),
+					      &actual_len,
+					      timeout_ms,
+					      NULL,
+					      error)) {
 			g_prefix_error_literal(error, "failed to do bulk transfer (write data): ");
 			return FALSE;
 		}
@@ -172,6 +167,21 @@ fu_qc_firehose_usb_device_write(FuQcFirehoseUsbDevice *self,
 	return TRUE;
 }
 
+static gboolean
+fu_qc_firehose_usb_device_write(FuQcFirehoseUsbDevice *self,
+				const guint8 *buf,
+				gsize sz,
+				guint timeout_ms,
+				GError **error)
+{
+	return fu_qc_firehose_usb_device_write_full(self,
+						    buf,
+						    sz,
+						    self->maxpktsize_out,
+						    timeout_ms,
+						    error);
+}
+
 static void
 fu_qc_firehose_usb_device_parse_eps(FuQcFirehoseUsbDevice *self, GPtrArray *endpoints)
 {
@@ -274,6 +284,7 @@ fu_qc_firehose_usb_device_impl_write_firmware(FuDevice *device,
 					      GError **error)
 {
 	FuQcFirehoseUsbDevice *self = FU_QC_FIREHOSE_USB_DEVICE(device);
+	FuQcFirehoseImplWriteFlags write_flags = FU_QC_FIREHOSE_IMPL_WRITE_FLAG_NONE;
 
 	/* progress */
 	fu_progress_set_id(progress, G_STRLOC);
@@ -291,12 +302,23 @@ fu_qc_firehose_usb_device_impl_write_firmware(FuDevice *device,
 	/* use firehose XML */
 	if (!fu_qc_firehose_impl_setup(FU_QC_FIREHOSE_IMPL(self), error))
 		return FALSE;
-	if (!fu_qc_firehose_impl_write_firmware(
-		FU_QC_FIREHOSE_IMPL(self),
-		firmware,
-		fu_device_has_private_flag(device, FU_QC_FIREHOSE_USB_DEVICE_NO_ZLP),
-		fu_progress_get_child(progress),
-		error))
+	if (fu_device_has_private_flag(device, FU_QC_FIREHOSE_USB_DEVICE_NO_ZLP))
+		write_flags |= FU_QC_FIREHOSE_IMPL_WRITE_FLAG_NO_ZLP;
+	if (fu_device_has_private_flag(device, FU_QC_FIREHOSE_USB_DEVICE_LARGE_PAYLOAD)) {
+		/* emulations recorded with older versions used packet-sized transfers */
+		if (fu_device_has_flag(device, FWUPD_DEVICE_FLAG_EMULATED) &&
+		    !fu_device_check_fwupd_version(device, "2.2.1")) {
+			g_debug("ignoring %s for old emulation",
+				FU_QC_FIREHOSE_USB_DEVICE_LARGE_PAYLOAD);
+		} else {
+			write_flags |= FU_QC_FIREHOSE_IMPL_WRITE_FLAG_LARGE_PAYLOAD;
+		}
+	}
+	if (!fu_qc_firehose_impl_write_firmware(FU_QC_FIREHOSE_IMPL(self),
+						firmware,
+						write_flags,
+						fu_progress_get_child(progress),
+						error))
 		return FALSE;
 	fu_progress_step_done(progress);
 
@@ -311,6 +333,8 @@ fu_qc_firehose_usb_device_replace(FuDevice *device, FuDevice *donor)
 		return;
 	if (fu_device_has_private_flag(donor, FU_QC_FIREHOSE_USB_DEVICE_NO_ZLP))
 		fu_device_add_private_flag(device, FU_QC_FIREHOSE_USB_DEVICE_NO_ZLP);
+	if (fu_device_has_private_flag(donor, FU_QC_FIREHOSE_USB_DEVICE_LARGE_PAYLOAD))
+		fu_device_add_private_flag(device, FU_QC_FIREHOSE_USB_DEVICE_LARGE_PAYLOAD);
 }
 
 static void
@@ -394,11 +418,25 @@ fu_qc_firehose_usb_device_impl_write(FuQcFirehoseImpl *impl,
 	return fu_qc_firehose_usb_device_write(self, buf, sz, timeout_ms, error);
 }
 
+static gboolean
+fu_qc_firehose_usb_device_impl_write_payload(FuQcFirehoseImpl *impl,
+					     const guint8 *buf,
+					     gsize sz,
+					     guint timeout_ms,
+					     GError **error)
+{
+	FuQcFirehoseUsbDevice *self = FU_QC_FIREHOSE_USB_DEVICE(impl);
+
+	/* submit the whole payload at once so the host controller can queue every packet */
+	return fu_qc_firehose_usb_device_write_full(self, buf, sz, sz, timeout_ms, error);
+}
+
 static void
 fu_qc_firehose_usb_device_impl_iface_init(FuQcFirehoseImplInterface *iface)
 {
 	iface->read = fu_qc_firehose_usb_device_impl_read;
 	iface->write = fu_qc_firehose_usb_device_impl_write;
+	iface->write_payload = fu_qc_firehose_usb_device_impl_write_payload;
 	iface->has_function = fu_qc_firehose_usb_device_impl_has_function;
 	iface->add_function = fu_qc_firehose_usb_device_impl_add_function;
 }
@@ -448,4 +486,5 @@ fu_qc_firehose_usb_device_class_init(FuQcFirehoseUsbDeviceClass *klass)
 	device_class->set_progress = fu_qc_firehose_usb_device_set_progress;
 	device_class->set_quirk_kv = fu_qc_firehose_usb_device_set_quirk_kv;
 	fu_device_register_private_flag(device_class, FU_QC_FIREHOSE_USB_DEVICE_NO_ZLP);
+	fu_device_register_private_flag(device_class, FU_QC_FIREHOSE_USB_DEVICE_LARGE_PAYLOAD);
 }
@@ -7,6 +7,7 @@
 #include "config.h"
 
 #include "fu-qc-firehose-impl-common.h"
+#include "fu-qc-firehose-impl.h"
 
 typedef struct {
 	guint cnt;
@@ -99,6 +100,225 @@ fu_qc_firehose_retry_invalid_func(void)
 	g_assert_cmpint(helper.cnt, ==, 1);
 }
 
+/* a firehose target that replies with scripted XML responses */
+#define FU_TYPE_QC_FIREHOSE_TEST_TARGET (fu_qc_firehose_test_target_get_type())
+G_DECLARE_FINAL_TYPE(FuQcFirehoseTestTarget,
+		     fu_qc_firehose_test_target,
+		     FU,
+		     QC_FIREHOSE_TEST_TARGET,
+		     GObject)
+
+struct _FuQcFirehoseTestTarget {
+	GObject parent_instance;
+	GPtrArray *responses;	 /* (element-type utf8) */
+	GPtrArray *requests;	 /* (element-type utf8) */
+	GArray *payload_sizes;	 /* (element-type gsize) */
+	guint responses_idx;
+};
+
+static void
+fu_qc_firehose_test_target_impl_iface_init(FuQcFirehoseImplInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(FuQcFirehoseTestTarget,
+			fu_qc_firehose_test_target,
+			G_TYPE_OBJECT,
+			G_IMPLEMENT_INTERFACE(FU_TYPE_QC_FIREHOSE_IMPL,
+					      fu_qc_firehose_test_target_impl_iface_init))
+
+static GByteArray *
+fu_qc_firehose_test_target_read(FuQcFirehoseImpl *impl, guint timeout_ms, GError **error)
+{
+	FuQcFirehoseTestTarget *self = FU_QC_FIREHOSE_TEST_TARGET(impl);
+	const gchar *xml;
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+
+	if (self->responses_idx >= self->responses->len) {
+		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND, "no response");
+		return NULL;
+	}
+	xml = g_ptr_array_index(self->responses, self->responses_idx++);
+	g_byte_array_append(buf, (const guint8 *)xml, strlen(xml));
+	return g_steal_pointer(&buf);
+}
+
+static gboolean
+fu_qc_firehose_test_target_write(FuQcFirehoseImpl *impl,
+				 const guint8 *buf,
+				 gsize bufsz,
+				 guint timeout_ms,
+				 GError **error)
+{
+	FuQcFirehoseTestTarget *self = FU_QC_FIREHOSE_TEST_TARGET(impl);
+
+	/* raw data is only sent using write_payload in these tests */
+	g_ptr_array_add(self->requests, g_strndup((const gchar *)buf, bufsz));
+	return TRUE;
+}
+
+static gboolean
+fu_qc_firehose_test_target_write_payload(FuQcFirehoseImpl *impl,
+					 const guint8 *buf,
+					 gsize bufsz,
+					 guint timeout_ms,
+					 GError **error)
+{
+	FuQcFirehoseTestTarget *self = FU_QC_FIREHOSE_TEST_TARGET(impl);
+	g_array_append_val(self->payload_sizes, bufsz);
+	return TRUE;
+}
+
+static gboolean
+fu_qc_firehose_test_target_has_function(FuQcFirehoseImpl *impl, FuQcFirehoseFunctions func)
+{
+	return (func & (FU_QC_FIREHOSE_FUNCTIONS_CONFIGURE | FU_QC_FIREHOSE_FUNCTIONS_PROGRAM)) > 0;
+}
+
+static void
+fu_qc_firehose_test_target_add_function(FuQcFirehoseImpl *impl, FuQcFirehoseFunctions func)
+{
+}
+
+static void
+fu_qc_firehose_test_target_impl_iface_init(FuQcFirehoseImplInterface *iface)
+{
+	iface->read = fu_qc_firehose_test_target_read;
+	iface->write = fu_qc_firehose_test_target_write;
+	iface->write_payload = fu_qc_firehose_test_target_write_payload;
+	iface->has_function = fu_qc_firehose_test_target_has_function;
+	iface->add_function = fu_qc_firehose_test_target_add_function;
+}
+
+static void
+fu_qc_firehose_test_target_init(FuQcFirehoseTestTarget *self)
+{
+	self->responses = g_ptr_array_new_with_free_func(g_free);
+	self->requests = g_ptr_array_new_with_free_func(g_free);
+	self->payload_sizes = g_array_new(FALSE, FALSE, sizeof(gsize));
+}
+
+static void
+fu_qc_firehose_test_target_finalize(GObject *object)
+{
+	FuQcFirehoseTestTarget *self = FU_QC_FIREHOSE_TEST_TARGET(object);
+	g_ptr_array_unref(self->responses);
+	g_ptr_array_unref(self->requests);
+	g_array_unref(self->payload_sizes);
+	G_OBJECT_CLASS(fu_qc_firehose_test_target_parent_class)->finalize(object);
+}
+
+static void
+fu_qc_firehose_test_target_class_init(FuQcFirehoseTestTargetClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_qc_firehose_test_target_finalize;
+}
+
+static void
+fu_qc_firehose_test_target_add_response(FuQcFirehoseTestTarget *self, const gchar *attrs)
+{
+	g_ptr_array_add(
+	    self->responses,
+	    g_strdup_printf("<?xml version=\"1.0\" ?><data><response %s /></data>", attrs));
+}
+
+/* one 1.5MB image, written as 3072 sectors of 512 bytes */
+static FuFirmware *
+fu_qc_firehose_test_firmware_new(void)
+{
+	gboolean ret;
+	const gchar *xml = "<?xml version=\"1.0\" ?><data><program SECTOR_SIZE_IN_BYTES=\"512\" "
+			   "filename=\"test.bin\" num_partition_sectors=\"3072\" "
+			   "physical_partition_number=\"0\" start_sector=\"0\" /></data>";
+	g_autofree guint8 *buf = g_malloc0(0x180000);
+	g_autoptr(FuFirmware) firmware = fu_firmware_new();
+	g_autoptr(FuFirmware) img_bin = NULL;
+	g_autoptr(FuFirmware) img_xml = NULL;
+	g_autoptr(GBytes) blob_bin = g_bytes_new_take(g_steal_pointer(&buf), 0x180000);
+	g_autoptr(GBytes) blob_xml = g_bytes_new_static(xml, strlen(xml));
+	g_autoptr(GError) error = NULL;
+
+	img_xml = fu_firmware_new_from_bytes(blob_xml);
+	fu_firmware_set_id(img_xml, "firehose-rawprogram.xml");
+	ret = fu_firmware_add_image(firmware, img_xml, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	img_bin = fu_firmware_new_from_bytes(blob_bin);
+	fu_firmware_set_id(img_bin, "test.bin");
+	ret = fu_firmware_add_image(firmware, img_bin, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	return g_steal_pointer(&firmware);
+}
+
+static void
+fu_qc_firehose_large_payload_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuFirmware) firmware = fu_qc_firehose_test_firmware_new();
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(FuQcFirehoseTestTarget) target = NULL;
+	g_autoptr(GError) error = NULL;
+
+	target = g_object_new(FU_TYPE_QC_FIREHOSE_TEST_TARGET, NULL);
+	fu_qc_firehose_test_target_add_response(
+	    target,
+	    "value=\"ACK\" MaxPayloadSizeToTargetInBytesSupported=\"4194304\"");
+	fu_qc_firehose_test_target_add_response(target, "value=\"ACK\"");
+	fu_qc_firehose_test_target_add_response(target, "value=\"ACK\" rawmode=\"true\"");
+	fu_qc_firehose_test_target_add_response(target, "value=\"ACK\" rawmode=\"false\"");
+	ret = fu_qc_firehose_impl_write_firmware(FU_QC_FIREHOSE_IMPL(target),
+						 firmware,
+						 FU_QC_FIREHOSE_IMPL_WRITE_FLAG_LARGE_PAYLOAD,
+						 progress,
+						 &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* asked for the larger size, and then sent the image in one transfer */
+	g_assert_cmpint(target->requests->len, ==, 3);
+	g_assert_nonnull(strstr(g_ptr_array_index(target->requests, 1),
+				"MaxPayloadSizeToTargetInBytes=\"4194304\""));
+	g_assert_cmpint(target->payload_sizes->len, ==, 1);
+	g_assert_cmpint(g_array_index(target->payload_sizes, gsize, 0), ==, 0x180000);
+}
+
+static void
+fu_qc_firehose_large_payload_nak_func(void)
+{
+	gboolean ret;
+	g_autoptr(FuFirmware) firmware = fu_qc_firehose_test_firmware_new();
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(FuQcFirehoseTestTarget) target = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* the target advertises a size that it then refuses */
+	target = g_object_new(FU_TYPE_QC_FIREHOSE_TEST_TARGET, NULL);
+	fu_qc_firehose_test_target_add_response(
+	    target,
+	    "value=\"ACK\" MaxPayloadSizeToTargetInBytesSupported=\"4194304\"");
+	fu_qc_firehose_test_target_add_response(target, "value=\"NAK\"");
+	fu_qc_firehose_test_target_add_response(target, "value=\"ACK\"");
+	fu_qc_firehose_test_target_add_response(target, "value=\"ACK\" rawmode=\"true\"");
+	fu_qc_firehose_test_target_add_response(target, "value=\"ACK\" rawmode=\"false\"");
+	ret = fu_qc_firehose_impl_write_firmware(FU_QC_FIREHOSE_IMPL(target),
+						 firmware,
+						 FU_QC_FIREHOSE_IMPL_WRITE_FLAG_LARGE_PAYLOAD,
+						 progress,
+						 &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* fell back to the accepted 1MB size */
+	g_assert_cmpint(target->requests->len, ==, 4);
+	g_assert_nonnull(strstr(g_ptr_array_index(target->requests, 1),
+				"MaxPayloadSizeToTargetInBytes=\"4194304\""));
+	g_assert_nonnull(strstr(g_ptr_array_index(target->requests, 2),
+				"MaxPayloadSizeToTargetInBytes=\"1048576\""));
+	g_assert_cmpint(target->payload_sizes->len, ==, 2);
+	g_assert_cmpint(g_array_index(target->payload_sizes, gsize, 0), ==, 0x100000);
+	g_assert_cmpint(g_array_index(target->payload_sizes, gsize, 1), ==, 0x80000);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -108,5 +328,7 @@ main(int argc, char **argv)
 	g_test_add_func("/qc-firehose/retry/done", fu_qc_firehose_retry_done_func);
 	g_test_add_func("/qc-firehose/retry/timeout", fu_qc_firehose_retry_timeout_func);
 	g_test_add_func("/qc-firehose/retry/invalid", fu_qc_firehose_retry_invalid_func);
+	g_test_add_func("/qc-firehose/large-payload", fu_qc_firehose_large_payload_func);
+	g_test_add_func("/qc-firehose/large-payload/nak", fu_qc_firehose_large_payload_nak_func);
 	return g_test_run();
 }
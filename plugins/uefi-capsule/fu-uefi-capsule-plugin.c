@@ -1168,38 +1168,33 @@ fu_uefi_capsule_plugin_coldplug(FuPlugin *plugin, FuProgress *progress, GError *
 static gboolean
 fu_uefi_capsule_plugin_cleanup_esp(FuUefiCapsulePlugin *self, GError **error)
 {
-	g_autofree gchar *esp_path = NULL;
-	g_autofree gchar *pattern = NULL;
 	g_autoptr(FuVolumeLocker) esp_locker = NULL;
 	g_autoptr(GPtrArray) files = NULL;
+	g_autoptr(GError) error_local = NULL;
 
 	if (self->esp == NULL)
 		return TRUE;
 
-	/* delete any files matching the glob in the ESP */
+	/* delete any capsules left in the OS directories of the ESP */
 	esp_locker = fu_volume_locker_new(self->esp, error);
 	if (esp_locker == NULL)
 		return FALSE;
-	esp_path = fu_volume_get_mount_point(self->esp);
-	if (esp_path == NULL) {
-		g_set_error_literal(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOT_SUPPORTED,
-				    "no mountpoint for ESP");
+	files = fu_volume_glob(self->esp,
+			       "EFI/*/fw/fwupd*.cap",
+			       FU_PATH_GLOB_FLAG_CASE_INSENSITIVE,
+			       &error_local);
+	if (files == NULL) {
+		if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND))
+			return TRUE;
+		g_propagate_error(error, g_steal_pointer(&error_local));
 		return FALSE;
 	}
-	files = fu_path_get_files(esp_path, error);
-	if (files == NULL)
-		return FALSE;
-	pattern = g_build_filename("*", "fw", "fwupd*.cap", NULL);
 	for (guint i = 0; i < files->len; i++) {
 		const gchar *fn = g_ptr_array_index(files, i);
-		if (g_pattern_match_simple(pattern, fn)) {
-			g_autoptr(GFile) file = g_file_new_for_path(fn);
-			g_debug("deleting %s", fn);
-			if (!g_file_delete(file, NULL, error))
-				return FALSE;
-		}
+		g_autoptr(GFile) file = g_file_new_for_path(fn);
+		g_debug("deleting %s", fn);
+		if (!g_file_delete(file, NULL, error))
+			return FALSE;
 	}
 
 	/* success */
@@ -28,6 +28,9 @@ G_DEFINE_TYPE(FuVliPdParadeDevice, fu_vli_pd_parade_device, FU_TYPE_USB_DEVICE)
 #define FU_VLI_PD_PARADE_I2C_CMD_WRITE 0xa6
 #define FU_VLI_PD_PARADE_I2C_CMD_READ  0xa5
 
+#define FU_VLI_PD_PARADE_BLOCK_SIZE 0x10000
+#define FU_VLI_PD_PARADE_READ_SIZE  0x20
+
 static void
 fu_vli_pd_parade_device_to_string(FuDevice *device, guint idt, GString *str)
 {
@@ -462,6 +465,53 @@ fu_vli_pd_parade_device_block_read(FuVliPdParadeDevice *self,
 	return TRUE;
 }
 
+static gboolean
+fu_vli_pd_parade_device_read_data(FuDevice *device,
+				  guint32 address,
+				  guint8 *buf,
+				  gsize bufsz,
+				  GError **error)
+{
+	FuVliPdParadeDevice *self = FU_VLI_PD_PARADE_DEVICE(device);
+
+	/* sanity check */
+	if (address % FU_VLI_PD_PARADE_READ_SIZE != 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "address 0x%x is not aligned",
+			    address);
+		return FALSE;
+	}
+	for (gsize i = 0; i < bufsz; i += FU_VLI_PD_PARADE_READ_SIZE) {
+		guint32 addr = address + i;
+		guint8 tmp[FU_VLI_PD_PARADE_READ_SIZE] = {0};
+
+		/* the offset selects the 256 byte page */
+		if (i == 0 || (addr & 0xFF) == 0) {
+			if (!fu_vli_pd_parade_device_set_offset(self, addr >> 8, error))
+				return FALSE;
+		}
+		if (!fu_vli_pd_parade_device_i2c_read(self,
+						      self->page7,
+						      addr & 0xFF,
+						      tmp,
+						      sizeof(tmp),
+						      error))
+			return FALSE;
+		if (!fu_memcpy_safe(buf,
+				    bufsz,
+				    i,
+				    tmp,
+				    sizeof(tmp),
+				    0x0,
+				    MIN(sizeof(tmp), bufsz - i),
+				    error))
+			return FALSE;
+	}
+	return TRUE;
+}
+
 static gboolean
 fu_vli_pd_parade_device_write_firmware(FuDevice *device,
 				       FuFirmware *firmware,
@@ -472,10 +522,7 @@ fu_vli_pd_parade_device_write_firmware(FuDevice *device,
 	FuVliPdParadeDevice *self = FU_VLI_PD_PARADE_DEVICE(device);
 	guint8 buf[0x20] = {0};
 	guint block_idx_tmp;
-	g_autoptr(GByteArray) buf_verify = NULL;
 	g_autoptr(GBytes) fw = NULL;
-	g_autoptr(GBytes) fw_verify = NULL;
-	g_autoptr(FuChunk) chk0 = NULL;
 	g_autoptr(FuChunkArray) blocks = NULL;
 
 	/* progress */
@@ -505,7 +552,7 @@ fu_vli_pd_parade_device_write_firmware(FuDevice *device,
 	blocks = fu_chunk_array_new_from_bytes(fw,
 					       FU_CHUNK_ADDR_OFFSET_NONE,
 					       FU_CHUNK_PAGESZ_NONE,
-					       0x10000,
+					       FU_VLI_PD_PARADE_BLOCK_SIZE,
 					       error);
 	if (blocks == NULL)
 		return FALSE;
@@ -548,36 +595,23 @@ fu_vli_pd_parade_device_write_firmware(FuDevice *device,
 		return FALSE;
 	fu_progress_step_done(progress);
 
-	/* add the new boot config into the verify buffer */
-	buf_verify = g_byte_array_sized_new(g_bytes_get_size(fw));
-	chk0 = fu_chunk_array_index(blocks, 0, error);
-	if (chk0 == NULL)
-		return FALSE;
-	g_byte_array_append(buf_verify, fu_chunk_get_data(chk0), fu_chunk_get_data_sz(chk0));
-
-	/*  verify SPI ROM, ignoring the boot config */
-	for (guint i = 1; i < fu_chunk_array_length(blocks); i++) {
-		g_autofree guint8 *vbuf = NULL;
-		g_autoptr(FuChunk) chk = NULL;
-
-		chk = fu_chunk_array_index(blocks, i, error);
-		if (chk == NULL)
+	/* verify SPI ROM, ignoring the boot config */
+	if (g_bytes_get_size(fw) > FU_VLI_PD_PARADE_BLOCK_SIZE) {
+		g_autoptr(GBytes) fw_verify = NULL;
+		fw_verify = fu_bytes_new_offset(fw,
+						FU_VLI_PD_PARADE_BLOCK_SIZE,
+						g_bytes_get_size(fw) - FU_VLI_PD_PARADE_BLOCK_SIZE,
+						error);
+		if (fw_verify == NULL)
 			return FALSE;
-		vbuf = g_malloc0(fu_chunk_get_data_sz(chk));
-		if (!fu_vli_pd_parade_device_block_read(self,
-							fu_chunk_get_idx(chk),
-							vbuf,
-							fu_chunk_get_data_sz(chk),
-							error))
+		if (!fu_device_verify_crc(device,
+					  FU_CRC_KIND_B32_STANDARD,
+					  FU_VLI_PD_PARADE_BLOCK_SIZE,
+					  fw_verify,
+					  fu_progress_get_child(progress),
+					  error))
 			return FALSE;
-		g_byte_array_append(buf_verify, vbuf, fu_chunk_get_data_sz(chk));
-		fu_progress_set_percentage_full(fu_progress_get_child(progress),
-						i + 1,
-						fu_chunk_array_length(blocks));
 	}
-	fw_verify = g_bytes_new(buf_verify->data, buf_verify->len);
-	if (!fu_bytes_compare(fw, fw_verify, error))
-		return FALSE;
 	fu_progress_step_done(progress);
 
 	/*  save boot config into Block_0 */
@@ -661,7 +695,12 @@ fu_vli_pd_parade_device_dump_firmware(FuDevice *device, FuProgress *progress, GE
 	/* read */
 	fu_progress_set_status(progress, FWUPD_STATUS_DEVICE_VERIFY);
 	fu_byte_array_set_size(fw, fu_device_get_firmware_size_max(device), 0x00);
-	blocks = fu_chunk_array_mutable_new(fw->data, fw->len, 0x0, 0x0, 0x10000, error);
+	blocks = fu_chunk_array_mutable_new(fw->data,
+					    fw->len,
+					    0x0,
+					    0x0,
+					    FU_VLI_PD_PARADE_BLOCK_SIZE,
+					    error);
 	if (blocks == NULL)
 		return FALSE;
 	fu_progress_set_id(progress, G_STRLOC);
@@ -732,6 +771,7 @@ fu_vli_pd_parade_device_class_init(FuVliPdParadeDeviceClass *klass)
 	device_class->to_string = fu_vli_pd_parade_device_to_string;
 	device_class->probe = fu_vli_pd_parade_device_probe;
 	device_class->dump_firmware = fu_vli_pd_parade_device_dump_firmware;
+	device_class->read_data = fu_vli_pd_parade_device_read_data;
 	device_class->write_firmware = fu_vli_pd_parade_device_write_firmware;
 	device_class->set_progress = fu_vli_pd_parade_device_set_progress;
 }
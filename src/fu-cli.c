@@ -3690,6 +3690,104 @@ fu_cli_maybe_send_reports(FuCli *self, FwupdRelease *rel, GError **error)
 	return TRUE;
 }
 
+static gboolean
+fu_cli_prefetch(FuCli *self, gchar **values, GError **error)
+{
+	FuCliPrivate *priv = GET_PRIVATE(self);
+	g_autofree gchar *cachedir = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GPtrArray) releases = g_ptr_array_new_with_free_func(g_object_unref);
+
+	/* the download cache is only used when installing using the daemon */
+	if (!fu_cli_has_arg_flag(self, FU_CLI_ARG_FLAG_USES_DAEMON)) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "prefetch is only supported when using the daemon");
+		return FALSE;
+	}
+	cachedir = fwupd_client_get_download_cache_dir(priv->client);
+	if (cachedir == NULL) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_ARGS,
+				    /* TRANSLATORS: the user didn't read the man page */
+				    _("A directory must be specified using --download-cache"));
+		return FALSE;
+	}
+
+	/* are the remotes very old */
+	if (!fu_cli_perhaps_refresh_remotes(self, error))
+		return FALSE;
+
+	/* handle both forms */
+	if (g_strv_length(values) == 0) {
+		devices = fwupd_client_get_devices(priv->client, priv->cancellable, error);
+		if (devices == NULL)
+			return FALSE;
+	} else {
+		devices = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+		for (guint idx = 0; idx < g_strv_length(values); idx++) {
+			FwupdDevice *device = fu_cli_get_device_by_id(self, values[idx], error);
+			if (device == NULL)
+				return FALSE;
+			g_ptr_array_add(devices, device);
+		}
+	}
+
+	/* the release that would be chosen by the update command */
+	for (guint i = 0; i < devices->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index(devices, i);
+		g_autoptr(GPtrArray) rels = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		if (!fwupd_device_has_flag(dev, FWUPD_DEVICE_FLAG_UPDATABLE) &&
+		    !fwupd_device_has_flag(dev, FWUPD_DEVICE_FLAG_UPDATABLE_HIDDEN))
+			continue;
+		if (!fwupd_device_has_flag(dev, FWUPD_DEVICE_FLAG_SUPPORTED))
+			continue;
+		if (!fu_cli_device_match_flags(self, dev))
+			continue;
+		if (!fu_cli_device_match_protocol(self, dev))
+			continue;
+		rels = fwupd_client_get_upgrades(priv->client,
+						 fwupd_device_get_id(dev),
+						 priv->cancellable,
+						 &error_local);
+		if (rels == NULL) {
+			g_debug("%s", error_local->message);
+			continue;
+		}
+		for (guint j = 0; j < rels->len; j++) {
+			FwupdRelease *rel = g_ptr_array_index(rels, j);
+			if (!fu_cli_release_match_flags(self, rel))
+				continue;
+			g_ptr_array_add(releases, g_object_ref(rel));
+			break;
+		}
+	}
+	if (releases->len == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOTHING_TO_DO,
+				    /* TRANSLATORS: this is an error string */
+				    _("No updates available"));
+		return FALSE;
+	}
+
+	/* download them all at the same time */
+	if (!fwupd_client_prefetch_releases(priv->client,
+					    releases,
+					    priv->download_flags,
+					    priv->cancellable,
+					    error))
+		return FALSE;
+
+	/* TRANSLATORS: the firmware has been saved so it can be installed without a network */
+	fu_console_print_literal(priv->console, _("Successfully downloaded firmware updates"));
+	return TRUE;
+}
+
 static gboolean
 fu_cli_update(FuCli *self, gchar **values, GError **error)
 {
@@ -5248,6 +5346,7 @@ typedef struct {
 	gboolean only_p2p;
 	gboolean version;
 	gint download_retries;
+	gchar *download_cache;
 	gchar *filter_device;
 	gchar *filter_release;
 	gchar **filter_protocols;
@@ -5257,6 +5356,7 @@ static void
 fu_cli_group_helper_free(FuCliGroupHelper *helper)
 {
 	g_object_unref(helper->self);
+	g_free(helper->download_cache);
 	g_free(helper->filter_device);
 	g_free(helper->filter_release);
 	g_strfreev(helper->filter_protocols);
@@ -5473,6 +5573,14 @@ fu_cli_group_pre_parse_cb(GOptionContext *context,
 	     /* TRANSLATORS: command line option */
 	     N_("Set the download retries for transient errors"),
 	     NULL},
+	    {"download-cache",
+	     '\0',
+	     G_OPTION_FLAG_IN_MAIN,
+	     G_OPTION_ARG_FILENAME,
+	     &helper->download_cache,
+	     /* TRANSLATORS: command line option */
+	     N_("Keep downloaded firmware in a directory, which may be shared by all users"),
+	     NULL},
 	    {"p2p",
 	     '\0',
 	     G_OPTION_FLAG_IN_MAIN,
@@ -5727,6 +5835,8 @@ fu_cli_group_post_parse_cb(GOptionContext *context,
 		fu_cli_add_arg_flag(self, FU_CLI_ARG_FLAG_VERSION);
 	if (helper->download_retries > 0)
 		fwupd_client_download_set_retries(priv->client, helper->download_retries);
+	if (helper->download_cache != NULL)
+		fwupd_client_set_download_cache_dir(priv->client, helper->download_cache);
 
 	/* parse filter flags */
 	if (helper->filter_device != NULL) {
@@ -6957,6 +7067,14 @@ fu_cli_cmd_array_add_common(FuCli *self)
 			     _("Updates all specified devices to latest firmware version, or all "
 			       "devices if unspecified"),
 			     fu_cli_update);
+	fu_cli_cmd_array_add(self,
+			     "prefetch",
+			     /* TRANSLATORS: command argument: uppercase, spaces->dashes */
+			     _("[DEVICE-ID|GUID]"),
+			     /* TRANSLATORS: command description */
+			     _("Downloads the latest firmware for all specified devices, or all "
+			       "devices if unspecified, so that it can be installed later"),
+			     fu_cli_prefetch);
 	fu_cli_cmd_array_add(self,
 			     "verify",
 			     /* TRANSLATORS: command argument: uppercase, spaces->dashes */
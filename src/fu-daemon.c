@@ -17,6 +17,7 @@
 
 #include "fu-context-private.h"
 #include "fu-daemon.h"
+#include "fu-progress-private.h"
 
 typedef struct {
 	FuEngine *engine;
@@ -256,6 +257,30 @@ fu_daemon_check_syscall_filtering(GError **error)
 	return TRUE;
 }
 
+gboolean
+fu_daemon_get_trace_enabled(FuDaemon *self)
+{
+	FuContext *ctx = fu_engine_get_context(fu_daemon_get_engine(self));
+	g_autofree gchar *filename = fu_context_get_config_str(ctx, "TraceFile");
+	return g_log_get_debug_enabled() || (filename != NULL && filename[0] != '\0');
+}
+
+void
+fu_daemon_export_trace(FuDaemon *self, FuProgress *progress)
+{
+	FuContext *ctx = fu_engine_get_context(fu_daemon_get_engine(self));
+	g_autofree gchar *filename = fu_context_get_config_str(ctx, "TraceFile");
+	g_autoptr(GError) error_local = NULL;
+
+	if (filename == NULL || filename[0] == '\0' || !fu_progress_get_profile(progress))
+		return;
+	if (!fu_progress_export_trace(progress, filename, &error_local)) {
+		g_warning("failed to export trace: %s", error_local->message);
+		return;
+	}
+	g_debug("exported trace to %s", filename);
+}
+
 gboolean
 fu_daemon_setup(FuDaemon *self, const gchar *socket_address, GError **error)
 {
@@ -295,6 +320,7 @@ fu_daemon_setup(FuDaemon *self, const gchar *socket_address, GError **error)
 		if (str != NULL)
 			g_print("\n%s\n", str);
 	}
+	fu_daemon_export_trace(self, progress);
 
 	/* success */
 	return TRUE;
@@ -52,5 +52,9 @@ gdouble
 fu_daemon_get_percentage(FuDaemon *self) G_GNUC_NON_NULL(1);
 void
 fu_daemon_set_percentage(FuDaemon *self, gdouble percentage) G_GNUC_NON_NULL(1);
+gboolean
+fu_daemon_get_trace_enabled(FuDaemon *self) G_GNUC_NON_NULL(1);
+void
+fu_daemon_export_trace(FuDaemon *self, FuProgress *progress) G_GNUC_NON_NULL(1, 2);
 
 G_END_DECLS
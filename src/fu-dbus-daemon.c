@@ -42,6 +42,7 @@ struct _FuDbusDaemon {
 	FuPolkitAuthority *authority;
 	guint owner_id;
 	GPtrArray *system_inhibits;
+	guint64 device_generation; /* incremented for each device signal */
 };
 
 G_DEFINE_TYPE(FuDbusDaemon, fu_dbus_daemon, FU_TYPE_DAEMON)
@@ -66,63 +67,6 @@ fu_dbus_daemon_engine_changed_cb(FuEngine *engine, FuDbusDaemon *self)
 	fu_daemon_schedule_housekeeping(FU_DAEMON(self));
 }
 
-static void
-fu_dbus_daemon_engine_device_added_cb(FuEngine *engine, FuDevice *device, FuDbusDaemon *self)
-{
-	GVariant *val;
-
-	/* not yet connected */
-	if (self->connection == NULL)
-		return;
-	val = fwupd_codec_to_variant(FWUPD_CODEC(device), FWUPD_CODEC_FLAG_NONE);
-	g_dbus_connection_emit_signal(self->connection,
-				      NULL,
-				      FWUPD_DBUS_PATH,
-				      FWUPD_DBUS_INTERFACE,
-				      "DeviceAdded",
-				      g_variant_new_tuple(&val, 1),
-				      NULL);
-	fu_daemon_schedule_housekeeping(FU_DAEMON(self));
-}
-
-static void
-fu_dbus_daemon_engine_device_removed_cb(FuEngine *engine, FuDevice *device, FuDbusDaemon *self)
-{
-	GVariant *val;
-
-	/* not yet connected */
-	if (self->connection == NULL)
-		return;
-	val = fwupd_codec_to_variant(FWUPD_CODEC(device), FWUPD_CODEC_FLAG_NONE);
-	g_dbus_connection_emit_signal(self->connection,
-				      NULL,
-				      FWUPD_DBUS_PATH,
-				      FWUPD_DBUS_INTERFACE,
-				      "DeviceRemoved",
-				      g_variant_new_tuple(&val, 1),
-				      NULL);
-	fu_daemon_schedule_housekeeping(FU_DAEMON(self));
-}
-
-static void
-fu_dbus_daemon_engine_device_changed_cb(FuEngine *engine, FuDevice *device, FuDbusDaemon *self)
-{
-	GVariant *val;
-
-	/* not yet connected */
-	if (self->connection == NULL)
-		return;
-	val = fwupd_codec_to_variant(FWUPD_CODEC(device), FWUPD_CODEC_FLAG_NONE);
-	g_dbus_connection_emit_signal(self->connection,
-				      NULL,
-				      FWUPD_DBUS_PATH,
-				      FWUPD_DBUS_INTERFACE,
-				      "DeviceChanged",
-				      g_variant_new_tuple(&val, 1),
-				      NULL);
-	fu_daemon_schedule_housekeeping(FU_DAEMON(self));
-}
-
 static void
 fu_dbus_daemon_engine_device_request_cb(FuEngine *engine, FwupdRequest *request, FuDbusDaemon *self)
 {
@@ -171,6 +115,46 @@ fu_dbus_daemon_emit_property_changed(FuDbusDaemon *self,
 	g_variant_builder_clear(&invalidated_builder);
 }
 
+/* clients mirroring the device list read this on demand to detect missed signals */
+static void
+fu_dbus_daemon_emit_device_signal(FuDbusDaemon *self, const gchar *signal_name, FuDevice *device)
+{
+	GVariant *val;
+
+	self->device_generation++;
+
+	/* not yet connected */
+	if (self->connection == NULL)
+		return;
+	val = fwupd_codec_to_variant(FWUPD_CODEC(device), FWUPD_CODEC_FLAG_NONE);
+	g_dbus_connection_emit_signal(self->connection,
+				      NULL,
+				      FWUPD_DBUS_PATH,
+				      FWUPD_DBUS_INTERFACE,
+				      signal_name,
+				      g_variant_new_tuple(&val, 1),
+				      NULL);
+	fu_daemon_schedule_housekeeping(FU_DAEMON(self));
+}
+
+static void
+fu_dbus_daemon_engine_device_added_cb(FuEngine *engine, FuDevice *device, FuDbusDaemon *self)
+{
+	fu_dbus_daemon_emit_device_signal(self, "DeviceAdded", device);
+}
+
+static void
+fu_dbus_daemon_engine_device_removed_cb(FuEngine *engine, FuDevice *device, FuDbusDaemon *self)
+{
+	fu_dbus_daemon_emit_device_signal(self, "DeviceRemoved", device);
+}
+
+static void
+fu_dbus_daemon_engine_device_changed_cb(FuEngine *engine, FuDevice *device, FuDbusDaemon *self)
+{
+	fu_dbus_daemon_emit_device_signal(self, "DeviceChanged", device);
+}
+
 static void
 fu_dbus_daemon_engine_status_changed_cb(FuEngine *engine, FwupdStatus status, FuDbusDaemon *self)
 {
@@ -720,7 +704,7 @@ fu_dbus_daemon_authorize_install_queue(FuMainAuthHelper *helper_ref)
 	}
 
 	/* all authenticated, so install all the things */
-	fu_progress_set_profile(helper->progress, g_log_get_debug_enabled());
+	fu_progress_set_profile(helper->progress, fu_daemon_get_trace_enabled(FU_DAEMON(self)));
 	g_signal_connect(FU_PROGRESS(helper->progress),
 			 "percentage-changed",
 			 G_CALLBACK(fu_dbus_daemon_progress_percentage_changed_cb),
@@ -739,6 +723,7 @@ fu_dbus_daemon_authorize_install_queue(FuMainAuthHelper *helper_ref)
 					 helper->flags,
 					 &error);
 	fu_daemon_set_update_in_progress(FU_DAEMON(self), FALSE);
+	fu_daemon_export_trace(FU_DAEMON(self), helper->progress);
 	if (fu_daemon_get_pending_stop(FU_DAEMON(self))) {
 		g_set_error_literal(&error, /* nocheck:error-false-return */
 				    FWUPD_ERROR,
@@ -866,7 +851,16 @@ fu_dbus_daemon_invocation_get_input_stream(GDBusMethodInvocation *invocation, GE
 			return NULL;
 		stream_safe = fu_memory_input_stream_new_from_bytes(blob);
 	} else {
-		stream_safe = g_object_ref(stream);
+		gint fd_sealed =
+		    fu_unix_seekable_input_stream_get_fd(FU_UNIX_SEEKABLE_INPUT_STREAM(stream));
+		g_autoptr(GError) error_mmap = NULL;
+
+		/* the seals mean the contents cannot change, so map rather than read */
+		stream_safe = fu_memory_input_stream_new_from_fd(fd_sealed, &error_mmap);
+		if (stream_safe == NULL) {
+			g_debug("cannot map sealed fd, using read: %s", error_mmap->message);
+			stream_safe = g_object_ref(stream);
+		}
 	}
 
 	/* success */
@@ -2718,6 +2712,9 @@ fu_dbus_daemon_get_property(GDBusConnection *connection_,
 	if (g_strcmp0(property_name, "Hwids") == 0)
 		return fu_dbus_daemon_get_property_hwids(self);
 
+	if (g_strcmp0(property_name, "DeviceGeneration") == 0)
+		return g_variant_new_uint64(self->device_generation);
+
 	/* return an error */
 	g_set_error(error, /* nocheck:error */
 		    G_DBUS_ERROR,
@@ -39,6 +39,7 @@
 #include "fu-history.h"
 #include "fu-jcat-context.h"
 #include "fu-plugin-private.h"
+#include "fu-progress-private.h"
 #include "fu-security-attrs-private.h"
 #include "fu-smbios-private.h"
 
@@ -200,6 +201,34 @@ fu_engine_cli_maybe_prefix_sandbox_error(const gchar *value, GError **error) /*
 	}
 }
 
+static FuInputStream *
+fu_engine_cli_input_stream_from_path(const gchar *filename, GError **error)
+{
+#ifdef HAVE_GETUID
+	GStatBuf st = {0};
+	g_autofd gint fd = -1;
+
+	/* firmware can be hundreds of MB, so avoid copying what is already in the page cache --
+	 * but only if no other user can truncate the file, which would crash us with SIGBUS */
+	fd = g_open(filename, O_RDONLY, 0);
+	if (fd >= 0 && fstat(fd, &st) == 0 && st.st_uid == 0 &&
+	    (st.st_mode & (S_IWGRP | S_IWOTH)) == 0) {
+		g_autoptr(FuInputStream) stream = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		stream = fu_memory_input_stream_new_from_fd(fd, &error_local);
+		if (stream != NULL)
+			return g_steal_pointer(&stream);
+		g_debug("cannot map %s, falling back to reading: %s",
+			filename,
+			error_local->message);
+	} else {
+		g_debug("not mapping %s as it could be modified", filename);
+	}
+#endif
+	return fu_input_stream_from_path(filename, error);
+}
+
 static gboolean
 fu_engine_cli_smbios_dump(FuCli *cli, gchar **values, GError **error)
 {
@@ -504,7 +533,7 @@ fu_engine_cli_install_blob(FuCli *cli, gchar **values, GError **error)
 	}
 
 	/* parse blob */
-	stream_fw = fu_input_stream_from_path(values[0], error);
+	stream_fw = fu_engine_cli_input_stream_from_path(values[0], error);
 	if (stream_fw == NULL) {
 		fu_engine_cli_maybe_prefix_sandbox_error(values[0], error);
 		return FALSE;
@@ -1768,8 +1797,13 @@ fu_engine_cli_firmware_parse(FuCli *cli, gchar **values, GError **error)
 		if (firmware_type == NULL)
 			return FALSE;
 	} else if (g_strcmp0(values[1], "auto") == 0) {
-		g_autoptr(GPtrArray) gtype_ids = fu_context_get_firmware_gtype_ids(ctx);
+		g_autoptr(GPtrArray) gtype_ids = NULL;
 		g_autoptr(GPtrArray) firmware_auto_types = g_ptr_array_new_with_free_func(g_free);
+
+		/* only try the types where the magic matches, if any */
+		gtype_ids = fu_context_get_firmware_gtype_ids_for_stream(ctx, stream, error);
+		if (gtype_ids == NULL)
+			return FALSE;
 		for (guint i = 0; i < gtype_ids->len; i++) {
 			const gchar *gtype_id = g_ptr_array_index(gtype_ids, i);
 			GType gtype_tmp;
@@ -1916,6 +1950,313 @@ fu_engine_cli_firmware_export(FuCli *cli, gchar **values, GError **error)
 	return TRUE;
 }
 
+/* files queued on the worker pool per thread, to bound memory use */
+#define FU_ENGINE_CLI_BATCH_PENDING_PER_THREAD 4
+
+typedef struct {
+	FuContext *ctx;
+	GArray *gtypes;	   /* of GType */
+	GPtrArray *ids;	   /* of utf-8, same order as gtypes */
+	FuFirmwareParseFlags parse_flags;
+	GMutex mutex;
+	GCond cond;
+	guint pending;
+	guint pending_max;
+	guint cnt_success;
+	guint cnt_failed;
+} FuEngineCliBatchHelper;
+
+static FuFirmware *
+fu_engine_cli_firmware_batch_detect(FuEngineCliBatchHelper *helper,
+				    FuInputStream *stream,
+				    GPtrArray *matches,
+				    GError **error)
+{
+	g_autoptr(FuFirmware) firmware_best = NULL;
+	g_autoptr(GPtrArray) gtype_ids = NULL;
+
+	/* the caller specified the type */
+	if (helper->gtypes->len == 1) {
+		g_autoptr(FuFirmware) firmware =
+		    g_object_new(g_array_index(helper->gtypes, GType, 0), NULL);
+		if (!fu_firmware_parse_stream(firmware, stream, 0x0, helper->parse_flags, error))
+			return NULL;
+		g_ptr_array_add(matches, g_ptr_array_index(helper->ids, 0));
+		return g_steal_pointer(&firmware);
+	}
+
+	/* try all the plausible GTypes, returning the most likely that parsed */
+	gtype_ids = fu_context_get_firmware_gtype_ids_for_stream(helper->ctx, stream, error);
+	if (gtype_ids == NULL)
+		return NULL;
+	for (guint j = 0; j < gtype_ids->len; j++) {
+		const gchar *gtype_id = g_ptr_array_index(gtype_ids, j);
+		guint i = 0;
+		g_autoptr(FuFirmware) firmware = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		if (!g_ptr_array_find_with_equal_func(helper->ids, gtype_id, g_str_equal, &i))
+			continue;
+		firmware = g_object_new(g_array_index(helper->gtypes, GType, i), NULL);
+		if (!fu_firmware_parse_stream(firmware,
+					      stream,
+					      0x0,
+					      helper->parse_flags,
+					      &error_local)) {
+			g_debug("failed to parse as %s: %s", gtype_id, error_local->message);
+			continue;
+		}
+		g_ptr_array_add(matches, g_ptr_array_index(helper->ids, i));
+		if (firmware_best == NULL)
+			firmware_best = g_steal_pointer(&firmware);
+	}
+	if (firmware_best == NULL) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "no firmware type matched");
+		return NULL;
+	}
+	return g_steal_pointer(&firmware_best);
+}
+
+static void
+fu_engine_cli_firmware_batch_parse_cb(gpointer data, gpointer user_data)
+{
+	FuEngineCliBatchHelper *helper = (FuEngineCliBatchHelper *)user_data;
+	gint64 start = g_get_monotonic_time();
+	gsize streamsz = 0;
+	g_autofree gchar *filename = (gchar *)data;
+	g_autofree gchar *str = NULL;
+	g_autoptr(FuFirmware) firmware = NULL;
+	g_autoptr(FuInputStream) stream = NULL;
+	g_autoptr(FwupdJsonObject) json_obj = fwupd_json_object_new();
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GPtrArray) matches = g_ptr_array_new(); /* of utf-8 */
+
+	fwupd_json_object_add_string(json_obj, "Filename", filename);
+	stream = fu_input_stream_from_path(filename, &error_local);
+	if (stream != NULL) {
+		if (fu_input_stream_size(stream, &streamsz, NULL))
+			fwupd_json_object_add_integer(json_obj, "Size", streamsz);
+		firmware =
+		    fu_engine_cli_firmware_batch_detect(helper, stream, matches, &error_local);
+	}
+	if (firmware != NULL) {
+		g_autoptr(FwupdJsonArray) json_imgs = fwupd_json_array_new();
+		g_autoptr(GPtrArray) imgs = fu_firmware_get_images(firmware);
+
+		g_autoptr(FwupdJsonArray) json_matches = fwupd_json_array_new();
+
+		fwupd_json_object_add_string(json_obj,
+					     "FirmwareType",
+					     g_ptr_array_index(matches, 0));
+		for (guint i = 0; i < matches->len; i++)
+			fwupd_json_array_add_string(json_matches, g_ptr_array_index(matches, i));
+		fwupd_json_object_add_array(json_obj, "Matches", json_matches);
+		if (matches->len > 1)
+			fwupd_json_object_add_boolean(json_obj, "Ambiguous", TRUE);
+		if (fu_firmware_get_version(firmware) != NULL) {
+			fwupd_json_object_add_string(json_obj,
+						     "Version",
+						     fu_firmware_get_version(firmware));
+		}
+		for (guint i = 0; i < imgs->len; i++) {
+			FuFirmware *img = g_ptr_array_index(imgs, i);
+			g_autoptr(FwupdJsonObject) json_img = fwupd_json_object_new();
+			fwupd_json_object_add_string(json_img, "GType", G_OBJECT_TYPE_NAME(img));
+			if (fu_firmware_get_id(img) != NULL) {
+				fwupd_json_object_add_string(json_img,
+							     "Id",
+							     fu_firmware_get_id(img));
+			}
+			if (fu_firmware_get_version(img) != NULL) {
+				fwupd_json_object_add_string(json_img,
+							     "Version",
+							     fu_firmware_get_version(img));
+			}
+			fwupd_json_array_add_object(json_imgs, json_img);
+		}
+		fwupd_json_object_add_array(json_obj, "Images", json_imgs);
+	} else {
+		fwupd_json_object_add_string(json_obj, "Error", error_local->message);
+	}
+	fwupd_json_object_add_integer(json_obj, "DurationUs", g_get_monotonic_time() - start);
+
+	/* one complete line per file so that the output can be streamed */
+	str = fwupd_json_object_to_string(json_obj, FWUPD_JSON_EXPORT_FLAG_NONE);
+	g_print("%s\n", str); /* nocheck:print */
+
+	/* unblock the producer */
+	g_mutex_lock(&helper->mutex);
+	if (firmware != NULL)
+		helper->cnt_success++;
+	else
+		helper->cnt_failed++;
+	helper->pending--;
+	g_cond_signal(&helper->cond);
+	g_mutex_unlock(&helper->mutex);
+}
+
+static gboolean
+fu_engine_cli_firmware_batch_push(FuEngineCliBatchHelper *helper,
+				  GThreadPool *pool,
+				  const gchar *filename,
+				  GError **error)
+{
+	g_mutex_lock(&helper->mutex);
+	while (helper->pending >= helper->pending_max)
+		g_cond_wait(&helper->cond, &helper->mutex);
+	helper->pending++;
+	g_mutex_unlock(&helper->mutex);
+	return g_thread_pool_push(pool, g_strdup(filename), error);
+}
+
+static gboolean
+fu_engine_cli_firmware_batch_push_dir(FuEngineCliBatchHelper *helper,
+				      GThreadPool *pool,
+				      const gchar *path,
+				      GError **error)
+{
+	const gchar *fn;
+	g_autoptr(GDir) dir = g_dir_open(path, 0, error);
+
+	if (dir == NULL)
+		return FALSE;
+	while ((fn = g_dir_read_name(dir)) != NULL) {
+		g_autofree gchar *filename = g_build_filename(path, fn, NULL);
+		if (g_file_test(filename, G_FILE_TEST_IS_SYMLINK))
+			continue;
+		if (g_file_test(filename, G_FILE_TEST_IS_DIR)) {
+			if (!fu_engine_cli_firmware_batch_push_dir(helper, pool, filename, error))
+				return FALSE;
+			continue;
+		}
+		if (!g_file_test(filename, G_FILE_TEST_IS_REGULAR))
+			continue;
+		if (!fu_engine_cli_firmware_batch_push(helper, pool, filename, error))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_engine_cli_firmware_batch_push_manifest(FuEngineCliBatchHelper *helper,
+					   GThreadPool *pool,
+					   const gchar *path,
+					   GError **error)
+{
+	g_autofree gchar *buf = NULL;
+	g_auto(GStrv) lines = NULL;
+
+	if (!g_file_get_contents(path, &buf, NULL, error))
+		return FALSE;
+	lines = g_strsplit(buf, "\n", -1);
+	for (guint i = 0; lines[i] != NULL; i++) {
+		g_strstrip(lines[i]);
+		if (lines[i][0] == '\0' || lines[i][0] == '#')
+			continue;
+		if (!fu_engine_cli_firmware_batch_push(helper, pool, lines[i], error))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_engine_cli_firmware_batch_parse(FuCli *cli, gchar **values, GError **error)
+{
+	FuEngineCli *self = FU_ENGINE_CLI(cli);
+	FuContext *ctx = fu_engine_get_context(self->engine);
+	FuEngineCliBatchHelper helper = {0};
+	GThreadPool *pool;
+	gboolean ret;
+	guint threads = MAX(g_get_num_processors(), 1);
+	g_autoptr(GArray) gtypes = g_array_new(FALSE, FALSE, sizeof(GType));
+	g_autoptr(GPtrArray) gtype_ids = NULL;
+	g_autoptr(GPtrArray) ids = g_ptr_array_new();
+
+	/* check args */
+	if (g_strv_length(values) == 0 || g_strv_length(values) > 2) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_ARGS,
+				    "Invalid arguments: directory or manifest required");
+		return FALSE;
+	}
+
+	/* load engine once for all the files */
+	if (!fu_engine_load(self->engine,
+			    FU_ENGINE_LOAD_FLAG_PATH_STORE_DEFAULTS | FU_ENGINE_LOAD_FLAG_READONLY |
+				FU_ENGINE_LOAD_FLAG_EXTERNAL_PLUGINS |
+				FU_ENGINE_LOAD_FLAG_BUILTIN_PLUGINS,
+			    self->progress,
+			    error))
+		return FALSE;
+
+	/* build the list of candidate types up front so the workers only read it */
+	gtype_ids = fu_context_get_firmware_gtype_ids(ctx);
+	for (guint i = 0; i < gtype_ids->len; i++) {
+		const gchar *gtype_id = g_ptr_array_index(gtype_ids, i);
+		GType gtype = fu_context_get_firmware_gtype_by_id(ctx, gtype_id);
+		if (gtype == G_TYPE_INVALID)
+			continue;
+		if (values[1] != NULL) {
+			if (g_strcmp0(gtype_id, values[1]) != 0)
+				continue;
+		} else {
+			g_autoptr(FuFirmware) firmware_tmp = NULL;
+			if (g_strcmp0(gtype_id, "raw") == 0)
+				continue;
+			firmware_tmp = g_object_new(gtype, NULL);
+			if (fu_firmware_has_flag(firmware_tmp, FU_FIRMWARE_FLAG_NO_AUTO_DETECTION))
+				continue;
+		}
+		g_array_append_val(gtypes, gtype);
+		g_ptr_array_add(ids, (gpointer)gtype_id);
+	}
+	if (gtypes->len == 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "GType %s not supported",
+			    values[1] != NULL ? values[1] : "auto");
+		return FALSE;
+	}
+
+	/* do not search for magic when probing every type, to match firmware-parse */
+	helper.ctx = ctx;
+	helper.gtypes = gtypes;
+	helper.ids = ids;
+	helper.parse_flags = self->parse_flags;
+	if (values[1] == NULL)
+		helper.parse_flags |= FU_FIRMWARE_PARSE_FLAG_NO_SEARCH;
+	helper.pending_max = threads * FU_ENGINE_CLI_BATCH_PENDING_PER_THREAD;
+
+	/* parse on a worker pool */
+	pool = g_thread_pool_new(fu_engine_cli_firmware_batch_parse_cb,
+				 &helper,
+				 threads,
+				 FALSE,
+				 error);
+	if (pool == NULL)
+		return FALSE;
+	g_mutex_init(&helper.mutex);
+	g_cond_init(&helper.cond);
+	if (g_file_test(values[0], G_FILE_TEST_IS_DIR))
+		ret = fu_engine_cli_firmware_batch_push_dir(&helper, pool, values[0], error);
+	else
+		ret = fu_engine_cli_firmware_batch_push_manifest(&helper, pool, values[0], error);
+
+	/* wait for the queued files to finish even on failure */
+	g_thread_pool_free(pool, FALSE, TRUE);
+	g_mutex_clear(&helper.mutex);
+	g_cond_clear(&helper.cond);
+	if (!ret)
+		return FALSE;
+	g_info("parsed %u files, %u failed", helper.cnt_success, helper.cnt_failed);
+	return TRUE;
+}
+
 static gboolean
 fu_engine_cli_firmware_extract_image(FuEngineCli *self,
 				     FuFirmware *firmware,
@@ -3881,7 +4222,7 @@ fu_engine_cli_sync_impl_get_details(FwupdClient *client,
 	FuEngineCli *self = FU_ENGINE_CLI(user_data);
 	g_autoptr(FuInputStream) stream = NULL;
 
-	stream = fu_input_stream_from_path(filename, error);
+	stream = fu_engine_cli_input_stream_from_path(filename, error);
 	if (stream == NULL) {
 		fu_engine_cli_maybe_prefix_sandbox_error(filename, error);
 		return NULL;
@@ -4089,7 +4430,7 @@ fu_engine_cli_sync_impl_install(FwupdClient *client,
 	}
 
 	/* download if required */
-	stream = fu_input_stream_from_path(filename, error);
+	stream = fu_engine_cli_input_stream_from_path(filename, error);
 	if (stream == NULL) {
 		fu_engine_cli_maybe_prefix_sandbox_error(filename, error);
 		return FALSE;
@@ -4446,6 +4787,7 @@ main(int argc, char *argv[])
 	g_autoptr(GOptionContext) option_context = g_option_context_new(NULL);
 	g_autofree gchar *cmd_descriptions = NULL;
 	g_autofree gchar *destdir = NULL;
+	g_autofree gchar *trace_filename = NULL;
 	const GOptionEntry options[] = {
 	    {"ignore-checksum",
 	     '\0',
@@ -4525,6 +4867,15 @@ main(int argc, char *argv[])
 	     &destdir,
 	     _("Prefix for import and output files"),
 	     NULL},
+	    {"trace",
+	     '\0',
+	     0,
+	     G_OPTION_ARG_FILENAME,
+	     &trace_filename,
+	     /* TRANSLATORS: command line option */
+	     N_("Save a timeline of the action in Chrome trace-event format"),
+	     /* TRANSLATORS: command argument: uppercase, spaces->dashes */
+	     N_("FILE")},
 	    {NULL}};
 
 #ifdef _WIN32
@@ -4665,6 +5016,13 @@ main(int argc, char *argv[])
 			     /* TRANSLATORS: command description */
 			     _("Export a firmware file structure to XML"),
 			     fu_engine_cli_firmware_export);
+	fu_cli_cmd_array_add(FU_CLI(self),
+			     "firmware-batch-parse",
+			     /* TRANSLATORS: command argument: uppercase, spaces->dashes */
+			     _("DIRECTORY|MANIFEST [FIRMWARE-TYPE]"),
+			     /* TRANSLATORS: command description */
+			     _("Parse many firmware files, showing the results as JSON lines"),
+			     fu_engine_cli_firmware_batch_parse);
 	fu_cli_cmd_array_add(FU_CLI(self),
 			     "firmware-extract",
 			     /* TRANSLATORS: command argument: uppercase, spaces->dashes */
@@ -4907,7 +5265,8 @@ main(int argc, char *argv[])
 				 error->message);
 		return EXIT_FAILURE;
 	}
-	fu_progress_set_profile(self->progress, g_log_get_debug_enabled());
+	fu_progress_set_profile(self->progress,
+				g_log_get_debug_enabled() || trace_filename != NULL);
 
 	/* allow disabling SSL strict mode for broken corporate proxies */
 	if (fu_cli_has_arg_flag(FU_CLI(self), FU_CLI_ARG_FLAG_DISABLE_SSL_STRICT)) {
@@ -4976,11 +5335,22 @@ main(int argc, char *argv[])
 	rc = fu_cli_main(FU_CLI(self), argc, argv);
 
 	/* a good place to do the traceback */
-	if (fu_progress_get_profile(self->progress)) {
+	if (g_log_get_debug_enabled()) {
 		g_autofree gchar *str = fu_progress_traceback(self->progress);
 		if (str != NULL)
 			fu_console_print_literal(fu_cli_get_console(FU_CLI(self)), str);
 	}
+	if (trace_filename != NULL) {
+		g_autoptr(GError) error_trace = NULL;
+		if (!fu_progress_export_trace(self->progress, trace_filename, &error_trace)) {
+			fu_console_print(fu_cli_get_console(FU_CLI(self)),
+					 "%s: %s",
+					 /* TRANSLATORS: the trace timeline could not be saved */
+					 _("Failed to save trace"),
+					 error_trace->message);
+			return EXIT_FAILURE;
+		}
+	}
 
 	/* success */
 	return rc;
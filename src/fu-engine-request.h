@@ -21,6 +21,8 @@ const gchar *
 fu_engine_request_get_sender(FuEngineRequest *self) G_GNUC_NON_NULL(1);
 void
 fu_engine_request_add_flag(FuEngineRequest *self, FuEngineRequestFlags flag) G_GNUC_NON_NULL(1);
+FuEngineRequestFlags
+fu_engine_request_get_flags(FuEngineRequest *self) G_GNUC_NON_NULL(1);
 gboolean
 fu_engine_request_has_flag(FuEngineRequest *self,
 			   FuEngineRequestFlags flag) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
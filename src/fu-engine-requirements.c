@@ -16,7 +16,10 @@
 #define FU_ENGINE_REQUIREMENTS_VERSION_REQ_MAX_LEN 1024
 
 static gboolean
-fu_engine_requirements_regex_match(const gchar *version_req, const gchar *version, GError **error)
+fu_engine_requirements_regex_match(FuEngine *self,
+				   const gchar *version_req,
+				   const gchar *version,
+				   GError **error)
 {
 	if (strlen(version_req) > FU_ENGINE_REQUIREMENTS_VERSION_REQ_MAX_LEN) {
 		g_set_error_literal(error,
@@ -25,22 +28,14 @@ fu_engine_requirements_regex_match(const gchar *version_req, const gchar *versio
 				    "rejecting overly long regex pattern");
 		return FALSE;
 	}
-	if (!g_regex_match_simple(version_req, version, 0, 0)) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_INTERNAL,
-			    "failed regex [%s %s]",
-			    version_req,
-			    version);
-		return FALSE;
-	}
-
-	/* success */
-	return TRUE;
+	return fu_engine_regex_match(self, version_req, version, error);
 }
 
 static gboolean
-fu_engine_requirements_glob_match(const gchar *version_req, const gchar *version, GError **error)
+fu_engine_requirements_glob_match(FuEngine *self,
+				  const gchar *version_req,
+				  const gchar *version,
+				  GError **error)
 {
 	if (strlen(version_req) > FU_ENGINE_REQUIREMENTS_VERSION_REQ_MAX_LEN) {
 		g_set_error_literal(error,
@@ -49,7 +44,7 @@ fu_engine_requirements_glob_match(const gchar *version_req, const gchar *version
 				    "rejecting overly long glob pattern");
 		return FALSE;
 	}
-	if (!g_pattern_match_simple(version_req, version)) {
+	if (!fu_engine_glob_match(self, version_req, version)) {
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_INTERNAL,
@@ -64,37 +59,41 @@ fu_engine_requirements_glob_match(const gchar *version_req, const gchar *version
 }
 
 static gboolean
-fu_engine_requirements_require_vercmp_part(const gchar *compare,
+fu_engine_requirements_require_vercmp_part(FuEngine *self,
+					   const gchar *compare,
 					   const gchar *version_req,
-					   const gchar *version,
-					   FwupdVersionFormat fmt,
+					   FuVersionKey *version_key,
 					   GError **error)
 {
+	const gchar *version = fu_version_key_get_version(version_key);
 	gboolean ret = FALSE;
 	gint rc = 0;
 
+	/* the device version key is cached, so only the requirement has to be parsed */
+	if (g_strcmp0(compare, "eq") == 0 || g_strcmp0(compare, "ne") == 0 ||
+	    g_strcmp0(compare, "lt") == 0 || g_strcmp0(compare, "gt") == 0 ||
+	    g_strcmp0(compare, "le") == 0 || g_strcmp0(compare, "ge") == 0) {
+		g_autoptr(FuVersionKey) version_req_key =
+		    fu_version_key_new(version_req, fu_version_key_get_format(version_key));
+		rc = fu_version_key_compare(version_key, version_req_key);
+	}
+
 	if (g_strcmp0(compare, "eq") == 0) {
-		rc = fu_version_compare(version, version_req, fmt);
 		ret = rc == 0;
 	} else if (g_strcmp0(compare, "ne") == 0) {
-		rc = fu_version_compare(version, version_req, fmt);
 		ret = rc != 0;
 	} else if (g_strcmp0(compare, "lt") == 0) {
-		rc = fu_version_compare(version, version_req, fmt);
 		ret = rc < 0;
 	} else if (g_strcmp0(compare, "gt") == 0) {
-		rc = fu_version_compare(version, version_req, fmt);
 		ret = rc > 0;
 	} else if (g_strcmp0(compare, "le") == 0) {
-		rc = fu_version_compare(version, version_req, fmt);
 		ret = rc <= 0;
 	} else if (g_strcmp0(compare, "ge") == 0) {
-		rc = fu_version_compare(version, version_req, fmt);
 		ret = rc >= 0;
 	} else if (g_strcmp0(compare, "glob") == 0) {
-		return fu_engine_requirements_glob_match(version_req, version, error);
+		return fu_engine_requirements_glob_match(self, version_req, version, error);
 	} else if (g_strcmp0(compare, "regex") == 0) {
-		return fu_engine_requirements_regex_match(version_req, version, error);
+		return fu_engine_requirements_regex_match(self, version_req, version, error);
 	} else {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -161,12 +160,13 @@ fu_engine_requirements_check_fwupd_version(FuEngineRequirementsHelper *helper,
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuEngineRequirementsHelper, fu_engine_requirements_helper_free)
 
 static gboolean
-fu_engine_requirements_require_vercmp(XbNode *req,
-				      const gchar *version,
-				      FwupdVersionFormat fmt,
+fu_engine_requirements_require_vercmp(FuEngine *self,
+				      XbNode *req,
+				      FuVersionKey *version_key,
 				      FuEngineRequirementsHelper *helper,
 				      GError **error)
 {
+	const gchar *version = fu_version_key_get_version(version_key);
 	const gchar *compare = xb_node_get_attr(req, "compare");
 	const gchar *version_req = xb_node_get_attr(req, "version");
 	g_auto(GStrv) split = NULL;
@@ -194,21 +194,21 @@ fu_engine_requirements_require_vercmp(XbNode *req,
 		g_auto(GStrv) kv = g_strsplit(split[i], "=", 2);
 		if (g_strv_length(kv) > 1) {
 			helper->has_id_requirement_glob = TRUE;
-			if (!g_pattern_match_simple(kv[0], version)) {
+			if (!fu_engine_glob_match(self, kv[0], version)) {
 				g_debug("skipping vercmp %s as version %s", kv[0], version);
 				continue;
 			}
 			g_debug("checking vercmp %s as version %s", kv[1], version);
-			return fu_engine_requirements_require_vercmp_part(compare,
+			return fu_engine_requirements_require_vercmp_part(self,
+									  compare,
 									  kv[1],
-									  version,
-									  fmt,
+									  version_key,
 									  error);
 		}
-		return fu_engine_requirements_require_vercmp_part(compare,
+		return fu_engine_requirements_require_vercmp_part(self,
+								  compare,
 								  kv[0],
-								  version,
-								  fmt,
+								  version_key,
 								  error);
 	}
 
@@ -239,6 +239,7 @@ fu_engine_requirements_check_not_child(FuEngine *self,
 	for (guint i = 0; i < children->len; i++) {
 		FuDevice *child = g_ptr_array_index(children, i);
 		const gchar *version = fu_device_get_version(child);
+		g_autoptr(FuVersionKey) version_key = NULL;
 		if (version == NULL) {
 			g_autofree gchar *id_display = fu_device_get_id_display(device);
 			g_autofree gchar *id_display_child = fu_device_get_id_display(child);
@@ -250,11 +251,8 @@ fu_engine_requirements_check_not_child(FuEngine *self,
 				    id_display);
 			return FALSE;
 		}
-		if (fu_engine_requirements_require_vercmp(req,
-							  version,
-							  fu_device_get_version_format(child),
-							  helper,
-							  NULL)) {
+		version_key = fu_device_get_version_key(child);
+		if (fu_engine_requirements_require_vercmp(self, req, version_key, helper, NULL)) {
 			g_set_error(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_NOT_SUPPORTED,
@@ -299,7 +297,7 @@ fu_engine_requirements_check_vendor_id(FuEngine *self,
 
 	/* it is always safe to use a regex, even for simple strings */
 	vendor_ids_device = fu_strjoin("|", vendor_ids);
-	if (!g_regex_match_simple(vendor_ids_metadata, vendor_ids_device, 0, 0)) {
+	if (!fu_engine_regex_match(self, vendor_ids_metadata, vendor_ids_device, NULL)) {
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_INVALID_FILE,
@@ -337,6 +335,7 @@ fu_engine_requirements_check_firmware(FuEngine *self,
 	const gchar *depth_str;
 	gint64 depth = G_MAXINT64;
 	g_autoptr(FuDevice) device_actual = g_object_ref(device);
+	g_autoptr(FuVersionKey) version_key = NULL;
 	g_autoptr(GError) error_local = NULL;
 	g_auto(GStrv) guids = NULL;
 
@@ -379,12 +378,12 @@ fu_engine_requirements_check_firmware(FuEngine *self,
 	/* old firmware version */
 	if (xb_node_get_text(req) == NULL) {
 		version = fu_device_get_version(device_actual);
-		if (!fu_engine_requirements_require_vercmp(
-			req,
-			version,
-			fu_device_get_version_format(device_actual),
-			helper,
-			&error_local)) {
+		version_key = fu_device_get_version_key(device_actual);
+		if (!fu_engine_requirements_require_vercmp(self,
+							   req,
+							   version_key,
+							   helper,
+							   &error_local)) {
 			if (g_strcmp0(xb_node_get_attr(req, "compare"), "ge") == 0) {
 				g_set_error(
 				    error,
@@ -408,12 +407,13 @@ fu_engine_requirements_check_firmware(FuEngine *self,
 	/* bootloader version */
 	if (g_strcmp0(xb_node_get_text(req), "bootloader") == 0) {
 		version = fu_device_get_version_bootloader(device_actual);
-		if (!fu_engine_requirements_require_vercmp(
-			req,
-			version,
-			fu_device_get_version_format(device_actual),
-			helper,
-			&error_local)) {
+		version_key =
+		    fu_version_key_new(version, fu_device_get_version_format(device_actual));
+		if (!fu_engine_requirements_require_vercmp(self,
+							   req,
+							   version_key,
+							   helper,
+							   &error_local)) {
 			if (g_strcmp0(xb_node_get_attr(req, "compare"), "ge") == 0) {
 				g_set_error(
 				    error,
@@ -558,12 +558,9 @@ fu_engine_requirements_check_firmware(FuEngine *self,
 
 	/* get the version of the other device */
 	version = fu_device_get_version(device_actual);
+	version_key = fu_device_get_version_key(device_actual);
 	if (version != NULL && xb_node_get_attr(req, "compare") != NULL &&
-	    !fu_engine_requirements_require_vercmp(req,
-						   version,
-						   fu_device_get_version_format(device_actual),
-						   helper,
-						   &error_local)) {
+	    !fu_engine_requirements_require_vercmp(self, req, version_key, helper, &error_local)) {
 		if (g_strcmp0(xb_node_get_attr(req, "compare"), "ge") == 0) {
 			g_set_error(error,
 				    FWUPD_ERROR,
@@ -594,6 +591,7 @@ fu_engine_requirements_check_id(FuEngine *self,
 				GError **error)
 {
 	FuContext *ctx = fu_engine_get_context(self);
+	g_autoptr(FuVersionKey) version_key = NULL;
 	g_autoptr(GError) error_local = NULL;
 	const gchar *version;
 
@@ -614,11 +612,8 @@ fu_engine_requirements_check_id(FuEngine *self,
 			    xb_node_get_text(req));
 		return FALSE;
 	}
-	if (!fu_engine_requirements_require_vercmp(req,
-						   version,
-						   FWUPD_VERSION_FORMAT_UNKNOWN,
-						   helper,
-						   &error_local)) {
+	version_key = fu_version_key_new(version, FWUPD_VERSION_FORMAT_UNKNOWN);
+	if (!fu_engine_requirements_require_vercmp(self, req, version_key, helper, &error_local)) {
 		if (g_strcmp0(xb_node_get_attr(req, "compare"), "ge") == 0) {
 			g_set_error(error,
 				    FWUPD_ERROR,
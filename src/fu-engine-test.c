@@ -167,6 +167,66 @@ fu_engine_generate_md_func(void)
 	g_assert_cmpstr(tmp, ==, NULL);
 }
 
+static void
+fu_engine_update_metadata_unchanged_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *fn = NULL;
+	g_autofree gchar *fn_cache = NULL;
+	g_autofree gchar *fn_cache_sig = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuEngine) engine = fu_engine_new(ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(FwupdRemote) remote_cfg = fwupd_remote_new();
+	g_autoptr(GBytes) blob_raw = g_bytes_new_static("not checked", 11);
+	g_autoptr(GBytes) blob_sig = g_bytes_new_static("also not checked", 16);
+	g_autoptr(GError) error = NULL;
+	FwupdRemote *remote;
+
+	/* set up test harness */
+	tmpdir = fu_temporary_directory_new("self-tests", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_LOCALSTATEDIR_METADATA, tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_CACHEDIR_PKG, tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_DATADIR_PKG, tmpdir);
+	fwupd_remote_set_id(remote_cfg, "cached");
+	fwupd_remote_set_metadata_uri(remote_cfg, "https://localhost/firmware.xml.gz");
+	fwupd_remote_add_flag(remote_cfg, FWUPD_REMOTE_FLAG_ENABLED);
+	fn = fu_temporary_directory_build(tmpdir, "remotes.d", "cached.conf", NULL);
+	ret = fu_remote_save_to_filename(remote_cfg, fn, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_engine_load(engine,
+			     FU_ENGINE_LOAD_FLAG_REMOTES | FU_ENGINE_LOAD_FLAG_NO_CACHE,
+			     progress,
+			     &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* the client has seen an HTTP 304 and sends back the cached copies */
+	remote = fu_engine_get_remote_by_id(engine, "cached", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(remote);
+	fn_cache = fu_temporary_directory_build(tmpdir, "cached", "firmware.xml.gz", NULL);
+	g_assert_cmpstr(fwupd_remote_get_filename_cache(remote), ==, fn_cache);
+	ret = fu_bytes_set_contents(fn_cache, blob_raw, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fn_cache_sig = g_strdup_printf("%s.jcat", fn_cache);
+	ret = fu_bytes_set_contents(fn_cache_sig, blob_sig, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_true(fwupd_remote_needs_refresh(remote));
+
+	/* this skips the JCat verification, but still resets the age */
+	ret = fu_engine_update_metadata_bytes(engine, "cached", blob_raw, blob_sig, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_false(fwupd_remote_needs_refresh(remote));
+}
+
 static void
 fu_engine_test_plugin_mutable_enumeration(void)
 {
@@ -1114,6 +1174,7 @@ fu_engine_downgrade_func(void)
 {
 	FwupdRelease *rel;
 	gboolean ret;
+	guint cache_hits;
 	g_autofree gchar *fn_broken = NULL;
 	g_autofree gchar *fn_stable = NULL;
 	g_autofree gchar *fn_testing = NULL;
@@ -1121,6 +1182,7 @@ fu_engine_downgrade_func(void)
 	g_autoptr(FuDevice) device = fu_device_new(ctx);
 	g_autoptr(FuEngine) engine = fu_engine_new(ctx);
 	g_autoptr(FuEngineRequest) request = fu_engine_request_new(NULL);
+	g_autoptr(FuEngineRequest) request_fr = fu_engine_request_new(NULL);
 	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
 	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
 	g_autoptr(GError) error = NULL;
@@ -1273,6 +1335,33 @@ fu_engine_downgrade_func(void)
 	g_assert_nonnull(releases);
 	g_assert_cmpint(releases->len, ==, 4);
 
+	/* alternating requests are both cached, and the releases use the latest request */
+	fu_engine_request_set_locale(request_fr, "fr_FR.UTF-8");
+	cache_hits = fu_engine_get_releases_cache_hits(engine);
+	for (guint i = 0; i < 2; i++) {
+		g_autoptr(GPtrArray) releases_fr = NULL;
+		g_autoptr(GPtrArray) releases_tmp = NULL;
+
+		releases_fr =
+		    fu_engine_get_releases(engine, request_fr, fu_device_get_id(device), &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(releases_fr);
+		g_assert_cmpint(releases_fr->len, ==, 4);
+		g_assert_true(fu_release_get_request(g_ptr_array_index(releases_fr, 0)) ==
+			      request_fr);
+		releases_tmp =
+		    fu_engine_get_releases(engine, request, fu_device_get_id(device), &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(releases_tmp);
+		g_assert_true(fu_release_get_request(g_ptr_array_index(releases_tmp, 0)) ==
+			      request);
+
+		/* the earlier results are not modified */
+		g_assert_true(fu_release_get_request(g_ptr_array_index(releases_fr, 0)) ==
+			      request_fr);
+	}
+	g_assert_cmpint(fu_engine_get_releases_cache_hits(engine), ==, cache_hits + 3);
+
 	/* no upgrades, as no firmware is approved */
 	releases_up = fu_engine_get_upgrades(engine, request, fu_device_get_id(device), &error);
 	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO);
@@ -3517,6 +3606,7 @@ fu_engine_report_metadata_func(void)
 	    "CpuArchitecture",
 	    "DistroId",
 	    "FwupdSupported",
+	    "ReleasesCacheHits",
 	    "RuntimeVersion(org.freedesktop.fwupd)",
 	    "SELinux",
 	};
@@ -3598,6 +3688,8 @@ main(int argc, char **argv)
 			fu_plugin_engine_get_results_appstream_id_func);
 	g_test_add_func("/fwupd/engine/release-dedupe", fu_engine_release_dedupe_func);
 	g_test_add_func("/fwupd/engine/generate-md", fu_engine_generate_md_func);
+	g_test_add_func("/fwupd/engine/update-metadata-unchanged",
+			fu_engine_update_metadata_unchanged_func);
 	g_test_add_func("/fwupd/engine/better-than", fu_engine_device_better_than_func);
 	g_test_add_func("/fwupd/engine/plugin/mutable", fu_engine_test_plugin_mutable_enumeration);
 	g_test_add_func("/fwupd/engine/plugin/composite", fu_engine_plugin_composite_func);
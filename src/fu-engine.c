@@ -136,6 +136,12 @@ struct _FuEngine {
 	GPtrArray *disabled_plugins; /* (element-type utf-8) */
 	GPtrArray *trusted_reports;  /* (element-type FwupdReport) */
 	GArray *trusted_uids;	     /* (element-type guint64) */
+	GHashTable *regex_cache;     /* (element-type utf-8 GRegex) */
+	GHashTable *glob_cache;	     /* (element-type utf-8 GPatternSpec) */
+	GHashTable *releases_cache;  /* (element-type utf-8 FuEngineReleasesCacheItem) */
+	guint64 releases_generation;
+	guint releases_cache_hits;
+	guint releases_cache_misses;
 };
 
 enum { PROP_0, PROP_CONTEXT, PROP_LAST };
@@ -211,11 +217,38 @@ fu_engine_update_motd_reset(FuEngine *self)
 								  self);
 }
 
+typedef struct {
+	guint64 generation;
+	GPtrArray *releases; /* (nullable) (element-type FuRelease) */
+	GError *error;	     /* (nullable) */
+} FuEngineReleasesCacheItem;
+
+static void
+fu_engine_releases_cache_item_free(FuEngineReleasesCacheItem *item)
+{
+	if (item->releases != NULL)
+		g_ptr_array_unref(item->releases);
+	if (item->error != NULL)
+		g_error_free(item->error);
+	g_free(item);
+}
+
+/* anything that could change the result of fu_engine_get_releases_for_device() */
+static void
+fu_engine_releases_cache_invalidate(FuEngine *self)
+{
+	self->releases_generation++;
+	g_hash_table_remove_all(self->releases_cache);
+}
+
 static void
 fu_engine_emit_changed(FuEngine *self)
 {
 	g_autoptr(GError) error = NULL;
 
+	/* requirements may depend on other devices */
+	fu_engine_releases_cache_invalidate(self);
+
 	/* do nothing */
 	if (self->phase != FU_ENGINE_PHASE_DONE)
 		return;
@@ -235,6 +268,9 @@ fu_engine_emit_changed(FuEngine *self)
 static void
 fu_engine_emit_device_changed_safe(FuEngine *self, FuDevice *device)
 {
+	/* requirements may depend on other devices */
+	fu_engine_releases_cache_invalidate(self);
+
 	/* do nothing */
 	if (self->phase != FU_ENGINE_PHASE_DONE)
 		return;
@@ -680,6 +716,7 @@ fu_engine_ensure_context_flag_save_events(FuEngine *self)
 static void
 fu_engine_device_added_cb(FuDeviceList *device_list, FuDevice *device, FuEngine *self)
 {
+	fu_engine_releases_cache_invalidate(self);
 	fu_engine_watch_device(self, device);
 	fu_engine_ensure_device_problem_priority(self, device);
 	fu_engine_ensure_device_power_inhibit(self, device);
@@ -704,6 +741,7 @@ fu_engine_device_runner_device_removed(FuEngine *self, FuDevice *device)
 static void
 fu_engine_device_removed_cb(FuDeviceList *device_list, FuDevice *device, FuEngine *self)
 {
+	fu_engine_releases_cache_invalidate(self);
 	fu_engine_device_runner_device_removed(self, device);
 	fu_engine_acquiesce_reset(self);
 	g_signal_handlers_disconnect_by_data(device, self);
@@ -2258,6 +2296,14 @@ fu_engine_get_report_metadata(FuEngine *self, GError **error)
 	if (host_bkc != NULL)
 		g_hash_table_insert(hash, g_strdup("HostBkc"), g_steal_pointer(&host_bkc));
 
+	/* this is useful to know if the releases cache is actually helping */
+	g_hash_table_insert(hash,
+			    g_strdup("ReleasesCacheHits"),
+			    g_strdup_printf("%u", self->releases_cache_hits));
+	g_hash_table_insert(hash,
+			    g_strdup("ReleasesCacheMisses"),
+			    g_strdup_printf("%u", self->releases_cache_misses));
+
 #ifdef HAVE_PASSIM
 	/* this is useful to know if passim support is actually helping bandwidth use */
 	fu_engine_ensure_passim_client(self);
@@ -4241,6 +4287,9 @@ fu_engine_create_silo_index(FuEngine *self, GError **error)
 	g_autoptr(GError) error_container_checksum2 = NULL;
 	g_autoptr(GError) error_tag_by_guid_version = NULL;
 
+	/* any cached releases refer to the old silo */
+	fu_engine_releases_cache_invalidate(self);
+
 	/* print what we've got */
 	components = xb_silo_query(self->silo, "components/component[@type='firmware']", 0, NULL);
 	if (components == NULL)
@@ -4754,6 +4803,7 @@ fu_engine_config_changed_cb(FuConfig *config, FuEngine *self)
 
 	/* sync */
 	fu_engine_config_reload(self);
+	fu_engine_releases_cache_invalidate(self);
 
 	/* amend P2P policy */
 	for (guint i = 0; i < remotes->len; i++) {
@@ -4779,9 +4829,64 @@ fu_engine_metadata_changed(FuEngine *self)
 	fu_engine_emit_changed(self);
 }
 
+static gboolean
+fu_engine_remote_in_silo(FuEngine *self, const gchar *remote_id)
+{
+	g_autoptr(XbNode) n = NULL;
+	g_autoptr(XbQuery) query = NULL;
+	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
+
+	if (self->silo == NULL)
+		return FALSE;
+	query = xb_query_new_full(self->silo,
+				  "components/custom/value[@key='fwupd::RemoteId'][text()=?]",
+				  XB_QUERY_FLAG_NONE,
+				  NULL);
+	if (query == NULL)
+		return TRUE;
+	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, remote_id, NULL);
+	n = xb_silo_query_first_with_context(self->silo, query, &context, NULL);
+	return n != NULL;
+}
+
+/* if the remote is, or was, providing metadata then the silo has to be rebuilt */
+static gboolean
+fu_engine_remote_affects_silo(FuEngine *self, const gchar *remote_id)
+{
+	g_autoptr(FwupdRemote) remote = NULL;
+
+	if (fu_engine_remote_in_silo(self, remote_id))
+		return TRUE;
+	remote = fu_remote_list_get_by_id(self->remote_list, remote_id, NULL);
+	if (remote == NULL)
+		return TRUE;
+	if (!fwupd_remote_has_flag(remote, FWUPD_REMOTE_FLAG_ENABLED))
+		return FALSE;
+	return g_file_test(fwupd_remote_get_filename_cache(remote), G_FILE_TEST_EXISTS);
+}
+
 static void
-fu_engine_remote_list_changed_cb(FuRemoteList *remote_list, FuEngine *self)
+fu_engine_remote_list_changed_cb(FuRemoteList *remote_list, GStrv remote_ids, FuEngine *self)
 {
+	/* the silo is shared by all the remotes, but only rebuild it once per batch */
+	if (remote_ids != NULL) {
+		g_autofree gchar *str = g_strjoinv(", ", remote_ids);
+		gboolean affects_silo = FALSE;
+
+		for (guint i = 0; remote_ids[i] != NULL; i++) {
+			if (fu_engine_remote_affects_silo(self, remote_ids[i])) {
+				affects_silo = TRUE;
+				break;
+			}
+		}
+		if (!affects_silo) {
+			g_info("remotes changed: %s, no metadata to reload", str);
+			fu_engine_releases_cache_invalidate(self);
+			fu_engine_emit_changed(self);
+			return;
+		}
+		g_info("remotes changed: %s", str);
+	}
 	fu_engine_metadata_changed(self);
 }
 
@@ -4928,6 +5033,43 @@ fu_engine_validate_result_timestamp(FuJcatResult *jcat_result,
 	return TRUE;
 }
 
+static gboolean
+fu_engine_remote_metadata_is_unchanged(FwupdRemote *remote, GBytes *bytes_raw, GBytes *bytes_sig)
+{
+	g_autoptr(GBytes) blob_raw = NULL;
+	g_autoptr(GBytes) blob_sig = NULL;
+
+	if (fwupd_remote_get_filename_cache(remote) == NULL ||
+	    fwupd_remote_get_filename_cache_sig(remote) == NULL)
+		return FALSE;
+
+	/* the signature is small, so check that first */
+	blob_sig = fu_bytes_get_contents(fwupd_remote_get_filename_cache_sig(remote), NULL);
+	if (blob_sig == NULL || !g_bytes_equal(blob_sig, bytes_sig))
+		return FALSE;
+	blob_raw = fu_bytes_get_contents(fwupd_remote_get_filename_cache(remote), NULL);
+	if (blob_raw == NULL || !g_bytes_equal(blob_raw, bytes_raw))
+		return FALSE;
+	return TRUE;
+}
+
+static gboolean
+fu_engine_remote_metadata_touch(FwupdRemote *remote, GError **error)
+{
+	g_autoptr(GFile) file = g_file_new_for_path(fwupd_remote_get_filename_cache(remote));
+
+	if (!g_file_set_attribute_uint64(file,
+					 G_FILE_ATTRIBUTE_TIME_MODIFIED,
+					 (guint64)g_get_real_time() / G_USEC_PER_SEC,
+					 G_FILE_QUERY_INFO_NONE,
+					 NULL,
+					 error)) {
+		fwupd_error_convert(error);
+		return FALSE;
+	}
+	return fwupd_remote_ensure_mtime(remote, error);
+}
+
 /**
  * fu_engine_update_metadata_bytes:
  * @self: a #FuEngine
@@ -4978,6 +5120,12 @@ fu_engine_update_metadata_bytes(FuEngine *self,
 		return FALSE;
 	}
 
+	/* this is exactly what was verified and loaded last time, so just update the age */
+	if (fu_engine_remote_metadata_is_unchanged(remote, bytes_raw, bytes_sig)) {
+		g_info("metadata for %s is unchanged, skipping reload", remote_id);
+		return fu_engine_remote_metadata_touch(remote, error);
+	}
+
 	/* verify JCatFile, or create a dummy one from legacy data */
 	istream = fu_memory_input_stream_new_from_bytes(bytes_sig);
 	g_istream = fu_input_stream_as_g_input_stream(istream);
@@ -5770,16 +5918,18 @@ fu_engine_sort_releases_cb(gconstpointer a, gconstpointer b, gpointer user_data)
 	FuRelease *rel_a = FU_RELEASE(*((FuRelease **)a));
 	FuRelease *rel_b = FU_RELEASE(*((FuRelease **)b));
 	gint rc;
+	g_autoptr(FuVersionKey) key_a = NULL;
+	g_autoptr(FuVersionKey) key_b = NULL;
 
 	/* first by branch */
 	rc = g_strcmp0(fu_release_get_branch(rel_b), fu_release_get_branch(rel_a));
 	if (rc != 0)
 		return rc;
 
-	/* then by version */
-	rc = fu_version_compare(fu_release_get_version(rel_b),
-				fu_release_get_version(rel_a),
-				fu_device_get_version_format(device));
+	/* then by version, using the cached keys as this is called O(n log n) times */
+	key_a = fu_release_get_version_key(rel_a, fu_device_get_version_format(device));
+	key_b = fu_release_get_version_key(rel_b, fu_device_get_version_format(device));
+	rc = fu_version_key_compare(key_b, key_a);
 	if (rc != 0)
 		return rc;
 
@@ -5949,11 +6099,11 @@ fu_engine_get_branch_fallback(const gchar *nullable_branch)
 	return nullable_branch;
 }
 
-GPtrArray *
-fu_engine_get_releases_for_device(FuEngine *self,
-				  FuEngineRequest *request,
-				  FuDevice *device,
-				  GError **error)
+static GPtrArray *
+fu_engine_get_releases_for_device_uncached(FuEngine *self,
+					   FuEngineRequest *request,
+					   FuDevice *device,
+					   GError **error)
 {
 	GPtrArray *device_guids;
 	g_autoptr(GPtrArray) branches = NULL;
@@ -6070,6 +6220,110 @@ fu_engine_get_releases_for_device(FuEngine *self,
 	return g_steal_pointer(&releases);
 }
 
+/* the parts of the device and request that are not covered by the generation */
+static gchar *
+fu_engine_releases_cache_fingerprint(FuEngineRequest *request, FuDevice *device)
+{
+	GPtrArray *guids = fu_device_get_guids(device);
+	g_autoptr(GString) str = g_string_new(NULL);
+
+	g_string_append_printf(str,
+			       "%s|%s|%s|%s|%u|%" G_GUINT64_FORMAT "|%" G_GUINT64_FORMAT
+			       "|%" G_GUINT64_FORMAT "|%" G_GUINT64_FORMAT "|%" G_GUINT64_FORMAT
+			       "|%s",
+			       fu_device_get_id(device),
+			       fu_device_get_version(device),
+			       fu_device_get_version_lowest(device),
+			       fu_device_get_branch(device),
+			       fu_device_get_version_format(device),
+			       fu_device_get_flags(device),
+			       fwupd_device_get_problems(FWUPD_DEVICE(device)),
+			       fwupd_device_get_request_flags(FWUPD_DEVICE(device)),
+			       (guint64)fu_engine_request_get_flags(request),
+			       (guint64)fu_engine_request_get_feature_flags(request),
+			       fu_engine_request_get_locale(request));
+	for (guint i = 0; i < guids->len; i++) {
+		const gchar *guid = g_ptr_array_index(guids, i);
+		g_string_append_printf(str, "|%s", guid);
+	}
+	return g_string_free(g_steal_pointer(&str), FALSE);
+}
+
+/* the cached releases are shared, so never modify them */
+static GPtrArray *
+fu_engine_releases_cache_copy(GPtrArray *releases, FuEngineRequest *request, GError **error)
+{
+	g_autoptr(GPtrArray) releases_new =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	for (guint i = 0; i < releases->len; i++) {
+		FuRelease *release = g_ptr_array_index(releases, i);
+		g_autoptr(FuRelease) release_new = fu_release_copy(release, error);
+		if (release_new == NULL)
+			return NULL;
+
+		/* the sender may be different to the request that created the release */
+		fu_release_set_request(release_new, request);
+		g_ptr_array_add(releases_new, g_steal_pointer(&release_new));
+	}
+	return g_steal_pointer(&releases_new);
+}
+
+GPtrArray *
+fu_engine_get_releases_for_device(FuEngine *self,
+				  FuEngineRequest *request,
+				  FuDevice *device,
+				  GError **error)
+{
+	FuEngineReleasesCacheItem *item;
+	g_autofree gchar *fingerprint = fu_engine_releases_cache_fingerprint(request, device);
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GPtrArray) releases = NULL;
+
+	/* the silo, remotes, approved list and every device are unchanged */
+	item = g_hash_table_lookup(self->releases_cache, fingerprint);
+	if (item != NULL && item->generation == self->releases_generation) {
+		self->releases_cache_hits++;
+		g_debug("releases cache hit for %s [%u hits, %u misses]",
+			fu_device_get_id(device),
+			self->releases_cache_hits,
+			self->releases_cache_misses);
+		if (item->error != NULL) {
+			g_propagate_error(error, g_error_copy(item->error));
+			return NULL;
+		}
+		return fu_engine_releases_cache_copy(item->releases, request, error);
+	}
+	self->releases_cache_misses++;
+	g_debug("releases cache miss for %s [%u hits, %u misses]",
+		fu_device_get_id(device),
+		self->releases_cache_hits,
+		self->releases_cache_misses);
+
+	/* the device may be modified, e.g. FWUPD_DEVICE_FLAG_HAS_MULTIPLE_BRANCHES */
+	releases = fu_engine_get_releases_for_device_uncached(self, request, device, &error_local);
+	item = g_new0(FuEngineReleasesCacheItem, 1);
+	item->generation = self->releases_generation;
+	g_free(fingerprint);
+	fingerprint = fu_engine_releases_cache_fingerprint(request, device);
+	if (releases != NULL)
+		item->releases = g_ptr_array_ref(releases);
+	else
+		item->error = g_error_copy(error_local);
+	g_hash_table_insert(self->releases_cache, g_steal_pointer(&fingerprint), item);
+	if (releases == NULL) {
+		g_propagate_error(error, g_steal_pointer(&error_local));
+		return NULL;
+	}
+	return fu_engine_releases_cache_copy(releases, request, error);
+}
+
+guint
+fu_engine_get_releases_cache_hits(FuEngine *self)
+{
+	g_return_val_if_fail(FU_IS_ENGINE(self), 0);
+	return self->releases_cache_hits;
+}
+
 /**
  * fu_engine_search:
  * @self: a #FuEngine
@@ -6336,6 +6590,7 @@ fu_engine_add_approved_firmware(FuEngine *self, const gchar *checksum)
 		    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 	}
 	g_hash_table_add(self->approved_firmware, g_strdup(checksum));
+	fu_engine_releases_cache_invalidate(self);
 }
 
 gchar *
@@ -7187,6 +7442,73 @@ fu_engine_is_uid_trusted(FuEngine *self, guint64 calling_uid)
 	return FALSE;
 }
 
+/* the same few patterns are used by thousands of requirements in the metadata */
+#define FU_ENGINE_PATTERN_CACHE_MAX 1024
+
+gboolean
+fu_engine_regex_match(FuEngine *self, const gchar *pattern, const gchar *str, GError **error)
+{
+	GRegex *regex;
+
+	g_return_val_if_fail(FU_IS_ENGINE(self), FALSE);
+	g_return_val_if_fail(pattern != NULL, FALSE);
+	g_return_val_if_fail(str != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	regex = g_hash_table_lookup(self->regex_cache, pattern);
+	if (regex == NULL) {
+		g_autoptr(GError) error_local = NULL;
+		regex = g_regex_new(pattern, G_REGEX_OPTIMIZE, 0, &error_local);
+		if (regex == NULL) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "invalid regex [%s]: %s",
+				    pattern,
+				    error_local->message);
+			return FALSE;
+		}
+		if (g_hash_table_size(self->regex_cache) >= FU_ENGINE_PATTERN_CACHE_MAX)
+			g_hash_table_remove_all(self->regex_cache);
+		g_hash_table_insert(self->regex_cache, g_strdup(pattern), regex);
+	}
+	if (!g_regex_match(regex, str, 0, NULL)) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INTERNAL,
+			    "failed regex [%s %s]",
+			    pattern,
+			    str);
+		return FALSE;
+	}
+
+	/* success */
+	return TRUE;
+}
+
+gboolean
+fu_engine_glob_match(FuEngine *self, const gchar *pattern, const gchar *str)
+{
+	GPatternSpec *pspec;
+
+	g_return_val_if_fail(FU_IS_ENGINE(self), FALSE);
+	g_return_val_if_fail(pattern != NULL, FALSE);
+	g_return_val_if_fail(str != NULL, FALSE);
+
+	pspec = g_hash_table_lookup(self->glob_cache, pattern);
+	if (pspec == NULL) {
+		pspec = g_pattern_spec_new(pattern);
+		if (g_hash_table_size(self->glob_cache) >= FU_ENGINE_PATTERN_CACHE_MAX)
+			g_hash_table_remove_all(self->glob_cache);
+		g_hash_table_insert(self->glob_cache, g_strdup(pattern), pspec);
+	}
+#if GLIB_CHECK_VERSION(2, 70, 0)
+	return g_pattern_spec_match_string(pspec, str);
+#else
+	return g_pattern_match_string(pspec, str);
+#endif
+}
+
 gboolean
 fu_engine_plugin_allows_enumeration(FuEngine *self, FuPlugin *plugin)
 {
@@ -9508,6 +9830,7 @@ fu_engine_constructed(GObject *obj)
 	fu_config_set_default(config, "fwupd", "OnlyTrustPostQuantumSignatures", "false");
 	fu_config_set_default(config, "fwupd", "ShowDevicePrivate", "true");
 	fu_config_set_default(config, "fwupd", "TestDevices", "false");
+	fu_config_set_default(config, "fwupd", "TraceFile", NULL);
 	fu_config_set_default(config, "fwupd", "TrustedReports", "VendorId=$OEM");
 	fu_config_set_default(config, "fwupd", "TrustedUids", NULL);
 	fu_config_set_default(config, "fwupd", "UpdateMotd", "true");
@@ -9669,6 +9992,17 @@ fu_engine_init(FuEngine *self)
 	self->disabled_plugins = g_ptr_array_new_with_free_func(g_free);
 	self->trusted_uids = g_array_new(FALSE, FALSE, sizeof(guint64));
 	self->trusted_reports = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	self->regex_cache =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_regex_unref);
+	self->glob_cache = g_hash_table_new_full(g_str_hash,
+						 g_str_equal,
+						 g_free,
+						 (GDestroyNotify)g_pattern_spec_free);
+	self->releases_cache =
+	    g_hash_table_new_full(g_str_hash,
+				  g_str_equal,
+				  g_free,
+				  (GDestroyNotify)fu_engine_releases_cache_item_free);
 
 	/* register /org/freedesktop/fwupd globally */
 	g_resources_register(fu_get_resource());
@@ -9729,6 +10063,9 @@ fu_engine_finalize(GObject *obj)
 	g_ptr_array_unref(self->disabled_plugins);
 	g_ptr_array_unref(self->trusted_reports);
 	g_array_unref(self->trusted_uids);
+	g_hash_table_unref(self->regex_cache);
+	g_hash_table_unref(self->glob_cache);
+	g_hash_table_unref(self->releases_cache);
 
 	G_OBJECT_CLASS(fu_engine_parent_class)->finalize(obj);
 }
@@ -44,6 +44,12 @@ const gchar *
 fu_engine_get_host_machine_id(FuEngine *self) G_GNUC_NON_NULL(1);
 gboolean
 fu_engine_is_uid_trusted(FuEngine *self, guint64 calling_uid) G_GNUC_NON_NULL(1);
+gboolean
+fu_engine_regex_match(FuEngine *self, const gchar *pattern, const gchar *str, GError **error)
+    G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_engine_glob_match(FuEngine *self, const gchar *pattern, const gchar *str)
+    G_GNUC_NON_NULL(1, 2);
 gchar *
 fu_engine_get_host_security_id(FuEngine *self, const gchar *fwupd_version) G_GNUC_NON_NULL(1);
 FuCabinet *
@@ -232,6 +238,8 @@ fu_engine_load_release(FuEngine *self,
 		       GError **error) G_GNUC_NON_NULL(1, 2, 4);
 gchar *
 fu_engine_get_remote_id_for_stream(FuEngine *self, FuInputStream *stream) G_GNUC_NON_NULL(1, 2);
+guint
+fu_engine_get_releases_cache_hits(FuEngine *self) G_GNUC_NON_NULL(1);
 gboolean
 fu_engine_modify_bios_settings(FuEngine *self,
 			       GHashTable *settings,
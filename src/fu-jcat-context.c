@@ -21,14 +21,33 @@
 #include "fu-jcat-libcrypto-pkcs7-engine.h"
 #endif
 
+/* successful signature verifications are remembered for this many items */
+#define FU_JCAT_CONTEXT_VERIFY_CACHE_MAX 64
+
+/* ...and for this long, in seconds, so that certificate expiry is still noticed */
+#define FU_JCAT_CONTEXT_VERIFY_CACHE_TIMEOUT (60 * 60)
+
 struct _FuJcatContext {
 	GObject parent_instance;
 	GPtrArray *engines;
 	GPtrArray *public_keys;
 	gchar *keyring_path;
 	guint32 blob_kinds;
+	GHashTable *verify_cache; /* (element-type utf8 FuJcatContextVerifyCacheItem) */
 };
 
+typedef struct {
+	FuJcatResult *result;
+	gint64 ctime; /* wall clock, us */
+} FuJcatContextVerifyCacheItem;
+
+static void
+fu_jcat_context_verify_cache_item_free(FuJcatContextVerifyCacheItem *item)
+{
+	g_object_unref(item->result);
+	g_free(item);
+}
+
 G_DEFINE_TYPE(FuJcatContext, fu_jcat_context, G_TYPE_OBJECT)
 
 static void
@@ -36,6 +55,7 @@ fu_jcat_context_finalize(GObject *obj)
 {
 	FuJcatContext *self = FU_JCAT_CONTEXT(obj);
 	g_free(self->keyring_path);
+	g_hash_table_unref(self->verify_cache);
 	g_ptr_array_unref(self->engines);
 	g_ptr_array_unref(self->public_keys);
 	G_OBJECT_CLASS(fu_jcat_context_parent_class)->finalize(obj);
@@ -54,6 +74,11 @@ fu_jcat_context_init(FuJcatContext *self)
 	self->keyring_path = g_build_filename(g_get_user_data_dir(), PACKAGE_NAME, NULL);
 	self->engines = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	self->public_keys = g_ptr_array_new_with_free_func(g_free);
+	self->verify_cache =
+	    g_hash_table_new_full(g_str_hash,
+				  g_str_equal,
+				  g_free,
+				  (GDestroyNotify)fu_jcat_context_verify_cache_item_free);
 
 	g_ptr_array_add(self->engines, fu_jcat_sha256_engine_new(self));
 	g_ptr_array_add(self->engines, fu_jcat_sha512_engine_new(self));
@@ -90,6 +115,9 @@ fu_jcat_context_add_public_keys(FuJcatContext *self, const gchar *path)
 	}
 	while ((fn_tmp = g_dir_read_name(dir)) != NULL)
 		g_ptr_array_add(self->public_keys, g_build_filename(path, fn_tmp, NULL));
+
+	/* the keyring has changed */
+	fu_jcat_context_invalidate(self);
 }
 
 /* private */
@@ -99,6 +127,61 @@ fu_jcat_context_get_public_keys(FuJcatContext *self)
 	return self->public_keys;
 }
 
+/* private: called when the keys used by any engine have changed */
+void
+fu_jcat_context_invalidate(FuJcatContext *self)
+{
+	g_return_if_fail(FU_IS_JCAT_CONTEXT(self));
+	g_hash_table_remove_all(self->verify_cache);
+}
+
+static FuJcatResult *
+fu_jcat_context_pubkey_verify(FuJcatContext *self,
+			      FuJcatEngine *engine,
+			      GBytes *data,
+			      GBytes *blob_signature,
+			      FuJcatVerifyFlags flags,
+			      GError **error)
+{
+	FuJcatContextVerifyCacheItem *item;
+	g_autofree gchar *checksum_data = NULL;
+	g_autofree gchar *checksum_signature = NULL;
+	g_autofree gchar *key = NULL;
+	g_autoptr(FuJcatResult) result = NULL;
+
+	/* the same metadata and cabinet signatures are checked on every refresh and install */
+	checksum_data = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, data);
+	checksum_signature = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob_signature);
+	key = g_strdup_printf("%s:%s:%s:0x%x",
+			      fwupd_jcat_blob_kind_to_string(fu_jcat_engine_get_kind(engine)),
+			      checksum_data,
+			      checksum_signature,
+			      (guint)flags);
+	item = g_hash_table_lookup(self->verify_cache, key);
+	if (item != NULL) {
+		/* the monotonic clock stops during suspend, and the wall clock may go backwards */
+		gint64 age = g_get_real_time() - item->ctime;
+		if (age >= 0 &&
+		    age < (gint64)FU_JCAT_CONTEXT_VERIFY_CACHE_TIMEOUT * G_USEC_PER_SEC) {
+			g_debug("using cached verification result for %s", checksum_data);
+			return g_object_ref(item->result);
+		}
+		g_hash_table_remove(self->verify_cache, key);
+	}
+
+	/* only successes are cached */
+	result = fu_jcat_engine_pubkey_verify(engine, data, blob_signature, flags, error);
+	if (result == NULL)
+		return NULL;
+	if (g_hash_table_size(self->verify_cache) >= FU_JCAT_CONTEXT_VERIFY_CACHE_MAX)
+		g_hash_table_remove_all(self->verify_cache);
+	item = g_new0(FuJcatContextVerifyCacheItem, 1);
+	item->result = g_object_ref(result);
+	item->ctime = g_get_real_time();
+	g_hash_table_insert(self->verify_cache, g_steal_pointer(&key), item);
+	return g_steal_pointer(&result);
+}
+
 /**
  * fu_jcat_context_set_keyring_path:
  * @self: #FuJcatContext
@@ -215,7 +298,7 @@ fu_jcat_context_verify_blob(FuJcatContext *self,
 	}
 	if (fu_jcat_engine_get_method(engine) == FWUPD_JCAT_BLOB_METHOD_CHECKSUM)
 		return fu_jcat_engine_self_verify(engine, data, blob_signature, flags, error);
-	return fu_jcat_engine_pubkey_verify(engine, data, blob_signature, flags, error);
+	return fu_jcat_context_pubkey_verify(self, engine, data, blob_signature, flags, error);
 }
 
 /**
@@ -328,11 +411,12 @@ fu_jcat_context_verify_item(FuJcatContext *self,
 		}
 		if (fu_jcat_engine_get_method(engine) != FWUPD_JCAT_BLOB_METHOD_SIGNATURE)
 			continue;
-		result = fu_jcat_engine_pubkey_verify(engine,
-						      data,
-						      fwupd_jcat_blob_get_data(blob),
-						      flags,
-						      &error_local);
+		result = fu_jcat_context_pubkey_verify(self,
+						       engine,
+						       data,
+						       fwupd_jcat_blob_get_data(blob),
+						       flags,
+						       &error_local);
 		if (result == NULL) {
 			g_debug("signature failure: %s", error_local->message);
 			continue;
@@ -488,11 +572,12 @@ fu_jcat_context_verify_target(FuJcatContext *self,
 				error_local->message);
 			continue;
 		}
-		result = fu_jcat_engine_pubkey_verify(engine,
-						      fwupd_jcat_blob_get_data(blob_target),
-						      fwupd_jcat_blob_get_data(blob),
-						      flags,
-						      &error_local);
+		result = fu_jcat_context_pubkey_verify(self,
+						       engine,
+						       fwupd_jcat_blob_get_data(blob_target),
+						       fwupd_jcat_blob_get_data(blob),
+						       flags,
+						       &error_local);
 		if (result == NULL) {
 			g_debug("signature failure: %s", error_local->message);
 			continue;
@@ -52,5 +52,7 @@ void
 fu_jcat_context_allow_blob_kind(FuJcatContext *self, FwupdJcatBlobKind kind) G_GNUC_NON_NULL(1);
 GPtrArray *
 fu_jcat_context_get_public_keys(FuJcatContext *self) G_GNUC_NON_NULL(1);
+void
+fu_jcat_context_invalidate(FuJcatContext *self) G_GNUC_NON_NULL(1);
 
 G_END_DECLS
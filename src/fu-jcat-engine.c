@@ -14,6 +14,7 @@ typedef struct {
 	FwupdJcatBlobKind kind;
 	FwupdJcatBlobMethod method;
 	gboolean done_setup;
+	guint public_keys_loaded;
 } FuJcatEnginePrivate;
 
 static void
@@ -51,10 +52,6 @@ fu_jcat_engine_setup(FuJcatEngine *self, GError **error)
 
 	g_return_val_if_fail(FU_IS_JCAT_ENGINE(self), FALSE);
 
-	/* already done */
-	if (priv->done_setup)
-		return TRUE;
-
 	/* sanity check */
 	if (priv->context == NULL) {
 		g_set_error_literal(error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL, "no context");
@@ -62,21 +59,24 @@ fu_jcat_engine_setup(FuJcatEngine *self, GError **error)
 	}
 
 	/* optional */
-	if (klass->setup != NULL) {
+	if (!priv->done_setup && klass->setup != NULL) {
 		if (!klass->setup(self, error))
 			return FALSE;
 	}
+	priv->done_setup = TRUE;
+
+	/* only load the public keys added to the context since last time */
 	if (klass->add_public_key != NULL) {
 		GPtrArray *fns = fu_jcat_context_get_public_keys(priv->context);
-		for (guint i = 0; i < fns->len; i++) {
+		for (guint i = priv->public_keys_loaded; i < fns->len; i++) {
 			const gchar *fn = g_ptr_array_index(fns, i);
 			if (!klass->add_public_key(self, fn, error))
 				return FALSE;
+			priv->public_keys_loaded = i + 1;
 		}
 	}
 
 	/* success */
-	priv->done_setup = TRUE;
 	return TRUE;
 }
 
@@ -231,6 +231,7 @@ gboolean
 fu_jcat_engine_add_public_key_raw(FuJcatEngine *self, GBytes *blob, GError **error)
 {
 	FuJcatEngineClass *klass = FU_JCAT_ENGINE_GET_CLASS(self);
+	FuJcatEnginePrivate *priv = GET_PRIVATE(self);
 	g_return_val_if_fail(FU_IS_JCAT_ENGINE(self), FALSE);
 	g_return_val_if_fail(blob != NULL, FALSE);
 	if (klass->add_public_key_raw == NULL) {
@@ -242,7 +243,10 @@ fu_jcat_engine_add_public_key_raw(FuJcatEngine *self, GBytes *blob, GError **err
 	}
 	if (!fu_jcat_engine_setup(self, error))
 		return FALSE;
-	return klass->add_public_key_raw(self, blob, error);
+	if (!klass->add_public_key_raw(self, blob, error))
+		return FALSE;
+	fu_jcat_context_invalidate(priv->context);
+	return TRUE;
 }
 
 /**
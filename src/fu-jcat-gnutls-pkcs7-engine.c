@@ -17,7 +17,9 @@
 
 struct _FuJcatGnutlsPkcs7Engine {
 	FuJcatEngine parent_instance;
-	GPtrArray *pubkeys_crts; /* element-type gnutls_x509_crt_t */
+	GPtrArray *pubkeys_crts;	/* element-type gnutls_x509_crt_t */
+	gnutls_x509_trust_list_t tl;	/* nullable, built from pubkeys_crts */
+	gnutls_x509_trust_list_t tl_pq; /* nullable, built from pubkeys_crts */
 };
 
 G_DEFINE_TYPE(FuJcatGnutlsPkcs7Engine, fu_jcat_gnutls_pkcs7_engine, FU_TYPE_JCAT_ENGINE)
@@ -51,6 +53,10 @@ fu_jcat_gnutls_pkcs7_engine_add_pubkey_blob_fmt(FuJcatGnutlsPkcs7Engine *self,
 		return FALSE;
 	}
 	g_ptr_array_add(self->pubkeys_crts, g_steal_pointer(&crt));
+
+	/* rebuild the trust lists the next time they are needed */
+	g_clear_pointer(&self->tl, _gnutls_x509_trust_list_deinit);
+	g_clear_pointer(&self->tl_pq, _gnutls_x509_trust_list_deinit);
 	return TRUE;
 }
 
@@ -154,6 +160,42 @@ fu_jcat_gnutls_pkcs7_engine_build_trust_list_only_pq(FuJcatGnutlsPkcs7Engine *se
 }
 #endif
 
+/* the trust list is only rebuilt when a public key is added */
+static gnutls_x509_trust_list_t
+fu_jcat_gnutls_pkcs7_engine_ensure_trust_list(FuJcatGnutlsPkcs7Engine *self, GError **error)
+{
+	g_auto(gnutls_x509_trust_list_t) tl = NULL;
+
+	if (self->tl != NULL)
+		return self->tl;
+	tl = fu_jcat_gnutls_pkcs7_engine_build_trust_list(self, error);
+	if (tl == NULL)
+		return NULL;
+	if (!fu_jcat_gnutls_ensure_trust_list_valid(tl, error))
+		return NULL;
+	self->tl = g_steal_pointer(&tl);
+	return self->tl;
+}
+
+#ifdef HAVE_GNUTLS_PQC
+static gnutls_x509_trust_list_t
+fu_jcat_gnutls_pkcs7_engine_ensure_trust_list_only_pq(FuJcatGnutlsPkcs7Engine *self,
+						      GError **error)
+{
+	g_auto(gnutls_x509_trust_list_t) tl = NULL;
+
+	if (self->tl_pq != NULL)
+		return self->tl_pq;
+	tl = fu_jcat_gnutls_pkcs7_engine_build_trust_list_only_pq(self, error);
+	if (tl == NULL)
+		return NULL;
+	if (!fu_jcat_gnutls_ensure_trust_list_valid(tl, error))
+		return NULL;
+	self->tl_pq = g_steal_pointer(&tl);
+	return self->tl_pq;
+}
+#endif
+
 /* verifies a detached signature just like:
  *  `certtool --p7-verify --load-certificate client.pem --infile=test.p7b` */
 static FuJcatResult *
@@ -224,11 +266,11 @@ fu_jcat_gnutls_pkcs7_engine_verify(FuJcatEngine *engine,
 		if (crt != NULL) {
 			rc = gnutls_pkcs7_verify_direct(pkcs7, crt, i, &datum, verify_flags);
 		} else {
-			g_auto(gnutls_x509_trust_list_t) tl = NULL;
+			gnutls_x509_trust_list_t tl;
 			if (flags & FU_JCAT_VERIFY_FLAG_ONLY_PQ) {
 #ifdef HAVE_GNUTLS_PQC
-				tl = fu_jcat_gnutls_pkcs7_engine_build_trust_list_only_pq(self,
-											  error);
+				tl = fu_jcat_gnutls_pkcs7_engine_ensure_trust_list_only_pq(self,
+											   error);
 				if (tl == NULL)
 					return NULL;
 #else
@@ -239,12 +281,10 @@ fu_jcat_gnutls_pkcs7_engine_verify(FuJcatEngine *engine,
 				return NULL;
 #endif
 			} else {
-				tl = fu_jcat_gnutls_pkcs7_engine_build_trust_list(self, error);
+				tl = fu_jcat_gnutls_pkcs7_engine_ensure_trust_list(self, error);
 				if (tl == NULL)
 					return NULL;
 			}
-			if (!fu_jcat_gnutls_ensure_trust_list_valid(tl, error))
-				return NULL;
 			rc = gnutls_pkcs7_verify(pkcs7,
 						 tl,
 						 NULL,	 /* vdata */
@@ -510,6 +550,10 @@ static void
 fu_jcat_gnutls_pkcs7_engine_finalize(GObject *object)
 {
 	FuJcatGnutlsPkcs7Engine *self = FU_JCAT_GNUTLS_PKCS7_ENGINE(object);
+	if (self->tl != NULL)
+		_gnutls_x509_trust_list_deinit(self->tl);
+	if (self->tl_pq != NULL)
+		_gnutls_x509_trust_list_deinit(self->tl_pq);
 	g_ptr_array_unref(self->pubkeys_crts);
 	G_OBJECT_CLASS(fu_jcat_gnutls_pkcs7_engine_parent_class)->finalize(object);
 }
@@ -413,6 +413,13 @@ fu_jcat_context_verify_blob_func(void)
 	g_autoptr(FuJcatEngine) engine3 = NULL;
 	g_autoptr(FuJcatEngine) engine4 = NULL;
 	g_autoptr(FuJcatResult) result = NULL;
+	g_autoptr(FuJcatResult) result_bad = NULL;
+	g_autoptr(FuJcatResult) result_cached = NULL;
+	g_autoptr(FuJcatResult) result_rekeyed = NULL;
+	g_autofree gchar *fn_cert = NULL;
+	g_autoptr(GBytes) data_cert = NULL;
+	g_autoptr(GBytes) data_fwbin_bad = NULL;
+	gboolean ret;
 
 	/* set up context */
 	pki_dir = g_test_build_filename(G_TEST_DIST, "tests", "pki", NULL);
@@ -453,6 +460,42 @@ fu_jcat_context_verify_blob_func(void)
 	g_assert_cmpstr(fu_jcat_result_get_authority(result),
 			==,
 			"O=Linux Vendor Firmware Project,CN=LVFS CA");
+
+	/* the same data and signature is not verified again */
+	result_cached = fu_jcat_context_verify_blob(context,
+						    data_fwbin,
+						    blob,
+						    FU_JCAT_VERIFY_FLAG_DISABLE_TIME_CHECKS,
+						    &error);
+	g_assert_no_error(error);
+	g_assert_true(result_cached == result);
+
+	/* adding a key drops the cached result */
+	fn_cert = g_test_build_filename(G_TEST_DIST, "tests", "pki", "test.pem", NULL);
+	data_cert = fu_bytes_get_contents(fn_cert, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(data_cert);
+	ret = fu_jcat_engine_add_public_key_raw(engine3, data_cert, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	result_rekeyed = fu_jcat_context_verify_blob(context,
+						     data_fwbin,
+						     blob,
+						     FU_JCAT_VERIFY_FLAG_DISABLE_TIME_CHECKS,
+						     &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(result_rekeyed);
+	g_assert_true(result_rekeyed != result);
+
+	/* different data with the same signature is */
+	data_fwbin_bad = g_bytes_new_static("hello world", 11);
+	result_bad = fu_jcat_context_verify_blob(context,
+						 data_fwbin_bad,
+						 blob,
+						 FU_JCAT_VERIFY_FLAG_DISABLE_TIME_CHECKS,
+						 &error);
+	g_assert_nonnull(error);
+	g_assert_null(result_bad);
 }
 
 static void
@@ -34,6 +34,7 @@ struct _FuRelease {
 	GPtrArray *soft_reqs; /* nullable, element-type XbNode */
 	GPtrArray *hard_reqs; /* nullable, element-type XbNode */
 	guint64 priority;
+	FuVersionKey *version_key; /* nullable */
 };
 
 G_DEFINE_TYPE(FuRelease, fu_release, FWUPD_TYPE_RELEASE)
@@ -1384,6 +1385,33 @@ fu_release_get_action_id(FuRelease *self)
 	return "org.freedesktop.fwupd.update-internal";
 }
 
+/**
+ * fu_release_get_version_key:
+ * @self: a #FuRelease
+ * @fmt: a version format, e.g. %FWUPD_VERSION_FORMAT_TRIPLET
+ *
+ * Gets the release version split and normalized using @fmt. The key is cached, and only
+ * rebuilt if the release version or @fmt changes.
+ *
+ * Returns: (transfer full): a #FuVersionKey
+ **/
+FuVersionKey *
+fu_release_get_version_key(FuRelease *self, FwupdVersionFormat fmt)
+{
+	const gchar *version;
+
+	g_return_val_if_fail(FU_IS_RELEASE(self), NULL);
+
+	version = fu_release_get_version(self);
+	if (self->version_key == NULL || fu_version_key_get_format(self->version_key) != fmt ||
+	    g_strcmp0(fu_version_key_get_version(self->version_key), version) != 0) {
+		if (self->version_key != NULL)
+			fu_version_key_unref(self->version_key);
+		self->version_key = fu_version_key_new(version, fmt);
+	}
+	return fu_version_key_ref(self->version_key);
+}
+
 /**
  * fu_release_compare:
  * @release1: first task to compare.
@@ -1398,6 +1426,9 @@ fu_release_compare(FuRelease *release1, FuRelease *release2)
 {
 	FuDevice *device1 = fu_release_get_device(release1);
 	FuDevice *device2 = fu_release_get_device(release2);
+	FwupdVersionFormat fmt = FWUPD_VERSION_FORMAT_UNKNOWN;
+	g_autoptr(FuVersionKey) key1 = NULL;
+	g_autoptr(FuVersionKey) key2 = NULL;
 
 	/* device order, lower is better */
 	if (device1 != NULL && device2 != NULL && device1 != device2) {
@@ -1424,10 +1455,11 @@ fu_release_compare(FuRelease *release1, FuRelease *release2)
 	}
 
 	/* FWUPD_DEVICE_FLAG_INSTALL_ALL_RELEASES has to be from oldest to newest */
-	return fu_version_compare(fu_release_get_version(release1),
-				  fu_release_get_version(release2),
-				  device1 != NULL ? fu_device_get_version_format(device1)
-						  : FWUPD_VERSION_FORMAT_UNKNOWN);
+	if (device1 != NULL)
+		fmt = fu_device_get_version_format(device1);
+	key1 = fu_release_get_version_key(release1, fmt);
+	key2 = fu_release_get_version_key(release2, fmt);
+	return fu_version_key_compare(key1, key2);
 }
 
 static void
@@ -1458,6 +1490,8 @@ fu_release_finalize(GObject *obj)
 		g_ptr_array_unref(self->soft_reqs);
 	if (self->hard_reqs != NULL)
 		g_ptr_array_unref(self->hard_reqs);
+	if (self->version_key != NULL)
+		fu_version_key_unref(self->version_key);
 
 	G_OBJECT_CLASS(fu_release_parent_class)->finalize(obj);
 }
@@ -1476,3 +1510,44 @@ fu_release_new(void)
 	self = g_object_new(FU_TYPE_RELEASE, NULL);
 	return FU_RELEASE(self);
 }
+
+/**
+ * fu_release_copy:
+ * @self: a #FuRelease
+ * @error: (nullable): optional return location for an error
+ *
+ * Makes a copy of the release so that it can be modified, e.g. using fu_release_set_request(),
+ * without affecting @self.
+ *
+ * Returns: (transfer full): a #FuRelease, or %NULL on error
+ **/
+FuRelease *
+fu_release_copy(FuRelease *self, GError **error)
+{
+	g_autoptr(FuRelease) new = fu_release_new();
+	g_autoptr(GVariant) value = NULL;
+
+	g_return_val_if_fail(FU_IS_RELEASE(self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* FwupdRelease */
+	value = fwupd_codec_to_variant(FWUPD_CODEC(self), FWUPD_CODEC_FLAG_TRUSTED);
+	if (!fwupd_codec_from_variant(FWUPD_CODEC(new), value, error))
+		return NULL;
+
+	/* FuRelease, avoiding the side effects of the setters */
+	g_set_object(&new->request, self->request);
+	g_set_object(&new->device, self->device);
+	g_set_object(&new->remote, self->remote);
+	g_set_object(&new->config, self->config);
+	g_set_object(&new->stream, self->stream);
+	new->update_request_id = g_strdup(self->update_request_id);
+	new->device_version_old = g_strdup(self->device_version_old);
+	new->firmware_basename = g_strdup(self->firmware_basename);
+	new->priority = self->priority;
+	if (self->soft_reqs != NULL)
+		new->soft_reqs = g_ptr_array_ref(self->soft_reqs);
+	if (self->hard_reqs != NULL)
+		new->hard_reqs = g_ptr_array_ref(self->hard_reqs);
+	return g_steal_pointer(&new);
+}
@@ -18,6 +18,8 @@ G_DECLARE_FINAL_TYPE(FuRelease, fu_release, FU, RELEASE, FwupdRelease)
 
 FuRelease *
 fu_release_new(void);
+FuRelease *
+fu_release_copy(FuRelease *self, GError **error) G_GNUC_NON_NULL(1);
 
 #define fu_release_get_appstream_id(r)	 fwupd_release_get_appstream_id(FWUPD_RELEASE(r))
 #define fu_release_get_filename(r)	 fwupd_release_get_filename(FWUPD_RELEASE(r))
@@ -100,6 +102,8 @@ const gchar *
 fu_release_get_action_id(FuRelease *self) G_GNUC_NON_NULL(1);
 gint
 fu_release_compare(FuRelease *release1, FuRelease *release2) G_GNUC_NON_NULL(1, 2);
+FuVersionKey *
+fu_release_get_version_key(FuRelease *self, FwupdVersionFormat fmt) G_GNUC_NON_NULL(1);
 void
 fu_release_set_priority(FuRelease *self, guint64 priority) G_GNUC_NON_NULL(1);
 guint64
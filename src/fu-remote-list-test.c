@@ -8,6 +8,120 @@
 
 #include "fu-context-private.h"
 #include "fu-remote-list.h"
+#include "fu-test.h"
+
+typedef struct {
+	guint cnt;
+	gchar **remote_ids;
+} FuRemoteListChangedHelper;
+
+static void
+fu_remote_list_changed_cb(FuRemoteList *remote_list, GStrv remote_ids, gpointer user_data)
+{
+	FuRemoteListChangedHelper *helper = (FuRemoteListChangedHelper *)user_data;
+	helper->cnt++;
+	g_strfreev(helper->remote_ids);
+	helper->remote_ids = g_strdupv(remote_ids);
+	fu_test_loop_quit();
+}
+
+static void
+fu_remote_list_write_remote(const gchar *filename, const gchar *title, const gchar *order_after)
+{
+	gboolean ret;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GString) str = g_string_new(NULL);
+
+	g_string_append_printf(str,
+			       "[fwupd Remote]\n"
+			       "Enabled=false\n"
+			       "Title=%s\n"
+			       "MetadataURI=http://localhost/stable.xml.gz\n",
+			       title);
+	if (order_after != NULL)
+		g_string_append_printf(str, "OrderAfter=%s\n", order_after);
+	ret = g_file_set_contents(filename, str->str, -1, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+}
+
+static void
+fu_remote_list_monitor_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *fn_bar = NULL;
+	g_autofree gchar *fn_foo = NULL;
+	g_autofree gchar *testdatadir = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new();
+	g_autoptr(FuRemoteList) remote_list = NULL;
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(FwupdRemote) remote = NULL;
+	g_autoptr(FwupdRemote) remote_bar = NULL;
+	g_autoptr(GError) error = NULL;
+	FuRemoteListChangedHelper helper = {0};
+
+	/* set up test harness */
+	tmpdir = fu_temporary_directory_new("remote-list-monitor", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	testdatadir = g_test_build_filename(G_TEST_DIST, "tests", NULL);
+	fu_context_set_path(ctx, FU_PATH_KIND_DATADIR_PKG, testdatadir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_CACHEDIR_PKG, tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_LOCALSTATEDIR_PKG, tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_LOCALSTATEDIR_METADATA, tmpdir);
+	fu_config_set_default(fu_context_get_config(ctx), "fwupd", "TestDevices", "false");
+	fn_foo = fu_temporary_directory_build(tmpdir, "remotes.d", "foo.conf", NULL);
+	fn_bar = fu_temporary_directory_build(tmpdir, "remotes.d", "bar.conf", NULL);
+	ret = fu_path_mkdir_parent(fn_foo, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fu_remote_list_write_remote(fn_foo, "Foo", "bar");
+	fu_remote_list_write_remote(fn_bar, "Bar", NULL);
+	remote_list = fu_remote_list_new(ctx);
+	ret = fu_remote_list_load(remote_list, FU_CONTEXT_LOAD_FLAG_NONE, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	remote_bar = fu_remote_list_get_by_id(remote_list, "bar", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(remote_bar);
+	g_assert_cmpint(fwupd_remote_get_priority(remote_bar), ==, 1);
+	g_signal_connect(FU_REMOTE_LIST(remote_list),
+			 "changed",
+			 G_CALLBACK(fu_remote_list_changed_cb),
+			 &helper);
+
+	/* both changes are coalesced into one reload of just those remotes */
+	fu_remote_list_write_remote(fn_foo, "Foo2", "bar");
+	fu_remote_list_write_remote(fn_bar, "Bar2", NULL);
+	fu_test_loop_run_with_timeout(5000);
+	fu_test_loop_quit();
+	g_assert_cmpint(helper.cnt, ==, 1);
+	g_assert_nonnull(helper.remote_ids);
+	g_assert_cmpint(g_strv_length(helper.remote_ids), ==, 2);
+	g_assert_true(g_strv_contains((const gchar *const *)helper.remote_ids, "foo"));
+	g_assert_true(g_strv_contains((const gchar *const *)helper.remote_ids, "bar"));
+	remote = fu_remote_list_get_by_id(remote_list, "foo", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(remote);
+	g_assert_cmpstr(fwupd_remote_get_title(remote), ==, "Foo2");
+	g_strfreev(helper.remote_ids);
+	helper.remote_ids = NULL;
+
+	/* only foo is parsed again, but the OrderAfter it no longer has is not kept */
+	fu_remote_list_write_remote(fn_foo, "Foo3", NULL);
+	fu_test_loop_run_with_timeout(5000);
+	fu_test_loop_quit();
+	g_assert_cmpint(helper.cnt, ==, 2);
+	g_assert_nonnull(helper.remote_ids);
+	g_assert_cmpint(g_strv_length(helper.remote_ids), ==, 1);
+	g_assert_cmpstr(helper.remote_ids[0], ==, "foo");
+	g_clear_object(&remote_bar);
+	remote_bar = fu_remote_list_get_by_id(remote_list, "bar", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(remote_bar);
+	g_assert_cmpint(fwupd_remote_get_priority(remote_bar), ==, 0);
+	g_strfreev(helper.remote_ids);
+}
 
 static void
 fu_remote_list_repair_func(void)
@@ -69,5 +183,6 @@ main(int argc, char **argv)
 	(void)g_setenv("G_TEST_SRCDIR", SRCDIR, FALSE);
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/remote-list/repair", fu_remote_list_repair_func);
+	g_test_add_func("/fwupd/remote-list/monitor", fu_remote_list_monitor_func);
 	return g_test_run();
 }
@@ -23,6 +23,9 @@
 #include "fu-remote-list.h"
 #include "fu-remote.h"
 
+/* coalesce the file monitor events when config management rewrites many remotes at once */
+#define FU_REMOTE_LIST_CHANGED_DELAY 500 /* ms */
+
 enum { SIGNAL_CHANGED, SIGNAL_ADDED, SIGNAL_LAST };
 
 static guint signals[SIGNAL_LAST] = {0};
@@ -35,8 +38,11 @@ fu_remote_list_finalize(GObject *obj);
 struct _FuRemoteList {
 	GObject parent_instance;
 	FuContext *ctx;
-	GPtrArray *array;    /* (element-type FwupdRemote) */
-	GPtrArray *monitors; /* (element-type GFileMonitor) */
+	GPtrArray *array;	   /* (element-type FwupdRemote) */
+	GHashTable *monitors;	   /* (element-type utf8 GFileMonitor) */
+	GHashTable *changed_paths; /* (element-type utf8) */
+	GHashTable *priorities;	   /* (element-type utf8 gint) */
+	guint changed_id;
 	gboolean testing_remote;
 	gboolean fix_metadata_uri;
 	XbSilo *silo;
@@ -47,10 +53,13 @@ struct _FuRemoteList {
 G_DEFINE_TYPE(FuRemoteList, fu_remote_list, G_TYPE_OBJECT)
 
 static void
-fu_remote_list_emit_changed(FuRemoteList *self)
+fu_remote_list_emit_changed(FuRemoteList *self, GStrv remote_ids)
 {
-	g_debug("::remote_list changed");
-	g_signal_emit(self, signals[SIGNAL_CHANGED], 0);
+	g_autofree gchar *str = NULL;
+	if (remote_ids != NULL)
+		str = g_strjoinv(",", remote_ids);
+	g_debug("::remote_list changed: %s", str != NULL ? str : "all");
+	g_signal_emit(self, signals[SIGNAL_CHANGED], 0, remote_ids);
 }
 
 static void
@@ -71,6 +80,9 @@ fu_remote_list_set_lvfs_metadata_format(FuRemoteList *self, const gchar *lvfs_me
 	self->lvfs_metadata_format = g_strdup(lvfs_metadata_format);
 }
 
+static gboolean
+fu_remote_list_changed_cb(gpointer user_data);
+
 static void
 fu_remote_list_monitor_changed_cb(GFileMonitor *monitor,
 				  GFile *file,
@@ -79,17 +91,19 @@ fu_remote_list_monitor_changed_cb(GFileMonitor *monitor,
 				  gpointer user_data)
 {
 	FuRemoteList *self = FU_REMOTE_LIST(user_data);
-	g_autoptr(GError) error = NULL;
 	g_autofree gchar *filename = g_file_get_path(file);
 
 	/* ignore permission changes */
 	if (event_type == G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED)
 		return;
 
-	g_info("%s changed, reloading all remotes", filename);
-	if (!fu_remote_list_reload(self, &error))
-		g_warning("failed to rescan remotes: %s", error->message);
-	fu_remote_list_emit_changed(self);
+	/* process everything that changed in the same window in one go */
+	g_debug("%s changed, scheduling reload", filename);
+	g_hash_table_add(self->changed_paths, g_steal_pointer(&filename));
+	if (self->changed_id == 0) {
+		self->changed_id =
+		    g_timeout_add(FU_REMOTE_LIST_CHANGED_DELAY, fu_remote_list_changed_cb, self);
+	}
 }
 
 /* GLib only returns the very unhelpful "Unable to find default local file monitor type"
@@ -127,9 +141,14 @@ static gboolean
 fu_remote_list_add_inotify(FuRemoteList *self, const gchar *filename, GError **error)
 {
 	GFileMonitor *monitor;
-	g_autoptr(GFile) file = g_file_new_for_path(filename);
+	g_autoptr(GFile) file = NULL;
+
+	/* already watched, e.g. when the remote is reloaded */
+	if (g_hash_table_contains(self->monitors, filename))
+		return TRUE;
 
 	/* set up a notify watch */
+	file = g_file_new_for_path(filename);
 	monitor = g_file_monitor(file, G_FILE_MONITOR_NONE, NULL, error);
 	if (monitor == NULL) {
 		fu_remote_list_fixup_inotify_error(error);
@@ -139,7 +158,7 @@ fu_remote_list_add_inotify(FuRemoteList *self, const gchar *filename, GError **e
 			 "changed",
 			 G_CALLBACK(fu_remote_list_monitor_changed_cb),
 			 self);
-	g_ptr_array_add(self->monitors, monitor);
+	g_hash_table_insert(self->monitors, g_strdup(filename), monitor);
 	return TRUE;
 }
 
@@ -267,6 +286,13 @@ fu_remote_list_add_remote(FuRemoteList *self, FwupdRemote *remote)
 	g_return_if_fail(FWUPD_IS_REMOTE(remote));
 	fu_remote_list_emit_added(self, remote);
 	g_ptr_array_add(self->array, g_object_ref(remote));
+
+	/* the priority before any OrderBefore or OrderAfter was applied */
+	if (fwupd_remote_get_id(remote) != NULL) {
+		g_hash_table_insert(self->priorities,
+				    g_strdup(fwupd_remote_get_id(remote)),
+				    GINT_TO_POINTER(fwupd_remote_get_priority(remote)));
+	}
 }
 
 static gboolean
@@ -452,6 +478,7 @@ fu_remote_list_set_key_value(FuRemoteList *self,
 			     GError **error)
 {
 	const gchar *filename;
+	const gchar *remote_ids[] = {remote_id, NULL};
 	g_autofree gchar *filename_new = NULL;
 	g_autofree gchar *value_old = NULL;
 	g_autoptr(FwupdRemote) remote = NULL;
@@ -505,7 +532,7 @@ fu_remote_list_set_key_value(FuRemoteList *self,
 		g_prefix_error(error, "failed to load %s: ", filename_new);
 		return FALSE;
 	}
-	fu_remote_list_emit_changed(self);
+	fu_remote_list_emit_changed(self, (GStrv)remote_ids);
 	return TRUE;
 }
 
@@ -592,33 +619,21 @@ fu_remote_list_depsolve_order_after(FuRemoteList *self)
 }
 
 static gboolean
-fu_remote_list_reload(FuRemoteList *self, GError **error)
+fu_remote_list_depsolve(FuRemoteList *self, GError **error)
 {
 	guint depsolve_check;
-	const gchar *remotesdir;
-	const gchar *remotesdir_mut;
-	const gchar *remotesdir_immut;
 	g_autoptr(GString) str = g_string_new(NULL);
 
-	/* clear */
-	g_ptr_array_set_size(self->array, 0);
-	g_ptr_array_set_size(self->monitors, 0);
-
-	/* search mutable, and then fall back to /etc and immutable */
-	remotesdir_mut = fu_context_get_path(self->ctx, FU_PATH_KIND_LOCALSTATEDIR_PKG, NULL);
-	if (remotesdir_mut != NULL) {
-		if (!fu_remote_list_add_for_path(self, remotesdir_mut, error))
-			return FALSE;
-	}
-	remotesdir = fu_context_get_path(self->ctx, FU_PATH_KIND_SYSCONFDIR_PKG, NULL);
-	if (remotesdir != NULL) {
-		if (!fu_remote_list_add_for_path(self, remotesdir, error))
-			return FALSE;
-	}
-	remotesdir_immut = fu_context_get_path(self->ctx, FU_PATH_KIND_DATADIR_PKG, NULL);
-	if (remotesdir_immut != NULL) {
-		if (!fu_remote_list_add_for_path(self, remotesdir_immut, error))
-			return FALSE;
+	/* undo any ordering from the last depsolve as only some remotes may have been reloaded */
+	for (guint i = 0; i < self->array->len; i++) {
+		FwupdRemote *remote = g_ptr_array_index(self->array, i);
+		gpointer priority = NULL;
+		if (!g_hash_table_lookup_extended(self->priorities,
+						  fwupd_remote_get_id(remote),
+						  NULL,
+						  &priority))
+			continue;
+		fwupd_remote_set_priority(remote, GPOINTER_TO_INT(priority));
 	}
 
 	/* depsolve */
@@ -658,6 +673,151 @@ fu_remote_list_reload(FuRemoteList *self, GError **error)
 	return TRUE;
 }
 
+static gboolean
+fu_remote_list_reload(FuRemoteList *self, GError **error)
+{
+	const gchar *remotesdir;
+	const gchar *remotesdir_mut;
+	const gchar *remotesdir_immut;
+
+	/* clear */
+	g_ptr_array_set_size(self->array, 0);
+	g_hash_table_remove_all(self->monitors);
+	g_hash_table_remove_all(self->changed_paths);
+	g_hash_table_remove_all(self->priorities);
+
+	/* search mutable, and then fall back to /etc and immutable */
+	remotesdir_mut = fu_context_get_path(self->ctx, FU_PATH_KIND_LOCALSTATEDIR_PKG, NULL);
+	if (remotesdir_mut != NULL) {
+		if (!fu_remote_list_add_for_path(self, remotesdir_mut, error))
+			return FALSE;
+	}
+	remotesdir = fu_context_get_path(self->ctx, FU_PATH_KIND_SYSCONFDIR_PKG, NULL);
+	if (remotesdir != NULL) {
+		if (!fu_remote_list_add_for_path(self, remotesdir, error))
+			return FALSE;
+	}
+	remotesdir_immut = fu_context_get_path(self->ctx, FU_PATH_KIND_DATADIR_PKG, NULL);
+	if (remotesdir_immut != NULL) {
+		if (!fu_remote_list_add_for_path(self, remotesdir_immut, error))
+			return FALSE;
+	}
+	return fu_remote_list_depsolve(self, error);
+}
+
+static void
+fu_remote_list_add_changed_id(GPtrArray *remote_ids, const gchar *remote_id)
+{
+	if (g_ptr_array_find_with_equal_func(remote_ids, remote_id, g_str_equal, NULL))
+		return;
+	g_ptr_array_add(remote_ids, g_strdup(remote_id));
+}
+
+static gboolean
+fu_remote_list_reload_filename(FuRemoteList *self,
+			       const gchar *filename,
+			       GPtrArray *remote_ids,
+			       GError **error)
+{
+	for (guint i = 0; i < self->array->len; i++) {
+		FwupdRemote *remote = g_ptr_array_index(self->array, i);
+		g_autofree gchar *remote_id = g_strdup(fwupd_remote_get_id(remote));
+
+		/* the metadata was downloaded again, the remote itself is unchanged */
+		if (g_strcmp0(filename, fwupd_remote_get_filename_cache(remote)) == 0) {
+			if (!fwupd_remote_ensure_mtime(remote, error))
+				return FALSE;
+			fu_remote_list_add_changed_id(remote_ids, remote_id);
+			return TRUE;
+		}
+
+		/* just parse this one file again */
+		if (g_strcmp0(filename, fwupd_remote_get_filename_source(remote)) == 0) {
+			g_autoptr(FwupdRemote) remote_new = NULL;
+
+			if (!g_file_test(filename, G_FILE_TEST_EXISTS)) {
+				g_set_error(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_NOT_SUPPORTED,
+					    "%s was removed",
+					    filename);
+				return FALSE;
+			}
+			g_ptr_array_remove_index(self->array, i);
+			if (!fu_remote_list_add_for_file(self, filename, error))
+				return FALSE;
+
+			/* a remote with the old ID may be shadowed in a different directory */
+			remote_new = fu_remote_list_get_by_id(self, remote_id, NULL);
+			if (remote_new == NULL) {
+				g_set_error(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_NOT_SUPPORTED,
+					    "%s no longer provides %s",
+					    filename,
+					    remote_id);
+				return FALSE;
+			}
+			fu_remote_list_add_changed_id(remote_ids, remote_id);
+			return TRUE;
+		}
+	}
+
+	/* a new remote, or one that is currently shadowed by another with the same ID */
+	if (g_str_has_suffix(filename, ".conf")) {
+		g_set_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "%s is new", filename);
+		return FALSE;
+	}
+
+	/* a remotes.d directory itself */
+	if (g_file_test(filename, G_FILE_TEST_IS_DIR) ||
+	    g_str_has_suffix(filename, G_DIR_SEPARATOR_S "remotes.d")) {
+		g_set_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED, "%s changed", filename);
+		return FALSE;
+	}
+
+	/* e.g. an editor backup file */
+	g_debug("ignoring %s as not used by any remote", filename);
+	return TRUE;
+}
+
+static gboolean
+fu_remote_list_changed_cb(gpointer user_data)
+{
+	FuRemoteList *self = FU_REMOTE_LIST(user_data);
+	GHashTableIter iter;
+	gpointer key;
+	g_autoptr(GHashTable) changed_paths = self->changed_paths;
+	g_autoptr(GPtrArray) remote_ids = g_ptr_array_new_with_free_func(g_free);
+	g_autoptr(GError) error = NULL;
+
+	/* start collecting again */
+	self->changed_id = 0;
+	self->changed_paths = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+	/* only parse the remotes that changed, and fall back to everything */
+	g_hash_table_iter_init(&iter, changed_paths);
+	while (g_hash_table_iter_next(&iter, &key, NULL)) {
+		const gchar *filename = (const gchar *)key;
+		g_autoptr(GError) error_local = NULL;
+
+		if (!fu_remote_list_reload_filename(self, filename, remote_ids, &error_local)) {
+			g_info("%s, reloading all remotes", error_local->message);
+			if (!fu_remote_list_reload(self, &error))
+				g_warning("failed to rescan remotes: %s", error->message);
+			fu_remote_list_emit_changed(self, NULL);
+			return G_SOURCE_REMOVE;
+		}
+	}
+	if (remote_ids->len == 0)
+		return G_SOURCE_REMOVE;
+	if (!fu_remote_list_depsolve(self, &error))
+		g_warning("failed to rescan remotes: %s", error->message);
+	g_ptr_array_add(remote_ids, NULL);
+	fu_remote_list_emit_changed(self, (GStrv)remote_ids->pdata);
+	return G_SOURCE_REMOVE;
+}
+
 static gboolean
 fu_remote_list_load_metainfos(FuRemoteList *self, XbBuilder *builder, GError **error)
 {
@@ -713,7 +873,7 @@ fu_remote_list_set_testing_remote_enabled(FuRemoteList *self, gboolean enable, G
 	if (!fu_remote_list_reload(self, error))
 		return FALSE;
 
-	fu_remote_list_emit_changed(self);
+	fu_remote_list_emit_changed(self, NULL);
 
 	return TRUE;
 }
@@ -816,6 +976,7 @@ fu_remote_list_class_init(FuRemoteListClass *klass)
 	/**
 	 * FuRemoteList::changed:
 	 * @self: the #FuRemoteList instance that emitted the signal
+	 * @remote_ids: (nullable): the IDs of the remotes that changed, or %NULL for all
 	 *
 	 * The ::changed signal is emitted when the list of remotes has
 	 * changed, for instance when a remote has been added or removed.
@@ -826,9 +987,10 @@ fu_remote_list_class_init(FuRemoteListClass *klass)
 					       0,
 					       NULL,
 					       NULL,
-					       g_cclosure_marshal_VOID__VOID,
+					       g_cclosure_marshal_generic,
 					       G_TYPE_NONE,
-					       0);
+					       1,
+					       G_TYPE_STRV);
 	/**
 	 * FuRemoteList::added:
 	 * @self: the #FuRemoteList instance that emitted the signal
@@ -857,14 +1019,20 @@ static void
 fu_remote_list_init(FuRemoteList *self)
 {
 	self->array = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	self->monitors =
-	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_remote_list_monitor_unref);
+	self->monitors = g_hash_table_new_full(g_str_hash,
+					       g_str_equal,
+					       g_free,
+					       (GDestroyNotify)fu_remote_list_monitor_unref);
+	self->changed_paths = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	self->priorities = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 }
 
 static void
 fu_remote_list_finalize(GObject *obj)
 {
 	FuRemoteList *self = FU_REMOTE_LIST(obj);
+	if (self->changed_id != 0)
+		g_source_remove(self->changed_id);
 	if (self->ctx != NULL)
 		g_object_unref(self->ctx);
 	if (self->silo != NULL)
@@ -872,7 +1040,9 @@ fu_remote_list_finalize(GObject *obj)
 	if (self->query != NULL)
 		g_object_unref(self->query);
 	g_ptr_array_unref(self->array);
-	g_ptr_array_unref(self->monitors);
+	g_hash_table_unref(self->monitors);
+	g_hash_table_unref(self->changed_paths);
+	g_hash_table_unref(self->priorities);
 	g_free(self->lvfs_metadata_format);
 	G_OBJECT_CLASS(fu_remote_list_parent_class)->finalize(obj);
 }
@@ -97,6 +97,12 @@ fu_remote_load_from_filename(FwupdRemote *self,
 		else
 			fwupd_remote_remove_flag(self, FWUPD_REMOTE_FLAG_NO_PHASED_UPDATES);
 	}
+	if (g_key_file_has_key(kf, group, "AllowDeltaMetadata", NULL)) {
+		if (g_key_file_get_boolean(kf, group, "AllowDeltaMetadata", NULL))
+			fwupd_remote_add_flag(self, FWUPD_REMOTE_FLAG_ALLOW_DELTA_METADATA);
+		else
+			fwupd_remote_remove_flag(self, FWUPD_REMOTE_FLAG_ALLOW_DELTA_METADATA);
+	}
 	if (g_key_file_has_key(kf, group, "RequiresAuth", NULL)) {
 		if (g_key_file_get_boolean(kf, group, "RequiresAuth", NULL))
 			fwupd_remote_add_flag(self, FWUPD_REMOTE_FLAG_REQUIRES_AUTH);
@@ -240,6 +246,8 @@ fu_remote_save_to_filename(FwupdRemote *self,
 		g_key_file_set_boolean(kf, group, "AutomaticSecurityReports", TRUE);
 	if (fwupd_remote_has_flag(self, FWUPD_REMOTE_FLAG_REQUIRES_AUTH))
 		g_key_file_set_boolean(kf, group, "RequiresAuth", TRUE);
+	if (fwupd_remote_has_flag(self, FWUPD_REMOTE_FLAG_ALLOW_DELTA_METADATA))
+		g_key_file_set_boolean(kf, group, "AllowDeltaMetadata", TRUE);
 
 	/* save file */
 	if (!fu_path_mkdir_parent(filename, error))
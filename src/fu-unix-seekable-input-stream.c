@@ -229,6 +229,23 @@ fu_unix_seekable_input_stream_require_seal(FuUnixSeekableInputStream *stream, GE
 #endif
 }
 
+/**
+ * fu_unix_seekable_input_stream_get_fd:
+ * @stream: a #FuUnixSeekableInputStream
+ *
+ * Gets the file descriptor backing this stream, which is still owned by the stream.
+ *
+ * Returns: a file descriptor
+ *
+ * Since: 2.2.1
+ **/
+gint
+fu_unix_seekable_input_stream_get_fd(FuUnixSeekableInputStream *stream)
+{
+	g_return_val_if_fail(FU_IS_UNIX_SEEKABLE_INPUT_STREAM(stream), -1);
+	return stream->fd;
+}
+
 static void
 fu_unix_seekable_input_stream_class_init(FuUnixSeekableInputStreamClass *klass)
 {
@@ -22,5 +22,7 @@ FuInputStream *
 fu_unix_seekable_input_stream_new(gint fd, gboolean close_fd, GError **error);
 gboolean
 fu_unix_seekable_input_stream_require_seal(FuUnixSeekableInputStream *stream, GError **error);
+gint
+fu_unix_seekable_input_stream_get_fd(FuUnixSeekableInputStream *stream);
 
 G_END_DECLS